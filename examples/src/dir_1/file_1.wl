@@ -1,3 +1,3 @@
 load "../dir_2/file_2.wl";
 
-fun file1_fn() { file2_fn(); println("file1_fn() called"); }
+lambda file1_fn() { file2_fn(); println("file1_fn() called"); }
@@ -1,3 +1,3 @@
 load "pwd_file.wl";
 
-fun file2_fn() { pwd(); println("file2_fn() called"); }
+lambda file2_fn() { pwd(); println("file2_fn() called"); }
@@ -1 +1 @@
-fun pwd() { println("Additional function pwd() called"); }
+lambda pwd() { println("Additional function pwd() called"); }
@@ -1,3 +1,3 @@
 load "dir_1/file_1.wl";
 
-fun main() { print("main(): "); file1_fn(); }
+lambda main() { print("main(): "); file1_fn(); }
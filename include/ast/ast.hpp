@@ -5,7 +5,10 @@
 
 #include <boost/smart_ptr/local_shared_ptr.hpp>
 #include <boost/smart_ptr/make_local_shared.hpp>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -41,6 +44,53 @@ constexpr uint32_t operator|(type_t lhs, type_t rhs) noexcept(true) {
   return static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs);
 }
 
+/// Type of expression value, inferred by semantic analyzer.
+enum struct inferred_t : uint8_t {
+  UNKNOWN,
+  INTEGER,
+  FLOAT,
+  STRING,
+  ARRAY,
+  OBJECT
+};
+
+/// Node, that holds inferred type of its value (for loops - type of exit condition).
+/// Unknown by default, so evaluator uses generic path for unannotated nodes.
+class Annotated {
+public:
+  inferred_t inferred_type() const noexcept(true);
+  void set_inferred_type(inferred_t type) noexcept(true);
+
+private:
+  inferred_t inferred_type_ = inferred_t::UNKNOWN;
+};
+
+/// Storage of variable, resolved by semantic analyzer.
+enum struct scope_t : uint8_t {
+  /// Looked up by name at runtime.
+  UNRESOLVED,
+  /// Slot of lambda frame, parameters take first slots.
+  PARAMETER,
+  LOCAL,
+  /// Top-level or nested lambda, looked up by name at runtime.
+  GLOBAL
+};
+
+/// Node, that refers to variable by name.
+class Resolvable {
+public:
+  scope_t scope() const noexcept(true);
+  /// @pre    scope is parameter or local
+  uint32_t slot() const noexcept(true);
+  /// @return true if variable is stored in lambda frame
+  bool in_frame() const noexcept(true);
+  void resolve(scope_t scope, uint32_t slot = 0) noexcept(true);
+
+private:
+  scope_t scope_ = scope_t::UNRESOLVED;
+  uint32_t slot_ = 0;
+};
+
 class Object {
 public:
   virtual constexpr type_t ast_type() const noexcept(true);
@@ -57,16 +107,46 @@ private:
   std::vector<boost::local_shared_ptr<Object>> expressions_;
 };
 
+class BigInteger;
+
+/// Signed 64-bit integer, promoted to BigInteger once value doesn't fit into 64 bits.
+/// Value is demoted back as soon as it fits again, so small values are never big.
 class Integer : public Object {
 public:
+  /// value() of big integer. It's a valid small value as well, so it only hints, that
+  /// integer may be big: evaluator tests the value it has loaded instead of a separate tag.
+  static constexpr int64_t big_value = std::numeric_limits<int64_t>::min();
+
+  /// @param  data - decimal digits with optional leading minus
+  /// @throws std::invalid_argument if data isn't an integer
   Integer(std::string_view data) noexcept(false);
-  Integer(size_t data) noexcept(true);
-  size_t& value() noexcept(true);
-  const size_t& value() const noexcept(true);
+  Integer(int64_t data) noexcept(true);
+  Integer(BigInteger data) noexcept(false);
+  Integer(const Integer& other) noexcept(false);
+  Integer& operator=(const Integer& other) noexcept(false);
+  ~Integer() noexcept(true) override;
+  /// @pre    !is_big() if value is changed
+  /// @return value, big_value if integer is big
+  int64_t& value() noexcept(true);
+  /// @return value, big_value if integer is big
+  const int64_t& value() const noexcept(true);
+  bool is_big() const noexcept(true) {
+    return static_cast<bool>(big_);
+  }
+  /// @pre    is_big()
+  const BigInteger& big() const noexcept(true);
+  /// @return value as BigInteger, even if it's small
+  BigInteger to_big() const noexcept(false);
+  /// @post   !is_big()
+  void assign(int64_t data) noexcept(true);
+  void assign(BigInteger data) noexcept(false);
+  std::string to_string() const noexcept(false);
   constexpr type_t ast_type() const noexcept(true) override;
 
 private:
-  size_t data_;
+  int64_t data_;
+  /// Value, that doesn't fit into 64 bits, owned by integer and copied with it.
+  std::unique_ptr<const BigInteger> big_;
 };
 
 class Float : public Object {
@@ -92,7 +172,7 @@ private:
   std::string data_;
 };
 
-class Symbol : public Object {
+class Symbol : public Object, public Annotated, public Resolvable {
 public:
   Symbol(std::string name) noexcept(true);
   const std::string& name() const noexcept(true);
@@ -106,13 +186,14 @@ class Array : public Object {
 public:
   Array(std::vector<boost::local_shared_ptr<Object>> elements) noexcept(true);
   std::vector<boost::local_shared_ptr<Object>>& elements() noexcept(true);
+  const std::vector<boost::local_shared_ptr<Object>>& elements() const noexcept(true);
   constexpr type_t ast_type() const noexcept(true) override;
 
 private:
   std::vector<boost::local_shared_ptr<Object>> elements_;
 };
 
-class Unary : public Object {
+class Unary : public Object, public Annotated {
 public:
   Unary(token_t type, boost::local_shared_ptr<Object> operation) noexcept(true);
   boost::local_shared_ptr<Object>& operand() noexcept(true);
@@ -125,18 +206,48 @@ private:
   boost::local_shared_ptr<Object> operation_;
 };
 
-class Binary : public Object {
+/// State of binary, that specializes itself on execution (quickening).
+enum struct quickening_t : uint8_t {
+  /// Not executed yet.
+  UNQUICKENED,
+  /// Has handler for operand types of first execution.
+  QUICKENED,
+  /// Operands had other types, so binary uses type dispatch from now on.
+  GENERIC
+};
+
+class Binary : public Object, public Annotated {
 public:
+  /// Value of binary for operands of types, which handler is installed for. Result of
+  /// previous execution is passed to be reused, if nothing else refers to it.
+  using handler_t = boost::local_shared_ptr<Object> (*)(const boost::local_shared_ptr<Object>&, const boost::local_shared_ptr<Object>&, boost::local_shared_ptr<Object>& result);
+
   Binary(token_t type, boost::local_shared_ptr<Object> lhs, boost::local_shared_ptr<Object> rhs) noexcept(true);
   boost::local_shared_ptr<Object>& lhs() noexcept(true);
   const boost::local_shared_ptr<Object>& lhs() const noexcept(true);
   boost::local_shared_ptr<Object>& rhs() noexcept(true);
   const boost::local_shared_ptr<Object>& rhs() const noexcept(true);
   token_t type() const noexcept(true);
+  quickening_t quickening() const noexcept(true);
+  /// @pre    quickening is quickened
+  /// @return value of binary for given operands
+  boost::local_shared_ptr<Object> call_handler(const boost::local_shared_ptr<Object>& lhs, const boost::local_shared_ptr<Object>& rhs) noexcept(false);
+  /// @return true if handler is valid for operands of given types
+  bool guards(type_t lhs_type, type_t rhs_type) const noexcept(true);
+  /// @pre    quickened computes this binary for operands of given types
+  /// @post   quickening is quickened
+  void quicken(handler_t quickened, type_t lhs_type, type_t rhs_type) noexcept(true);
+  /// @post   quickening is generic, binary isn't quickened again
+  void deoptimize() noexcept(true);
   constexpr type_t ast_type() const noexcept(true) override;
 
 private:
   token_t type_;
+  quickening_t quickening_ = quickening_t::UNQUICKENED;
+  type_t lhs_guard_ = type_t::OBJECT;
+  type_t rhs_guard_ = type_t::OBJECT;
+  handler_t handler_ = nullptr;
+  boost::local_shared_ptr<Object> result_;
   boost::local_shared_ptr<Object> lhs_;
   boost::local_shared_ptr<Object> rhs_;
 };
@@ -152,9 +263,10 @@ private:
   std::vector<boost::local_shared_ptr<Object>> statements_;
 };
 
-class While : public Object {
+class While : public Object, public Annotated {
 public:
   While(boost::local_shared_ptr<Object> exit_condition, boost::local_shared_ptr<Block> block) noexcept(true);
+  boost::local_shared_ptr<Object>& exit_condition() noexcept(true);
   const boost::local_shared_ptr<Object>& exit_condition() const noexcept(true);
   const boost::local_shared_ptr<Block>& body() const noexcept(true);
   constexpr type_t ast_type() const noexcept(true) override;
@@ -164,7 +276,7 @@ private:
   boost::local_shared_ptr<Block> block_;
 };
 
-class For : public Object {
+class For : public Object, public Annotated {
 public:
   For() = default;
 
@@ -189,6 +301,7 @@ class If : public Object {
 public:
   If(boost::local_shared_ptr<Object> exit_condition, boost::local_shared_ptr<Block> body) noexcept(true);
   If(boost::local_shared_ptr<Object> exit_condition, boost::local_shared_ptr<Block> body, boost::local_shared_ptr<Block> else_body) noexcept(true);
+  boost::local_shared_ptr<Object>& condition() noexcept(true);
   const boost::local_shared_ptr<Object>& condition() const noexcept(true);
   const boost::local_shared_ptr<Block>& body() const noexcept(true);
   const boost::local_shared_ptr<Block>& else_body() const noexcept(true);
@@ -202,34 +315,86 @@ private:
 
 class Lambda : public Object {
 public:
+  using body_parser_t = std::function<boost::local_shared_ptr<Block>()>;
+
   Lambda(std::string name, std::vector<boost::local_shared_ptr<Object>> arguments, boost::local_shared_ptr<Block> body) noexcept(true);
+  /// @brief create lambda, which body is parsed on first parse_body() call
+  Lambda(std::string name, std::vector<boost::local_shared_ptr<Object>> arguments, body_parser_t body_parser) noexcept(true);
   std::string name() const noexcept(true);
   const std::vector<boost::local_shared_ptr<Object>>& arguments() const noexcept(true);
+  /// @return body, null if lambda is lazy
   const boost::local_shared_ptr<Block>& body() const noexcept(true);
+  /// @return true if body wasn't parsed yet
+  bool is_lazy() const noexcept(true);
+  /// @throws all exceptions from body parser
+  /// @return parsed body of lazy lambda, that should be passed to set_body() after checks
+  boost::local_shared_ptr<Block> parse_body() const noexcept(false);
+  /// @post   is_lazy() is false
+  void set_body(boost::local_shared_ptr<Block> body) noexcept(true);
+  /// @return true if variables of body are resolved to frame slots
+  bool is_bound() const noexcept(true);
+  /// @return count of parameters and locals
+  uint32_t frame_size() const noexcept(true);
+  /// @post   is_bound() is true
+  void bind(uint32_t frame_size) noexcept(true);
+  /// @return true if result depends only on arguments and call has no effects,
+  ///         false until effects are analyzed
+  bool is_pure() const noexcept(true);
+  void set_pure(bool pure) noexcept(true);
   constexpr type_t ast_type() const noexcept(true) override;
 
 private:
   std::string name_;
   std::vector<boost::local_shared_ptr<Object>> arguments_;
   boost::local_shared_ptr<Block> body_;
+  body_parser_t body_parser_;
+  std::optional<uint32_t> frame_size_;
+  bool pure_ = false;
 };
 
-class LambdaCall : public Object {
+/// Callee is resolved by semantic analyzer. Variable callee is kept as Resolvable.
+class LambdaCall : public Object, public Resolvable {
 public:
+  using builtin_t = std::function<std::optional<boost::local_shared_ptr<Object>>(const std::vector<boost::local_shared_ptr<Object>>&)>;
+
+  enum struct target_t : uint8_t {
+    /// Looked up by name at runtime.
+    UNRESOLVED,
+    BUILTIN,
+    LAMBDA,
+    /// Lambda, stored in variable.
+    VARIABLE
+  };
+
   LambdaCall(std::string name, std::vector<boost::local_shared_ptr<Object>> arguments) noexcept(true);
   const std::string& name() const noexcept(true);
+  std::vector<boost::local_shared_ptr<Object>>& arguments() noexcept(true);
   const std::vector<boost::local_shared_ptr<Object>>& arguments() const noexcept(true);
+  target_t target() const noexcept(true);
+  /// @pre    target is builtin
+  const builtin_t& builtin() const noexcept(true);
+  /// @pre    target is lambda
+  Lambda& lambda() const noexcept(true);
+  void bind(const builtin_t& builtin) noexcept(true);
+  /// @note   lambda is not owned, it must live as long as program tree
+  void bind(Lambda& lambda) noexcept(true);
+  /// @post   target is variable, resolved by Resolvable
+  void bind_variable() noexcept(true);
   constexpr type_t ast_type() const noexcept(true) override;
 
 private:
   std::string name_;
   std::vector<boost::local_shared_ptr<Object>> arguments_;
+  target_t target_ = target_t::UNRESOLVED;
+  const builtin_t* builtin_ = nullptr;
+  Lambda* lambda_ = nullptr;
 };
 
 class TypeCreator : public Object {
 public:
   TypeCreator(std::string name, std::vector<boost::local_shared_ptr<Object>> arguments) noexcept(true);
   const std::string& name() const noexcept(true);
+  std::vector<boost::local_shared_ptr<Object>>& arguments() noexcept(true);
   const std::vector<boost::local_shared_ptr<Object>>& arguments() const noexcept(true);
   constexpr type_t ast_type() const noexcept(true) override;
 
@@ -260,7 +425,7 @@ private:
   std::vector<std::pair<std::string, boost::local_shared_ptr<Object>>> arguments_;
 };
 
-class TypeFieldOperator : public Object {
+class TypeFieldOperator : public Object, public Resolvable {
 public:
   TypeFieldOperator(std::string type_name, std::string type_field) noexcept(true);
   const std::string& name() const noexcept(true);
@@ -0,0 +1,177 @@
+#ifndef WEAK_AST_BIG_INTEGER_HPP
+#define WEAK_AST_BIG_INTEGER_HPP
+
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ast {
+
+/// Integer of arbitrary size, stored as sign and magnitude. Magnitude is split into 32-bit
+/// limbs, least significant first, and values up to 128 bits keep limbs inline, so
+/// integers just above 64 bits don't allocate.
+///
+/// Division truncates toward zero and right shift rounds toward negative infinity, as
+/// they do for 64-bit integers. Bitwise operators work on two's complement representation.
+class BigInteger {
+public:
+  using limb_t = uint32_t;
+
+  /// Limbs of magnitude, least significant first. Up to inline_limbs limbs are kept in
+  /// place, longer magnitude is moved to heap as a whole.
+  class Limbs {
+  public:
+    static constexpr size_t inline_limbs = 4;
+
+    Limbs() noexcept(true) = default;
+
+    Limbs(size_t count, limb_t value) noexcept(false) {
+      resize(count, value);
+    }
+
+    Limbs(std::initializer_list<limb_t> limbs) noexcept(false) {
+      for (const limb_t limb : limbs) {
+        push_back(limb);
+      }
+    }
+
+    size_t size() const noexcept(true) {
+      return size_;
+    }
+
+    bool empty() const noexcept(true) {
+      return size_ == 0;
+    }
+
+    limb_t* begin() noexcept(true) {
+      return size_ <= inline_limbs ? inline_.data() : heap_.data();
+    }
+
+    const limb_t* begin() const noexcept(true) {
+      return size_ <= inline_limbs ? inline_.data() : heap_.data();
+    }
+
+    limb_t* end() noexcept(true) {
+      return begin() + size_;
+    }
+
+    const limb_t* end() const noexcept(true) {
+      return begin() + size_;
+    }
+
+    limb_t& operator[](size_t i) noexcept(true) {
+      return begin()[i];
+    }
+
+    limb_t operator[](size_t i) const noexcept(true) {
+      return begin()[i];
+    }
+
+    limb_t& front() noexcept(true) {
+      return begin()[0];
+    }
+
+    limb_t front() const noexcept(true) {
+      return begin()[0];
+    }
+
+    limb_t back() const noexcept(true) {
+      return begin()[size_ - 1];
+    }
+
+    void push_back(limb_t limb) noexcept(false) {
+      resize(size_ + 1, limb);
+    }
+
+    void pop_back() noexcept(false) {
+      resize(size_ - 1);
+    }
+
+    void clear() noexcept(true) {
+      heap_.clear();
+      size_ = 0;
+    }
+
+    /// @param  value - value of added limbs
+    void resize(size_t count, limb_t value = 0) noexcept(false);
+
+    bool operator==(const Limbs& other) const noexcept(true);
+
+  private:
+    size_t size_ = 0;
+    std::array<limb_t, inline_limbs> inline_{};
+    std::vector<limb_t> heap_;
+  };
+
+  /// @post   value is zero
+  BigInteger() noexcept(true) = default;
+
+  explicit BigInteger(int64_t value) noexcept(false);
+
+  /// @param  decimal - digits with optional leading minus
+  /// @return null if decimal has no digits or has other characters
+  static std::optional<BigInteger> parse(std::string_view decimal) noexcept(false);
+
+  bool is_zero() const noexcept(true);
+
+  bool is_negative() const noexcept(true);
+
+  bool fits_int64() const noexcept(true);
+
+  /// @pre    fits_int64()
+  int64_t to_int64() const noexcept(true);
+
+  /// @return the nearest double, infinity if value is out of its range
+  double to_double() const noexcept(true);
+
+  std::string to_string() const noexcept(false);
+
+  friend BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs) noexcept(false);
+  friend BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs) noexcept(false);
+  friend BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs) noexcept(false);
+  friend BigInteger operator&(const BigInteger& lhs, const BigInteger& rhs) noexcept(false);
+  friend BigInteger operator|(const BigInteger& lhs, const BigInteger& rhs) noexcept(false);
+  friend BigInteger operator^(const BigInteger& lhs, const BigInteger& rhs) noexcept(false);
+
+  /// @pre    divisor is not zero
+  /// @return quotient, truncated toward zero, and remainder with sign of dividend
+  static std::pair<BigInteger, BigInteger> divide(const BigInteger& dividend, const BigInteger& divisor) noexcept(false);
+
+  BigInteger shift_left(uint64_t bits) const noexcept(false);
+
+  BigInteger shift_right(uint64_t bits) const noexcept(false);
+
+  friend std::strong_ordering operator<=>(const BigInteger& lhs, const BigInteger& rhs) noexcept(true);
+  friend bool operator==(const BigInteger& lhs, const BigInteger& rhs) noexcept(true) = default;
+
+private:
+  using magnitude_t = Limbs;
+
+  BigInteger(bool negative, magnitude_t magnitude) noexcept(true);
+
+  /// @post   magnitude has no leading zero limbs, zero is not negative
+  void normalize() noexcept(true);
+
+  /// @param  limbs - count of limbs of result, enough to hold sign bit
+  /// @return value in two's complement
+  magnitude_t twos_complement(size_t limbs) const noexcept(false);
+
+  /// @param  complement - value in two's complement
+  static BigInteger from_twos_complement(magnitude_t complement) noexcept(false);
+
+  template <typename Operation>
+  static BigInteger bitwise(const BigInteger& lhs, const BigInteger& rhs, Operation operation) noexcept(false);
+
+  bool negative_ = false;
+  magnitude_t magnitude_;
+};
+
+}// namespace ast
+
+#endif// WEAK_AST_BIG_INTEGER_HPP
@@ -0,0 +1,195 @@
+#ifndef WEAK_AST_FLAT_TREE_HPP
+#define WEAK_AST_FLAT_TREE_HPP
+
+#include "../ast/ast.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ast {
+
+/// Program tree stored as struct of arrays.
+///
+/// Nodes are laid out in pre-order, so each subtree is a contiguous range:
+/// the first child of node N is N + 1, and the next sibling of node N is end(N).
+/// Literals and names live in side tables, referenced by node payload.
+///
+/// Children of nodes:
+///   UNARY           - operand
+///   BINARY          - lhs, rhs
+///   ARRAY, BLOCK    - elements
+///   WHILE           - condition, body
+///   FOR             - init, condition, increment (each of them may be null), body
+///   IF              - condition, body, else body (may be null)
+///   LAMBDA          - arguments, body
+///   LAMBDA_CALL     - arguments
+///   TYPE_CREATOR    - arguments
+///   TYPE_DEFINITION - fields as symbols
+///
+/// Inferred types of annotated nodes (symbols, unary, binary and loops) are kept as well.
+/// Integer, that doesn't fit into 64 bits, is kept as decimal in string table, and its
+/// operator byte is set.
+///
+/// Read-only passes walk it directly: semantic analysis, tree shaking and the program
+/// cache image. Evaluator and rewriting optimizer passes work on object nodes, since
+/// they replace subtrees and evaluation changes literals in place.
+class FlatTree {
+public:
+  using index_t = uint32_t;
+
+  class ChildIterator {
+  public:
+    ChildIterator(const FlatTree& tree, index_t node) noexcept(true)
+      : tree_(&tree)
+      , node_(node) {}
+
+    index_t operator*() const noexcept(true) {
+      return node_;
+    }
+
+    ChildIterator& operator++() noexcept(true) {
+      node_ = tree_->end(node_);
+      return *this;
+    }
+
+    bool operator==(const ChildIterator& rhs) const noexcept(true) {
+      return node_ == rhs.node_;
+    }
+
+  private:
+    const FlatTree* tree_;
+    index_t node_;
+  };
+
+  struct Children {
+    ChildIterator first;
+    ChildIterator last;
+
+    ChildIterator begin() const noexcept(true) {
+      return first;
+    }
+    ChildIterator end() const noexcept(true) {
+      return last;
+    }
+  };
+
+  /// @throws std::runtime_error if tree contains runtime-only node (e.g. type object)
+  static FlatTree flatten(const RootObject& root) noexcept(false);
+
+  /// @return tree of objects, equal to the flattened one
+  boost::local_shared_ptr<RootObject> materialize() const noexcept(false);
+
+  /// @brief  all arrays written one after another, suitable for memcpy or mmap
+  /// @note   numbers are stored in host byte order, so image is valid only on the machine that wrote it
+  std::string image() const noexcept(false);
+
+  /// @throws std::runtime_error if image is truncated or tree structure is broken
+  static FlatTree from_image(std::string_view image) noexcept(false);
+
+  bool operator==(const FlatTree&) const = default;
+
+  index_t size() const noexcept(true) {
+    return static_cast<index_t>(kinds_.size());
+  }
+
+  /// @return node type, type_t{0} for absent optional child
+  type_t kind(index_t node) const noexcept(true) {
+    return kinds_[node] == 0 ? type_t{0} : static_cast<type_t>(1U << kinds_[node]);
+  }
+
+  bool is_null(index_t node) const noexcept(true) {
+    return kinds_[node] == 0;
+  }
+
+  /// @pre    node is unary or binary
+  token_t op(index_t node) const noexcept(true) {
+    return static_cast<token_t>(operators_[node]);
+  }
+
+  /// @return index of node after subtree of node
+  index_t end(index_t node) const noexcept(true) {
+    return ends_[node];
+  }
+
+  Children children(index_t node) const noexcept(true) {
+    return {ChildIterator(*this, node + 1), ChildIterator(*this, ends_[node])};
+  }
+
+  Children roots() const noexcept(true) {
+    return {ChildIterator(*this, 0), ChildIterator(*this, size())};
+  }
+
+  /// @pre    node has at least n + 1 children
+  index_t child(index_t node, size_t n) const noexcept(true) {
+    index_t result = node + 1;
+    while (n-- > 0) {
+      result = ends_[result];
+    }
+    return result;
+  }
+
+  size_t children_count(index_t node) const noexcept(true) {
+    size_t count = 0;
+    for ([[maybe_unused]] index_t child : children(node)) {
+      ++count;
+    }
+    return count;
+  }
+
+  /// @return inferred type of annotated node, unknown for others
+  inferred_t inferred_type(index_t node) const noexcept(true) {
+    return static_cast<inferred_t>(inferred_types_[node]);
+  }
+
+  /// @pre    node is integer
+  bool is_big_integer(index_t node) const noexcept(true) {
+    return operators_[node] != 0;
+  }
+
+  /// @pre    node is integer, that isn't big
+  int64_t integer(index_t node) const noexcept(true) {
+    return integers_[payloads_[node]];
+  }
+
+  /// @pre    node is float
+  double floating(index_t node) const noexcept(true) {
+    return floats_[payloads_[node]];
+  }
+
+  /// @pre    node is string, symbol or named node, type field has two strings (name, field)
+  std::string_view string(index_t node, size_t n = 0) const noexcept(true) {
+    const index_t id = payloads_[node] + static_cast<index_t>(n);
+    return std::string_view(characters_).substr(string_offsets_[id], string_offsets_[id + 1] - string_offsets_[id]);
+  }
+
+private:
+  index_t add_node(type_t kind, token_t op, index_t payload) noexcept(false);
+  index_t add_string(std::string_view string) noexcept(false);
+  void flatten_node(const boost::local_shared_ptr<Object>& node) noexcept(false);
+  void flatten_nodes(const std::vector<boost::local_shared_ptr<Object>>& nodes) noexcept(false);
+
+  boost::local_shared_ptr<Object> materialize_node(index_t node) const noexcept(false);
+  std::vector<boost::local_shared_ptr<Object>> materialize_children(index_t node, index_t last) const noexcept(false);
+  boost::local_shared_ptr<Block> materialize_block(index_t node) const noexcept(false);
+
+  /// @throws std::runtime_error if subtrees overlap, payloads are out of range or
+  ///         node has wrong number of children
+  void validate() const noexcept(false);
+
+  std::vector<uint8_t> kinds_;
+  std::vector<uint8_t> operators_;
+  std::vector<uint8_t> inferred_types_;
+  std::vector<index_t> ends_;
+  std::vector<index_t> payloads_;
+
+  std::vector<int64_t> integers_;
+  std::vector<double> floats_;
+  std::vector<index_t> string_offsets_{0};
+  std::string characters_;
+};
+
+}// namespace ast
+
+#endif// WEAK_AST_FLAT_TREE_HPP
@@ -0,0 +1,55 @@
+#ifndef WEAK_CACHE_PROGRAM_CACHE_HPP
+#define WEAK_CACHE_PROGRAM_CACHE_HPP
+
+#include "../ast/ast.hpp"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// On-disk cache of analyzed programs, one file per program entry point.
+///
+/// Program is cached per variant, that names every option changing its tree (tree
+/// shaking, optimizer level and passes), so runs with other options don't share entries.
+///
+/// @note Entry is valid while contents of every loaded file and interpreter
+///       executable are unchanged. Entries are replaced by atomic rename, so
+///       concurrent writers and readers always see a complete file.
+class ProgramCache {
+public:
+  struct Source {
+    /// Canonical path.
+    std::string path;
+    /// FNV-1a hash of file contents.
+    uint64_t hash;
+  };
+
+  /// @param directory - created on first store()
+  explicit ProgramCache(std::filesystem::path directory) noexcept(true);
+
+  /// @return $XDG_CACHE_HOME/weak_language, ~/.cache/weak_language if
+  ///         XDG_CACHE_HOME isn't set
+  static std::filesystem::path default_directory() noexcept(false);
+
+  /// @return FNV-1a hash of file contents, 0 if file cannot be read
+  static uint64_t hash_file(const std::string& path) noexcept(true);
+
+  /// @brief  map entry of filename to memory and check its sources
+  /// @param  variant - options, program was compiled with
+  /// @return cached program, null pointer if there is no valid entry
+  boost::local_shared_ptr<ast::RootObject> load(std::string_view filename, std::string_view variant = {}) const noexcept(true);
+
+  /// @brief  replace entry of filename, errors are ignored since cache is optional
+  /// @param  sources - all files of program, the entry point is the last one
+  /// @param  variant - options, program was compiled with
+  void store(std::string_view filename, const std::vector<Source>& sources, const ast::RootObject& program, std::string_view variant = {}) const noexcept(true);
+
+  /// @return path to cache entry of filename, compiled with variant options
+  std::filesystem::path entry_path(std::string_view filename, std::string_view variant = {}) const noexcept(false);
+
+private:
+  std::filesystem::path directory_;
+};
+
+#endif// WEAK_CACHE_PROGRAM_CACHE_HPP
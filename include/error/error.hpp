@@ -3,6 +3,7 @@
 
 #include "eval_error.hpp"
 #include "lexical_error.hpp"
+#include "load_error.hpp"
 #include "parse_error.hpp"
 #include "semantic_error.hpp"
 
@@ -0,0 +1,15 @@
+#ifndef WEAK_ERROR_LOAD_ERROR_HPP
+#define WEAK_ERROR_LOAD_ERROR_HPP
+
+#include "../../include/error/common_error.hpp"
+
+struct LoadError : public CommonError {
+public:
+  explicit LoadError(std::string_view argument)
+    : CommonError("load_error", argument) {}
+  template <typename... Args>
+  explicit LoadError(const char* fmt, Args&&... args)
+    : CommonError("load_error", format(fmt, std::forward<Args>(args)...)) {}
+};
+
+#endif//WEAK_ERROR_LOAD_ERROR_HPP
@@ -2,16 +2,46 @@
 #define WEAK_EVAL_HPP
 
 #include "../ast/ast.hpp"
+#include "../eval/memo_cache.hpp"
+#include "../eval/tiering.hpp"
 #include "../storage/storage.hpp"
 
 #include <boost/pool/pool_alloc.hpp>
 
 class Evaluator {
 public:
+  /// @brief create evaluator without program, statements are passed to eval_statement()
+  Evaluator() noexcept(true) = default;
+
   Evaluator(const boost::local_shared_ptr<ast::RootObject>& program) noexcept(false);
 
   void eval() noexcept(false);
 
+  /// @brief  declare lambda or type definition, evaluate any other statement in global scope
+  /// @post   storage is in global scope even if exception was thrown
+  /// @throws all exceptions from eval
+  /// @return statement value, null for declarations
+  boost::local_shared_ptr<ast::Object> eval_statement(const boost::local_shared_ptr<ast::Object>& statement) noexcept(false);
+
+  static constexpr size_t default_memo_capacity = 4096;
+
+  /// @brief  cache results of lambdas, marked pure by semantic analyzer and returning
+  ///         new object, when they are called with numbers and strings
+  /// @param  capacity - max count of cached calls, 0 disables memoization
+  /// @post   previously cached results and counters are dropped
+  void enable_memoization(size_t capacity = default_memo_capacity) noexcept(true);
+
+  /// @return memoization counters, zeros if memoization is disabled
+  MemoCache::Stats memo_stats() const noexcept(true);
+
+  /// @brief  count calls and loop iterations of bound lambdas, optimize hot ones
+  ///         while program runs (see Tiering)
+  /// @post   previous profiles and events are dropped
+  void enable_tiering(Tiering::Thresholds thresholds = {}) noexcept(true);
+
+  /// @return tier-up events, empty if tiering is disabled
+  std::vector<Tiering::Event> tier_events() const noexcept(false);
+
 private:
   /// @throws EvalError if lambda not found
   /// @throws TypeError if non-lambdaal object passed
@@ -19,6 +49,33 @@ private:
   /// @throws all exceptions from eval
   boost::local_shared_ptr<ast::Object> call_lambda(std::string_view name, const std::vector<boost::local_shared_ptr<ast::Object>>& evaluated_args) noexcept(false);
 
+  /// @brief  call lambda, resolved by name or by semantic analyzer; bound lambda keeps its
+  ///         parameters and locals in frame, other one in storage
+  /// @throws EvalError in case of mismatch in the number of arguments
+  /// @throws all exceptions from eval
+  boost::local_shared_ptr<ast::Object> call_lambda(ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& evaluated_args) noexcept(false);
+
+  /// @brief  parse, analyze and bind body of lazy lambda, by the same rules as eager one
+  /// @throws ParseError, SemanticError, lambda stays lazy in that case
+  void compile_lazy_body(ast::Lambda& lambda) noexcept(false);
+
+  /// @brief  evaluate body of lambda, bypassing memoization
+  /// @throws EvalError in case of mismatch in the number of arguments
+  /// @throws all exceptions from eval
+  boost::local_shared_ptr<ast::Object> invoke_lambda(ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& evaluated_args) noexcept(false);
+
+  /// @brief  evaluate body of lambda, bypassing memoization and tiering
+  /// @throws EvalError in case of mismatch in the number of arguments
+  /// @throws all exceptions from eval
+  boost::local_shared_ptr<ast::Object> eval_lambda_body(ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& evaluated_args) noexcept(false);
+
+  /// @return frame slot of resolved variable, or storage record
+  /// @throws EvalError if variable not found or was not assigned yet
+  boost::local_shared_ptr<ast::Object>& variable(const ast::Resolvable& resolvable, const std::string& name) noexcept(false);
+
+  /// @throws std::bad_alloc
+  void assign(const ast::Symbol& symbol, boost::local_shared_ptr<ast::Object> value) noexcept(false);
+
   /// @throws all exceptions from call_lambda or builtin lambdas
   boost::local_shared_ptr<ast::Object> eval_lambda_call(const boost::local_shared_ptr<ast::LambdaCall>& lambda_call) noexcept(false);
 
@@ -54,12 +111,71 @@ private:
   /// @throws EvalError if type mismatch
   boost::local_shared_ptr<ast::Object> eval_type_field_access(const boost::local_shared_ptr<ast::TypeFieldOperator>& type_field) noexcept(false);
 
+  /// @brief  evaluate expression, inferred as integer, without type dispatch and
+  ///         allocation of intermediate values
+  /// @pre    expression is inferred as integer by semantic analyzer
+  /// @post   if value doesn't fit into 64 bits, and expression isn't a literal or
+  ///         variable, overflow_ holds it, caller takes it with integer_object() or drops it
+  /// @throws all exceptions from eval
+  /// @return value of expression, ast::Integer::big_value if it may not fit into 64 bits
+  int64_t eval_integer(const boost::local_shared_ptr<ast::Object>& expression) noexcept(false);
+
+  /// @brief  evaluate binary, inferred as integer, as eval_integer() does
+  /// @throws all exceptions from eval
+  int64_t eval_integer_binary(const ast::Binary& binary) noexcept(false);
+
+  /// @return value of integer, ast::Integer::big_value if it's big, then it's kept in overflow_
+  int64_t unpack_integer(const boost::local_shared_ptr<ast::Object>& integer) noexcept(true);
+
+  /// @post   overflow_ holds integer if it's big
+  /// @return ast::Integer::big_value
+  int64_t keep_overflow(const boost::local_shared_ptr<ast::Object>& integer) noexcept(true);
+
+  /// @brief  evaluate integer binary, which lhs may not fit into 64 bits
+  /// @param  lhs - result of integer_object()
+  /// @throws all exceptions from eval
+  int64_t eval_big_binary(const ast::Binary& binary, boost::local_shared_ptr<ast::Object> lhs) noexcept(false);
+
+  /// @brief  evaluate integer binary, which result or rhs may not fit into 64 bits
+  /// @param  rhs - result of eval_integer()
+  /// @throws all exceptions from eval
+  int64_t eval_big_binary(const ast::Binary& binary, int64_t lhs, int64_t rhs) noexcept(false);
+
+  /// @brief  compound assignment to integer variable, which value, rhs or result may not fit into 64 bits
+  /// @param  rhs - result of eval_integer() for binary rhs
+  /// @throws all exceptions from eval
+  void eval_big_assign_binary(const ast::Binary& binary, const boost::local_shared_ptr<ast::Object>& variable, int64_t rhs) noexcept(false);
+
+  /// @param  value - result of eval_integer() for expression
+  /// @return integer with the value: bignum from overflow_, literal or value of variable
+  ///         if they are big, new integer otherwise
+  boost::local_shared_ptr<ast::Object> integer_object(const boost::local_shared_ptr<ast::Object>& expression, int64_t value) noexcept(false);
+
+  /// @brief  integer_object() for ast::Integer::big_value
+  boost::local_shared_ptr<ast::Object> big_integer_object(const boost::local_shared_ptr<ast::Object>& expression) noexcept(false);
+
+  /// @brief  evaluate condition, inferred as integer
+  /// @throws all exceptions from eval
+  bool eval_condition(const boost::local_shared_ptr<ast::Object>& condition) noexcept(false);
+
   /// @throws all exceptions from internal lambdas
   boost::local_shared_ptr<ast::Object> eval(const boost::local_shared_ptr<ast::Object>& expression) noexcept(false);
 
   std::vector<boost::local_shared_ptr<ast::Object>> expressions_;
   std::unordered_map<std::string, std::function<boost::local_shared_ptr<ast::Object>(const std::vector<boost::local_shared_ptr<ast::Object>>&)>> type_creators_;
   Storage storage_;
+  /// Frames of bound lambdas, that are called now, one after another.
+  std::vector<boost::local_shared_ptr<ast::Object>> frames_;
+  size_t frame_base_ = 0;
+  std::optional<MemoCache> memo_;
+  /// Top-level lambdas, that bodies of lazy lambdas are bound to, built on first lazy call.
+  std::optional<std::unordered_map<std::string, ast::Lambda*>> lazy_globals_;
+  std::optional<Tiering> tiering_;
+  /// Profile of running lambda, null if it's not profiled.
+  Tiering::Profile* profile_ = nullptr;
+  /// Result of eval_integer(), that doesn't fit into 64 bits, null if it's a literal or
+  /// value of variable, since they are read again.
+  boost::local_shared_ptr<ast::Object> overflow_;
 };
 
 #endif// WEAK_EVAL_HPP
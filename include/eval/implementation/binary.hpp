@@ -18,6 +18,27 @@ boost::local_shared_ptr<ast::Object> binary_implementation(
     const boost::local_shared_ptr<ast::Object>& lhs,
     const boost::local_shared_ptr<ast::Object>& rhs) noexcept(false);
 
+/// @brief  select handler, that computes binary for operands of given types without
+///         type dispatch, to quicken binary node with it
+/// @return handler, null if binary_implementation() throws for such operands
+ast::Binary::handler_t quickened_binary_implementation(
+    ast::type_t left_type,
+    ast::type_t right_type,
+    token_t operation_type) noexcept(true);
+
+/// @brief  arithmetic of two integers without type dispatch and allocation
+/// @param  result - the same value, as integer created by binary_implementation()
+/// @throws EvalError if operator is invalid, divisor is zero or shift is negative
+/// @return false if result doesn't fit into 64 bits, so it has to be computed by
+///         binary_implementation()
+bool integral_binary_implementation(token_t operation_type, int64_t lhs, int64_t rhs, int64_t& result) noexcept(false);
+
+/// @brief  compound assignment of two integers, lhs isn't changed
+/// @param  result - new value of variable, the same as assign_binary_implementation() stores
+/// @throws EvalError if operator is invalid, divisor is zero or shift is negative
+/// @return false if result doesn't fit into 64 bits
+bool integral_assign_binary_implementation(token_t operation_type, int64_t lhs, int64_t rhs, int64_t& result) noexcept(false);
+
 /// @throws EvalError if operator is invalid
 /// @throws EvalError if expression types are mismatch
 boost::local_shared_ptr<ast::Object> assign_binary_implementation(
@@ -5,6 +5,10 @@
 
 namespace eval_context {
 
+/// @brief  increment or decrement integer in place, promoting it to bignum on overflow
+/// @throws EvalError if operator is invalid
+void integral_unary_implementation(token_t unary_type, ast::Integer& integer) noexcept(false);
+
 /// @throws EvalError if operator is invalid
 void unary_implementation(
     token_t unary_type,
@@ -0,0 +1,64 @@
+#ifndef WEAK_EVAL_MEMO_CACHE_HPP
+#define WEAK_EVAL_MEMO_CACHE_HPP
+
+#include "../ast/ast.hpp"
+
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Results of pure lambdas, keyed on lambda and argument values, with least
+/// recently used entry evicted first.
+///
+/// Only numbers and strings are cached, both as arguments and as results, since
+/// evaluator changes numbers in place and arrays or objects may be mutated by
+/// array builtins after the call. Found results are copied for the same reason.
+///
+/// Uncached call may return object of callee itself, such as a parameter or a literal
+/// of body, which caller changes in place, so only lambdas returning new object on
+/// every call are cached.
+class MemoCache {
+public:
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+  };
+
+  /// @pre    capacity > 0
+  explicit MemoCache(size_t capacity) noexcept(true);
+
+  /// @return true if lambda is pure and returns new object on every call
+  bool accepts(const ast::Lambda& lambda) noexcept(false);
+
+  /// @return key of call, null if some argument is not a number or string
+  static std::optional<std::string> key(const ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false);
+
+  /// @brief  count hit or miss, make found entry most recently used
+  /// @return copy of cached result (which is null for lambda without value), or
+  ///         std::nullopt if call is not cached
+  std::optional<boost::local_shared_ptr<ast::Object>> find(const std::string& key) noexcept(false);
+
+  /// @brief  remember result of call, unless it's not a number or string
+  /// @post   size() <= capacity
+  void insert(std::string key, const boost::local_shared_ptr<ast::Object>& result) noexcept(false);
+
+  size_t size() const noexcept(true);
+
+  const Stats& stats() const noexcept(true);
+
+private:
+  using entries_t = std::list<std::pair<std::string, boost::local_shared_ptr<ast::Object>>>;
+
+  size_t capacity_;
+  /// Most recently used first.
+  entries_t entries_;
+  std::unordered_map<std::string, entries_t::iterator> index_;
+  /// Lambda -> accepts(lambda).
+  std::unordered_map<const ast::Lambda*, bool> lambdas_;
+  Stats stats_;
+};
+
+#endif// WEAK_EVAL_MEMO_CACHE_HPP
@@ -0,0 +1,36 @@
+#ifndef WEAK_EVAL_SESSION_HPP
+#define WEAK_EVAL_SESSION_HPP
+
+#include "../eval/eval.hpp"
+
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/// Interactive session. Only the new input is compiled each time, and it is
+/// evaluated by one long-living Evaluator, so lambdas, types and variables
+/// defined by previous inputs stay visible.
+class Session {
+public:
+  /// @throws LexicalError, ParseError, SemanticError while compiling input
+  /// @throws all exceptions from Evaluator::eval_statement(), statements
+  ///         evaluated before failed one take effect
+  /// @return value of the last statement, null if it has no value
+  boost::local_shared_ptr<ast::Object> eval(std::string_view input) noexcept(false);
+
+  /// @return false if input has unclosed braces or parentheses, so more lines are expected
+  static bool is_complete(std::string_view input) noexcept(true);
+
+  /// @brief  read lines until input is complete, empty line is read or stream ends
+  /// @param  prompt - receives continuation prompt before each next line
+  /// @return input, incomplete one if stream ends inside it, so eval() reports it;
+  ///         null if stream ends before any line
+  static std::optional<std::string> read_input(std::istream& input, std::ostream& prompt) noexcept(false);
+
+private:
+  Evaluator evaluator_;
+};
+
+#endif// WEAK_EVAL_SESSION_HPP
@@ -0,0 +1,102 @@
+#ifndef WEAK_EVAL_TIERING_HPP
+#define WEAK_EVAL_TIERING_HPP
+
+#include "../ast/ast.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Counters of calls and loop iterations (back edges) of lambdas, that decide when
+/// lambda is hot enough to be optimized while program runs (tier-up). Hot lambda is
+/// cloned, the clone is optimized by the full pipeline and is called instead of lambda
+/// from then on. Cold lambdas are evaluated as is, so they cost nothing to optimize.
+///
+/// Types of arguments are recorded until tier-up. If all calls passed the same types
+/// and some of them are numbers, clone body is inferred for these parameter types, so
+/// evaluator takes integer paths for parameters too. Such clone is guarded: call with
+/// arguments of other types runs lambda itself, and after as many misses as the calls
+/// threshold the clone is replaced by one without parameter types.
+///
+/// Tier-up happens on call, when calls reach their threshold, or on loop back edge,
+/// when back edges do. Running call keeps its body, so clone, made on back edge, is
+/// run from the next call on. Thresholds may be set by --tier-calls and
+/// --tier-back-edges options.
+class Tiering {
+public:
+  struct Thresholds {
+    size_t calls = 1000;
+    size_t back_edges = 10000;
+  };
+
+  enum struct reason_t : uint8_t {
+    CALLS,
+    BACK_EDGES,
+    /// Specialized clone was skipped too often.
+    GUARD_MISSES
+  };
+
+  struct Event {
+    std::string lambda;
+    reason_t reason;
+    size_t calls = 0;
+    size_t back_edges = 0;
+    /// Types, assumed for parameters, empty if clone is not specialized.
+    std::vector<ast::inferred_t> parameters;
+    /// Changes of optimizer passes.
+    size_t changes = 0;
+  };
+
+  struct Profile {
+    /// Profiled lambda.
+    const ast::Lambda* lambda = nullptr;
+    size_t calls = 0;
+    size_t back_edges = 0;
+    size_t misses = 0;
+    /// Types of arguments of all recorded calls, valid if not polymorphic.
+    std::vector<ast::type_t> signature;
+    bool polymorphic = false;
+    /// Clone, that is called instead of lambda, null before tier-up.
+    boost::local_shared_ptr<ast::Lambda> optimized;
+    /// Types of arguments, required by specialized clone, empty if clone is generic.
+    std::vector<ast::type_t> guard;
+  };
+
+  struct Entry {
+    /// Counts back edges of loops of this call.
+    Profile& profile;
+    /// Lambda body to run, null to run lambda itself. Held by caller, since recursive
+    /// call may replace the clone.
+    boost::local_shared_ptr<ast::Lambda> target;
+  };
+
+  explicit Tiering(Thresholds thresholds) noexcept(true);
+
+  /// @brief  count call of lambda and record types of its arguments, tier lambda up,
+  ///         if it's hot
+  /// @pre    lambda is bound and lives as long as tiering
+  /// @throws all exceptions from optimizer
+  Entry enter(const ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false);
+
+  /// @brief  count iteration of loop of profiled call, tier its lambda up, if loops
+  ///         of all its calls made enough iterations
+  /// @throws all exceptions from optimizer
+  void count_back_edge(Profile& profile) noexcept(false) {
+    if (++profile.back_edges == thresholds_.back_edges && !profile.optimized) [[unlikely]] {
+      tier_up(*profile.lambda, profile, reason_t::BACK_EDGES);
+    }
+  }
+
+  /// @return tier-up events in order they happened
+  const std::vector<Event>& events() const noexcept(true);
+
+private:
+  /// @post   profile.optimized is optimized clone of lambda
+  void tier_up(const ast::Lambda& lambda, Profile& profile, reason_t reason) noexcept(false);
+
+  Thresholds thresholds_;
+  std::unordered_map<const ast::Lambda*, Profile> profiles_;
+  std::vector<Event> events_;
+};
+
+#endif// WEAK_EVAL_TIERING_HPP
@@ -0,0 +1,24 @@
+#ifndef WEAK_FNV1A_HPP
+#define WEAK_FNV1A_HPP
+
+#include <cstdint>
+#include <string_view>
+
+namespace fnv1a {
+
+static constexpr uint64_t offset_basis = 0xCBF29CE484222325;
+static constexpr uint64_t prime = 0x100000001B3;
+
+/// @param  seed - hash of preceding data, allows to hash data by parts
+constexpr uint64_t create(std::string_view buffer, uint64_t seed = offset_basis) noexcept {
+  uint64_t hash = seed;
+  for (char c : buffer) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= prime;
+  }
+  return hash;
+}
+
+}// namespace fnv1a
+
+#endif// WEAK_FNV1A_HPP
@@ -0,0 +1,178 @@
+#ifndef WEAK_IR_HPP
+#define WEAK_IR_HPP
+
+#include "../ast/ast.hpp"
+#include "../lexer/token.hpp"
+
+#include <boost/smart_ptr/local_shared_ptr.hpp>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/// Mid-level representation of lambda bodies in static single assignment form.
+namespace ir {
+
+/// Index of instruction in function, which is also its value.
+using value_t = uint32_t;
+/// Index of basic block in function.
+using block_t = uint32_t;
+
+constexpr block_t no_block = std::numeric_limits<block_t>::max();
+
+/// Values are references to objects, as in evaluator: literals are shared, and UNARY
+/// and UPDATE change object of their first operand in place.
+///
+/// Operands of instructions:
+///   CONSTANT, PARAMETER, LOAD - none
+///   BINARY, UPDATE            - lhs, rhs
+///   UNARY, FIELD              - operand
+///   CALL                      - callee (only for lambda in variable), arguments
+///   CREATE                    - arguments
+///   PHI                       - one value per predecessor
+///   BRANCH                    - condition
+///   RETURN                    - value of lambda, if any
+enum struct opcode_t : uint8_t {
+  /// Literal or array of literals of body. Evaluator changes literals in place, so
+  /// node is shared with program tree.
+  CONSTANT,
+  PARAMETER,
+  /// Lambda or free variable, looked up by name at runtime.
+  LOAD,
+  /// Arithmetic, comparison or logic, gives new object.
+  BINARY,
+  /// Increment, decrement or negation of operand in place, gives operand.
+  UNARY,
+  /// Compound assignment, gives new value of variable, which may be its old object.
+  UPDATE,
+  CALL,
+  CREATE,
+  FIELD,
+  PHI,
+  JUMP,
+  BRANCH,
+  RETURN
+};
+
+/// @return true if instruction ends basic block
+constexpr bool is_terminator(opcode_t opcode) noexcept(true) {
+  return opcode == opcode_t::JUMP || opcode == opcode_t::BRANCH || opcode == opcode_t::RETURN;
+}
+
+struct Instruction {
+  opcode_t opcode = opcode_t::CONSTANT;
+  ast::inferred_t type = ast::inferred_t::UNKNOWN;
+  /// Operator of BINARY, UNARY and UPDATE.
+  token_t op = token_t::NONE;
+  std::vector<value_t> operands;
+  /// Incoming block of each operand of PHI, successors of JUMP and BRANCH (taken if
+  /// condition is true, then otherwise).
+  std::vector<block_t> blocks;
+  /// Literal of CONSTANT, symbol of LOAD, call of CALL, creator of CREATE, field
+  /// operator of FIELD. Gives names and callee.
+  boost::local_shared_ptr<ast::Object> node;
+  /// Position of PARAMETER.
+  uint32_t index = 0;
+  /// Block, which contains instruction, no_block if instruction is removed.
+  block_t block = no_block;
+};
+
+struct Block {
+  /// Phis first, terminator last.
+  std::vector<value_t> instructions;
+  std::vector<block_t> predecessors;
+};
+
+/// Control flow graph of one lambda body. Block 0 is entry, RETURN leaves function.
+class Function {
+public:
+  static constexpr block_t entry = 0;
+
+  /// @pre    lambda is bound
+  /// @throws std::runtime_error if body has construct, which IR doesn't express with
+  ///         the same evaluation: nested lambda, assignment out of frame, array literal
+  ///         of expressions, assignment used as value, for loop without integral counter
+  static Function lower(const ast::Lambda& lambda) noexcept(false);
+
+  /// @brief  replace body of lambda by statements, that evaluate function, and bind
+  ///         lambda to new frame
+  /// @pre    function is verified; control flow is structured: every loop has one
+  ///         header, and every branch, that is not loop exit, meets at its
+  ///         post-dominator
+  /// @throws std::runtime_error if control flow isn't structured
+  void materialize(ast::Lambda& lambda) const noexcept(false);
+
+  /// @throws std::runtime_error with description of the first broken rule: blocks end
+  ///         with the only terminator, phis are first and have one operand per
+  ///         predecessor, every value dominates its uses, and types agree
+  void verify() const noexcept(false);
+
+  /// @return textual form, one instruction per line, values numbered in order of blocks
+  std::string dump() const noexcept(false);
+
+  Function(std::string name, uint32_t parameters) noexcept(true);
+
+  block_t add_block() noexcept(false);
+
+  /// @brief  add instruction to the end of block, terminator links block to its successors
+  value_t append(block_t block, Instruction instruction) noexcept(false);
+
+  /// @brief  add phi without operands after other phis of block
+  value_t add_phi(block_t block, ast::inferred_t type) noexcept(false);
+
+  /// @brief  make all uses of value refer to other value
+  void replace_uses(value_t from, value_t to) noexcept(true);
+
+  /// @pre    value isn't used
+  void remove(value_t value) noexcept(true);
+
+  const std::string& name() const noexcept(true) {
+    return name_;
+  }
+
+  uint32_t parameters() const noexcept(true) {
+    return parameters_;
+  }
+
+  Instruction& instruction(value_t value) noexcept(true) {
+    return instructions_[value];
+  }
+
+  const Instruction& instruction(value_t value) const noexcept(true) {
+    return instructions_[value];
+  }
+
+  size_t instructions_count() const noexcept(true) {
+    return instructions_.size();
+  }
+
+  const Block& block(block_t block) const noexcept(true) {
+    return blocks_[block];
+  }
+
+  size_t blocks_count() const noexcept(true) {
+    return blocks_.size();
+  }
+
+  /// @return successors of block, given by its terminator
+  const std::vector<block_t>& successors(block_t block) const noexcept(true);
+
+  /// @return immediate dominator of each block, entry for itself, no_block for unreachable blocks
+  std::vector<block_t> dominators() const noexcept(false);
+
+  /// @return immediate post-dominator of each block, no_block for blocks, that return
+  std::vector<block_t> post_dominators() const noexcept(false);
+
+  /// @return count of uses of each value
+  std::vector<size_t> use_counts() const noexcept(false);
+
+private:
+  std::string name_;
+  uint32_t parameters_;
+  std::vector<Instruction> instructions_;
+  std::vector<Block> blocks_;
+};
+
+}// namespace ir
+
+#endif// WEAK_IR_HPP
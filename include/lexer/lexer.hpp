@@ -3,7 +3,9 @@
 
 #include "../error/lexical_error.hpp"
 #include "../lexer/token.hpp"
+#include "../thread_pool.hpp"
 
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -18,13 +20,30 @@ class Lexer {
 public:
   Lexer(std::istringstream data);
 
+  Lexer(const Lexer&) = delete;
+  Lexer& operator=(const Lexer&) = delete;
+
   /// @pre    m_input is constructed
   /// @post   m_current_index == m_input size. It means that all symbols were processed
   /// @throw  LexicalError if the analyzed data is incorrect
   /// @return correct Token's array
   std::vector<Token> tokenize();
 
+  /// @brief  split input into chunks at whitespaces outside of string literals and
+  ///         tokenize them on the pool workers
+  /// @param  min_chunk_size - lower bound of chunk size, input shorter than two chunks
+  ///                          is processed serially
+  /// @throw  LexicalError, the same one as tokenize() throws on this input
+  /// @return exactly the same Token's array as tokenize()
+  std::vector<Token> tokenize_parallel(ThreadPool& pool, size_t min_chunk_size = 1 << 18);
+
 private:
+  /// @brief  chunk lexer, that views the part of parent's input
+  Lexer(std::string_view chunk) noexcept(true);
+
+  /// @return positions where input can be split without breaking a token
+  std::vector<size_t> find_split_points(ThreadPool& pool, size_t chunks_count) const;
+
   char current() const;
 
   char previous() const;
@@ -59,7 +78,8 @@ private:
   Token process_operator();
 
   size_t current_index_{0};
-  const std::vector<char> input_;
+  const std::vector<char> data_;
+  const std::string_view input_;
 
   const std::unordered_map<std::string, token_t>& keywords_;
   const std::unordered_map<std::string, token_t>& operators_;
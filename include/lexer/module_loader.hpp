@@ -0,0 +1,82 @@
+#ifndef WEAK_LEXER_MODULE_LOADER_HPP
+#define WEAK_LEXER_MODULE_LOADER_HPP
+
+#include "../error/load_error.hpp"
+#include "../lexer/token.hpp"
+#include "../thread_pool.hpp"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// Builds dependency graph of `load "filename";` statements.
+///
+/// @note Every file is read and tokenized exactly once, no matter how many
+///       modules load it. Relative paths are resolved against the directory
+///       of the loading file.
+class ModuleLoader {
+public:
+  struct Module {
+    /// Canonical path, used as module identity.
+    std::string path;
+    /// File tokens without load statements and without END_OF_DATA.
+    std::vector<Token> tokens;
+    /// Indices of loaded modules in modules().
+    std::vector<size_t> dependencies;
+    /// FNV-1a hash of file contents.
+    uint64_t source_hash = 0;
+  };
+
+  /// @param pool - if set, files are read and tokenized on its workers
+  explicit ModuleLoader(ThreadPool* pool = nullptr) noexcept(true);
+
+  /// @brief  load file and all its dependencies, that weren't loaded before
+  /// @note   files are discovered level by level, all files of one level are
+  ///         tokenized concurrently
+  /// @throws LoadError if file wasn't opened, load statement is malformed
+  ///         or dependencies form a cycle
+  /// @throws LexicalError
+  void load(std::string_view filename) noexcept(false);
+
+  /// @return loaded modules, every module goes after all modules it loads
+  const std::vector<Module>& modules() const noexcept(true);
+
+  /// @post   modules() is empty
+  /// @return loaded modules, every module goes after all modules it loads
+  std::vector<Module> take_modules() noexcept(true);
+
+  /// @post   modules() is empty
+  /// @return tokens of all modules in dependency order, ended with END_OF_DATA
+  std::vector<Token> take_tokens() noexcept(false);
+
+private:
+  enum struct state_t { IN_PROGRESS, LOADED };
+
+  /// Module, which dependencies are known, but not ordered yet.
+  struct PendingModule {
+    Module module;
+    /// Canonical paths of loaded files.
+    std::vector<std::string> requests;
+  };
+
+  /// @param  parallel_tokenize - use pool inside lexer, must be false on pool workers
+  /// @return module with load statements extracted to its requests
+  PendingModule read_module(std::string path, bool parallel_tokenize) const noexcept(false);
+
+  /// @return all files reachable from root, that weren't loaded before
+  std::unordered_map<std::string, PendingModule> discover(const std::string& root) const noexcept(false);
+
+  /// @brief  append discovered modules to modules() in dependency order
+  /// @throws LoadError if dependencies form a cycle
+  void sort(const std::string& root, std::unordered_map<std::string, PendingModule>& pending) noexcept(false);
+
+  /// @return cycle description, that ends with path
+  std::string cycle_trace(const std::vector<std::string>& stack, const std::string& path) const noexcept(false);
+
+  ThreadPool* pool_;
+  std::vector<Module> modules_;
+  std::unordered_map<std::string, size_t> indices_;
+};
+
+#endif// WEAK_LEXER_MODULE_LOADER_HPP
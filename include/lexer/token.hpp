@@ -3,6 +3,8 @@
 
 #include "../common_defs.hpp"
 
+#include <cstdint>
+#include <initializer_list>
 #include <string>
 
 enum struct token_t {
@@ -108,6 +110,9 @@ inline std::string dispatch_token(token_t tok) noexcept(true) {
     case token_t::NEQ: { return "!="; }
     case token_t::SRLI: { return ">>"; }
     case token_t::SLLI: { return "<<"; }
+    case token_t::BIT_AND: { return "&"; }
+    case token_t::BIT_OR: { return "|"; }
+    case token_t::BIT_XOR: { return "^"; }
     case token_t::FLOAT: { return "<float>"; }
     case token_t::NUM: { return "<number>"; }
     case token_t::SYMBOL: { return "<symbol>"; }
@@ -170,6 +175,42 @@ ALWAYS_INLINE constexpr bool is_binary(token_t tok) noexcept(true) {
 
 }// namespace token_traits
 
+/// Set of token types with O(1) membership check, that fits in a register.
+class TokenSet {
+public:
+  constexpr TokenSet(std::initializer_list<token_t> types) noexcept(true) {
+    for (token_t type : types) {
+      bits_ |= bit(type);
+    }
+  }
+
+  constexpr bool contains(token_t type) const noexcept(true) {
+    return (bits_ & bit(type)) != 0;
+  }
+
+  /// @return expected types separated by " or "
+  std::string to_string() const noexcept(false) {
+    std::string result;
+    for (uint64_t i = 0; i < capacity; ++i) {
+      if (bits_ & (uint64_t(1) << i)) {
+        result += result.empty() ? "" : " or ";
+        result += dispatch_token(static_cast<token_t>(i));
+      }
+    }
+    return result;
+  }
+
+private:
+  static constexpr uint64_t capacity = 64;
+  static_assert(static_cast<uint64_t>(token_t::END_OF_DATA) < capacity, "token_t doesn't fit into TokenSet");
+
+  static constexpr uint64_t bit(token_t type) noexcept(true) {
+    return uint64_t(1) << static_cast<uint64_t>(type);
+  }
+
+  uint64_t bits_ = 0;
+};
+
 struct Token {
   std::string data;
   token_t type = token_t::NONE;
@@ -0,0 +1,32 @@
+#ifndef WEAK_OPTIMIZER_COMMON_SUBEXPRESSION_ELIMINATOR_HPP
+#define WEAK_OPTIMIZER_COMMON_SUBEXPRESSION_ELIMINATOR_HPP
+
+#include "../ast/ast.hpp"
+
+/// Numbers values of expressions in each block, and evaluates expression, repeated
+/// with the same value, only once into temporary, assigned before the first statement
+/// that uses it.
+///
+/// Expressions are arithmetic over literals and variables of frame, and calls of pure
+/// builtins and lambdas. Value number of variable changes on assignment, increment
+/// and compound assignment, and calls of impure lambdas or builtins forget all values.
+/// Only statements without effects in their operands are numbered, so evaluation
+/// order of effects doesn't change.
+///
+/// @note Evaluator changes numbers in place, so in-place change of variable, that may
+///       share its value, forgets values of all such variables. Temporary is read only
+///       where its value is consumed, or assigned to variable, that never changes it.
+class CommonSubexpressionEliminator {
+public:
+  /// @pre    lambda body is parsed; lambdas without binding are left as is
+  explicit CommonSubexpressionEliminator(ast::Lambda& lambda) noexcept(true);
+
+  /// @note   nested lambdas are processed as well
+  /// @return count of expressions, replaced by reads of temporaries
+  size_t run() noexcept(false);
+
+private:
+  ast::Lambda& lambda_;
+};
+
+#endif// WEAK_OPTIMIZER_COMMON_SUBEXPRESSION_ELIMINATOR_HPP
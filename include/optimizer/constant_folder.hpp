@@ -0,0 +1,27 @@
+#ifndef WEAK_OPTIMIZER_CONSTANT_FOLDER_HPP
+#define WEAK_OPTIMIZER_CONSTANT_FOLDER_HPP
+
+#include "../ast/ast.hpp"
+
+/// Folds expressions over number literals, replaces reads of locals, assigned once
+/// with number, by literal.
+///
+/// Evaluator changes numbers in place, and variable refers to the very object, it was
+/// assigned, including literal node. So literal is put only where its value is read and
+/// dropped: operands, conditions, output, or assignment to variable, which is never
+/// changed in place, passed to lambda or returned.
+class ConstantFolder {
+public:
+  /// @pre    lambda body is parsed; without binding only expressions, which values
+  ///         are not stored, are folded
+  explicit ConstantFolder(ast::Lambda& lambda) noexcept(true);
+
+  /// @note   nested lambdas are folded as well
+  /// @return count of folded expressions and replaced reads
+  size_t run() noexcept(false);
+
+private:
+  ast::Lambda& lambda_;
+};
+
+#endif// WEAK_OPTIMIZER_CONSTANT_FOLDER_HPP
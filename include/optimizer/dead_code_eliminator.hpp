@@ -0,0 +1,28 @@
+#ifndef WEAK_OPTIMIZER_DEAD_CODE_ELIMINATOR_HPP
+#define WEAK_OPTIMIZER_DEAD_CODE_ELIMINATOR_HPP
+
+#include "../ast/ast.hpp"
+
+/// Removes code, which doesn't change program output:
+///   - branches of if with number literal as condition,
+///   - statements without effects, which values are dropped,
+///   - assignments to locals, that are never read,
+///   - empty loops.
+///
+/// @note Output, array changes, calls of impure lambdas, assignments of read variables
+///       and possibly trapping integral division are effects. Last statement of lambda
+///       is its value, so it's kept, unless it's an empty loop.
+class DeadCodeEliminator {
+public:
+  /// @pre    lambda body is parsed; without binding assignments are kept
+  explicit DeadCodeEliminator(ast::Lambda& lambda) noexcept(true);
+
+  /// @note   nested lambdas are processed as well
+  /// @return count of removed statements and pruned branches
+  size_t run() noexcept(false);
+
+private:
+  ast::Lambda& lambda_;
+};
+
+#endif// WEAK_OPTIMIZER_DEAD_CODE_ELIMINATOR_HPP
@@ -0,0 +1,34 @@
+#ifndef WEAK_OPTIMIZER_INLINER_HPP
+#define WEAK_OPTIMIZER_INLINER_HPP
+
+#include "../ast/ast.hpp"
+
+/// Substitutes bodies of small non-recursive lambdas into their call sites.
+///
+/// Call, which is a statement or is assigned to variable, is replaced by assignments
+/// of arguments to parameters, statements of body and its last expression as value
+/// of call. Parameters and locals of callee take new slots of caller frame.
+///
+/// Call of lambda, which body is a single expression without assignments, is replaced
+/// in any expression, if arguments have no effects. Parameters are replaced by arguments
+/// then, so argument, used more than once, must be literal or variable.
+///
+/// @note Only bound lambdas, that read no names outside of own frame and neither change
+///       nor return own literals (which live across calls), are inlined.
+class Inliner {
+public:
+  static constexpr size_t default_budget = 40;
+
+  /// @param budget - max count of nodes in inlined lambda body
+  explicit Inliner(ast::Lambda& caller, size_t budget = default_budget) noexcept(true);
+
+  /// @note   nested lambdas are processed as well
+  /// @return count of inlined call sites
+  size_t run() noexcept(false);
+
+private:
+  ast::Lambda& caller_;
+  size_t budget_;
+};
+
+#endif// WEAK_OPTIMIZER_INLINER_HPP
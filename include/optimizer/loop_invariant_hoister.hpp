@@ -0,0 +1,31 @@
+#ifndef WEAK_OPTIMIZER_LOOP_INVARIANT_HOISTER_HPP
+#define WEAK_OPTIMIZER_LOOP_INVARIANT_HOISTER_HPP
+
+#include "../ast/ast.hpp"
+
+/// Moves expressions, which give the same value in each iteration of while or for loop,
+/// into temporaries, assigned right before the loop.
+///
+/// Expression is invariant, if it reads only literals and variables of frame, that
+/// aren't assigned in loop, through arithmetic and pure builtins with number value
+/// (array-length, type predicates). Calls of pure lambdas are moved out of exit
+/// conditions only, since exit condition is evaluated at least once.
+///
+/// @note Evaluator changes numbers in place, so loop is left as is, if it changes in
+///       place a variable, that may share its value, or passes variables to impure
+///       lambdas or builtins. Temporaries are read only where their value is consumed,
+///       not kept.
+class LoopInvariantHoister {
+public:
+  /// @pre    lambda body is parsed; lambdas without binding are left as is
+  explicit LoopInvariantHoister(ast::Lambda& lambda) noexcept(true);
+
+  /// @note   nested lambdas are processed as well
+  /// @return count of moved expressions
+  size_t run() noexcept(false);
+
+private:
+  ast::Lambda& lambda_;
+};
+
+#endif// WEAK_OPTIMIZER_LOOP_INVARIANT_HOISTER_HPP
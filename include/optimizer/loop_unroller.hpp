@@ -0,0 +1,42 @@
+#ifndef WEAK_OPTIMIZER_LOOP_UNROLLER_HPP
+#define WEAK_OPTIMIZER_LOOP_UNROLLER_HPP
+
+#include "../ast/ast.hpp"
+
+/// Unrolls for loops with constant count of iterations.
+///
+/// Loop counter is recognized as StrengthReducer does, and its bound must be literal.
+/// Loop with few iterations, which all fit into size limit, is replaced by copies of
+/// its body, where counter is replaced by its values. Otherwise body is repeated
+/// `factor` times with increments between copies, exit condition is lowered so all
+/// copies run, and the rest of iterations runs in remainder while loop.
+///
+/// @note Evaluator assigns literals without copying and changes numbers in place, so
+///       body is copied only if its literals are never changed, and counter is read
+///       only where its value is consumed. Counter, changed in place, leaves its last
+///       value in init literal, so copies of fully unrolled loop are guarded by exit
+///       condition, and counter is set to its last value after them.
+class LoopUnroller {
+public:
+  static constexpr size_t default_factor = 4;
+  static constexpr size_t default_full_limit = 16;
+  static constexpr size_t default_size_limit = 128;
+
+  /// @pre    lambda body is parsed; lambdas without binding are left as is
+  /// @param  factor - count of body copies in partially unrolled loop
+  /// @param  full_limit - max count of iterations of fully unrolled loop
+  /// @param  size_limit - max count of nodes in all copies of body and increment
+  explicit LoopUnroller(ast::Lambda& lambda, size_t factor = default_factor, size_t full_limit = default_full_limit, size_t size_limit = default_size_limit) noexcept(true);
+
+  /// @note   nested lambdas are processed as well
+  /// @return count of unrolled loops
+  size_t run() noexcept(false);
+
+private:
+  ast::Lambda& lambda_;
+  size_t factor_;
+  size_t full_limit_;
+  size_t size_limit_;
+};
+
+#endif// WEAK_OPTIMIZER_LOOP_UNROLLER_HPP
@@ -2,21 +2,85 @@
 #define WEAK_OPTIMIZER_HPP
 
 #include <boost/smart_ptr/local_shared_ptr.hpp>
+#include <chrono>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace ast {
 class Object;
 class RootObject;
+class Lambda;
 }// namespace ast
 
+/// Runs pipeline of passes over bodies of top-level lambdas. Full pipeline inlines
+/// small lambdas (see Inliner), folds constants (see ConstantFolder), reduces arithmetic
+/// over loop counters (see StrengthReducer), moves invariants out of loops (see
+/// LoopInvariantHoister), unrolls loops with constant count of iterations (see
+/// LoopUnroller), reuses values of repeated expressions (see
+/// CommonSubexpressionEliminator), then removes dead code (see DeadCodeEliminator).
 class Optimizer {
 public:
-  Optimizer(boost::local_shared_ptr<ast::RootObject>& root);
+  /// Rewrites lambda in place.
+  /// @return count of changed expressions or statements
+  using pass_function_t = size_t (*)(ast::Lambda&);
+
+  struct Pass {
+    std::string_view name;
+    pass_function_t run;
+  };
+
+  struct PassStats {
+    std::string_view name;
+    size_t runs = 0;
+    size_t changes = 0;
+    std::chrono::nanoseconds time{0};
+  };
+
+  static constexpr unsigned max_level = 2;
+  /// Bound of pipeline repetitions for one lambda, if pipeline is repeated.
+  static constexpr size_t max_iterations = 4;
+
+  /// @return all passes, in order of full pipeline
+  static const std::vector<Pass>& passes() noexcept(true);
+
+  /// @return pass with given name, null if there is no such pass
+  static const Pass* find_pass(std::string_view name) noexcept(true);
+
+  /// @pre    program is bound by semantic analyzer, otherwise only expressions, which
+  ///         values are not stored, are folded
+  /// @param  level - 0 runs no passes, 1 runs full pipeline once, 2 repeats it until
+  ///         no pass changes anything
+  Optimizer(boost::local_shared_ptr<ast::RootObject>& root, unsigned level = 1);
+
+  /// @param  pipeline - passes in order of run
+  /// @param  to_fixed_point - repeat pipeline until no pass changes anything
+  Optimizer(boost::local_shared_ptr<ast::RootObject>& root, std::vector<Pass> pipeline, bool to_fixed_point);
 
   void optimize();
 
+  /// @brief  run pipeline of level over one lambda, used to re-optimize hot lambdas
+  ///         while program runs
+  /// @pre    lambda is bound
+  /// @return count of changed expressions or statements
+  static size_t optimize(ast::Lambda& lambda, unsigned level = max_level);
+
+  /// @return counters of all optimize() calls, one per pass in pipeline order
+  const std::vector<PassStats>& stats() const noexcept(true);
+
+  /// @return the largest count of pipeline runs for one lambda
+  size_t iterations() const noexcept(true);
+
 private:
+  /// @param  stats - counters of pipeline passes
+  /// @return count of pipeline runs and count of changes
+  static std::pair<size_t, size_t> run(ast::Lambda& lambda, const std::vector<Pass>& pipeline, bool to_fixed_point, std::vector<PassStats>& stats);
+
   std::vector<boost::local_shared_ptr<ast::Object>>& input_;
+  std::vector<Pass> pipeline_;
+  bool to_fixed_point_;
+  std::vector<PassStats> stats_;
+  size_t iterations_ = 0;
 };
 
 #endif// WEAK_OPTIMIZER_HPP
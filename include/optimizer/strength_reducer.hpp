@@ -0,0 +1,31 @@
+#ifndef WEAK_OPTIMIZER_STRENGTH_REDUCER_HPP
+#define WEAK_OPTIMIZER_STRENGTH_REDUCER_HPP
+
+#include "../ast/ast.hpp"
+
+/// Replaces arithmetic over induction variables of for loops by cheaper one.
+///
+/// Induction variable is assigned with integer literal in loop init, compared with
+/// `<` or `<=` in exit condition, and increased by integer literal in increment.
+/// If loop body reads it only as `i * M`, variable is scaled by M instead: init,
+/// bound and step are multiplied, and products become plain reads, so no derived
+/// variable is left. Otherwise, since variable is never negative, `i / 2^k` and
+/// `i % 2^k` become `i >> k` and `i & (2^k - 1)`.
+///
+/// @note Evaluator changes numbers in place, so variable must be read only where its
+///       value is consumed, and must not occur outside of its loop. Rewrite is done
+///       only if scaled values fit into 32 bits, as evaluator arithmetic does.
+class StrengthReducer {
+public:
+  /// @pre    lambda body is parsed; lambdas without binding are left as is
+  explicit StrengthReducer(ast::Lambda& lambda) noexcept(true);
+
+  /// @note   nested lambdas are processed as well
+  /// @return count of rewritten expressions
+  size_t run() noexcept(false);
+
+private:
+  ast::Lambda& lambda_;
+};
+
+#endif// WEAK_OPTIMIZER_STRENGTH_REDUCER_HPP
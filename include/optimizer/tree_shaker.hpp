@@ -0,0 +1,41 @@
+#ifndef WEAK_OPTIMIZER_TREE_SHAKER_HPP
+#define WEAK_OPTIMIZER_TREE_SHAKER_HPP
+
+#include "../ast/ast.hpp"
+#include "../ast/flat_tree.hpp"
+
+#include <boost/smart_ptr/local_shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+/// Removes top-level lambdas and type definitions, that can't be reached
+/// from entry lambda through calls, symbols and type creators.
+///
+/// @note Names are compared case-insensitively, as storage does, and every
+///       symbol is treated as possible lambda reference. Reachable lazy lambda
+///       may refer to anything, so program with one is left unchanged.
+class TreeShaker {
+public:
+  struct Stats {
+    size_t declarations = 0;
+    size_t nodes = 0;
+  };
+
+  /// @param trees - modules, references are resolved across all of them
+  TreeShaker(std::vector<boost::local_shared_ptr<ast::RootObject>>& trees, std::string entry = "main") noexcept(true);
+
+  /// @param flat_trees - flattened trees, kept by caller for semantic analysis, so they
+  ///        aren't flattened again
+  TreeShaker(std::vector<boost::local_shared_ptr<ast::RootObject>>& trees, const std::vector<ast::FlatTree>& flat_trees, std::string entry = "main") noexcept(true);
+
+  /// @brief  remove unreachable declarations, nothing is removed if there is no entry lambda
+  /// @return number of removed declarations and their nodes
+  Stats shake() noexcept(false);
+
+private:
+  std::vector<boost::local_shared_ptr<ast::RootObject>>& trees_;
+  const std::vector<ast::FlatTree>* flat_trees_ = nullptr;
+  std::string entry_;
+};
+
+#endif// WEAK_OPTIMIZER_TREE_SHAKER_HPP
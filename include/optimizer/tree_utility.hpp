@@ -0,0 +1,251 @@
+#ifndef WEAK_OPTIMIZER_TREE_UTILITY_HPP
+#define WEAK_OPTIMIZER_TREE_UTILITY_HPP
+
+#include "../ast/ast.hpp"
+
+#include <boost/smart_ptr/local_shared_ptr.hpp>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+/// Helpers, shared by optimizer passes.
+namespace optimization {
+
+using object_t = boost::local_shared_ptr<ast::Object>;
+
+bool is_number(const object_t& node) noexcept(true);
+
+/// @pre    node is number
+object_t copy_number(const object_t& number) noexcept(false);
+
+bool is_zero(const ast::Integer& integer) noexcept(true);
+
+bool is_literal(const object_t& node) noexcept(true);
+
+bool is_assignment(token_t type) noexcept(true);
+
+/// @return variable in lambda frame, assigned by node, null if node is not such assignment
+const ast::Symbol* assigned_symbol(const object_t& node) noexcept(true);
+
+/// @return true if evaluation of node gives new object, not shared with variable or literal
+bool is_fresh(const object_t& node) noexcept(true);
+
+/// @return true if call is print or println, which only read arguments
+bool is_output(const ast::LambdaCall& call) noexcept(true);
+
+/// @return true if call only reads arguments
+bool reads_arguments(const ast::LambdaCall& call) noexcept(true);
+
+/// @return variable, which value is changed in place by node, null otherwise
+const ast::Symbol* changed_symbol(const object_t& node) noexcept(true);
+
+/// @return true if evaluation of node changes anything, may fail or doesn't end
+bool has_effects(const object_t& node) noexcept(true);
+
+/// @brief  call function for each child expression or block of node, absent children are null
+template <typename Function>
+void for_each_child(const object_t& node, Function function) noexcept(false) {
+  // clang-format off
+  switch (node->ast_type()) {
+    case ast::type_t::ARRAY: { for (const auto& element : static_cast<const ast::Array&>(*node).elements()) { function(element); } return; }
+    case ast::type_t::BLOCK: { for (const auto& statement : static_cast<const ast::Block&>(*node).statements()) { function(statement); } return; }
+    case ast::type_t::UNARY: { function(static_cast<const ast::Unary&>(*node).operand()); return; }
+    case ast::type_t::BINARY: { function(static_cast<const ast::Binary&>(*node).lhs()); function(static_cast<const ast::Binary&>(*node).rhs()); return; }
+    case ast::type_t::LAMBDA_CALL: { for (const auto& argument : static_cast<const ast::LambdaCall&>(*node).arguments()) { function(argument); } return; }
+    case ast::type_t::TYPE_CREATOR: { for (const auto& argument : static_cast<const ast::TypeCreator&>(*node).arguments()) { function(argument); } return; }
+    // clang-format on
+    case ast::type_t::WHILE: {
+      const auto& while_ = static_cast<const ast::While&>(*node);
+      function(while_.exit_condition());
+      function(while_.body());
+      return;
+    }
+    case ast::type_t::FOR: {
+      const auto& for_ = static_cast<const ast::For&>(*node);
+      function(for_.loop_init());
+      function(for_.exit_condition());
+      function(for_.increment());
+      function(for_.body());
+      return;
+    }
+    case ast::type_t::IF: {
+      const auto& if_ = static_cast<const ast::If&>(*node);
+      function(if_.condition());
+      function(if_.body());
+      function(if_.else_body());
+      return;
+    }
+    default: {
+      return;
+    }
+  }
+}
+
+/// @brief  call function for blocks of statement: nested block, branches of if, body of loop
+template <typename Function>
+void for_each_block(const object_t& node, Function function) noexcept(false) {
+  switch (node->ast_type()) {
+    case ast::type_t::BLOCK: {
+      function(static_cast<ast::Block&>(*node));
+      return;
+    }
+    case ast::type_t::IF: {
+      const auto& if_ = static_cast<const ast::If&>(*node);
+      function(*if_.body());
+      if (if_.else_body()) {
+        function(*if_.else_body());
+      }
+      return;
+    }
+    case ast::type_t::WHILE: {
+      function(*static_cast<const ast::While&>(*node).body());
+      return;
+    }
+    case ast::type_t::FOR: {
+      function(*static_cast<const ast::For&>(*node).body());
+      return;
+    }
+    default: {
+      return;
+    }
+  }
+}
+
+/// @return count of nodes of expression or statement with nested ones
+size_t count_nodes(const object_t& node) noexcept(false);
+
+/// Passes reason only about non-negative literals within 32 bits, so sums and products
+/// of two such values never overflow 64-bit integers of evaluator.
+constexpr size_t max_integer = std::numeric_limits<int32_t>::max();
+
+/// @return value of integer literal, null if node isn't one or value doesn't fit into [0, max_integer]
+std::optional<size_t> literal_value(const object_t& node) noexcept(true);
+
+/// @return true if node reads variable of lambda frame in given slot
+bool is_variable(const object_t& node, uint32_t slot) noexcept(true);
+
+/// Counter of for loop: `for (i = init; i < bound; ++i)`, also `<=`, `i += step` and `i = i + step`.
+struct Induction {
+  uint32_t slot = 0;
+  size_t init = 0;
+  /// Null if bound isn't literal.
+  std::optional<size_t> bound;
+  bool inclusive = false;
+  size_t step = 0;
+  /// Increment changes counter in place (`++` and `+=`), so init literal keeps the
+  /// last value of counter after loop.
+  bool in_place = false;
+  /// Occurrences of counter in init, exit condition and increment.
+  size_t occurrences = 0;
+};
+
+/// @return counter of loop, null if loop has no such counter or its values may not fit into 32 bits
+std::optional<Induction> find_induction(const ast::For& for_) noexcept(true);
+
+/// @return count of iterations of loop, which starts from init literal, null if bound isn't literal
+std::optional<size_t> trip_count(const Induction& induction) noexcept(true);
+
+/// Copies nodes of lambda body, optionally moving its variables to slots of other lambda.
+class Cloner {
+public:
+  /// @brief  copy nodes of caller as is
+  Cloner() = default;
+
+  /// @param slots - callee slot -> caller slot
+  explicit Cloner(std::vector<uint32_t> slots) noexcept(true);
+
+  /// @brief  copy expression body, replacing parameters by copies of arguments
+  explicit Cloner(const std::vector<object_t>& arguments) noexcept(true);
+
+  /// @brief  copy nodes as is, but share literals and arrays with original, since evaluator
+  ///         changes them in place, so copy keeps values of original between calls
+  static Cloner sharing_literals() noexcept(true);
+
+  /// @note   lambdas and type definitions are shared, since such callees aren't inlined
+  object_t clone(const object_t& node) const noexcept(false);
+
+private:
+  std::vector<object_t> clone_all(const std::vector<object_t>& nodes) const noexcept(false);
+
+  boost::local_shared_ptr<ast::Block> clone_block(const boost::local_shared_ptr<ast::Block>& block) const noexcept(false);
+
+  void resolve(const ast::Resolvable& from, ast::Resolvable& to) const noexcept(true);
+
+  std::vector<uint32_t> slots_;
+  const std::vector<object_t>* arguments_ = nullptr;
+  bool share_literals_ = false;
+};
+
+/// Finds variables of lambda frame, which value may be shared with other variable
+/// (shared), and which value may be changed in place, returned or stored elsewhere (kept).
+///
+/// Evaluator changes numbers in place, so value, read through such variable, may change
+/// without assignment to it.
+class AliasAnalysis {
+public:
+  AliasAnalysis() = default;
+
+  /// @pre    lambda is bound
+  explicit AliasAnalysis(const ast::Lambda& lambda) noexcept(false);
+
+  bool is_shared(uint32_t slot) const noexcept(true) {
+    return shared_[slot];
+  }
+
+  bool is_kept(uint32_t slot) const noexcept(true) {
+    return kept_[slot];
+  }
+
+  /// @brief  register new variable at the end of frame, which is neither shared nor kept
+  void add_slot() noexcept(false);
+
+private:
+  void share(const object_t& node) noexcept(true);
+
+  void keep(const object_t& node) noexcept(true);
+
+  void collect(const object_t& node) noexcept(false);
+
+  /// Slot -> true if value may be shared with other variable.
+  std::vector<bool> shared_;
+  /// Slot -> true if value may be changed in place, returned or stored elsewhere.
+  std::vector<bool> kept_;
+};
+
+/// Assignments to variables of lambda frame.
+///
+/// Evaluator assigns literals, arguments and values of variables without copying, so only
+/// variable, every assignment of which is a new object, never shares its value.
+class Assignments {
+public:
+  Assignments() = default;
+
+  /// @pre    lambda is bound
+  explicit Assignments(const ast::Lambda& lambda) noexcept(false);
+
+  /// @return true if variable may hold literal of body, argument or value of other variable
+  bool is_shared(uint32_t slot) const noexcept(true) {
+    return shared_[slot];
+  }
+
+  /// @return true if every evaluation of statement gives new object
+  /// @note   lambda without datatype value returns null, so the value must always be datatype
+  bool is_value(const object_t& statement) const noexcept(true);
+
+private:
+  void collect(const object_t& node) noexcept(false);
+
+  /// Slot -> true if variable is assigned anything but new object.
+  std::vector<bool> shared_;
+  /// Slot -> true if variable is assigned in body.
+  std::vector<bool> assigned_;
+};
+
+/// @return true if every call of lambda returns new object, so caller, which changes it
+///         in place, changes nothing of callee or other caller
+bool returns_new_value(const ast::Lambda& lambda) noexcept(false);
+
+}// namespace optimization
+
+#endif// WEAK_OPTIMIZER_TREE_UTILITY_HPP
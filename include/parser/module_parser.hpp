@@ -0,0 +1,30 @@
+#ifndef WEAK_PARSER_MODULE_PARSER_HPP
+#define WEAK_PARSER_MODULE_PARSER_HPP
+
+#include "../ast/ast.hpp"
+#include "../lexer/module_loader.hpp"
+#include "../optimizer/tree_shaker.hpp"
+#include "../thread_pool.hpp"
+
+#include <boost/smart_ptr/local_shared_ptr.hpp>
+#include <vector>
+
+struct ModuleParserOptions {
+  /// Parse and analyze lambda bodies on first call, see Parser.
+  bool lazy_bodies = false;
+  /// Remove declarations unreachable from main before type inference.
+  bool tree_shaking = false;
+};
+
+/// @brief  parse and analyze every module into its own tree, modules are processed
+///         concurrently if pool is set
+/// @note   trees don't share nodes, so each of them is owned by one worker until
+///         it is merged (reference counters of local_shared_ptr aren't atomic)
+/// @param  shaking_stats - if set, receives number of declarations removed by tree shaking
+/// @throws ParseError of the first erroneous module in dependency order
+/// @throws SemanticError if top-level statement is neither lambda nor type definition
+/// @throws SemanticError of the first erroneous module in dependency order
+/// @return top-level declarations of all modules in order of modules
+boost::local_shared_ptr<ast::RootObject> parse_modules(std::vector<ModuleLoader::Module> modules, ThreadPool* pool = nullptr, ModuleParserOptions options = {}, TreeShaker::Stats* shaking_stats = nullptr) noexcept(false);
+
+#endif// WEAK_PARSER_MODULE_PARSER_HPP
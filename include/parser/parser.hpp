@@ -4,9 +4,11 @@
 #include "../ast/ast.hpp"
 #include "../error/parse_error.hpp"
 #include "../lexer/token.hpp"
+#include "../thread_pool.hpp"
 
 #include <boost/pool/pool_alloc.hpp>
-#include <optional>
+#include <memory>
+#include <span>
 #include <utility>
 
 /// LL Syntax analyzer.
@@ -15,11 +17,30 @@ public:
   template <typename T>
   using ast_ptr = boost::local_shared_ptr<T>;
 
-  explicit Parser(std::vector<Token> tokens) noexcept(true);
+  /// @param lazy_bodies - only match braces of top-level lambda bodies, each of them
+  ///                      is parsed on first ast::Lambda::parse_body() call
+  explicit Parser(std::vector<Token> tokens, bool lazy_bodies = false) noexcept(false);
 
   ast_ptr<ast::RootObject> parse() noexcept(false);
 
+  /// @brief  find top-level declarations by brace matching and parse groups of
+  ///         them on the pool workers
+  /// @param  min_chunk_tokens - lower bound of tokens count parsed by one worker,
+  ///                            input shorter than two chunks is parsed serially
+  /// @note   input is parsed serially if it has top-level statements other than
+  ///         lambdas and type definitions, or if any of workers failed, so errors
+  ///         are the same as parse() reports
+  /// @return exactly the same tree as parse()
+  ast_ptr<ast::RootObject> parse_parallel(ThreadPool& pool, size_t min_chunk_tokens = 1 << 14) noexcept(false);
+
 private:
+  /// @brief parser of tokens[begin, end), that is able to look at tokens after end
+  Parser(std::shared_ptr<const std::vector<Token>> tokens, size_t begin, size_t end, bool lazy_bodies) noexcept(true);
+
+  /// @return indices of top-level declarations starts followed by end of input,
+  ///         empty if input is not a sequence of lambdas and type definitions
+  std::vector<size_t> top_level_boundaries() const noexcept(true);
+
   /// @throws std::out_of_range
   const Token& current() const noexcept(false);
 
@@ -39,13 +60,13 @@ private:
 
   /// @throws std::out_of_range from current() and peek()
   /// @brief  get current token and match with one of samples
-  /// @return correct token, std::nullopt if input find no more tokens
-  std::optional<Token> match(const std::vector<token_t>& expected_types) noexcept(false);
+  /// @return correct token, nullptr if it doesn't match or input find no more tokens
+  const Token* match(TokenSet expected_types) noexcept(false);
 
   /// @throws std::out_of_range from match()
   /// @throws ParseError if the match was unsuccessful
   /// @return correct token of one of expected types
-  Token require(const std::vector<token_t>& expected_types) noexcept(false);
+  const Token& require(TokenSet expected_types) noexcept(false);
 
   /// @brief main parse lambda
   ast_ptr<ast::Object> primary() noexcept(false);
@@ -95,6 +116,17 @@ private:
   /// @return lambda parse tree that contains lambda name, argument list and body (block)
   ast_ptr<ast::Object> lambda_declare_statement() noexcept(false);
 
+  /// @pre    previous() returns 'lambda' token
+  /// @post   previous() returns '}' token of lambda body
+  /// @return lambda, which body is parsed on first call, eagerly parsed lambda if
+  ///         body braces are unbalanced
+  ast_ptr<ast::Object> lazy_lambda_declare_statement() noexcept(false);
+
+  /// @pre    previous() returns lambda name
+  /// @post   previous() returns ')' token
+  /// @return lambda parameters as symbols
+  std::vector<ast_ptr<ast::Object>> lambda_parameters() noexcept(false);
+
   /// @pre    previous() returns 'define-type' token
   /// @post   previous() returns first token after type definition
   /// @return parsed type definition with only field fields
@@ -119,8 +151,12 @@ private:
 
   ast_ptr<ast::Object> type_creator() noexcept(false);
 
-  std::vector<Token> input_;
+  /// Shared with lazy lambdas and chunk parsers.
+  std::shared_ptr<const std::vector<Token>> tokens_;
+  std::span<const Token> input_;
   size_t current_index_;
+  size_t end_index_;
+  bool lazy_bodies_;
 };
 
 #endif// WEAK_PARSER_HPP
@@ -2,42 +2,110 @@
 #define WEAK_SEMANTIC_ANALYZER_HPP
 
 #include "../ast/ast.hpp"
+#include "../ast/flat_tree.hpp"
 #include "../error/semantic_error.hpp"
 #include "../storage/storage.hpp"
 
+#include <initializer_list>
+#include <unordered_map>
+
+/// @note Analysis walks flat tree, so it touches only few contiguous arrays.
 class SemanticAnalyzer {
 public:
+  /// @post   after analyze() symbols, unary, binary and loop nodes of input are
+  ///         annotated with inferred types
   SemanticAnalyzer(boost::local_shared_ptr<ast::RootObject> input) noexcept(false);
 
+  /// @brief  analyze already flattened input, so program is flattened once for all passes
+  /// @param  flat - flattened input, it may still have declarations, removed from input
+  ///         by tree shaking, they are checked, but not annotated
+  SemanticAnalyzer(boost::local_shared_ptr<ast::RootObject> input, ast::FlatTree flat) noexcept(true);
+
+  /// @note   flat tree is analyzed without type inference, since it has no nodes to annotate
+  SemanticAnalyzer(ast::FlatTree input) noexcept(true);
+
   /// @throws SemanticError while analyzing
   void analyze() noexcept(false);
 
+  /// Top-level lambdas by lowercased name.
+  using lambda_table_t = std::unordered_map<std::string, ast::Lambda*>;
+
+  /// @brief  resolve variables of lambdas to frame slots, calls to builtins or lambdas,
+  ///         check arguments count of calls
+  /// @note   Scope is lexical: lambda sees its parameters, its locals and lambdas, declared
+  ///         at top level or in enclosing lambdas, but not variables of its callers or of
+  ///         enclosing lambdas. Variable, assigned anywhere in lambda body, is a local of
+  ///         the whole body, variable of for init is visible only inside loop.
+  /// @post   lambdas without effects, calling only such lambdas and pure builtins, are marked pure
+  /// @param  free_names_are_globals - unknown names are looked up at runtime, used by session,
+  ///         where they may be defined by previous input
+  /// @pre    program is analyzed and has all its top-level declarations
+  /// @throws SemanticError if variable or lambda is not defined, or arguments count is wrong
+  static void bind(ast::RootObject& program, bool free_names_are_globals = false) noexcept(false);
+
+  /// @brief  bind body of lazy lambda on its first call by the same rules as bind() of program
+  /// @pre    lambda body is parsed
+  /// @param  globals - top-level lambdas of program, see lambdas()
+  /// @throws SemanticError if variable or lambda is not defined, or arguments count is wrong
+  static void bind(ast::Lambda& lambda, const lambda_table_t& globals) noexcept(false);
+
+  /// @return top-level lambdas of program, later declaration replaces previous one
+  static lambda_table_t lambdas(const std::vector<boost::local_shared_ptr<ast::Object>>& program) noexcept(false);
+
+  /// @brief  infer types of lambda body again, assuming its parameters have given types
+  /// @pre    lambda is analyzed, every call of lambda passes values of given types
+  /// @param  parameters - type of each parameter, unknown ones are not assumed
+  static void specialize(ast::Lambda& lambda, const std::vector<ast::inferred_t>& parameters) noexcept(false);
+
 private:
-  void analyze_statement(const boost::local_shared_ptr<ast::Object>&) noexcept(false);
+  using index_t = ast::FlatTree::index_t;
+  /// Lowercased variable name -> type. Absent variables have unknown type.
+  using type_environment_t = std::unordered_map<std::string, ast::inferred_t>;
+
+  void analyze_statement(index_t) noexcept(false);
+
+  void analyze_array_statement(index_t) noexcept(false);
+
+  void analyze_assign_statement(index_t) noexcept(false);
+
+  void analyze_binary_statement(index_t) noexcept(false);
+
+  void analyze_lambda_call_statement(index_t) noexcept(false);
+
+  void analyze_lambda_statement(index_t) noexcept(false);
+
+  void analyze_if_statement(index_t) noexcept(false);
 
-  void analyze_array_statement(const boost::local_shared_ptr<ast::Array>&) noexcept(false);
+  void analyze_while_statement(index_t) noexcept(false);
 
-  void analyze_assign_statement(const boost::local_shared_ptr<ast::Binary>&) noexcept(false);
+  void analyze_for_statement(index_t) noexcept(false);
 
-  void analyze_binary_statement(const boost::local_shared_ptr<ast::Binary>&) noexcept(false);
+  void analyze_block_statement(index_t) noexcept(false);
 
-  void analyze_lambda_call_statement(const boost::local_shared_ptr<ast::LambdaCall>&) noexcept(false);
+  bool to_integral_convertible(index_t) noexcept(false);
 
-  void analyze_lambda_statement(const boost::local_shared_ptr<ast::Lambda>&) noexcept(false);
+  bool to_number_convertible(index_t) noexcept(false);
 
-  void analyze_if_statement(const boost::local_shared_ptr<ast::If>&) noexcept(false);
+  /// Flow-sensitive inference. Types are known only for values assigned in the same
+  /// lambda, since arguments may be anything. Scope is lexical, so each name of lambda
+  /// is bound to one its slot and called lambdas can't rebind it: their changes in place
+  /// keep numeric type, hence calls keep known types of caller.
+  void infer_types() noexcept(false);
 
-  void analyze_while_statement(const boost::local_shared_ptr<ast::While>&) noexcept(false);
+  ast::inferred_t infer_expression(const boost::local_shared_ptr<ast::Object>&, type_environment_t&) noexcept(false);
 
-  void analyze_for_statement(const boost::local_shared_ptr<ast::For>&) noexcept(false);
+  ast::inferred_t infer_binary(ast::Binary&, type_environment_t&) noexcept(false);
 
-  void analyze_block_statement(const boost::local_shared_ptr<ast::Block>&) noexcept(false);
+  ast::inferred_t infer_unary(ast::Unary&, type_environment_t&) noexcept(false);
 
-  bool to_integral_convertible(const boost::local_shared_ptr<ast::Object>&) noexcept(false);
+  void infer_if(const ast::If&, type_environment_t&) noexcept(false);
 
-  bool to_number_convertible(const boost::local_shared_ptr<ast::Object>&) noexcept(false);
+  /// @param  iteration - loop parts, evaluated after condition on every iteration
+  /// @return type of condition
+  ast::inferred_t infer_loop(const boost::local_shared_ptr<ast::Object>& condition, std::initializer_list<boost::local_shared_ptr<ast::Object>> iteration, type_environment_t&) noexcept(false);
 
-  std::vector<boost::local_shared_ptr<ast::Object>> input_;
+  boost::local_shared_ptr<ast::RootObject> program_;
+  ast::FlatTree input_;
 };
 
 #endif// WEAK_SEMANTIC_ANALYZER_HPP
@@ -6,8 +6,11 @@
 #include <functional>
 #include <optional>
 
-using builtin_function_t = std::function<std::optional<boost::local_shared_ptr<ast::Object>>(const std::vector<boost::local_shared_ptr<ast::Object>>&)>;
+using builtin_function_t = ast::LambdaCall::builtin_t;
 
 extern const std::unordered_map<std::string, builtin_function_t> builtins;
 
+/// @return true if builtin only computes result from arguments, without output or changes of arrays
+bool is_pure_builtin(std::string_view name) noexcept(true);
+
 #endif// WEAK_STD_BUILTINS_HPP
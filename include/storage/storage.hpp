@@ -34,6 +34,7 @@ public:
 
   ALWAYS_INLINE void scope_begin() noexcept(true);
   ALWAYS_INLINE void scope_end() noexcept(true);
+  ALWAYS_INLINE size_t scope_depth() const noexcept(true);
 
 private:
   Storage::StorageRecord* find(std::string_view name) const noexcept(true);
@@ -56,4 +57,8 @@ void Storage::scope_end() noexcept(true) {
   --scope_depth_;
 }
 
+size_t Storage::scope_depth() const noexcept(true) {
+  return scope_depth_;
+}
+
 #endif// WEAK_STORAGE_HPP
@@ -4,6 +4,7 @@
 #include "../error/eval_error.hpp"
 #include "../eval/eval.hpp"
 #include "../lexer/lexer.hpp"
+#include "../optimizer/loop_unroller.hpp"
 #include "../optimizer/optimizer.hpp"
 #include "../parser/parser.hpp"
 #include "../semantic/semantic_analyzer.hpp"
@@ -18,12 +19,18 @@ namespace eval_detail {
 
 static int test_counter = 0;
 
-Evaluator create_eval_context(std::string_view program, bool enable_optimizing = false) noexcept(false) {
+boost::local_shared_ptr<ast::RootObject> create_bound_tree(std::string_view program, bool lazy_bodies = false) noexcept(false) {
   Lexer lexer(std::istringstream{program.data()});
-  Parser parser(lexer.tokenize());
+  Parser parser(lexer.tokenize(), lazy_bodies);
   auto parsed_program = parser.parse();
   SemanticAnalyzer semantic_analyzer(parsed_program);
   semantic_analyzer.analyze();
+  SemanticAnalyzer::bind(*parsed_program);
+  return parsed_program;
+}
+
+Evaluator create_eval_context(std::string_view program, bool enable_optimizing = false, bool lazy_bodies = false) noexcept(false) {
+  auto parsed_program = create_bound_tree(program, lazy_bodies);
   if (enable_optimizing) {
     Optimizer optimizer(parsed_program);
     optimizer.optimize();
@@ -31,13 +38,18 @@ Evaluator create_eval_context(std::string_view program, bool enable_optimizing =
   return Evaluator(parsed_program);
 }
 
-void run_test(std::string_view program, std::string_view expected_output, bool enable_optimizing = true) noexcept(false) {
+/// @brief  compare output of evaluated program with expected one and reset output
+/// @param  program - source, shown on mismatch, empty if test has only a tree
+void expect_output(std::string_view program, std::string_view expected_output) noexcept(false) {
   std::cout << "Run eval test " << test_counter++ << " => ";
-  create_eval_context(program, enable_optimizing).eval();
   try {
     auto& stream = dynamic_cast<std::ostringstream&>(default_stdout);
     if (stream.str() != expected_output) {
-      std::cerr << "eval error: for " << program << "\n\tgot [" << stream.str() << "], expected [" << expected_output << "]\n";
+      std::cerr << "eval error: ";
+      if (!program.empty()) {
+        std::cerr << "for " << program << "\n\t";
+      }
+      std::cerr << "got [" << stream.str() << "], expected [" << expected_output << "]\n";
       exit(-1);
     }
     stream.str("");
@@ -47,6 +59,11 @@ void run_test(std::string_view program, std::string_view expected_output, bool e
   std::cout << "OK\n";
 }
 
+void run_test(std::string_view program, std::string_view expected_output, bool enable_optimizing = true, bool lazy_bodies = false) noexcept(false) {
+  create_eval_context(program, enable_optimizing, lazy_bodies).eval();
+  expect_output(program, expected_output);
+}
+
 #define ENABLE_FUZZING
 void expect_error(std::string_view program) {
 #ifndef ENABLE_FUZZING
@@ -72,6 +89,49 @@ auto speed_test(std::string_view description, std::string_view program, bool ena
   });
 };
 
+boost::local_shared_ptr<ast::RootObject> create_optimized_tree(std::string_view program) noexcept(false) {
+  auto parsed_program = create_bound_tree(program);
+  Optimizer optimizer(parsed_program);
+  optimizer.optimize();
+  return parsed_program;
+}
+
+/// @brief  run only given pass, so other passes don't change checked nodes
+boost::local_shared_ptr<ast::RootObject> create_optimized_tree(std::string_view program, std::string_view pass) noexcept(false) {
+  auto parsed_program = create_bound_tree(program);
+  Optimizer optimizer(parsed_program, {*Optimizer::find_pass(pass)}, /*to_fixed_point=*/false);
+  optimizer.optimize();
+  return parsed_program;
+}
+
+/// @brief  evaluate program and compare its output
+void check_output(boost::local_shared_ptr<ast::RootObject>& program, std::string_view expected_output) noexcept(false) {
+  Evaluator(program).eval();
+  expect_output(/*program=*/"", expected_output);
+}
+
+/// @brief  evaluate program and compare its output
+/// @param  setup - called with evaluator before evaluation
+/// @return evaluator after evaluation
+template <typename Setup>
+Evaluator run_prepared_test(std::string_view program, std::string_view expected_output, Setup setup) noexcept(false) {
+  Evaluator evaluator = create_eval_context(program);
+  setup(evaluator);
+  evaluator.eval();
+  expect_output(program, expected_output);
+  return evaluator;
+}
+
+/// @return memoization counters after evaluation
+MemoCache::Stats run_memoized_test(std::string_view program, std::string_view expected_output, size_t capacity = Evaluator::default_memo_capacity) noexcept(false) {
+  return run_prepared_test(program, expected_output, [capacity](Evaluator& evaluator) { evaluator.enable_memoization(capacity); }).memo_stats();
+}
+
+/// @return tier-up events of evaluation
+std::vector<Tiering::Event> run_tiered_test(std::string_view program, std::string_view expected_output, Tiering::Thresholds thresholds) noexcept(false) {
+  return run_prepared_test(program, expected_output, [thresholds](Evaluator& evaluator) { evaluator.enable_tiering(thresholds); }).tier_events();
+}
+
 }// namespace eval_detail
 
 void eval_print_tests() {
@@ -102,6 +162,8 @@ void eval_arithmetic_tests() {
   eval_detail::run_test("lambda main() { print(2 * (2 + 2)); }", "8");
   //  eval_detail::run_test("lambda main() { print((2 + 2) * 2); }", "8");
   eval_detail::run_test("lambda main() { print(2 << 2, 2 << 9, 2 << 10); }", "8 1024 2048");
+  eval_detail::run_test("lambda main() { print(12 & 10, 12 | 10, 12 ^ 10); }", "8 14 6");
+  eval_detail::run_test("lambda main() { var = 12; var &= 6; var |= 1; var ^= 3; print(var); }", "6");
   eval_detail::run_test("lambda main() { print(1 * 2 * 3 * 4 * 5); }", "120");
   eval_detail::run_test("lambda main() { print(++1); }", "2");
   eval_detail::run_test("lambda main() { print(--1); }", "0");
@@ -320,6 +382,110 @@ void eval_optimizer_reduce_tests() {
   eval_detail::run_test("lambda main() { for (i = 0; ; i += 1) {} }", "");
 }
 
+void eval_optimizer_folding_tests() {
+  eval_detail::run_test("lambda main() { print(2 * (2 + 2)); }", "8");
+  eval_detail::run_test("lambda main() { n = 10; x = n * 4; print(x); }", "40");
+  eval_detail::run_test("lambda main() { k = 3; s = 0; for (i = 0; i < k; ++i) { s = s + i * k; } print(s); }", "9");
+  eval_detail::run_test("lambda main() { if (1) { n = 2; } print(n); }", "2");
+  eval_detail::run_test("lambda main() { if (0) { print(1 / 0); } print(1.5 * 2); }", "3");
+  eval_detail::run_test("lambda f() { b = 2 + 1; ++b; b; } lambda main() { print(f(), f()); }", "4 4");
+  /// Variables share literal, so both are left as is.
+  eval_detail::run_test("lambda main() { n = 5; m = n; ++m; print(n, m); }", "6 6");
+
+  auto main_body = [](const boost::local_shared_ptr<ast::RootObject>& program) -> const std::vector<boost::local_shared_ptr<ast::Object>>& {
+    return static_cast<ast::Lambda&>(*program->get().back()).body()->statements();
+  };
+  auto print_argument = [](const boost::local_shared_ptr<ast::Object>& statement) -> const ast::Integer& {
+    return static_cast<const ast::Integer&>(*static_cast<const ast::LambdaCall&>(*statement).arguments()[0]);
+  };
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda main() { print(2 * (2 + 2)); }");
+    const auto& body = main_body(program);
+    assert(body.size() == 1 && print_argument(body[0]).value() == 8);
+  }
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda main() { n = 10; x = n * 4; print(x); }");
+    const auto& body = main_body(program);
+    assert(body.size() == 1 && print_argument(body[0]).value() == 40);
+  }
+  {
+    /// Assigned twice, so only folded.
+    const auto program = eval_detail::create_optimized_tree("lambda main() { n = 10; x = n * 4; print(x); x = 1; print(x); }");
+    const auto& body = main_body(program);
+    const auto& assignment = static_cast<const ast::Binary&>(*body[0]);
+    assert(body.size() == 4 && static_cast<const ast::Integer&>(*assignment.rhs()).value() == 40);
+  }
+}
+
+void eval_optimizer_dead_code_tests() {
+  eval_detail::run_test("lambda main() { if (0) { print(1); } else { print(2); } if (1) { print(3); } }", "23");
+  eval_detail::run_test("lambda main() { for (k = 0; k < 3; ++k) { for (j = 0; j < 3; ++j) { k * j; } } print(1); }", "1");
+  eval_detail::run_test("lambda f(a) { print(a); a; } lambda main() { x = f(1); y = 2; print(3); }", "13");
+  eval_detail::run_test("lambda sq(a) { a * a; } lambda main() { sq(2); arr = [1, 2]; array-replace(arr, 0, 5); print(array-get(arr, 0)); }", "5");
+  eval_detail::run_test("lambda main() { x = 1; if (x) {} 1 / 0.5; print(x); }", "1");
+
+  auto main_body = [](const boost::local_shared_ptr<ast::RootObject>& program) -> const std::vector<boost::local_shared_ptr<ast::Object>>& {
+    return static_cast<ast::Lambda&>(*program->get().back()).body()->statements();
+  };
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda main() { if (0) { print(1); } else { print(2); print(3); } 0; }");
+    const auto& body = main_body(program);
+    assert(body.size() == 3 && body[0]->ast_type() == ast::type_t::LAMBDA_CALL);
+  }
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda main() { for (k = 0; k < 3; ++k) { for (j = 0; j < 3; ++j) { k * j; } } }", "dce");
+    const auto& outer = static_cast<const ast::For&>(*main_body(program)[0]);
+    const auto& inner = static_cast<const ast::For&>(*outer.body()->statements()[0]);
+    assert(inner.body()->statements().empty());
+  }
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda f(a) { print(a); a; } lambda sq(a) { a * a; } lambda main() { x = f(1); y = 2; sq(y); print(3); }");
+    const auto& body = main_body(program);
+    assert(body.size() == 2);
+    assert(static_cast<const ast::LambdaCall&>(*body[0]).name() == "f");
+  }
+}
+
+void eval_inlining_tests() {
+  eval_detail::run_test("lambda add(a, b) { a + b; } lambda main() { s = 0; for (i = 0; i < 5; ++i) { s = add(s, i); } print(s); }", "10");
+  eval_detail::run_test("lambda sq(x) { x * x; } lambda add(a, b) { a + b; } lambda main() { print(1 + sq(add(1, 2))); }", "10");
+  eval_detail::run_test("lambda f(a) { t = a * 2; print(t); t; } lambda main() { y = f(3); z = f(y); print(y, z); }", "6126 12");
+  eval_detail::run_test("lambda id(a) { a; } lambda main() { x = 1; y = id(x); ++y; print(x, y); }", "2 2");
+  eval_detail::run_test("lambda inc(a) { ++a; } lambda main() { x = 1; inc(x); inc(x); print(x); }", "3");
+  eval_detail::run_test("lambda set(x) { x = 2; } lambda main() { x = 1; set(x); print(x); }", "1");
+  eval_detail::run_test("lambda twice(a) { a + a; } lambda main() { x = 2; print(twice(x * 3)); }", "12");
+  /// Literal of body lives across calls, so such lambda is called.
+  eval_detail::run_test("lambda g() { b = 3; ++b; b; } lambda main() { print(g(), g()); }", "5 5");
+  eval_detail::run_test("lambda fact(n) { r = 1; if (n > 1) { r = n * fact(n - 1); } r; } lambda main() { print(fact(5)); }", "120");
+  eval_detail::run_test("lambda main() { lambda half(a) { a / 2; } x = 0; for (i = 0; i < 4; ++i) { x = x + half(i * 2); } print(x); }", "6");
+
+  auto main_body = [](const boost::local_shared_ptr<ast::RootObject>& program) -> const std::vector<boost::local_shared_ptr<ast::Object>>& {
+    return static_cast<ast::Lambda&>(*program->get().back()).body()->statements();
+  };
+  {
+    /// Expression body takes place of call, then it's folded.
+    const auto program = eval_detail::create_optimized_tree("lambda sq(x) { x * x; } lambda main() { print(sq(3)); }");
+    const auto& body = main_body(program);
+    const auto& print = static_cast<const ast::LambdaCall&>(*body[0]);
+    assert(body.size() == 1 && static_cast<const ast::Integer&>(*print.arguments()[0]).value() == 9);
+  }
+  {
+    /// Statements of body get new slots of caller frame.
+    const auto program = eval_detail::create_optimized_tree("lambda f(a) { t = a * 2; print(t); t; } lambda main() { n = 0; for (i = 0; i < 3; ++i) { n = f(i); } print(n); }", "inline");
+    const auto& main = static_cast<const ast::Lambda&>(*program->get().back());
+    const auto& loop = static_cast<const ast::For&>(*main.body()->statements()[1]);
+    for (const auto& statement : loop.body()->statements()) {
+      assert(statement->ast_type() != ast::type_t::LAMBDA_CALL || static_cast<const ast::LambdaCall&>(*statement).name() == "print");
+    }
+    assert(main.frame_size() == 4);
+  }
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda fact(n) { r = 1; if (n > 1) { r = n * fact(n - 1); } r; } lambda main() { print(fact(5)); }");
+    const auto& print = static_cast<const ast::LambdaCall&>(*main_body(program)[0]);
+    assert(static_cast<const ast::LambdaCall&>(*print.arguments()[0]).name() == "fact");
+  }
+}
+
 void eval_fuzz_tests() {
   eval_detail::expect_error("lambda simple() { var; } lambda main() { simple(); }");
   eval_detail::expect_error("lambda main() { for (var = 0; var != 10; ++var) { } print(var); }");
@@ -331,6 +497,657 @@ void eval_fuzz_tests() {
   eval_detail::expect_error("lambda main() { a = 1 % 1.5; }");
 }
 
+void eval_lazy_bodies_tests() {
+  const bool enable_optimizing = true;
+  const bool lazy_bodies = true;
+  eval_detail::run_test("lambda f(x) { x * 2; } lambda main() { print(f(2)); }", "4", enable_optimizing, lazy_bodies);
+  eval_detail::run_test("lambda g(x) { x + 1; } lambda f(x) { y = g(x); y * 2; } lambda main() { print(f(1)); print(f(2)); }", "46", enable_optimizing, lazy_bodies);
+  eval_detail::run_test("define-type t(a); lambda f() { o = new t(1); o; } lambda main() { o = f(); print(o.a); }", "1", enable_optimizing, lazy_bodies);
+  /// Unused bodies are never parsed nor analyzed.
+  eval_detail::run_test("lambda unused() { 1 ++ 2; } lambda main() { print(1); }", "1", enable_optimizing, lazy_bodies);
+  eval_detail::run_test("lambda unused() { while (x) 1; } lambda main() { print(1); }", "1", enable_optimizing, lazy_bodies);
+
+  /// Lazy bodies are bound by the same lexical scope rules as eager ones.
+  for (bool lazy : {false, true}) {
+    eval_detail::run_test("lambda f() { i = 10; i; } lambda main() { i = 1; print(f(), i); }", "10 1", enable_optimizing, lazy);
+    eval_detail::run_test("lambda f(n) { if (n > 0) { f(n - 1); } n; } lambda main() { print(f(3)); }", "3", enable_optimizing, lazy);
+  }
+
+  /// Errors of used bodies are reported on first call, callee, reading variable of caller, is one.
+  for (std::string_view program : {"lambda f() { 1 ++ 2; } lambda main() { print(1); f(); }", "lambda f() { while (x) 1; } lambda main() { f(); }", "lambda f() { x; } lambda main() { x = 1; f(); }", "lambda f(a) { a; } lambda main() { f(); }"}) {
+    bool error = true;
+    trace_error(program, [&program, &error] {
+      eval_detail::create_eval_context(program, !enable_optimizing, lazy_bodies).eval();
+      error = false;
+    });
+    if (!error) {
+      throw EvalError("lazy bodies test: error expected in program\n\t{}", program);
+    }
+    default_stdout.clear();
+    if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+      stream->str("");
+    }
+  }
+}
+
+void eval_lazy_bodies_speed_tests() {
+  std::string program;
+  for (size_t i = 0; i < 5000; ++i) {
+    program += "lambda unused" + std::to_string(i) + "(a, b) {"
+               "  if (a < b) { x = a * 2 + b; } else { x = [a, b]; }"
+               "  for (i = 0; i < 10; ++i) { print(i, x, \"text\"); }"
+               "}\n";
+  }
+  program += "lambda main() { print(1); }";
+
+  std::cout << "\nLazy bodies speed test - time to first output, 5000 unused functions\n";
+  for (bool lazy_bodies : {false, true}) {
+    speed_benchmark(lazy_bodies ? "lazy" : "eager", 1, [&program, lazy_bodies] {
+      eval_detail::create_eval_context(program, /*enable_optimizing=*/false, lazy_bodies).eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_type_inference_tests() {
+  /// Integer paths.
+  eval_detail::run_test("lambda main() { i = 0; while (i < 5) { print(i); ++i; } }", "01234");
+  eval_detail::run_test("lambda main() { n = 3; for (i = 0; i < n + 2; ++i) { print(i); } }", "01234");
+  eval_detail::run_test("lambda main() { x = 7; if (x % 2) { print(\"Odd\"); } else { print(\"Even\"); } }", "Odd");
+  eval_detail::run_test("lambda main() { x = 2; y = 1 + x * (x << 3); print(y); }", "33");
+  eval_detail::run_test("lambda main() { x = 10; --x; --x; print(x); }", "8");
+  eval_detail::run_test("lambda main() { sum = 0; for (i = 0; i < 10; ++i) { sum = sum + i * i; } print(sum); }", "285");
+  /// Fallback to generic paths for types, unknown at compile time.
+  eval_detail::run_test("lambda twice(x) { x * 2; } lambda main() { print(twice(2), twice(1.5)); }", "4 3");
+  eval_detail::run_test("lambda main() { x = 1; for (i = 0; i < 2; ++i) { print(x + 1, \"\"); x = 0.5; } }", "2 1.5 ");
+  eval_detail::run_test("lambda rebind(x) { x = 1.5; x; } lambda main() { x = 1; y = rebind(x); print(y, x + 1); }", "1.5 2");
+  eval_detail::run_test("lambda flag(a) { if (a) { x = 1; } else { x = 0.5; } x + 1; } lambda main() { print(flag(1), flag(0)); }", "2 1.5");
+}
+
+void eval_binding_tests() {
+  eval_detail::run_test("lambda fact(n) { r = 1; if (n > 1) { r = n * fact(n - 1); } r; } lambda main() { print(fact(10)); }", "3628800");
+  eval_detail::run_test("lambda g(a) { a + 1; } lambda main() { f = g; print(f(1)); }", "2");
+  eval_detail::run_test("lambda main() { lambda inner(a) { a * 2; } print(inner(2)); }", "4");
+  eval_detail::run_test("lambda set(x) { x = 2; } lambda main() { x = 1; set(x); print(x); }", "1");
+  eval_detail::run_test("lambda main() { i = 5; for (i = 0; i < 3; ++i) {} print(i); }", "3");
+  eval_detail::run_test("lambda main() { for (i = 0; i < 2; ++i) { print(i); } for (i = 5; i < 7; ++i) { print(i); } }", "0156");
+  eval_detail::run_test("define-type pair(a, b); lambda main() { p = new pair(1, 2); print(p.a, p.b); }", "1 2");
+  eval_detail::expect_error("lambda main() { if (0) { x = 1; } print(x); }");
+}
+
+void eval_binding_speed_tests() {
+  const std::string_view program = R"(
+    lambda add(a, b) { a + b; }
+    lambda main() {
+      sum = 0;
+      for (i = 0; i < 100000; ++i) { sum = add(sum, i); }
+      print(sum);
+    }
+  )";
+  std::cout << "\nBinding speed test - 100000 calls\n";
+  for (bool bind : {false, true}) {
+    Lexer lexer(std::istringstream{program.data()});
+    Parser parser(lexer.tokenize());
+    auto parsed_program = parser.parse();
+    SemanticAnalyzer semantic_analyzer(parsed_program);
+    semantic_analyzer.analyze();
+    if (bind) {
+      SemanticAnalyzer::bind(*parsed_program);
+    }
+    speed_benchmark(bind ? "bound" : "storage", 1, [evaluator = Evaluator(parsed_program)]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_loop_invariant_tests() {
+  eval_detail::run_test("lambda main() { arr = [1, 2, 3]; s = 0; for (i = 0; i < array-length(arr); ++i) { s = s + array-get(arr, i); } print(s); }", "6");
+  eval_detail::run_test("lambda main() { n = 3; s = 0; for (i = 0; i < 4; ++i) { w = n * 3; s = s + w; } print(s, w); }", "36 9");
+  eval_detail::run_test("lambda sq(x) { r = x * x; r; } lambda main() { n = 3; k = 0; while (k < sq(n)) { k = k + 1; } print(k); }", "9");
+  eval_detail::run_test("lambda main() { n = 0; k = 5; while (k < n * 2) { k = k + 1; } print(k); }", "5");
+  /// Variables share value, so it changes in loop.
+  eval_detail::run_test("lambda main() { n = 3; m = n; for (j = 0; j < 3; ++j) { ++m; print(n * 2); } }", "81012");
+  eval_detail::run_test("lambda main() { arr = [1]; for (j = 0; j < 3; ++j) { array-insert(arr, 0, 7); print(array-length(arr)); } }", "234");
+  eval_detail::run_test("lambda main() { n = 2; for (i = 0; i < 3; ++i) { x = n * 2; ++x; print(x); } }", "555");
+  eval_detail::run_test("lambda main() { n = 2; for (i = 0; i < 2; ++i) { j = 0; while (j < 2) { print(n * (5 + i)); j = j + 1; } } }", "10101212");
+
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda main() { arr = [1, 2, 3]; s = 0; for (i = 0; i < array-length(arr); ++i) { s = s + i; } print(s); }");
+    const auto& body = static_cast<ast::Lambda&>(*program->get().back()).body()->statements();
+    const auto& temporary = static_cast<const ast::Binary&>(*body[2]);
+    assert(temporary.type() == token_t::ASSIGN && static_cast<const ast::LambdaCall&>(*temporary.rhs()).name() == "array-length");
+    const auto& loop = static_cast<const ast::For&>(*body[3]);
+    assert(static_cast<const ast::Binary&>(*loop.exit_condition()).rhs()->ast_type() == ast::type_t::SYMBOL);
+  }
+  {
+    /// Moved out of both loops.
+    const auto program = eval_detail::create_optimized_tree("lambda f(n) { for (i = 0; i < 2; ++i) { for (j = 0; j < 2; ++j) { print(n * 5); } } } lambda main() { f(2); }", "hoist");
+    const auto& body = static_cast<ast::Lambda&>(*program->get().front()).body()->statements();
+    const auto& outer = static_cast<const ast::For&>(*body.back());
+    const auto& inner = static_cast<const ast::For&>(*outer.body()->statements().back());
+    const auto& print = static_cast<const ast::LambdaCall&>(*inner.body()->statements()[0]);
+    assert(print.arguments()[0]->ast_type() == ast::type_t::SYMBOL);
+    assert(static_cast<const ast::Binary&>(*body[body.size() - 2]).rhs()->ast_type() == ast::type_t::BINARY);
+  }
+}
+
+void eval_strength_reduction_tests() {
+  eval_detail::run_test("lambda main() { s = 0; for (i = 0; i < 10; ++i) { s = s + i * 3; } print(s); }", "135");
+  eval_detail::run_test("lambda main() { s = 0; for (i = 1; i <= 20; i += 2) { s = s + i % 8; s = s + i / 4; } print(s); }", "56");
+  eval_detail::run_test("lambda main() { for (i = 0; i < 6; i = i + 2) { print(5 * i); } }", "01020");
+  /// Init literal keeps the last value of counter, so second run doesn't enter loop.
+  eval_detail::run_test("lambda f() { for (i = 0; i < 3; ++i) { print(i * 4); } } lambda main() { f(); f(); }", "048");
+  /// Counter is read not only in products, or product is kept by variable.
+  eval_detail::run_test("lambda main() { for (i = 0; i < 3; ++i) { print(i * 2, i); } }", "0 02 14 2");
+  eval_detail::run_test("lambda main() { for (i = 0; i < 3; ++i) { x = i * 2; ++x; print(x); } }", "135");
+  eval_detail::run_test("lambda main() { for (i = 0; i < 4; ++i) { print(i * 2, i * 3); } }", "0 02 34 66 9");
+
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda f() { s = 0; for (i = 1; i < 10; ++i) { s = s + i * 3; } s; } lambda main() { print(f()); }", "strength-reduce");
+    const auto& body = static_cast<ast::Lambda&>(*program->get().front()).body()->statements();
+    const auto& loop = static_cast<const ast::For&>(*body[1]);
+    assert(static_cast<const ast::Integer&>(*static_cast<const ast::Binary&>(*loop.loop_init()).rhs()).value() == 3);
+    assert(static_cast<const ast::Integer&>(*static_cast<const ast::Binary&>(*loop.exit_condition()).rhs()).value() == 30);
+    const auto& increment = static_cast<const ast::Binary&>(*loop.increment());
+    assert(increment.type() == token_t::PLUS_ASSIGN && static_cast<const ast::Integer&>(*increment.rhs()).value() == 3);
+    const auto& sum = static_cast<const ast::Binary&>(*static_cast<const ast::Binary&>(*loop.body()->statements()[0]).rhs());
+    assert(sum.rhs()->ast_type() == ast::type_t::SYMBOL);
+  }
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda f(n) { s = 0; for (i = 0; i < n; ++i) { s = s + i % 8; } s; } lambda main() { print(f(9)); }");
+    const auto& body = static_cast<ast::Lambda&>(*program->get().front()).body()->statements();
+    const auto& loop = static_cast<const ast::For&>(*body[1]);
+    const auto& sum = static_cast<const ast::Binary&>(*static_cast<const ast::Binary&>(*loop.body()->statements()[0]).rhs());
+    assert(static_cast<const ast::Binary&>(*sum.rhs()).type() == token_t::BIT_AND);
+  }
+}
+
+void eval_common_subexpression_tests() {
+  eval_detail::run_test("lambda f(a, b, c) { r = 0; if (10 < a * b + c) { r = r + 1; } if (20 > a * b + c) { r = r + 2; } r; } lambda main() { print(f(2, 3, 5)); }", "3");
+  eval_detail::run_test("lambda main() { v = [4, 5]; i = 1; x = 2 * array-get(v, i); y = 1 + array-get(v, i); print(x, y); }", "10 6");
+  /// Values change between occurrences.
+  eval_detail::run_test("lambda f(a, b) { x = a * b + 1; ++a; y = a * b + 1; print(x, y); } lambda main() { f(2, 3); }", "8 12");
+  eval_detail::run_test("lambda f(a, b) { m = a; x = a * b + 1; ++m; y = a * b + 1; print(x, y); } lambda main() { f(2, 3); }", "8 12");
+  eval_detail::run_test("lambda main() { v = [1, 2]; x = 0 + array-get(v, 1); array-replace(v, 1, 7); y = 0 + array-get(v, 1); print(x, y); }", "2 7");
+  /// Variable, which is changed in place, doesn't share value of temporary.
+  eval_detail::run_test("lambda f(a, b) { x = a * b + 3; y = a * b + 3; ++x; print(x, y); } lambda main() { f(2, 3); }", "13 12");
+
+  {
+    const auto program = eval_detail::create_optimized_tree("lambda f(a, b, c) { x = a * b + c; y = a * b + c; print(x, y); } lambda main() { f(2, 3, 5); }");
+    const auto& body = static_cast<ast::Lambda&>(*program->get().front()).body()->statements();
+    assert(body.size() == 4);
+    const auto& temporary = static_cast<const ast::Binary&>(*body[0]);
+    assert(temporary.type() == token_t::ASSIGN && temporary.rhs()->ast_type() == ast::type_t::BINARY);
+    assert(static_cast<const ast::Binary&>(*body[1]).rhs()->ast_type() == ast::type_t::SYMBOL);
+    assert(static_cast<const ast::Binary&>(*body[2]).rhs()->ast_type() == ast::type_t::SYMBOL);
+  }
+  {
+    /// Too cheap to be worth a temporary.
+    const auto program = eval_detail::create_optimized_tree("lambda f(a, b) { x = a * b; y = a * b; print(x, y); } lambda main() { f(2, 3); }");
+    const auto& body = static_cast<ast::Lambda&>(*program->get().front()).body()->statements();
+    assert(body.size() == 3);
+  }
+}
+
+void eval_common_subexpression_speed_tests() {
+  const std::string_view program = R"(
+    lambda main() {
+      v = [2, 3, 5, 7];
+      sum = 0;
+      for (i = 0; i < 100000; ++i) {
+        j = i % 4;
+        sum = sum + array-get(v, j);
+        sum = sum - array-get(v, j);
+        sum = sum + 1 + array-get(v, j);
+      }
+      print(sum);
+    }
+  )";
+  std::cout << "\nCommon subexpression speed test - 100000 iterations\n";
+  for (bool optimize : {false, true}) {
+    speed_benchmark(optimize ? "reused" : "recomputed", 1, [evaluator = eval_detail::create_eval_context(program, optimize)]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_strength_reduction_speed_tests() {
+  const std::string_view program = R"(
+    lambda main() {
+      sum = 0;
+      for (i = 0; i < 100000; ++i) {
+        sum = sum + i * 3;
+        sum = sum + i * 3;
+        sum = sum % 65536;
+      }
+      print(sum);
+    }
+  )";
+  std::cout << "\nStrength reduction speed test - 100000 iterations\n";
+  for (bool optimize : {false, true}) {
+    speed_benchmark(optimize ? "reduced" : "multiplied", 1, [evaluator = eval_detail::create_eval_context(program, optimize)]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_loop_invariant_speed_tests() {
+  const std::string_view program = R"(
+    lambda main() {
+      arr = [1, 2, 3, 4, 5, 6, 7, 8];
+      n = 7;
+      sum = 0;
+      for (i = 0; i < 100000; ++i) {
+        w = n * n + n * 3 + array-length(arr);
+        sum = sum + w;
+      }
+      print(sum);
+    }
+  )";
+  std::cout << "\nLoop invariant speed test - 100000 iterations\n";
+  for (bool optimize : {false, true}) {
+    speed_benchmark(optimize ? "hoisted" : "recomputed", 1, [evaluator = eval_detail::create_eval_context(program, optimize)]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_loop_unrolling_tests() {
+  eval_detail::run_test("lambda main() { s = 0; for (i = 0; i < 5; ++i) { s = s + i * i; } print(s); }", "30");
+  eval_detail::run_test("lambda main() { s = 0; for (i = 1; i <= 50; i += 1) { s = s + i; } print(s); }", "1275");
+  eval_detail::run_test("lambda main() { for (i = 0; i < 8; i = i + 3) { print(i); } }", "036");
+  /// Init literal keeps the last value of counter, so second run doesn't enter loop.
+  eval_detail::run_test("lambda f() { for (i = 0; i < 3; ++i) { print(i); } 0; } lambda main() { f(); f(); }", "012");
+  eval_detail::run_test("lambda f() { s = 0; for (i = 0; i < 30; ++i) { s = s + i; } print(s); } lambda main() { f(); f(); }", "4350");
+  eval_detail::run_test("lambda f() { for (i = 0; i < 3; i = i + 1) { print(i); } 0; } lambda main() { f(); f(); }", "012012");
+  /// Literals of body live across iterations.
+  eval_detail::run_test("lambda main() { for (i = 0; i < 3; ++i) { x = 0; ++x; print(x); } }", "123");
+  eval_detail::run_test("lambda main() { for (k = 0; k < 3; ++k) { for (j = 0; j < 2; ++j) { print(j); } } }", "01");
+  eval_detail::run_test("lambda main() { for (k = 0; k < 2; ++k) { for (j = 0; j < 2; j = j + 1) { print(k, j); } } }", "0 00 11 01 1");
+
+  auto lambda_body = [](const boost::local_shared_ptr<ast::RootObject>& program) -> const std::vector<boost::local_shared_ptr<ast::Object>>& {
+    return static_cast<const ast::Lambda&>(*program->get().front()).body()->statements();
+  };
+  {
+    auto program = eval_detail::create_optimized_tree("lambda f() { s = 0; for (i = 0; i < 3; i = i + 1) { s = s + i; } s; } lambda main() { print(f()); }");
+    const auto& body = lambda_body(program);
+    assert(std::none_of(body.begin(), body.end(), [](const auto& statement) { return statement->ast_type() == ast::type_t::FOR; }));
+    eval_detail::check_output(program, "3");
+  }
+  {
+    auto program = eval_detail::create_optimized_tree("lambda f() { s = 0; for (i = 0; i < 100; ++i) { s = s + i; } s; } lambda main() { print(f()); }");
+    const auto& body = lambda_body(program);
+    assert(body.size() == 3);
+    const auto& loop = static_cast<const ast::For&>(*body[1]);
+    assert(static_cast<const ast::Integer&>(*static_cast<const ast::Binary&>(*loop.exit_condition()).rhs()).value() == 97);
+    assert(loop.body()->statements().size() == 2 * LoopUnroller::default_factor - 1);
+    eval_detail::check_output(program, "4950");
+  }
+  {
+    /// Iterations, that don't fill all copies, run in remainder loop.
+    auto program = eval_detail::create_bound_tree("lambda f() { s = 0; for (i = 0; i < 101; ++i) { s = s + i; } s; } lambda main() { print(f()); }");
+    auto& function = static_cast<ast::Lambda&>(*program->get().front());
+    assert(LoopUnroller(function, /*factor=*/2).run() == 1);
+    const auto& body = function.body()->statements();
+    assert(body.size() == 4 && body[2]->ast_type() == ast::type_t::WHILE);
+    assert(static_cast<const ast::Integer&>(*static_cast<const ast::Binary&>(*static_cast<const ast::For&>(*body[1]).exit_condition()).rhs()).value() == 100);
+    eval_detail::check_output(program, "5050");
+  }
+  {
+    /// Copies don't fit into size limit.
+    auto program = eval_detail::create_bound_tree("lambda f() { s = 0; for (i = 0; i < 100; ++i) { s = s + i; } s; } lambda main() { print(f()); }");
+    assert(LoopUnroller(static_cast<ast::Lambda&>(*program->get().front()), LoopUnroller::default_factor, LoopUnroller::default_full_limit, /*size_limit=*/8).run() == 0);
+  }
+}
+
+void eval_loop_unrolling_speed_tests() {
+  const std::string_view program = R"(
+    lambda main() {
+      sum = 0;
+      for (i = 0; i < 100000; ++i) {
+        sum += i % 8;
+      }
+      print(sum);
+    }
+  )";
+  std::cout << "\nLoop unrolling speed test - 100000 iterations\n";
+  for (bool optimize : {false, true}) {
+    speed_benchmark(optimize ? "unrolled" : "looped", 1, [evaluator = eval_detail::create_eval_context(program, optimize)]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_optimizer_pipeline_tests() {
+  assert(Optimizer::find_pass("fold") && !Optimizer::find_pass("unknown"));
+  const std::string_view source = "lambda sq(a) { a * a; } lambda main() { n = 3; m = n * 2; x = sq(m); print(x); }";
+  auto main_body = [](const boost::local_shared_ptr<ast::RootObject>& program) -> const std::vector<boost::local_shared_ptr<ast::Object>>& {
+    return static_cast<const ast::Lambda&>(*program->get().back()).body()->statements();
+  };
+  {
+    auto program = eval_detail::create_bound_tree(source);
+    Optimizer optimizer(program, 0);
+    optimizer.optimize();
+    assert(optimizer.stats().empty() && optimizer.iterations() == 0 && main_body(program).size() == 4);
+    eval_detail::check_output(program, "36");
+  }
+  {
+    /// Only named passes run, in given order.
+    auto program = eval_detail::create_bound_tree(source);
+    Optimizer optimizer(program, {*Optimizer::find_pass("fold"), *Optimizer::find_pass("dce")}, /*to_fixed_point=*/false);
+    optimizer.optimize();
+    const auto& stats = optimizer.stats();
+    assert(stats.size() == 2 && stats[0].name == "fold" && stats[1].name == "dce");
+    assert(stats[0].runs == 2 && stats[0].changes > 0 && optimizer.iterations() == 1);
+    eval_detail::check_output(program, "36");
+  }
+  {
+    auto program = eval_detail::create_bound_tree(source);
+    Optimizer optimizer(program, 1);
+    optimizer.optimize();
+    assert(optimizer.stats().size() == Optimizer::passes().size() && optimizer.iterations() == 1);
+    eval_detail::check_output(program, "36");
+  }
+  {
+    /// The last run changes nothing.
+    auto program = eval_detail::create_bound_tree(source);
+    Optimizer optimizer(program, 2);
+    optimizer.optimize();
+    assert(optimizer.iterations() >= 2 && optimizer.iterations() <= Optimizer::max_iterations);
+    eval_detail::check_output(program, "36");
+  }
+}
+
+void eval_inlining_speed_tests() {
+  const std::string_view program = R"(
+    lambda add(a, b) { a + b; }
+    lambda scale(a) { t = a * 3; t - a; }
+    lambda main() {
+      sum = 0;
+      for (i = 0; i < 100000; ++i) { sum = add(sum, i); d = scale(i); sum = sum + d; }
+      print(sum);
+    }
+  )";
+  std::cout << "\nInlining speed test - 200000 calls\n";
+  for (bool optimize : {false, true}) {
+    speed_benchmark(optimize ? "inlined" : "called", 1, [evaluator = eval_detail::create_eval_context(program, optimize)]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_memoization_tests() {
+  const auto fib = eval_detail::run_memoized_test("lambda fib(n) { r = n + 0; if (n > 1) { a = fib(n - 1); r = a + fib(n - 2); } r; } lambda main() { print(fib(20)); }", "6765");
+  assert(fib.misses == 21 && fib.hits == 18);
+
+  /// Uncached call returns parameter or literal of body, which caller changes in place,
+  /// so such lambdas aren't cached and give the same output as without memoization.
+  for (const auto& [program, expected] : {std::pair{"lambda id(a) { a; } lambda main() { x = 1; r = id(x); r = id(x); ++r; println(x); }", "2\n"}, std::pair{"lambda f(a) { x = 5; x; } lambda main() { r = f(1); ++r; q = f(1); println(q); }", "6\n"}}) {
+    eval_detail::run_test(program, expected, /*enable_optimizing=*/false);
+    const auto shared = eval_detail::run_memoized_test(program, expected);
+    assert(shared.misses == 0 && shared.hits == 0);
+  }
+  const auto shared_local = eval_detail::run_memoized_test("lambda f(a) { r = a * 2; if (a > 1) { r = a; } r; } lambda main() { print(f(3), f(3)); }", "3 3");
+  assert(shared_local.misses == 0 && shared_local.hits == 0);
+
+  const auto impure = eval_detail::run_memoized_test("lambda show(a) { print(a); a; } lambda main() { show(1); show(1); }", "11");
+  assert(impure.misses == 0 && impure.hits == 0);
+
+  /// Cached result is copied, so caller may change it.
+  const auto copied = eval_detail::run_memoized_test("lambda id(a) { a + 0; } lambda main() { x = id(1); ++x; y = id(1); print(x, y); }", "2 1");
+  assert(copied.misses == 1 && copied.hits == 1);
+
+  const auto strings = eval_detail::run_memoized_test("lambda twice(s, a) { a * 2; } lambda main() { print(twice(\"ab\", 1), twice(\"ab\", 1), twice(\"c\", 1)); }", "2 2 2");
+  assert(strings.misses == 2 && strings.hits == 1);
+
+  const auto evicted = eval_detail::run_memoized_test("lambda sq(a) { a * a; } lambda main() { print(sq(1), sq(2), sq(3), sq(1), sq(3)); }", "1 4 9 1 9", /*capacity=*/2);
+  assert(evicted.misses == 4 && evicted.hits == 1 && evicted.evictions == 2);
+}
+
+void eval_tiering_tests() {
+  using reason_t = Tiering::reason_t;
+  using ast::inferred_t;
+
+  const auto cold = eval_detail::run_tiered_test("lambda sq(a) { a * a; } lambda main() { print(sq(2), sq(3)); }", "4 9", {3, 100});
+  assert(cold.empty());
+
+  /// Lambda, always called with integers, is specialized for them.
+  const auto hot = eval_detail::run_tiered_test("lambda sq(a) { a * a; } lambda main() { s = 0; for (i = 0; i < 10; ++i) { s = s + sq(i); } print(s); }", "285", {3, 1000});
+  assert(hot.size() == 1 && hot[0].lambda == "sq" && hot[0].reason == reason_t::CALLS && hot[0].calls == 3);
+  assert(hot[0].parameters == std::vector<inferred_t>{inferred_t::INTEGER});
+
+  const auto recursive = eval_detail::run_tiered_test("lambda fib(n) { r = n; if (n > 1) { r = fib(n - 1); r = r + fib(n - 2); } r; } lambda main() { print(fib(15)); }", "610", {10, 1000});
+  assert(recursive.size() == 1 && recursive[0].lambda == "fib" && recursive[0].parameters.size() == 1);
+
+  /// Arguments of different types leave clone generic.
+  const auto polymorphic = eval_detail::run_tiered_test("lambda twice(a) { a + a; } lambda main() { print(twice(1), twice(1.25), twice(2), twice(3)); }", "2 2.5 4 6", {3, 1000});
+  assert(polymorphic.size() == 1 && polymorphic[0].parameters.empty());
+
+  /// Calls, which miss guard of specialized clone, run lambda itself until clone is replaced.
+  const auto missed = eval_detail::run_tiered_test("lambda inc(a) { a + 1; } lambda main() { print(inc(1), inc(2), inc(1.5), inc(2.5), inc(3)); }", "2 3 2.5 3.5 4", {2, 1000});
+  assert(missed.size() == 2);
+  assert(missed[0].reason == reason_t::CALLS && missed[0].parameters == std::vector<inferred_t>{inferred_t::INTEGER});
+  assert(missed[1].reason == reason_t::GUARD_MISSES && missed[1].parameters.empty() && missed[1].calls == 4);
+
+  /// Iterations of loops make lambda hot on back edge, clone is run from the next call.
+  const auto loops = eval_detail::run_tiered_test("lambda sum(n) { s = n - n; for (i = n - n; i < n; ++i) { s = s + i; } s; } lambda main() { print(sum(10), sum(10), sum(10)); }", "45 45 45", {100, 15});
+  assert(loops.size() == 1 && loops[0].reason == reason_t::BACK_EDGES && loops[0].calls == 2 && loops[0].back_edges == 15);
+
+  /// Long loop tiers lambda up during its first call.
+  const auto long_loop = eval_detail::run_tiered_test("lambda count(n) { c = n - n; while (c < n) { ++c; } c; } lambda main() { print(count(50), count(3)); }", "50 3", {100, 20});
+  assert(long_loop.size() == 1 && long_loop[0].lambda == "count" && long_loop[0].calls == 1 && long_loop[0].back_edges == 20);
+
+  /// Clone shares literals, that evaluator changes in place, with lambda.
+  const auto literals = eval_detail::run_tiered_test("lambda g() { b = 3; ++b; b; } lambda main() { print(g(), g(), g()); }", "6 6 6", {2, 1000});
+  assert(literals.size() == 1 && literals[0].parameters.empty());
+}
+
+namespace eval_detail {
+
+ast::Binary& first_binary(ast::RootObject& program, std::string_view lambda_name) noexcept(false) {
+  for (const auto& expression : program.get()) {
+    if (expression->ast_type() == ast::type_t::LAMBDA && static_cast<ast::Lambda&>(*expression).name() == lambda_name) {
+      return static_cast<ast::Binary&>(*static_cast<ast::Lambda&>(*expression).body()->statements().front());
+    }
+  }
+  throw std::runtime_error("Lambda not found");
+}
+
+/// @brief  make binaries of tree use type dispatch, as before quickening
+void deoptimize_binaries(const boost::local_shared_ptr<ast::Object>& node) noexcept(false) {
+  if (!node) {
+    return;
+  }
+  switch (node->ast_type()) {
+    case ast::type_t::BINARY: {
+      auto& binary = static_cast<ast::Binary&>(*node);
+      binary.deoptimize();
+      deoptimize_binaries(binary.lhs());
+      deoptimize_binaries(binary.rhs());
+      break;
+    }
+    case ast::type_t::BLOCK: {
+      for (const auto& statement : static_cast<ast::Block&>(*node).statements()) {
+        deoptimize_binaries(statement);
+      }
+      break;
+    }
+    case ast::type_t::FOR: {
+      const auto& for_ = static_cast<ast::For&>(*node);
+      deoptimize_binaries(for_.loop_init());
+      deoptimize_binaries(for_.exit_condition());
+      deoptimize_binaries(for_.increment());
+      deoptimize_binaries(for_.body());
+      break;
+    }
+    case ast::type_t::WHILE: {
+      const auto& while_ = static_cast<ast::While&>(*node);
+      deoptimize_binaries(while_.exit_condition());
+      deoptimize_binaries(while_.body());
+      break;
+    }
+    case ast::type_t::LAMBDA: {
+      deoptimize_binaries(static_cast<ast::Lambda&>(*node).body());
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+}
+
+}// namespace eval_detail
+
+void eval_quickening_tests() {
+  eval_detail::run_test("lambda add(a, b) { a + b; } lambda main() { print(add(1, 2), add(1.5, 2), add(3, 4), add(1, 0.5)); }", "3 3.5 7 1.5", /*enable_optimizing=*/false);
+  eval_detail::run_test("lambda less(a, b) { a < b; } lambda main() { print(less(1, 2), less(2.5, 1.5), less(3, 1)); }", "1 0 0", /*enable_optimizing=*/false);
+  /// Result, reused by quickened binary, is never shared with variable.
+  eval_detail::run_test("lambda inc(a) { a + 1; } lambda main() { x = inc(1); y = 0; for (i = 0; i < 3; ++i) { y = inc(i); } print(x, y, inc(x)); }", "2 3 3", /*enable_optimizing=*/false);
+
+  auto program = eval_detail::create_bound_tree("lambda add(a, b) { a + b; } lambda sub(a, b) { a - b; } lambda main() { print(add(1, 2), add(3, 4), sub(5, 2), sub(1.5, 1)); }");
+  auto& add = eval_detail::first_binary(*program, "add");
+  auto& sub = eval_detail::first_binary(*program, "sub");
+  assert(add.quickening() == ast::quickening_t::UNQUICKENED);
+  eval_detail::check_output(program, "3 7 3 0.5");
+  assert(add.quickening() == ast::quickening_t::QUICKENED);
+  assert(add.guards(ast::type_t::INTEGER, ast::type_t::INTEGER) && !add.guards(ast::type_t::FLOAT, ast::type_t::INTEGER));
+  /// Guard failed on float operand.
+  assert(sub.quickening() == ast::quickening_t::GENERIC);
+}
+
+void eval_quickening_speed_tests() {
+  const std::string_view program = R"(
+    lambda sum(n) { s = n - n; for (i = n - n; i < n; ++i) { s = s + i * 3 - i; } s; }
+    lambda main() { print(sum(100000)); }
+  )";
+  std::cout << "\nQuickening speed test - loop over untyped values\n";
+  for (bool quicken : {false, true}) {
+    auto tree = eval_detail::create_bound_tree(program);
+    if (!quicken) {
+      for (const auto& expression : tree->get()) {
+        eval_detail::deoptimize_binaries(expression);
+      }
+    }
+    speed_benchmark(quicken ? "quickened" : "generic", 1, [evaluator = Evaluator(tree)]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_integer_overflow_tests() {
+  /// Integers are exact in 64 bits.
+  eval_detail::run_test("lambda main() { print(4294967296 * 4, 9223372036854775807); }", "17179869184 9223372036854775807");
+  eval_detail::run_test("lambda main() { a = 0 - 7; print(a, a / 2, a % 2, a >> 1); }", "-7 -3 -1 -4");
+  /// Overflow promotes to bignum, and result, that fits again, is demoted.
+  eval_detail::run_test("lambda main() { print(9223372036854775807 + 1, 1 << 64); }", "9223372036854775808 18446744073709551616");
+  eval_detail::run_test("lambda main() { a = 3037000500; print(a * a); }", "9223372037000250000");
+  eval_detail::run_test("lambda main() { a = 123456789012345678901234567890; print(a, a - 123456789012345678901234567889); }", "123456789012345678901234567890 1");
+  eval_detail::run_test("lambda main() { x = 9223372036854775807; x += 1; print(x, \"\"); x -= 1; print(x, \"\"); ++x; print(x, \"\"); --x; print(x); }", "9223372036854775808 9223372036854775807 9223372036854775808 9223372036854775807");
+  eval_detail::run_test("lambda fact(n) { r = 1; for (i = 1; i <= n; ++i) { r *= i; } r; } lambda main() { print(fact(25)); }", "15511210043330985984000000");
+  eval_detail::run_test("lambda main() { a = 1 << 100; b = 1 << 40; print(a / (b + 1), a % (b + 1), a >> 98); }", "1152921504605798400 1048576 4");
+  eval_detail::run_test("lambda main() { a = 0 - (1 << 100); print(a / 3, a % 3, a >> 1); }", "-422550200076076467165567735125 -1 -633825300114114700748351602688");
+  eval_detail::run_test("lambda main() { a = 1 << 70; print(a | 1, a & 3, a ^ a, a > 5, 5 > a, a == a, a * 0.5); }", "1180591620717411303425 0 0 1 0 1 5.90296e+20");
+  eval_detail::run_test("lambda main() { a = 1 << 70; n = 0; if (a) { while (a) { a = a >> 1; ++n; } } print(n); }", "71");
+  /// Min of 64 bits is small, though it's the value of bignum in evaluator.
+  eval_detail::run_test("lambda main() { a = 0 - 9223372036854775807; m = a - 1; print(m, m - 1, m + 1, m / (0 - 1), \"\"); s = m + 0; s += 1; ++m; print(m, s); }", "-9223372036854775808 -9223372036854775809 -9223372036854775807 9223372036854775808 -9223372036854775807 -9223372036854775807");
+  eval_detail::run_test("lambda main() { a = 1 << 64; b = a + 0; b -= a; c = 0; c += a; print(b, c + a, a + c); }", "0 36893488147419103232 36893488147419103232");
+  /// Quickened binary falls back to bignum without deoptimization.
+  eval_detail::run_test("lambda mul(a, b) { a * b; } lambda main() { print(mul(3, 4), mul(4294967296, 4294967296), mul(5, 6)); }", "12 18446744073709551616 30", /*enable_optimizing=*/false);
+  eval_detail::expect_error("lambda main() { a = 0; print(1 / a); }");
+  eval_detail::expect_error("lambda main() { a = 1 << 100; print(a % 0); }");
+  eval_detail::expect_error("lambda main() { a = 0 - 1; print(1 << a); }");
+}
+
+void eval_integer_overflow_speed_tests() {
+  const std::pair<std::string_view, std::string_view> programs[] = {
+      {"small hash", R"(
+        lambda main() { h = 7; for (i = 0; i < 200000; ++i) { h *= 31; h += i; h = h % 1000000007; } print(h); }
+      )"},
+      {"mixed factorial", R"(
+        lambda fact(n) { r = 1 + n - n; for (i = 1 + n - n; i <= n; ++i) { r *= i; } r; }
+        lambda main() { s = 0; for (k = 0; k < 2000; ++k) { s = fact(40); } print(s); }
+      )"},
+  };
+  std::cout << "\nInteger overflow speed test - 64-bit and bignum arithmetic\n";
+  for (const auto& [label, program] : programs) {
+    eval_detail::speed_test(label, program);
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_memoization_speed_tests() {
+  const std::string_view program = R"(
+    lambda fib(n) { r = n + 0; if (n > 1) { a = fib(n - 1); r = a + fib(n - 2); } r; }
+    lambda main() { print(fib(22)); }
+  )";
+  std::cout << "\nMemoization speed test - recursive fib(22)\n";
+  for (bool memoize : {false, true}) {
+    Evaluator evaluator = eval_detail::create_eval_context(program);
+    if (memoize) {
+      evaluator.enable_memoization();
+    }
+    speed_benchmark(memoize ? "memoized" : "plain", 1, [&evaluator]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
+void eval_type_inference_speed_tests() {
+  const std::string_view program = R"(
+    lambda main() {
+      sum = 0;
+      for (i = 0; i < 200000; ++i) {
+        if (i % 3) { sum = sum + 1 + i * 2; }
+      }
+      print(sum);
+    }
+  )";
+  std::cout << "\nType inference speed test - integer loop\n";
+  for (bool annotate : {false, true}) {
+    Lexer lexer(std::istringstream{program.data()});
+    Parser parser(lexer.tokenize());
+    auto parsed_program = parser.parse();
+    if (annotate) {
+      SemanticAnalyzer semantic_analyzer(parsed_program);
+      semantic_analyzer.analyze();
+    }
+    speed_benchmark(annotate ? "annotated" : "generic", 1, [evaluator = Evaluator(parsed_program)]() mutable {
+      evaluator.eval();
+    });
+  }
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    stream->str("");
+  }
+}
+
 void run_eval_tests() {
   std::cout << "Running eval tests...\n====\n";
 
@@ -348,7 +1165,33 @@ void run_eval_tests() {
   eval_user_types_tests();
   eval_compound_tests();
   eval_optimizer_reduce_tests();
+  eval_optimizer_folding_tests();
+  eval_optimizer_dead_code_tests();
+  eval_inlining_tests();
+  eval_inlining_speed_tests();
+  eval_optimizer_pipeline_tests();
+  eval_loop_invariant_tests();
+  eval_loop_invariant_speed_tests();
+  eval_strength_reduction_tests();
+  eval_strength_reduction_speed_tests();
+  eval_common_subexpression_tests();
+  eval_common_subexpression_speed_tests();
+  eval_loop_unrolling_tests();
+  eval_loop_unrolling_speed_tests();
   eval_fuzz_tests();
+  eval_lazy_bodies_tests();
+  eval_lazy_bodies_speed_tests();
+  eval_type_inference_tests();
+  eval_type_inference_speed_tests();
+  eval_binding_tests();
+  eval_binding_speed_tests();
+  eval_memoization_tests();
+  eval_memoization_speed_tests();
+  eval_tiering_tests();
+  eval_quickening_tests();
+  eval_quickening_speed_tests();
+  eval_integer_overflow_tests();
+  eval_integer_overflow_speed_tests();
 
   std::cout << "Eval tests passed successfully\n";
 }
@@ -0,0 +1,205 @@
+#ifndef WEAK_TESTS_FLAT_TREE_HPP
+#define WEAK_TESTS_FLAT_TREE_HPP
+
+#include "../ast/flat_tree.hpp"
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../semantic/semantic_analyzer.hpp"
+#include "../tests/test_utility.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <sstream>
+
+namespace flat_tree_detail {
+
+boost::local_shared_ptr<ast::RootObject> parse(std::string_view program) {
+  Lexer lexer(std::istringstream{std::string(program)});
+  Parser parser(lexer.tokenize());
+  return parser.parse();
+}
+
+const std::string_view all_nodes_program =
+    "define-type structure(a, b, c);"
+    "lambda f(x, y) {"
+    "  if (x < y) { x * 2 + 1.5; } else { \"str\\ning\"; }"
+    "  if (!x) { [1, 2, [x, y]]; }"
+    "  while (x > 0) { --x; x -= 1; }"
+    "  for (i = 0; i < 10; ++i) { print(i); }"
+    "  for (;;) {}"
+    "  obj = new structure(1, 2, 3);"
+    "  obj.a;"
+    "}"
+    "lambda main() { f(1, 2); }";
+
+/// @return number of nodes, reached by pointers
+size_t count_nodes(const boost::local_shared_ptr<ast::Object>& node) {
+  if (!node) {
+    return 0;
+  }
+  size_t count = 1;
+  auto count_all = [&count](const auto& nodes) {
+    for (const auto& child : nodes) {
+      count += count_nodes(child);
+    }
+  };
+  // clang-format off
+  switch (node->ast_type()) {
+    case ast::type_t::ARRAY: { count_all(boost::static_pointer_cast<ast::Array>(node)->elements()); break; }
+    case ast::type_t::BLOCK: { count_all(boost::static_pointer_cast<ast::Block>(node)->statements()); break; }
+    case ast::type_t::UNARY: { count += count_nodes(boost::static_pointer_cast<ast::Unary>(node)->operand()); break; }
+    case ast::type_t::LAMBDA_CALL: { count_all(boost::static_pointer_cast<ast::LambdaCall>(node)->arguments()); break; }
+    // clang-format on
+    case ast::type_t::BINARY: {
+      auto binary = boost::static_pointer_cast<ast::Binary>(node);
+      count += count_nodes(binary->lhs()) + count_nodes(binary->rhs());
+      break;
+    }
+    case ast::type_t::IF: {
+      auto if_ = boost::static_pointer_cast<ast::If>(node);
+      count += count_nodes(if_->condition()) + count_nodes(if_->body()) + count_nodes(if_->else_body());
+      break;
+    }
+    case ast::type_t::LAMBDA: {
+      auto lambda = boost::static_pointer_cast<ast::Lambda>(node);
+      count_all(lambda->arguments());
+      count += count_nodes(lambda->body());
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+  return count;
+}
+
+}// namespace flat_tree_detail
+
+void flat_tree_layout_tests() {
+  using namespace flat_tree_detail;
+
+  const auto tree = ast::FlatTree::flatten(*parse("lambda f(x) { if (x) { x + 1; } }"));
+  /// lambda, x, block, if, x, block, binary, x, 1, null else
+  assert(tree.size() == 10);
+  assert(tree.kind(0) == ast::type_t::LAMBDA && tree.string(0) == "f");
+  assert(tree.end(0) == tree.size());
+  assert(tree.children_count(0) == 2);
+  assert(tree.kind(tree.child(0, 1)) == ast::type_t::BLOCK);
+
+  const auto if_ = tree.child(tree.child(0, 1), 0);
+  assert(tree.kind(if_) == ast::type_t::IF && tree.children_count(if_) == 3);
+  assert(tree.is_null(tree.child(if_, 2)));
+
+  const auto binary = tree.child(tree.child(if_, 1), 0);
+  assert(tree.kind(binary) == ast::type_t::BINARY && tree.op(binary) == token_t::PLUS);
+  assert(tree.string(tree.child(binary, 0)) == "x");
+  assert(tree.integer(tree.child(binary, 1)) == 1);
+
+  const auto field = ast::FlatTree::flatten(*parse("lambda f() { obj.a; }"));
+  assert(field.string(2, 0) == "obj" && field.string(2, 1) == "a");
+
+  /// Integer, that doesn't fit into 64 bits, is kept as decimal.
+  const auto big = ast::FlatTree::flatten(*parse("lambda f() { 123456789012345678901234567890 + 1; }"));
+  const auto sum = big.child(big.child(0, 0), 0);
+  assert(big.is_big_integer(big.child(sum, 0)) && big.string(big.child(sum, 0)) == "123456789012345678901234567890");
+  assert(!big.is_big_integer(big.child(sum, 1)) && big.integer(big.child(sum, 1)) == 1);
+  assert(ast::FlatTree::flatten(*big.materialize()) == big);
+  assert(ast::FlatTree::from_image(big.image()) == big);
+}
+
+void flat_tree_round_trip_tests() {
+  using namespace flat_tree_detail;
+
+  const auto program = parse(all_nodes_program);
+  const auto tree = ast::FlatTree::flatten(*program);
+  assert(ast::FlatTree::flatten(*tree.materialize()) == tree);
+
+  const std::string image = tree.image();
+  assert(ast::FlatTree::from_image(image) == tree);
+  assert(ast::FlatTree::from_image(ast::FlatTree().image()).size() == 0);
+
+  /// Image is copied by memcpy into arrays, so any buffer works.
+  std::vector<char> copy(image.size());
+  std::memcpy(copy.data(), image.data(), image.size());
+  assert(ast::FlatTree::from_image(std::string_view(copy.data(), copy.size())) == tree);
+
+  for (size_t size = 0; size < image.size(); ++size) {
+    try {
+      ast::FlatTree::from_image(std::string_view(image).substr(0, size));
+      assert(false && "Truncated image accepted");
+    } catch (std::runtime_error&) {}
+  }
+
+  /// Damaged structure is detected, not read out of bounds.
+  std::string damaged = image;
+  for (size_t i = 40; i < damaged.size(); ++i) {
+    damaged[i] = static_cast<char>(~damaged[i]);
+    try {
+      const auto damaged_tree = ast::FlatTree::from_image(damaged);
+      damaged_tree.materialize();
+    } catch (std::runtime_error&) {}
+    damaged[i] = image[i];
+  }
+}
+
+void flat_tree_analyzer_tests() {
+  using namespace flat_tree_detail;
+
+  auto analyze = [](std::string_view program) {
+    SemanticAnalyzer analyzer(ast::FlatTree::from_image(ast::FlatTree::flatten(*parse(program)).image()));
+    analyzer.analyze();
+  };
+  analyze(all_nodes_program);
+  trace_error("if (1) { 1 ++ 2; }", [&analyze] {
+    analyze("if (1) { 1 ++ 2; }");
+    assert(false && "Error expected");
+  });
+}
+
+void flat_tree_speed_tests() {
+  using namespace flat_tree_detail;
+
+  std::string contents;
+  for (size_t i = 0; i < 5000; ++i) {
+    contents += "lambda f" + std::to_string(i) + "(a, b) { if (a < b) { a * 2 + b; } else { print(\"string\", [a, b]); } }\n";
+  }
+  const auto program = parse(contents);
+  const auto tree = ast::FlatTree::flatten(*program);
+
+  std::cout << "\nFlat tree speed test - " << tree.size() << " nodes\n";
+  size_t pointer_nodes = 0;
+  speed_benchmark("pointer tree walk", 100, [&] {
+    pointer_nodes = 0;
+    for (const auto& node : program->get()) {
+      pointer_nodes += count_nodes(node);
+    }
+  });
+  size_t flat_nodes = 0;
+  speed_benchmark("flat tree scan", 100, [&] {
+    flat_nodes = 0;
+    for (ast::FlatTree::index_t node = 0; node < tree.size(); ++node) {
+      flat_nodes += !tree.is_null(node);
+    }
+  });
+  assert(pointer_nodes == flat_nodes);
+  speed_benchmark("semantic analysis", 10, [&] {
+    SemanticAnalyzer analyzer(tree);
+    analyzer.analyze();
+  });
+  speed_benchmark("image load", 10, [image = tree.image()] {
+    ast::FlatTree::from_image(image);
+  });
+}
+
+void run_flat_tree_tests() {
+  std::cout << "Running flat tree tests...\n====\n";
+
+  flat_tree_layout_tests();
+  flat_tree_round_trip_tests();
+  flat_tree_analyzer_tests();
+  flat_tree_speed_tests();
+
+  std::cout << "Flat tree tests passed successfully\n";
+}
+
+#endif// WEAK_TESTS_FLAT_TREE_HPP
@@ -0,0 +1,24 @@
+#ifndef WEAK_TEST_FNV1A_HPP
+#define WEAK_TEST_FNV1A_HPP
+
+#include "../error/error.hpp"
+#include "../fnv1a.hpp"
+
+namespace fnv1a_detail {
+
+void run(std::string_view payload, uint64_t expected_hash) {
+  if (auto hash = fnv1a::create(payload); hash != expected_hash) {
+    throw RuntimeError("FNV-1a error: got {}, expected {}", hash, expected_hash);
+  }
+}
+
+}// namespace fnv1a_detail
+
+void run_fnv1a_tests() {
+  fnv1a_detail::run("", 0xCBF29CE484222325);
+  fnv1a_detail::run("a", 0xAF63DC4C8601EC8C);
+  fnv1a_detail::run("foobar", 0x85944171F73967E8);
+  static_assert(fnv1a::create("bar", fnv1a::create("foo")) == fnv1a::create("foobar"));
+}
+
+#endif// WEAK_TEST_FNV1A_HPP
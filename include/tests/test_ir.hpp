@@ -0,0 +1,263 @@
+#ifndef WEAK_TESTS_IR_HPP
+#define WEAK_TESTS_IR_HPP
+
+#include "../eval/eval.hpp"
+#include "../ir/ir.hpp"
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../semantic/semantic_analyzer.hpp"
+#include "../tests/test_utility.hpp"
+
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+
+namespace ir_detail {
+
+boost::local_shared_ptr<ast::RootObject> parse(std::string_view program) noexcept(false) {
+  Lexer lexer(std::istringstream{std::string(program)});
+  Parser parser(lexer.tokenize());
+  auto parsed_program = parser.parse();
+  SemanticAnalyzer semantic_analyzer(parsed_program);
+  semantic_analyzer.analyze();
+  SemanticAnalyzer::bind(*parsed_program);
+  return parsed_program;
+}
+
+ast::Lambda& find_lambda(ast::RootObject& program, std::string_view name) noexcept(false) {
+  for (const auto& expression : program.get()) {
+    if (expression->ast_type() == ast::type_t::LAMBDA && static_cast<ast::Lambda&>(*expression).name() == name) {
+      return static_cast<ast::Lambda&>(*expression);
+    }
+  }
+  throw std::runtime_error("Lambda not found");
+}
+
+std::string output_of(const boost::local_shared_ptr<ast::RootObject>& program) noexcept(false) {
+  Evaluator(program).eval();
+  std::string output;
+  if (auto* stream = dynamic_cast<std::ostringstream*>(&default_stdout)) {
+    output = stream->str();
+    stream->str("");
+  }
+  default_stdout.clear();
+  return output;
+}
+
+/// @return count of lambdas, replaced by statements of their verified IR
+size_t round_trip(ast::RootObject& program) noexcept(false) {
+  size_t lowered = 0;
+  for (const auto& expression : program.get()) {
+    if (expression->ast_type() != ast::type_t::LAMBDA) {
+      continue;
+    }
+    auto& lambda = static_cast<ast::Lambda&>(*expression);
+    try {
+      const auto function = ir::Function::lower(lambda);
+      function.verify();
+      function.materialize(lambda);
+      ++lowered;
+    } catch (std::runtime_error&) {}
+  }
+  return lowered;
+}
+
+/// @brief  lower all lambdas, turn them back into trees and compare output with
+///         evaluation of program as is
+void run_round_trip_test(std::string_view program, size_t lambdas) noexcept(false) {
+  std::cout << "Run IR round trip test => ";
+  const std::string expected = output_of(parse(program));
+  auto tree = parse(program);
+  if (const size_t lowered = round_trip(*tree); lowered != lambdas) {
+    std::cerr << "IR error: for " << program << "\n\tlowered " << lowered << " lambda(s), expected " << lambdas << "\n";
+    exit(-1);
+  }
+  if (const std::string output = output_of(tree); output != expected) {
+    std::cerr << "IR error: for " << program << "\n\tgot [" << output << "], expected [" << expected << "]\n";
+    exit(-1);
+  }
+  std::cout << "OK\n";
+}
+
+void expect_unlowered(std::string_view program) noexcept(false) {
+  const auto tree = parse(program);
+  try {
+    ir::Function::lower(find_lambda(*tree, "main"));
+    assert(false && "Lowering error expected");
+  } catch (std::runtime_error&) {}
+}
+
+ir::Instruction make(ir::opcode_t opcode, std::vector<ir::value_t> operands = {}, std::vector<ir::block_t> blocks = {}) noexcept(false) {
+  ir::Instruction instruction;
+  instruction.opcode = opcode;
+  instruction.operands = std::move(operands);
+  instruction.blocks = std::move(blocks);
+  return instruction;
+}
+
+void expect_rejected(const ir::Function& function) noexcept(false) {
+  try {
+    function.verify();
+    assert(false && "Verifier error expected");
+  } catch (std::runtime_error&) {}
+}
+
+}// namespace ir_detail
+
+void ir_round_trip_tests() {
+  using ir_detail::run_round_trip_test;
+  run_round_trip_test("lambda main() { x = 1; y = x + 2; print(x, y); }", 1);
+  run_round_trip_test("lambda f(x) { value = 0; if (x == 0) { value = 10; } else { value = \"s\"; } value; } lambda main() { print(f(0), f(1)); }", 2);
+  run_round_trip_test("lambda main() { i = 0; sum = 0; while (i < 10) { sum += i; ++i; } print(sum); }", 1);
+  run_round_trip_test("lambda main() { s = 0; for (i = 0; i < 5; ++i) { s = s + i * 2; } print(s); }", 1);
+  run_round_trip_test("lambda main() { n = 0; for (i = 0; i < 4; ++i) { for (j = 0; j < 3; ++j) { if (j == 1) { n += 10; } else { n += 1; } } } print(n); }", 1);
+  run_round_trip_test("lambda main() { n = 0; for (i = 0; i < 4; i = i + 1) { for (j = 0; j < 3; j = j + 1) { n = n + i * j; } } print(n); }", 1);
+  /// Values, swapped in loop, are copied in parallel.
+  run_round_trip_test("lambda main() { a = 1; b = 2; i = 0; while (i < 3) { t = a; a = b; b = t; i = i + 1; } print(a, b); }", 1);
+  run_round_trip_test("lambda g(x) { print(x); 1; } lambda main() { print(g(1), g(2)); y = g(3); print(y + g(4)); }", 2);
+  run_round_trip_test("lambda inc(x) { ++x; } lambda main() { a = 5; print(inc(a), a); }", 2);
+  run_round_trip_test("lambda main() { s = \"a\"; f = 1.5; f += 2.5; print(s, f); print(--1); }", 1);
+  run_round_trip_test("define-type pair(a, b); lambda main() { p = new pair(1, 2); print(p.a, p.b); }", 1);
+  run_round_trip_test("lambda main() { a = [1, 2]; print(a); }", 1);
+  run_round_trip_test("lambda twice(x) { x * 2; } lambda main() { f = twice; print(f(4)); }", 2);
+  run_round_trip_test("lambda next(x) { x + 1; } lambda main() { i = 0; while (5 > next(i)) { i = next(i); } print(i); }", 2);
+  run_round_trip_test("lambda main() { x = 1; x + 1; print(x); }", 1);
+  run_round_trip_test("lambda f(x) { x = 1; } lambda main() { f(2); print(3); }", 2);
+  run_round_trip_test("lambda fib(n) { result = 0; if (n < 2) { result = n; } else { a = fib(n - 1); b = fib(n - 2); result = a + b; } result; } lambda main() { print(fib(15)); }", 2);
+  run_round_trip_test("lambda main() { x = 0; y = 1; if (x) { y = 2; } print(y); }", 1);
+}
+
+void ir_unsupported_tests() {
+  using ir_detail::expect_unlowered;
+  expect_unlowered("lambda main() { lambda inner() { 1; } inner(); }");
+  expect_unlowered("lambda main() { x = 1; print([x]); }");
+  expect_unlowered("lambda main() { for (;;) {} }");
+  expect_unlowered("lambda main() { if (1) { x = 1; } print(x); }");
+  expect_unlowered("lambda main() {}");
+  expect_unlowered("lambda main() { x = 1; print(x += 1); }");
+}
+
+void ir_dump_tests() {
+  using namespace ir_detail;
+  const auto tree = parse("lambda f(x) { y = 0; if (x) { y = 1; } else { y = 2; } y; }");
+  const auto function = ir::Function::lower(find_lambda(*tree, "f"));
+  function.verify();
+  const std::string expected =
+      "function f(1)\n"
+      "block0:\n"
+      "  %0 = parameter 0 : unknown\n"
+      "  %1 = constant 0 : integer\n"
+      "  branch %0, block1, block2\n"
+      "block1: ; preds block0\n"
+      "  %2 = constant 1 : integer\n"
+      "  jump block3\n"
+      "block2: ; preds block0\n"
+      "  %3 = constant 2 : integer\n"
+      "  jump block3\n"
+      "block3: ; preds block1, block2\n"
+      "  %4 = phi [%2, block1], [%3, block2] : integer\n"
+      "  return %4\n";
+  if (function.dump() != expected) {
+    std::cerr << "IR error: got dump\n" << function.dump() << "expected\n" << expected;
+    exit(-1);
+  }
+
+  const auto loop = parse("lambda main() { s = 0; for (i = 0; i < 3; ++i) { s += i; } print(s); }");
+  const auto loop_function = ir::Function::lower(find_lambda(*loop, "main"));
+  loop_function.verify();
+  const std::string dump = loop_function.dump();
+  assert(dump.find("phi") != std::string::npos);
+  assert(dump.find("update += ") != std::string::npos);
+  assert(dump.find("unary ++ ") != std::string::npos);
+  /// Counter and sum stay integers over back edge.
+  assert(dump.find("phi [%0, block0], [%6, block2] : integer") != std::string::npos);
+  assert(dump.find("phi [%1, block0], [%7, block2] : integer") != std::string::npos);
+  const auto dominators = loop_function.dominators();
+  const auto post_dominators = loop_function.post_dominators();
+  assert(dominators[ir::Function::entry] == ir::Function::entry);
+  for (ir::block_t block = 1; block < loop_function.blocks_count(); ++block) {
+    assert(dominators[block] != ir::no_block);
+  }
+  /// Loop header is left through exit block, which returns.
+  assert(post_dominators[1] == 3);
+  assert(post_dominators[3] == ir::no_block);
+}
+
+void ir_verifier_tests() {
+  using namespace ir_detail;
+  using ir::opcode_t;
+
+  const auto literal = boost::make_local_shared<ast::Integer>(1);
+  auto constant = make(opcode_t::CONSTANT);
+  constant.type = ast::inferred_t::INTEGER;
+  constant.node = literal;
+  {
+    ir::Function function("f", 0);
+    const auto entry = function.add_block();
+    function.append(entry, constant);
+    expect_rejected(function);
+    function.append(entry, make(opcode_t::RETURN, {0}));
+    function.verify();
+  }
+  {
+    /// Constant claims type other than its literal.
+    ir::Function function("f", 0);
+    const auto entry = function.add_block();
+    auto wrong = constant;
+    wrong.type = ast::inferred_t::FLOAT;
+    function.append(entry, wrong);
+    function.append(entry, make(opcode_t::RETURN, {0}));
+    expect_rejected(function);
+  }
+  {
+    /// Value is used in block, which its definition doesn't dominate.
+    ir::Function function("f", 1);
+    const auto entry = function.add_block();
+    const auto then_block = function.add_block();
+    const auto else_block = function.add_block();
+    const auto merge = function.add_block();
+    const auto condition = function.append(entry, make(opcode_t::PARAMETER));
+    function.append(entry, make(opcode_t::BRANCH, {condition}, {then_block, else_block}));
+    const auto value = function.append(then_block, constant);
+    function.append(then_block, make(opcode_t::JUMP, {}, {merge}));
+    function.append(else_block, make(opcode_t::JUMP, {}, {merge}));
+    function.append(merge, make(opcode_t::RETURN, {value}));
+    expect_rejected(function);
+  }
+  {
+    /// Phi has operand for each predecessor.
+    ir::Function function("f", 1);
+    const auto entry = function.add_block();
+    const auto next = function.add_block();
+    const auto value = function.append(entry, constant);
+    function.append(entry, make(opcode_t::JUMP, {}, {next}));
+    const auto phi = function.add_phi(next, ast::inferred_t::INTEGER);
+    function.append(next, make(opcode_t::RETURN, {phi}));
+    expect_rejected(function);
+    function.instruction(phi).operands = {value};
+    function.instruction(phi).blocks = {entry};
+    function.verify();
+  }
+  {
+    /// Unreachable block.
+    ir::Function function("f", 0);
+    const auto entry = function.add_block();
+    const auto orphan = function.add_block();
+    function.append(entry, make(opcode_t::RETURN));
+    function.append(orphan, make(opcode_t::RETURN));
+    expect_rejected(function);
+  }
+}
+
+void run_ir_tests() {
+  std::cout << "Running IR tests...\n====\n";
+
+  ir_round_trip_tests();
+  ir_unsupported_tests();
+  ir_dump_tests();
+  ir_verifier_tests();
+
+  std::cout << "IR tests passed successfully\n";
+}
+
+#endif// WEAK_TESTS_IR_HPP
@@ -5,6 +5,7 @@
 #include "../tests/test_utility.hpp"
 
 #include <iomanip>
+#include <iterator>
 #include <random>
 #include <sstream>
 
@@ -25,6 +26,36 @@ void run_test(std::string_view data, std::vector<Token> assertion_tokens) {
   }
 }
 
+void run_parallel_test(ThreadPool& pool, std::string_view data, size_t min_chunk_size) {
+  std::string serial_error;
+  std::string parallel_error;
+  std::vector<Token> serial_tokens;
+  std::vector<Token> parallel_tokens;
+  try {
+    Lexer lexer(std::istringstream{data.data()});
+    serial_tokens = lexer.tokenize();
+  } catch (LexicalError& lexical_error) {
+    serial_error = lexical_error.what();
+  }
+  try {
+    Lexer lexer(std::istringstream{data.data()});
+    parallel_tokens = lexer.tokenize_parallel(pool, min_chunk_size);
+  } catch (LexicalError& lexical_error) {
+    parallel_error = lexical_error.what();
+  }
+  if (serial_error != parallel_error) {
+    throw LexicalError("parallel lexer: got error [" + parallel_error + "], expected [" + serial_error + "]");
+  }
+  if (serial_tokens.size() != parallel_tokens.size()) {
+    throw LexicalError("parallel lexer: got " + std::to_string(parallel_tokens.size()) + " tokens, expected " + std::to_string(serial_tokens.size()));
+  }
+  for (size_t i = 0; i < serial_tokens.size(); i++) {
+    if (serial_tokens[i].type != parallel_tokens[i].type || serial_tokens[i].data != parallel_tokens[i].data) {
+      throw LexicalError("parallel lexer: token " + std::to_string(i) + " mismatch, " + parallel_tokens[i].data + " got, but " + serial_tokens[i].data + " required");
+    }
+  }
+}
+
 void assert_exception(std::string_view data) {
   trace_error(data, [&data] {
     Lexer lexer(std::istringstream{data.data()});
@@ -246,6 +277,64 @@ void lexer_speed_tests() {
   });
 }
 
+void lexer_parallel_tests() {
+  ThreadPool pool(4);
+  std::mt19937 gen(1337);
+  const std::vector<std::string> parts{
+      "lambda f(a, b) { a += b; }",
+      " \"string with spaces\" ",
+      "\"\\\" escaped quote and \\\\ backslash \"",
+      "\"\"",
+      "\"\\\"",
+      "\"  \" \"\\\"\\\"\"",
+      "1.25 + 333 <<= >>= ++-- ",
+      "\n\t\r\f\v",
+      "   ",
+      "\"\n multiline \n string \n\"",
+      "symbol_with-dash? ",
+      "new point(1, 2);"};
+  std::uniform_int_distribution<size_t> distrib(0, parts.size() - 1);
+  for (size_t test = 0; test < 50; ++test) {
+    std::string data;
+    for (size_t i = 0; i < 200; ++i) {
+      data += parts[distrib(gen)];
+    }
+    for (size_t min_chunk_size : {1, 7, 64, 1000}) {
+      lexer_detail::run_parallel_test(pool, data, min_chunk_size);
+    }
+    /// Errors must be the same as serial lexer finds first.
+    lexer_detail::run_parallel_test(pool, data + " @ " + data + " 1..2 ", 16);
+    lexer_detail::run_parallel_test(pool, data + " \"without closing quote", 16);
+    lexer_detail::run_parallel_test(pool, data + " \"\\", 16);
+  }
+}
+
+void lexer_parallel_speed_tests() {
+  std::string data =
+      "lambda f(a, b, c) {"
+      "  if (a == b) {"
+      "    variable_0 = 123.456 + c;"
+      "  } else {"
+      "    literal_1 = \"Lorem ipsum dolor sit amet\";"
+      "  }"
+      "}\n";
+
+  for (size_t i = 0; i < 14; i++)
+    data += data;
+
+  ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2U));
+
+  std::cout << "\nLexer parallel speed test - input size (" << data.size() / 1024.0 / 1024.0 << " MiB.), " << pool.size() << " thread(s)\n";
+  speed_benchmark("serial", 1, [&data] {
+    Lexer lexer(std::istringstream{data.data()});
+    const std::vector<Token> tokens = lexer.tokenize();
+  });
+  speed_benchmark("parallel", 1, [&data, &pool] {
+    Lexer lexer(std::istringstream{data.data()});
+    const std::vector<Token> tokens = lexer.tokenize_parallel(pool);
+  });
+}
+
 void run_lexer_tests() {
   std::cout << "Running lexer tests...\n====\n";
 
@@ -255,7 +344,9 @@ void run_lexer_tests() {
   lexer_operator_tests();
   lexer_expression_tests();
   lexer_fuzz_tests();
+  lexer_parallel_tests();
   lexer_speed_tests();
+  lexer_parallel_speed_tests();
 
   std::cout << "Lexer tests passed successfully\n";
 }
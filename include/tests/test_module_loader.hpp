@@ -0,0 +1,211 @@
+#ifndef WEAK_TESTS_MODULE_LOADER_HPP
+#define WEAK_TESTS_MODULE_LOADER_HPP
+
+#include "../lexer/module_loader.hpp"
+#include "../parser/module_parser.hpp"
+#include "../parser/parser.hpp"
+#include "../tests/test_utility.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+
+namespace module_loader_detail {
+
+const std::filesystem::path& test_directory() {
+  static const std::filesystem::path directory = std::filesystem::temp_directory_path() / "weak_module_loader_tests";
+  return directory;
+}
+
+std::string write_file(const std::filesystem::path& relative, std::string_view contents) {
+  const std::filesystem::path path = test_directory() / relative;
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path) << contents;
+  return std::filesystem::weakly_canonical(path).string();
+}
+
+size_t index_of(const ModuleLoader& loader, const std::string& path) {
+  const auto& modules = loader.modules();
+  for (size_t i = 0; i < modules.size(); ++i) {
+    if (modules[i].path == path) {
+      return i;
+    }
+  }
+  assert(false && "Module not loaded");
+  return modules.size();
+}
+
+void assert_load_error(const std::string& path, std::string_view expected_message) {
+  ModuleLoader loader;
+  try {
+    loader.load(path);
+  } catch (LoadError& load_error) {
+    if (std::string_view(load_error.what()).find(expected_message) == std::string_view::npos) {
+      throw LoadError("module loader: got error [" + std::string(load_error.what()) + "], expected [" + std::string(expected_message) + "]");
+    }
+    return;
+  }
+  assert(false && "Error expected");
+}
+
+std::vector<std::string> declaration_names(const boost::local_shared_ptr<ast::RootObject>& root) {
+  std::vector<std::string> names;
+  for (const auto& declaration : root->get()) {
+    if (auto lambda = boost::dynamic_pointer_cast<ast::Lambda>(declaration)) {
+      names.push_back(lambda->name());
+    } else {
+      names.push_back(boost::static_pointer_cast<ast::TypeDefinition>(declaration)->name());
+    }
+  }
+  return names;
+}
+
+template <typename Error>
+void assert_parse_error(ThreadPool* pool, const std::string& path) {
+  ModuleLoader loader(pool);
+  loader.load(path);
+  try {
+    parse_modules(loader.take_modules(), pool);
+  } catch (Error&) {
+    return;
+  }
+  assert(false && "Error expected");
+}
+
+}// namespace module_loader_detail
+
+void module_loader_diamond_tests() {
+  using namespace module_loader_detail;
+
+  const std::string d = write_file("diamond/d.wl", "lambda d() { 4; }");
+  const std::string b = write_file("diamond/lib/b.wl", "load \"../d.wl\"; lambda b() { 2; }");
+  const std::string c = write_file("diamond/c.wl", "load \"d.wl\";\nlambda c() { 3; }");
+  const std::string main = write_file("diamond/main.wl", "load \"lib/b.wl\"; load \"c.wl\"; lambda main() { b(); c(); }");
+
+  ModuleLoader loader;
+  loader.load(main);
+  /// Already loaded files are skipped.
+  loader.load(d);
+
+  const auto& modules = loader.modules();
+  assert(modules.size() == 4);
+  assert(modules.back().path == main);
+  assert(index_of(loader, d) < index_of(loader, b));
+  assert(index_of(loader, d) < index_of(loader, c));
+  assert(modules[index_of(loader, b)].dependencies == std::vector<size_t>{index_of(loader, d)});
+  assert(modules[index_of(loader, c)].dependencies == std::vector<size_t>{index_of(loader, d)});
+  assert((modules.back().dependencies == std::vector<size_t>{index_of(loader, b), index_of(loader, c)}));
+
+  const std::vector<Token> tokens = loader.take_tokens();
+  assert(loader.modules().empty());
+  assert(tokens.back().type == token_t::END_OF_DATA);
+  size_t lambdas = 0;
+  for (const Token& token : tokens) {
+    assert(token.type != token_t::LOAD);
+    lambdas += token.type == token_t::LAMBDA;
+  }
+  assert(lambdas == 4);
+}
+
+void module_loader_error_tests() {
+  using namespace module_loader_detail;
+
+  const std::string a = write_file("cycle/a.wl", "load \"b.wl\";");
+  write_file("cycle/b.wl", "load \"c.wl\";");
+  write_file("cycle/c.wl", "load \"b.wl\";");
+  assert_load_error(a, "Cyclic load: ");
+  assert_load_error(a, "b.wl -> ");
+
+  const std::string self = write_file("cycle/self.wl", "load \"self.wl\";");
+  assert_load_error(self, "Cyclic load: ");
+
+  const std::string missing = write_file("missing/main.wl", "load \"missing.wl\";");
+  assert_load_error(missing, "Cannot open file: ");
+  assert_load_error((test_directory() / "missing/not_exists.wl").string(), "Cannot open file: ");
+
+  const std::string malformed = write_file("malformed/main.wl", "load file;");
+  assert_load_error(malformed, "expected `load \"filename\";`");
+  const std::string unfinished = write_file("malformed/unfinished.wl", "load \"main.wl\"");
+  assert_load_error(unfinished, "expected `load \"filename\";`");
+}
+
+void module_parser_tests() {
+  using namespace module_loader_detail;
+
+  constexpr size_t modules_count = 40;
+  std::string main_contents;
+  for (size_t i = 0; i < modules_count; ++i) {
+    std::string contents;
+    if (i > 0) {
+      contents += "load \"" + std::to_string(i / 2) + ".wl\";\n";
+    }
+    contents += "define-type t" + std::to_string(i) + "(a, b);\n";
+    contents += "lambda f" + std::to_string(i) + "(a) { if (a < " + std::to_string(i) + ") { a * 2; } }\n";
+    contents += "lambda g" + std::to_string(i) + "() { for (i = 0; i < 10; ++i) { println(i); } }\n";
+    write_file("parse/" + std::to_string(i) + ".wl", contents);
+    main_contents += "load \"" + std::to_string(modules_count - i - 1) + ".wl\";\n";
+  }
+  const std::string main = write_file("parse/main.wl", main_contents + "lambda main() { f0(1); }");
+
+  ModuleLoader serial_loader;
+  serial_loader.load(main);
+  Parser parser(serial_loader.take_tokens());
+  const std::vector<std::string> expected_names = declaration_names(parser.parse());
+  assert(expected_names.size() == modules_count * 3 + 1);
+
+  ThreadPool pool(4);
+  for (ThreadPool* used_pool : {static_cast<ThreadPool*>(nullptr), &pool}) {
+    ModuleLoader loader(used_pool);
+    loader.load(main);
+    assert(declaration_names(parse_modules(loader.take_modules(), used_pool)) == expected_names);
+
+    write_file("parse_errors/ok.wl", "lambda ok() {}");
+    assert_parse_error<ParseError>(used_pool, write_file("parse_errors/parse.wl", "load \"ok.wl\"; lambda f( {}"));
+    assert_parse_error<SemanticError>(used_pool, write_file("parse_errors/semantic.wl", "load \"ok.wl\"; lambda f() { 1 = 2; }"));
+    assert_parse_error<SemanticError>(used_pool, write_file("parse_errors/top_level.wl", "load \"ok.wl\"; 1 + 2;"));
+  }
+}
+
+void module_loader_speed_tests() {
+  using namespace module_loader_detail;
+
+  /// Each file loads two next ones, so every file is requested twice.
+  constexpr size_t files_count = 2000;
+  std::string root;
+  for (size_t i = 0; i < files_count; ++i) {
+    std::string contents = "lambda f" + std::to_string(i) + "() { " + std::to_string(i) + "; }\n";
+    if (i + 1 < files_count) {
+      contents += "load \"" + std::to_string(i + 1) + ".wl\";\n";
+    }
+    if (i + 2 < files_count) {
+      contents += "load \"" + std::to_string(i + 2) + ".wl\";\n";
+    }
+    std::string path = write_file("chain/" + std::to_string(i) + ".wl", contents);
+    if (i == 0) {
+      root = path;
+    }
+  }
+
+  std::cout << "\nModule loader speed test - chain of " << files_count << " files\n";
+  speed_benchmark("load", 1, [&root] {
+    ModuleLoader loader;
+    loader.load(root);
+    assert(loader.modules().size() == files_count);
+    assert(loader.take_tokens().size() == files_count * 8 + 1);
+  });
+}
+
+void run_module_loader_tests() {
+  std::cout << "Running module loader tests...\n====\n";
+
+  std::filesystem::remove_all(module_loader_detail::test_directory());
+  module_loader_diamond_tests();
+  module_loader_error_tests();
+  module_parser_tests();
+  module_loader_speed_tests();
+  std::filesystem::remove_all(module_loader_detail::test_directory());
+
+  std::cout << "Module loader tests passed successfully\n";
+}
+
+#endif// WEAK_TESTS_MODULE_LOADER_HPP
@@ -0,0 +1,187 @@
+#ifndef WEAK_TESTS_PARSER_HPP
+#define WEAK_TESTS_PARSER_HPP
+
+#include "../ast/flat_tree.hpp"
+#include "../lexer/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../tests/test_utility.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+namespace parser_detail {
+
+std::vector<Token> tokenize(std::string_view program) {
+  Lexer lexer(std::istringstream{std::string(program)});
+  return lexer.tokenize();
+}
+
+void assert_parse_error(std::string_view program, std::string_view expected_message) {
+  try {
+    Parser parser(tokenize(program));
+    parser.parse();
+  } catch (ParseError& parse_error) {
+    if (std::string_view(parse_error.what()).find(expected_message) == std::string_view::npos) {
+      throw ParseError("parser: got error [" + std::string(parse_error.what()) + "], expected [" + std::string(expected_message) + "]");
+    }
+    return;
+  }
+  assert(false && "Error expected");
+}
+
+}// namespace parser_detail
+
+void token_set_tests() {
+  constexpr TokenSet set{token_t::COMMA, token_t::RIGHT_PAREN, token_t::END_OF_DATA};
+  static_assert(set.contains(token_t::COMMA));
+  static_assert(set.contains(token_t::RIGHT_PAREN));
+  static_assert(set.contains(token_t::END_OF_DATA));
+  static_assert(!set.contains(token_t::DOT));
+  static_assert(!set.contains(token_t::SEMICOLON));
+  static_assert(!TokenSet{}.contains(token_t::DOT));
+  assert(set.to_string() == ", or ) or <EOF>");
+}
+
+void parser_error_tests() {
+  parser_detail::assert_parse_error("lambda f(a b) {}", ", or ) expected, got <symbol>");
+  parser_detail::assert_parse_error("lambda f() { while (x) 1; }", "{ expected, got <number>");
+  parser_detail::assert_parse_error("lambda () {}", "<symbol> expected, got (");
+  parser_detail::assert_parse_error("x = [1, 2;", ", or ] expected, got ;");
+}
+
+void parallel_parser_tests() {
+  ThreadPool pool(4);
+  auto assert_same_tree = [&pool](std::string_view input) {
+    Parser serial(parser_detail::tokenize(input));
+    Parser parallel(parser_detail::tokenize(input));
+    if (ast::FlatTree::flatten(*serial.parse()) != ast::FlatTree::flatten(*parallel.parse_parallel(pool, 8))) {
+      throw ParseError("parser: parallel tree differs for " + std::string(input));
+    }
+  };
+
+  std::string program;
+  for (size_t i = 0; i < 200; ++i) {
+    program += "define-type t" + std::to_string(i) + "(a, b);";
+    program += "lambda f" + std::to_string(i) + "(a) { if (a) { a; } else { [a, 1]; } while (a) { --a; } }";
+    program += "lambda g" + std::to_string(i) + "() {}";
+  }
+  assert_same_tree(program);
+  assert_same_tree("");
+  assert_same_tree("lambda f() {}");
+  /// Not only declarations at top level, parsed serially.
+  assert_same_tree(program + "1 + 2;" + program);
+
+  /// Error is the same as serial parser reports.
+  auto assert_same_error = [&pool](std::string_view input) {
+    std::string serial_error;
+    std::string parallel_error;
+    try {
+      Parser parser(parser_detail::tokenize(input));
+      parser.parse();
+    } catch (ParseError& error) {
+      serial_error = error.what();
+    }
+    try {
+      Parser parser(parser_detail::tokenize(input));
+      parser.parse_parallel(pool, 8);
+    } catch (ParseError& error) {
+      parallel_error = error.what();
+    }
+    assert(!serial_error.empty() && serial_error == parallel_error);
+  };
+  assert_same_error(program + "lambda f() { while (x) 1; }" + program + "lambda g(1) {}");
+  assert_same_error(program + "lambda f() { { }");
+  assert_same_error(program + "define-type t(1);" + program);
+  assert_same_error(program + "lambda h() {} + 1;");
+}
+
+void lazy_parser_tests() {
+  std::string program;
+  for (size_t i = 0; i < 100; ++i) {
+    program += "define-type t" + std::to_string(i) + "(a, b);";
+    program += "lambda f" + std::to_string(i) + "(a, b) { if (a) { while (a) { --a; } } else { [a, b]; } }";
+  }
+  Parser eager(parser_detail::tokenize(program));
+  const auto expected = ast::FlatTree::flatten(*eager.parse());
+
+  ThreadPool pool(4);
+  for (bool parallel : {false, true}) {
+    Parser lazy(parser_detail::tokenize(program), /*lazy_bodies=*/true);
+    auto tree = parallel ? lazy.parse_parallel(pool, 8) : lazy.parse();
+    for (const auto& statement : tree->get()) {
+      if (statement->ast_type() == ast::type_t::LAMBDA) {
+        auto lambda = boost::static_pointer_cast<ast::Lambda>(statement);
+        assert(lambda->is_lazy());
+        lambda->set_body(lambda->parse_body());
+        assert(!lambda->is_lazy());
+      }
+    }
+    assert(ast::FlatTree::flatten(*tree) == expected);
+  }
+
+  /// Unbalanced body is parsed eagerly to report the error.
+  try {
+    Parser lazy(parser_detail::tokenize("lambda f() { { }"), /*lazy_bodies=*/true);
+    lazy.parse();
+    assert(false && "Error expected");
+  } catch (ParseError&) {}
+}
+
+void parser_speed_tests() {
+  std::string program;
+  for (size_t i = 0; i < 20000; ++i) {
+    program += "lambda f" + std::to_string(i) + "(a, b, c) {"
+               "  if (a < b) { x = a * 2 + b; } else { x = [a, b, c]; }"
+               "  for (i = 0; i < 10; ++i) { print(i, x, \"text\"); }"
+               "  while (c > 0) { --c; }"
+               "}\n";
+  }
+  const std::vector<Token> tokens = parser_detail::tokenize(program);
+  std::vector<Token> input = tokens;
+
+  std::cout << "\nParser speed test - " << tokens.size() << " tokens\n";
+  auto start = std::chrono::high_resolution_clock::now();
+  Parser parser(std::move(input));
+  parser.parse();
+  const auto time_spent = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::high_resolution_clock::now() - start).count();
+  std::cout << std::setw(60) << "parse" << "\t: " << time_spent << " s. (" << static_cast<uint64_t>(tokens.size() / time_spent) << " tokens/s.)" << std::endl;
+}
+
+void parallel_parser_speed_tests() {
+  std::string program;
+  for (size_t i = 0; i < 10000; ++i) {
+    program += "lambda f" + std::to_string(i) + "(a, b, c) {"
+               "  if (a < b) { x = a * 2 + b; } else { x = [a, b, c]; }"
+               "  for (i = 0; i < 10; ++i) { print(i, x, \"text\"); }"
+               "}\n";
+  }
+  const std::vector<Token> tokens = parser_detail::tokenize(program);
+  ThreadPool pool(std::max(2U, std::thread::hardware_concurrency()));
+
+  std::cout << "\nParallel parser speed test - 10000 functions, " << pool.size() << " workers\n";
+  speed_benchmark("serial parse", 1, [&tokens] {
+    Parser parser(tokens);
+    parser.parse();
+  });
+  speed_benchmark("parallel parse", 1, [&tokens, &pool] {
+    Parser parser(tokens);
+    parser.parse_parallel(pool);
+  });
+}
+
+void run_parser_tests() {
+  std::cout << "Running parser tests...\n====\n";
+
+  token_set_tests();
+  parser_error_tests();
+  parallel_parser_tests();
+  lazy_parser_tests();
+  parser_speed_tests();
+  parallel_parser_speed_tests();
+
+  std::cout << "Parser tests passed successfully\n";
+}
+
+#endif// WEAK_TESTS_PARSER_HPP
@@ -0,0 +1,160 @@
+#ifndef WEAK_TESTS_PROGRAM_CACHE_HPP
+#define WEAK_TESTS_PROGRAM_CACHE_HPP
+
+#include "../ast/flat_tree.hpp"
+#include "../cache/program_cache.hpp"
+#include "../lexer/lexer.hpp"
+#include "../lexer/module_loader.hpp"
+#include "../parser/module_parser.hpp"
+#include "../parser/parser.hpp"
+#include "../tests/test_utility.hpp"
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+
+namespace program_cache_detail {
+
+const std::filesystem::path& test_directory() {
+  static const std::filesystem::path directory = std::filesystem::temp_directory_path() / "weak_program_cache_tests";
+  return directory;
+}
+
+std::string write_file(const std::filesystem::path& relative, std::string_view contents) {
+  const std::filesystem::path path = test_directory() / relative;
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path, std::ios::trunc) << contents;
+  return std::filesystem::weakly_canonical(path).string();
+}
+
+/// @return program and its sources, as they are passed to ProgramCache::store()
+std::pair<boost::local_shared_ptr<ast::RootObject>, std::vector<ProgramCache::Source>> compile(const std::string& path) {
+  ModuleLoader loader;
+  loader.load(path);
+  std::vector<ProgramCache::Source> sources;
+  for (const auto& module : loader.modules()) {
+    sources.push_back({module.path, module.source_hash});
+  }
+  return {parse_modules(loader.take_modules()), std::move(sources)};
+}
+
+void assert_same(const boost::local_shared_ptr<ast::RootObject>& lhs, const boost::local_shared_ptr<ast::RootObject>& rhs) {
+  assert(lhs && rhs);
+  if (ast::FlatTree::flatten(*lhs) != ast::FlatTree::flatten(*rhs)) {
+    throw RuntimeError("program cache: trees differ");
+  }
+}
+
+const std::string_view all_nodes_program =
+    "define-type structure(a, b, c);"
+    "lambda f(x, y) {"
+    "  if (x < y) { x * 2 + 1.5; } else { \"str\\ning\"; }"
+    "  if (!x) { [1, 2, [x, y]]; }"
+    "  while (x > 0) { --x; x -= 1; }"
+    "  for (i = 0; i < 10; ++i) { print(i); }"
+    "  for (;;) {}"
+    "  obj = new structure(1, 2, 3);"
+    "  obj.a;"
+    "}"
+    "lambda main() { f(1, 2); }";
+
+}// namespace program_cache_detail
+
+void program_cache_tests() {
+  using namespace program_cache_detail;
+
+  const ProgramCache cache(test_directory() / "cache");
+  const std::string lib = write_file("src/lib.wl", "define-type pair(a, b); lambda g() { 1; }");
+  const std::string main = write_file("src/main.wl", std::string("load \"lib.wl\";") + all_nodes_program.data());
+
+  assert(!cache.load(main));
+  auto [program, sources] = compile(main);
+  assert(sources.size() == 2 && sources.back().path == main);
+  cache.store(main, sources, *program);
+  assert_same(cache.load(main), program);
+
+  /// Any dependency change invalidates entry, reverted change makes it valid again.
+  write_file("src/lib.wl", "define-type pair(a, b); lambda g() { 2; }");
+  assert(!cache.load(main));
+  write_file("src/lib.wl", "define-type pair(a, b); lambda g() { 1; }");
+  assert_same(cache.load(main), program);
+  std::filesystem::remove(lib);
+  assert(!cache.load(main));
+  write_file("src/lib.wl", "define-type pair(a, b); lambda g() { 1; }");
+
+  /// Program compiled with other options has its own entry.
+  assert(!cache.load(main, "no-shake;O0"));
+  cache.store(main, sources, *program, "no-shake;O0");
+  assert_same(cache.load(main, "no-shake;O0"), program);
+  assert(cache.entry_path(main, "no-shake;O0") != cache.entry_path(main));
+  assert_same(cache.load(main), program);
+  assert(!cache.load(main, "no-shake;O1"));
+
+  /// Damaged entry is a miss, not an error.
+  const std::filesystem::path entry = cache.entry_path(main);
+  const auto entry_size = std::filesystem::file_size(entry);
+  {
+    std::fstream file(entry, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(static_cast<std::streamoff>(entry_size - 1));
+    file.put('\xFF');
+  }
+  assert(!cache.load(main));
+  std::filesystem::resize_file(entry, entry_size / 2);
+  assert(!cache.load(main));
+
+  /// Concurrent writers replace entry atomically, so reader never sees a partial one.
+  cache.store(main, sources, *program);
+  ThreadPool pool(4);
+  std::vector<std::future<void>> writers;
+  for (size_t i = 0; i < 4; ++i) {
+    writers.push_back(pool.submit([&cache, &main] {
+      auto [written_program, written_sources] = compile(main);
+      for (size_t j = 0; j < 20; ++j) {
+        cache.store(main, written_sources, *written_program);
+      }
+    }));
+  }
+  for (size_t i = 0; i < 40; ++i) {
+    assert_same(cache.load(main), program);
+  }
+  for (auto& writer : writers) {
+    writer.get();
+  }
+  assert_same(cache.load(main), program);
+  for (const auto& file : std::filesystem::directory_iterator(test_directory() / "cache")) {
+    assert(file.path().extension() == ".wlc" && "Temporary file left");
+  }
+}
+
+void program_cache_speed_tests() {
+  using namespace program_cache_detail;
+
+  std::string contents;
+  for (size_t i = 0; i < 2000; ++i) {
+    contents += "lambda f" + std::to_string(i) + "(a, b) { if (a < b) { a * 2 + b; } else { print(\"string\", [a, b]); } }\n";
+  }
+  const std::string main = write_file("speed/main.wl", contents);
+  const ProgramCache cache(test_directory() / "cache");
+
+  std::cout << "\nProgram cache speed test - " << contents.size() / 1024 << " KiB. program\n";
+  speed_benchmark("front end", 1, [&main, &cache] {
+    auto [program, sources] = compile(main);
+    cache.store(main, sources, *program);
+  });
+  speed_benchmark("cache", 1, [&main, &cache] {
+    assert(cache.load(main));
+  });
+}
+
+void run_program_cache_tests() {
+  std::cout << "Running program cache tests...\n====\n";
+
+  std::filesystem::remove_all(program_cache_detail::test_directory());
+  program_cache_tests();
+  program_cache_speed_tests();
+  std::filesystem::remove_all(program_cache_detail::test_directory());
+
+  std::cout << "Program cache tests passed successfully\n";
+}
+
+#endif// WEAK_TESTS_PROGRAM_CACHE_HPP
@@ -32,6 +32,48 @@ void assert_correct(std::string_view data) {
   SemanticAnalyzer analyzer(parsed_trees);
   analyzer.analyze();
 }
+
+void expect_binding_error(std::string_view data) {
+  trace_error(data, [&data] {
+    const boost::local_shared_ptr<ast::RootObject> parsed_trees = create_parse_tree(data);
+    SemanticAnalyzer analyzer(parsed_trees);
+    analyzer.analyze();
+    SemanticAnalyzer::bind(*parsed_trees);
+    assert(false && "Error expected");
+  });
+}
+
+boost::local_shared_ptr<ast::RootObject> create_bound_tree(std::string_view data, bool free_names_are_globals = false) {
+  const boost::local_shared_ptr<ast::RootObject> parsed_trees = create_parse_tree(data);
+  SemanticAnalyzer analyzer(parsed_trees);
+  analyzer.analyze();
+  SemanticAnalyzer::bind(*parsed_trees, free_names_are_globals);
+  return parsed_trees;
+}
+
+/// @return body statements of the first lambda of analyzed program
+std::vector<boost::local_shared_ptr<ast::Object>> analyzed_body(std::string_view data) {
+  const boost::local_shared_ptr<ast::RootObject> parsed_trees = create_parse_tree(data);
+  SemanticAnalyzer analyzer(parsed_trees);
+  analyzer.analyze();
+  return boost::static_pointer_cast<ast::Lambda>(parsed_trees->get().front())->body()->statements();
+}
+
+/// @return inferred type of the last statement of the first lambda
+ast::inferred_t last_statement_type(std::string_view data) {
+  const auto body = analyzed_body(data);
+  const auto& last = body.back();
+  // clang-format off
+  switch (last->ast_type()) {
+    case ast::type_t::SYMBOL: { return boost::static_pointer_cast<ast::Symbol>(last)->inferred_type(); }
+    case ast::type_t::UNARY: { return boost::static_pointer_cast<ast::Unary>(last)->inferred_type(); }
+    case ast::type_t::BINARY: { return boost::static_pointer_cast<ast::Binary>(last)->inferred_type(); }
+    case ast::type_t::WHILE: { return boost::static_pointer_cast<ast::While>(last)->inferred_type(); }
+    case ast::type_t::FOR: { return boost::static_pointer_cast<ast::For>(last)->inferred_type(); }
+    default: { return ast::inferred_t::UNKNOWN; }
+  }
+  // clang-format on
+}
 }// namespace semantic_detail
 
 void semantic_analyzer_test_syntax() {
@@ -83,10 +125,138 @@ void semantic_analyzer_test_syntax() {
   semantic_detail::assert_correct("array-get(array, function_call());");
 }
 
+void semantic_analyzer_type_inference_tests() {
+  using ast::inferred_t;
+  using semantic_detail::last_statement_type;
+
+  assert(last_statement_type("lambda f() { x = 1; x + 2; }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { x = 1; x + 2.5; }") == inferred_t::FLOAT);
+  assert(last_statement_type("lambda f() { x = 1.5; x * x; }") == inferred_t::FLOAT);
+  assert(last_statement_type("lambda f() { x = 1; y = x * 3; y < 2; }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { x = \"Text\"; x; }") == inferred_t::STRING);
+  assert(last_statement_type("lambda f() { x = [1, 2]; x; }") == inferred_t::ARRAY);
+  assert(last_statement_type("lambda f() { X = 1; x; }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { x = 1; ++x; }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { x = \"Text\"; x + 1; }") == inferred_t::UNKNOWN);
+
+  /// Arguments and variables of callers may have any type.
+  assert(last_statement_type("lambda f(a) { a + 1; }") == inferred_t::UNKNOWN);
+  assert(last_statement_type("lambda f() { y + 1; }") == inferred_t::UNKNOWN);
+  assert(last_statement_type("lambda f(a) { x = a; x; }") == inferred_t::UNKNOWN);
+  assert(last_statement_type("lambda f(a) { x = 1; x += a; x; }") == inferred_t::INTEGER);
+
+  /// Scope is lexical, so called lambda can't rebind variables of caller.
+  assert(last_statement_type("lambda f() { x = 1; g(); x; }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { x = 1; print(x); x; }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { x = 1; y = x + g(); x; }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { x = 1.5; g(x); x * 2.5; }") == inferred_t::FLOAT);
+  assert(last_statement_type("lambda f() { x = 1; y = g(); y; }") == inferred_t::UNKNOWN);
+
+  assert(last_statement_type("lambda f(a) { if (a) { x = 1; } else { x = 2; } x; }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f(a) { if (a) { x = 1; } else { x = 2.5; } x; }") == inferred_t::UNKNOWN);
+  assert(last_statement_type("lambda f(a) { if (a) { x = 1; } x; }") == inferred_t::UNKNOWN);
+  assert(last_statement_type("lambda f(a) { x = 1; if (a) { x = 2; } x; }") == inferred_t::INTEGER);
+
+  assert(last_statement_type("lambda f() { i = 0; while (i < 10) { ++i; } }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { i = 0.5; while (i < 10) { ++i; } }") == inferred_t::FLOAT);
+  assert(last_statement_type("lambda f() { i = 0; while (i < 10) { i = 1.5; } }") == inferred_t::UNKNOWN);
+  assert(last_statement_type("lambda f() { i = 0; while (i < 10) { g(i); } }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { for (i = 0; i < 10; ++i) {} }") == inferred_t::INTEGER);
+  assert(last_statement_type("lambda f() { for (i = 0; i < 10; ++i) { i = \"Text\"; } }") == inferred_t::UNKNOWN);
+  assert(last_statement_type("lambda f() { for (i = 0; i < 10; i += 1) { x = i * 2; } x; }") == inferred_t::UNKNOWN);
+  assert(last_statement_type("lambda f() { x = 0; for (i = 0; i < 10; ++i) { x = i * 2; } x; }") == inferred_t::INTEGER);
+
+  /// Symbol inside loop is annotated with type, valid on every iteration.
+  const auto body = semantic_detail::analyzed_body("lambda f() { x = 1; while (x < 10) { y = x; x = 2.5; } }");
+  const auto loop = boost::static_pointer_cast<ast::While>(body.back());
+  const auto assignment = boost::static_pointer_cast<ast::Binary>(loop->body()->statements().front());
+  assert(boost::static_pointer_cast<ast::Symbol>(assignment->rhs())->inferred_type() == inferred_t::UNKNOWN);
+
+  /// Annotations survive flattening.
+  const boost::local_shared_ptr<ast::RootObject> analyzed = semantic_detail::create_parse_tree("lambda f() { x = 1; x + 2; }");
+  SemanticAnalyzer analyzer(analyzed);
+  analyzer.analyze();
+  const auto restored = ast::FlatTree::flatten(*analyzed).materialize();
+  const auto restored_body = boost::static_pointer_cast<ast::Lambda>(restored->get().front())->body()->statements();
+  assert(boost::static_pointer_cast<ast::Binary>(restored_body.back())->inferred_type() == inferred_t::INTEGER);
+}
+
+void semantic_analyzer_binding_tests() {
+  semantic_detail::expect_binding_error("lambda main() { print(y); }");
+  semantic_detail::expect_binding_error("lambda main() { undefined(); }");
+  semantic_detail::expect_binding_error("lambda f(a) { a; } lambda main() { f(); }");
+  semantic_detail::expect_binding_error("lambda f(a) { a; } lambda main() { f(1, 2); }");
+  semantic_detail::expect_binding_error("lambda main() { for (i = 0; i < 10; ++i) {} print(i); }");
+  semantic_detail::expect_binding_error("lambda main() { x = 1; lambda inner() { x; } inner(); }");
+  /// Scope is lexical, so callee doesn't see locals of its caller, as it did with dynamic scope.
+  semantic_detail::expect_binding_error("lambda f() { x; } lambda main() { x = 1; f(); }");
+  semantic_detail::expect_binding_error("lambda f() { g(); } lambda main() { lambda g() {} f(); }");
+  semantic_detail::create_bound_tree("lambda main() { i = 5; for (i = 0; i < 10; ++i) {} print(i); }");
+  semantic_detail::create_bound_tree("lambda main() { for (i = 0; i < 2; ++i) {} for (i = 0; i < 2; ++i) {} }");
+  semantic_detail::create_bound_tree("lambda main() { lambda inner(a) { a; } inner(1); }");
+  semantic_detail::create_bound_tree("lambda f() { g(); } lambda g() {} lambda main() { f(); }");
+  semantic_detail::create_bound_tree("lambda main() { print(y); undefined(); }", /*free_names_are_globals=*/true);
+  semantic_detail::create_bound_tree("x = 1; print(x);");
+
+  const auto program = semantic_detail::create_bound_tree("lambda f(a, b) { c = a; print(c); g(b); } lambda g(x) { x; } lambda main() { f(1, 2); }");
+  const auto& f = static_cast<ast::Lambda&>(*program->get()[0]);
+  const auto& body = f.body()->statements();
+  assert(f.is_bound() && f.frame_size() == 3);
+
+  const auto& assignment = static_cast<ast::Binary&>(*body[0]);
+  const auto& c = static_cast<ast::Symbol&>(*assignment.lhs());
+  const auto& a = static_cast<ast::Symbol&>(*assignment.rhs());
+  assert(a.scope() == ast::scope_t::PARAMETER && a.slot() == 0);
+  assert(c.scope() == ast::scope_t::LOCAL && c.slot() == 2);
+
+  const auto& print = static_cast<ast::LambdaCall&>(*body[1]);
+  assert(print.target() == ast::LambdaCall::target_t::BUILTIN);
+
+  const auto& g = static_cast<ast::LambdaCall&>(*body[2]);
+  assert(g.target() == ast::LambdaCall::target_t::LAMBDA);
+  assert(&g.lambda() == program->get()[1].get());
+  assert(static_cast<ast::Symbol&>(*g.arguments()[0]).slot() == 1);
+}
+
+void semantic_analyzer_purity_tests() {
+  const auto program = semantic_detail::create_bound_tree(R"(
+    lambda square(a) { a * a; }
+    lambda show(a) { print(a); }
+    lambda calls_show(a) { show(a); square(a); }
+    lambda increment(a) { ++a; }
+    lambda fresh(a) { b = a + 1; ++b; b += a; b; }
+    lambda counter(n) { s = 0; for (i = 0; i < n; ++i) { s = s + i; } s; }
+    lambda fib(n) { r = n; if (n > 1) { r = fib(n - 1); r = r + fib(n - 2); } r; }
+    lambda pack(a) { x = [a]; x; }
+    lambda replace(x) { array-replace(x, 0, 1); }
+    lambda even(n) { r = 1; if (n) { r = odd(n - 1); } r; }
+    lambda odd(n) { r = 0; if (n) { r = even(n - 1); } print(r); r; }
+    lambda declares() { lambda inner(a) { a; } inner(1); }
+    lambda main() {}
+  )");
+  auto is_pure = [&program](size_t index) { return static_cast<ast::Lambda&>(*program->get()[index]).is_pure(); };
+  assert(is_pure(0));
+  assert(!is_pure(1));
+  assert(!is_pure(2));
+  assert(!is_pure(3));
+  assert(is_pure(4));
+  /// Loop variable is initialized by literal, so increment changes program.
+  assert(!is_pure(5));
+  assert(is_pure(6));
+  assert(!is_pure(7));
+  assert(!is_pure(8));
+  assert(!is_pure(9));
+  assert(!is_pure(10));
+  assert(!is_pure(11));
+}
+
 void run_semantic_analyzer_tests() {
   std::cout << "Running semantic analyzer tests...\n====\n";
 
   semantic_analyzer_test_syntax();
+  semantic_analyzer_type_inference_tests();
+  semantic_analyzer_binding_tests();
+  semantic_analyzer_purity_tests();
 
   std::cout << "Semantic analyzer tests passed successfully\n";
 }
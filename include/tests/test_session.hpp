@@ -0,0 +1,127 @@
+#ifndef WEAK_TESTS_SESSION_HPP
+#define WEAK_TESTS_SESSION_HPP
+
+#include "../eval/session.hpp"
+#include "../tests/test_utility.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+extern std::ostream& default_stdout;
+
+namespace session_detail {
+
+void run_input(Session& session, std::string_view input, std::string_view expected_output) {
+  session.eval(input);
+  try {
+    auto& stream = dynamic_cast<std::ostringstream&>(default_stdout);
+    if (stream.str() != expected_output) {
+      std::cerr << "session error: for " << input << "\n\tgot [" << stream.str() << "], expected [" << expected_output << "]\n";
+      exit(-1);
+    }
+    stream.str("");
+  } catch (std::bad_cast&) {}
+  default_stdout.clear();
+}
+
+template <typename Error>
+void expect_error(Session& session, std::string_view input) {
+  try {
+    session.eval(input);
+  } catch (Error&) {
+    try {
+      dynamic_cast<std::ostringstream&>(default_stdout).str("");
+    } catch (std::bad_cast&) {}
+    default_stdout.clear();
+    return;
+  }
+  assert(false && "Error expected");
+}
+
+}// namespace session_detail
+
+void session_state_tests() {
+  Session session;
+
+  session_detail::run_input(session, "lambda square(x) { x * x; }", "");
+  session_detail::run_input(session, "value = square(7);", "");
+  session_detail::run_input(session, "print(value);", "49");
+  session_detail::run_input(session, "define-type point(x, y);", "");
+  session_detail::run_input(session, "p = new point(1, 2); print(p.y);", "2");
+
+  /// Later declaration replaces the previous one.
+  session_detail::run_input(session, "lambda square(x) { x * x * x; }", "");
+  session_detail::run_input(session, "print(square(2), value);", "8 49");
+
+  auto result = session.eval("square(3);");
+  assert(result && result->ast_type() == ast::type_t::INTEGER);
+  assert(boost::static_pointer_cast<ast::Integer>(result)->value() == 27);
+}
+
+void session_error_tests() {
+  Session session;
+
+  session_detail::run_input(session, "lambda fail(x) { x + undefined; }", "");
+  session_detail::run_input(session, "kept = 1;", "");
+  session_detail::expect_error<LexicalError>(session, "\"unclosed");
+  session_detail::expect_error<ParseError>(session, "lambda f( {");
+  session_detail::expect_error<EvalError>(session, "fail(1);");
+  session_detail::expect_error<EvalError>(session, "missing(1);");
+
+  /// Failed call must not leave session in a nested scope.
+  session_detail::run_input(session, "print(kept); kept = 2;", "1");
+  session_detail::run_input(session, "lambda read() { kept; } print(read());", "2");
+}
+
+void session_completeness_tests() {
+  assert(Session::is_complete(""));
+  assert(Session::is_complete("x = 1;"));
+  assert(!Session::is_complete("lambda f() {"));
+  assert(!Session::is_complete("lambda f() {\n  if (x) {\n  }\n"));
+  assert(Session::is_complete("lambda f() {\n  if (x) {\n  }\n}\n"));
+  assert(!Session::is_complete("print(1,"));
+  assert(!Session::is_complete("x = [1, 2"));
+  assert(Session::is_complete("s = \"{\";"));
+  assert(Session::is_complete("s = \"unclosed {"));
+}
+
+void session_input_tests() {
+  std::ostringstream prompt;
+
+  std::istringstream complete("x = 1;\nlambda f() {\n  x;\n}\n");
+  assert(Session::read_input(complete, prompt) == "x = 1;\n");
+  assert(Session::read_input(complete, prompt) == "lambda f() {\n  x;\n}\n");
+  assert(!Session::read_input(complete, prompt));
+
+  /// Last statement without trailing newline is read.
+  std::istringstream no_newline("print(5);");
+  const auto last = Session::read_input(no_newline, prompt);
+  assert(last == "print(5);\n");
+  assert(!Session::read_input(no_newline, prompt));
+  Session session;
+  session_detail::run_input(session, *last, "5");
+
+  /// Input, cut by end of stream, is returned to be reported instead of being dropped.
+  std::istringstream cut("lambda g() {\n  print(1);");
+  const auto incomplete = Session::read_input(cut, prompt);
+  assert(incomplete == "lambda g() {\n  print(1);\n");
+  assert(!Session::read_input(cut, prompt));
+  session_detail::expect_error<ParseError>(session, *incomplete);
+
+  std::istringstream empty("");
+  assert(!Session::read_input(empty, prompt));
+}
+
+void run_session_tests() {
+  std::cout << "Running session tests...\n====\n";
+
+  session_state_tests();
+  session_error_tests();
+  session_completeness_tests();
+  session_input_tests();
+
+  std::cout << "Session tests passed successfully\n";
+}
+
+#endif// WEAK_TESTS_SESSION_HPP
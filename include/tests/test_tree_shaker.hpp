@@ -0,0 +1,104 @@
+#ifndef WEAK_TESTS_TREE_SHAKER_HPP
+#define WEAK_TESTS_TREE_SHAKER_HPP
+
+#include "../ast/flat_tree.hpp"
+#include "../lexer/lexer.hpp"
+#include "../optimizer/tree_shaker.hpp"
+#include "../parser/parser.hpp"
+#include "../tests/test_utility.hpp"
+
+#include <cassert>
+#include <sstream>
+
+namespace tree_shaker_detail {
+
+boost::local_shared_ptr<ast::RootObject> parse(std::string_view program, bool lazy_bodies = false) {
+  Lexer lexer(std::istringstream{std::string(program)});
+  Parser parser(lexer.tokenize(), lazy_bodies);
+  return parser.parse();
+}
+
+std::string declaration_names(const std::vector<boost::local_shared_ptr<ast::RootObject>>& trees) {
+  std::string names;
+  for (const auto& tree : trees) {
+    for (const auto& declaration : tree->get()) {
+      if (declaration->ast_type() == ast::type_t::LAMBDA) {
+        names += boost::static_pointer_cast<ast::Lambda>(declaration)->name() + " ";
+      } else if (declaration->ast_type() == ast::type_t::TYPE_DEFINITION) {
+        names += boost::static_pointer_cast<ast::TypeDefinition>(declaration)->name() + " ";
+      }
+    }
+  }
+  return names;
+}
+
+/// @return names of declarations left after shaking of modules
+std::string shake(std::vector<std::string_view> modules, TreeShaker::Stats* stats = nullptr, bool lazy_bodies = false) {
+  std::vector<boost::local_shared_ptr<ast::RootObject>> trees;
+  for (std::string_view module : modules) {
+    trees.push_back(parse(module, lazy_bodies));
+  }
+  TreeShaker shaker(trees);
+  const TreeShaker::Stats result = shaker.shake();
+  if (stats) {
+    *stats = result;
+  }
+  return declaration_names(trees);
+}
+
+}// namespace tree_shaker_detail
+
+void tree_shaker_reachability_tests() {
+  using tree_shaker_detail::shake;
+
+  TreeShaker::Stats stats;
+  assert(shake({"define-type used(a); define-type unused(a);"
+                "lambda g(x) { x; } lambda unused_f() { g(1); }"
+                "lambda f() { o = new used(1); g(o.a); }"
+                "lambda main() { f(); }"},
+               &stats) == "used g f main ");
+  /// define-type unused(a) - type definition and a symbol, unused_f - lambda, block, call and integer.
+  assert(stats.declarations == 2 && stats.nodes == 6);
+
+  /// Names are case-insensitive, symbols may refer to lambdas.
+  assert(shake({"lambda F() { 1; } lambda main() { f(); }"}) == "F main ");
+  assert(shake({"lambda callback() { 1; } lambda main() { x = callback; }"}) == "callback main ");
+  /// Callee of unreachable lambda is unreachable too.
+  assert(shake({"lambda a() { b(); } lambda b() { a(); } lambda main() { print(1); }"}) == "main ");
+
+  /// References are resolved across modules.
+  assert(shake({"lambda lib() { 1; } lambda unused() { 2; }", "lambda main() { lib(); }"}) == "lib main ");
+
+  /// Without entry point or with reachable lazy lambda nothing is removed.
+  assert(shake({"lambda f() { 1; } lambda g() { 2; }"}, &stats) == "f g " && stats.declarations == 0);
+  assert(shake({"lambda f() { 1; } lambda main() { 2; }"}, &stats, /*lazy_bodies=*/true) == "f main " && stats.declarations == 0);
+}
+
+void tree_shaker_speed_tests() {
+  std::string program;
+  for (size_t i = 0; i < 5000; ++i) {
+    program += "lambda f" + std::to_string(i) + "(a, b) { if (a < b) { f" + std::to_string(i + 1) + "(a, b); } else { print([a, b]); } }\n";
+  }
+  program += "lambda main() { f4990(1, 2); }";
+  const auto tree = tree_shaker_detail::parse(program);
+
+  std::cout << "\nTree shaker speed test - 5000 lambdas\n";
+  TreeShaker::Stats stats;
+  speed_benchmark("shake", 1, [&tree, &stats] {
+    std::vector<boost::local_shared_ptr<ast::RootObject>> trees{tree};
+    TreeShaker shaker(trees);
+    stats = shaker.shake();
+  });
+  assert(stats.declarations == 4990 && tree->get().size() == 11);
+}
+
+void run_tree_shaker_tests() {
+  std::cout << "Running tree shaker tests...\n====\n";
+
+  tree_shaker_reachability_tests();
+  tree_shaker_speed_tests();
+
+  std::cout << "Tree shaker tests passed successfully\n";
+}
+
+#endif// WEAK_TESTS_TREE_SHAKER_HPP
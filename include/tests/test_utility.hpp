@@ -4,6 +4,7 @@
 #include "../ast/ast.hpp"
 #include "../error/eval_error.hpp"
 #include "../error/lexical_error.hpp"
+#include "../error/load_error.hpp"
 #include "../error/parse_error.hpp"
 #include "../error/semantic_error.hpp"
 
@@ -17,6 +18,9 @@ template <typename Fun>
 void trace_error(std::string_view program, Fun&& fn) {
   try {
     fn();
+  } catch (LoadError& load_error) {
+    std::cout << "While loading:\n\t" << program << "\nLoad error processed:\n\t" << load_error.what() << "\n\n";
+    goto clear_stdout;
   } catch (LexicalError& lexical_error) {
     std::cout << "While analyzing:\n\t" << program << "\nLexical error processed:\n\t" << lexical_error.what() << "\n\n";
     goto clear_stdout;
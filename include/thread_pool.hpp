@@ -0,0 +1,89 @@
+#ifndef WEAK_THREAD_POOL_HPP
+#define WEAK_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// Fixed-size pool of worker threads executing submitted tasks in FIFO order.
+///
+/// @note Tasks must not block on futures of tasks submitted after them,
+///       otherwise pool with one worker deadlocks.
+class ThreadPool {
+public:
+  /// @param threads_count - number of workers, 0 is treated as 1
+  /// @throws std::system_error if thread cannot be started
+  explicit ThreadPool(size_t threads_count) noexcept(false) {
+    threads_count = std::max<size_t>(threads_count, 1);
+    workers_.reserve(threads_count);
+    for (size_t i = 0; i < threads_count; ++i) {
+      workers_.emplace_back([this] { work(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// @post all already submitted tasks are finished
+  ~ThreadPool() noexcept(true) {
+    {
+      std::lock_guard lock(mutex_);
+      stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  size_t size() const noexcept(true) {
+    return workers_.size();
+  }
+
+  /// @throws std::bad_alloc
+  /// @return future that holds result or exception thrown from function
+  template <typename Function>
+  auto submit(Function&& function) noexcept(false) -> std::future<std::invoke_result_t<Function>> {
+    using result_t = std::invoke_result_t<Function>;
+    auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<Function>(function));
+    std::future<result_t> result = task->get_future();
+    {
+      std::lock_guard lock(mutex_);
+      tasks_.emplace([task] { (*task)(); });
+    }
+    condition_.notify_one();
+    return result;
+  }
+
+private:
+  void work() noexcept(true) {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock(mutex_);
+        condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stopping_ = false;
+};
+
+#endif// WEAK_THREAD_POOL_HPP
@@ -0,0 +1,13 @@
+#include "../../include/ast/ast.hpp"
+
+namespace ast {
+
+inferred_t Annotated::inferred_type() const noexcept(true) {
+  return inferred_type_;
+}
+
+void Annotated::set_inferred_type(inferred_t type) noexcept(true) {
+  inferred_type_ = type;
+}
+
+}// namespace ast
@@ -9,4 +9,8 @@ std::vector<boost::local_shared_ptr<Object>>& Array::elements() noexcept(true) {
   return elements_;
 }
 
+const std::vector<boost::local_shared_ptr<Object>>& Array::elements() const noexcept(true) {
+  return elements_;
+}
+
 }// namespace ast
@@ -0,0 +1,411 @@
+#include "../../include/ast/big_integer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace ast {
+
+namespace {
+
+using magnitude_t = BigInteger::Limbs;
+
+constexpr size_t limb_bits = 32;
+constexpr uint64_t limb_base = uint64_t{1} << limb_bits;
+/// The largest power of ten, that fits into limb, used to convert decimals chunk by chunk.
+constexpr BigInteger::limb_t decimal_chunk = 1'000'000'000;
+constexpr size_t decimal_chunk_digits = 9;
+
+void trim(magnitude_t& magnitude) noexcept(true) {
+  while (!magnitude.empty() && magnitude.back() == 0) {
+    magnitude.pop_back();
+  }
+}
+
+magnitude_t from_uint64(uint64_t value) noexcept(false) {
+  magnitude_t magnitude;
+  for (; value != 0; value >>= limb_bits) {
+    magnitude.push_back(static_cast<BigInteger::limb_t>(value));
+  }
+  return magnitude;
+}
+
+int compare_magnitudes(const magnitude_t& lhs, const magnitude_t& rhs) noexcept(true) {
+  if (lhs.size() != rhs.size()) {
+    return lhs.size() < rhs.size() ? -1 : 1;
+  }
+  for (size_t i = lhs.size(); i-- > 0;) {
+    if (lhs[i] != rhs[i]) {
+      return lhs[i] < rhs[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+magnitude_t add_magnitudes(const magnitude_t& lhs, const magnitude_t& rhs) noexcept(false) {
+  const magnitude_t& longer = lhs.size() >= rhs.size() ? lhs : rhs;
+  const magnitude_t& shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+  magnitude_t sum;
+  uint64_t carry = 0;
+  for (size_t i = 0; i < longer.size(); ++i) {
+    carry += uint64_t{longer[i]} + (i < shorter.size() ? shorter[i] : 0);
+    sum.push_back(static_cast<BigInteger::limb_t>(carry));
+    carry >>= limb_bits;
+  }
+  if (carry != 0) {
+    sum.push_back(static_cast<BigInteger::limb_t>(carry));
+  }
+  return sum;
+}
+
+/// @pre    lhs >= rhs
+magnitude_t subtract_magnitudes(const magnitude_t& lhs, const magnitude_t& rhs) noexcept(false) {
+  magnitude_t difference;
+  int64_t borrow = 0;
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    int64_t limb = int64_t{lhs[i]} - (i < rhs.size() ? rhs[i] : 0) - borrow;
+    borrow = limb < 0 ? 1 : 0;
+    difference.push_back(static_cast<BigInteger::limb_t>(limb + (borrow << limb_bits)));
+  }
+  trim(difference);
+  return difference;
+}
+
+magnitude_t multiply_magnitudes(const magnitude_t& lhs, const magnitude_t& rhs) noexcept(false) {
+  if (lhs.empty() || rhs.empty()) {
+    return {};
+  }
+  magnitude_t product(lhs.size() + rhs.size(), 0);
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < rhs.size(); ++j) {
+      carry += uint64_t{lhs[i]} * rhs[j] + product[i + j];
+      product[i + j] = static_cast<BigInteger::limb_t>(carry);
+      carry >>= limb_bits;
+    }
+    product[i + rhs.size()] = static_cast<BigInteger::limb_t>(carry);
+  }
+  trim(product);
+  return product;
+}
+
+/// @brief  magnitude = magnitude * factor + addend
+void multiply_add(magnitude_t& magnitude, BigInteger::limb_t factor, BigInteger::limb_t addend) noexcept(false) {
+  uint64_t carry = addend;
+  for (auto& limb : magnitude) {
+    carry += uint64_t{limb} * factor;
+    limb = static_cast<BigInteger::limb_t>(carry);
+    carry >>= limb_bits;
+  }
+  if (carry != 0) {
+    magnitude.push_back(static_cast<BigInteger::limb_t>(carry));
+  }
+}
+
+/// @pre    divisor is not zero
+/// @return remainder, magnitude is replaced by quotient
+BigInteger::limb_t divide_by_limb(magnitude_t& magnitude, BigInteger::limb_t divisor) noexcept(true) {
+  uint64_t remainder = 0;
+  for (size_t i = magnitude.size(); i-- > 0;) {
+    const uint64_t current = (remainder << limb_bits) | magnitude[i];
+    magnitude[i] = static_cast<BigInteger::limb_t>(current / divisor);
+    remainder = current % divisor;
+  }
+  trim(magnitude);
+  return static_cast<BigInteger::limb_t>(remainder);
+}
+
+size_t bit_length(const magnitude_t& magnitude) noexcept(true) {
+  if (magnitude.empty()) {
+    return 0;
+  }
+  return (magnitude.size() - 1) * limb_bits + (limb_bits - static_cast<size_t>(std::countl_zero(magnitude.back())));
+}
+
+bool test_bit(const magnitude_t& magnitude, size_t bit) noexcept(true) {
+  return (magnitude[bit / limb_bits] >> (bit % limb_bits)) & 1;
+}
+
+magnitude_t shift_magnitude_left(const magnitude_t& magnitude, uint64_t bits) noexcept(false) {
+  if (magnitude.empty()) {
+    return {};
+  }
+  const size_t limbs = bits / limb_bits;
+  const size_t offset = bits % limb_bits;
+  magnitude_t shifted(limbs, 0);
+  BigInteger::limb_t carry = 0;
+  for (const auto limb : magnitude) {
+    shifted.push_back(static_cast<BigInteger::limb_t>((uint64_t{limb} << offset) | carry));
+    carry = offset == 0 ? 0 : static_cast<BigInteger::limb_t>(limb >> (limb_bits - offset));
+  }
+  shifted.push_back(carry);
+  trim(shifted);
+  return shifted;
+}
+
+/// @brief  shift in place, each limb is read before it's overwritten
+void shift_magnitude_right(magnitude_t& magnitude, uint64_t bits) noexcept(true) {
+  const size_t limbs = bits / limb_bits;
+  if (limbs >= magnitude.size()) {
+    magnitude.clear();
+    return;
+  }
+  const size_t offset = bits % limb_bits;
+  for (size_t i = limbs; i < magnitude.size(); ++i) {
+    const uint64_t next = i + 1 < magnitude.size() ? magnitude[i + 1] : 0;
+    magnitude[i - limbs] = static_cast<BigInteger::limb_t>(((next << limb_bits) | magnitude[i]) >> offset);
+  }
+  magnitude.resize(magnitude.size() - limbs);
+  trim(magnitude);
+}
+
+/// @pre    divisor is not zero
+/// @return quotient and remainder
+/// @note   divisor of several limbs is rare, so it's divided bit by bit
+std::pair<magnitude_t, magnitude_t> divide_magnitudes(const magnitude_t& dividend, const magnitude_t& divisor) noexcept(false) {
+  if (compare_magnitudes(dividend, divisor) < 0) {
+    return {{}, dividend};
+  }
+  if (divisor.size() == 1) {
+    magnitude_t quotient = dividend;
+    const auto remainder = divide_by_limb(quotient, divisor.front());
+    return {std::move(quotient), remainder == 0 ? magnitude_t{} : magnitude_t{remainder}};
+  }
+  magnitude_t quotient(dividend.size(), 0);
+  magnitude_t remainder;
+  for (size_t bit = bit_length(dividend); bit-- > 0;) {
+    remainder = shift_magnitude_left(remainder, 1);
+    if (test_bit(dividend, bit)) {
+      if (remainder.empty()) {
+        remainder.push_back(1);
+      } else {
+        remainder.front() |= 1;
+      }
+    }
+    if (compare_magnitudes(remainder, divisor) >= 0) {
+      remainder = subtract_magnitudes(remainder, divisor);
+      quotient[bit / limb_bits] |= BigInteger::limb_t{1} << (bit % limb_bits);
+    }
+  }
+  trim(quotient);
+  return {std::move(quotient), std::move(remainder)};
+}
+
+/// @brief  two's complement negation in place, carry out of the last limb is dropped
+void negate(magnitude_t& complement) noexcept(true) {
+  uint64_t carry = 1;
+  for (auto& limb : complement) {
+    carry += static_cast<BigInteger::limb_t>(~limb);
+    limb = static_cast<BigInteger::limb_t>(carry);
+    carry >>= limb_bits;
+  }
+}
+
+}// namespace
+
+void BigInteger::Limbs::resize(size_t count, limb_t value) noexcept(false) {
+  if (count <= inline_limbs) {
+    if (size_ > inline_limbs) {
+      std::copy_n(heap_.begin(), count, inline_.begin());
+      heap_.clear();
+    } else if (count > size_) {
+      std::fill(inline_.begin() + static_cast<ptrdiff_t>(size_), inline_.begin() + static_cast<ptrdiff_t>(count), value);
+    }
+  } else {
+    if (size_ <= inline_limbs) {
+      heap_.assign(inline_.begin(), inline_.begin() + static_cast<ptrdiff_t>(size_));
+    }
+    heap_.resize(count, value);
+  }
+  size_ = count;
+}
+
+bool BigInteger::Limbs::operator==(const Limbs& other) const noexcept(true) {
+  return std::equal(begin(), end(), other.begin(), other.end());
+}
+
+BigInteger::BigInteger(int64_t value) noexcept(false)
+  : negative_(value < 0)
+  , magnitude_(from_uint64(value < 0 ? uint64_t{0} - static_cast<uint64_t>(value) : static_cast<uint64_t>(value))) {}
+
+BigInteger::BigInteger(bool negative, magnitude_t magnitude) noexcept(true)
+  : negative_(negative)
+  , magnitude_(std::move(magnitude)) {
+  normalize();
+}
+
+std::optional<BigInteger> BigInteger::parse(std::string_view decimal) noexcept(false) {
+  const bool negative = !decimal.empty() && decimal.front() == '-';
+  if (negative) {
+    decimal.remove_prefix(1);
+  }
+  if (decimal.empty() || !std::all_of(decimal.begin(), decimal.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+    return std::nullopt;
+  }
+  magnitude_t magnitude;
+  /// First chunk takes the remainder, so other chunks have all digits.
+  size_t chunk_size = decimal.size() % decimal_chunk_digits;
+  chunk_size = chunk_size == 0 ? decimal_chunk_digits : chunk_size;
+  for (size_t position = 0; position < decimal.size(); position += chunk_size, chunk_size = decimal_chunk_digits) {
+    limb_t chunk = 0;
+    limb_t factor = 1;
+    for (const char digit : decimal.substr(position, chunk_size)) {
+      chunk = chunk * 10 + static_cast<limb_t>(digit - '0');
+      factor *= 10;
+    }
+    multiply_add(magnitude, factor, chunk);
+  }
+  return BigInteger(negative, std::move(magnitude));
+}
+
+bool BigInteger::is_zero() const noexcept(true) {
+  return magnitude_.empty();
+}
+
+bool BigInteger::is_negative() const noexcept(true) {
+  return negative_;
+}
+
+bool BigInteger::fits_int64() const noexcept(true) {
+  if (magnitude_.size() > 2) {
+    return false;
+  }
+  const uint64_t value = magnitude_.size() == 2 ? (uint64_t{magnitude_[1]} << limb_bits) | magnitude_[0] : magnitude_.empty() ? 0 : magnitude_[0];
+  const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+  return value <= limit || (negative_ && value == limit + 1);
+}
+
+int64_t BigInteger::to_int64() const noexcept(true) {
+  uint64_t value = 0;
+  for (size_t i = magnitude_.size(); i-- > 0;) {
+    value = (value << limb_bits) | magnitude_[i];
+  }
+  return static_cast<int64_t>(negative_ ? uint64_t{0} - value : value);
+}
+
+double BigInteger::to_double() const noexcept(true) {
+  double value = 0;
+  for (size_t i = magnitude_.size(); i-- > 0;) {
+    value = value * static_cast<double>(limb_base) + magnitude_[i];
+  }
+  return negative_ ? -value : value;
+}
+
+std::string BigInteger::to_string() const noexcept(false) {
+  if (is_zero()) {
+    return "0";
+  }
+  magnitude_t rest = magnitude_;
+  std::string digits;
+  while (!rest.empty()) {
+    limb_t chunk = divide_by_limb(rest, decimal_chunk);
+    for (size_t i = 0; i < decimal_chunk_digits && (chunk != 0 || !rest.empty()); ++i) {
+      digits.push_back(static_cast<char>('0' + chunk % 10));
+      chunk /= 10;
+    }
+  }
+  if (negative_) {
+    digits.push_back('-');
+  }
+  std::reverse(digits.begin(), digits.end());
+  return digits;
+}
+
+BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs) noexcept(false) {
+  if (lhs.negative_ == rhs.negative_) {
+    return BigInteger(lhs.negative_, add_magnitudes(lhs.magnitude_, rhs.magnitude_));
+  }
+  if (compare_magnitudes(lhs.magnitude_, rhs.magnitude_) >= 0) {
+    return BigInteger(lhs.negative_, subtract_magnitudes(lhs.magnitude_, rhs.magnitude_));
+  }
+  return BigInteger(rhs.negative_, subtract_magnitudes(rhs.magnitude_, lhs.magnitude_));
+}
+
+BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs) noexcept(false) {
+  return lhs + BigInteger(!rhs.negative_, rhs.magnitude_);
+}
+
+BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs) noexcept(false) {
+  return BigInteger(lhs.negative_ != rhs.negative_, multiply_magnitudes(lhs.magnitude_, rhs.magnitude_));
+}
+
+std::pair<BigInteger, BigInteger> BigInteger::divide(const BigInteger& dividend, const BigInteger& divisor) noexcept(false) {
+  auto [quotient, remainder] = divide_magnitudes(dividend.magnitude_, divisor.magnitude_);
+  return {BigInteger(dividend.negative_ != divisor.negative_, std::move(quotient)), BigInteger(dividend.negative_, std::move(remainder))};
+}
+
+BigInteger BigInteger::shift_left(uint64_t bits) const noexcept(false) {
+  return BigInteger(negative_, shift_magnitude_left(magnitude_, bits));
+}
+
+BigInteger BigInteger::shift_right(uint64_t bits) const noexcept(false) {
+  if (!negative_) {
+    magnitude_t shifted = magnitude_;
+    shift_magnitude_right(shifted, bits);
+    return BigInteger(false, std::move(shifted));
+  }
+  /// -((|x| - 1) >> bits) - 1 rounds toward negative infinity.
+  const magnitude_t one{1};
+  magnitude_t shifted = subtract_magnitudes(magnitude_, one);
+  shift_magnitude_right(shifted, bits);
+  return BigInteger(true, add_magnitudes(shifted, one));
+}
+
+BigInteger::magnitude_t BigInteger::twos_complement(size_t limbs) const noexcept(false) {
+  magnitude_t complement = magnitude_;
+  complement.resize(limbs, 0);
+  if (negative_) {
+    negate(complement);
+  }
+  return complement;
+}
+
+BigInteger BigInteger::from_twos_complement(magnitude_t complement) noexcept(false) {
+  const bool negative = !complement.empty() && (complement.back() >> (limb_bits - 1)) != 0;
+  if (negative) {
+    negate(complement);
+  }
+  return BigInteger(negative, std::move(complement));
+}
+
+template <typename Operation>
+BigInteger BigInteger::bitwise(const BigInteger& lhs, const BigInteger& rhs, Operation operation) noexcept(false) {
+  /// One more limb keeps sign bit of both operands.
+  const size_t limbs = std::max(lhs.magnitude_.size(), rhs.magnitude_.size()) + 1;
+  magnitude_t result = lhs.twos_complement(limbs);
+  const magnitude_t other = rhs.twos_complement(limbs);
+  for (size_t i = 0; i < limbs; ++i) {
+    result[i] = operation(result[i], other[i]);
+  }
+  return from_twos_complement(std::move(result));
+}
+
+BigInteger operator&(const BigInteger& lhs, const BigInteger& rhs) noexcept(false) {
+  return BigInteger::bitwise(lhs, rhs, [](BigInteger::limb_t l, BigInteger::limb_t r) -> BigInteger::limb_t { return l & r; });
+}
+
+BigInteger operator|(const BigInteger& lhs, const BigInteger& rhs) noexcept(false) {
+  return BigInteger::bitwise(lhs, rhs, [](BigInteger::limb_t l, BigInteger::limb_t r) -> BigInteger::limb_t { return l | r; });
+}
+
+BigInteger operator^(const BigInteger& lhs, const BigInteger& rhs) noexcept(false) {
+  return BigInteger::bitwise(lhs, rhs, [](BigInteger::limb_t l, BigInteger::limb_t r) -> BigInteger::limb_t { return l ^ r; });
+}
+
+std::strong_ordering operator<=>(const BigInteger& lhs, const BigInteger& rhs) noexcept(true) {
+  if (lhs.negative_ != rhs.negative_) {
+    return lhs.negative_ ? std::strong_ordering::less : std::strong_ordering::greater;
+  }
+  const int magnitude = compare_magnitudes(lhs.magnitude_, rhs.magnitude_);
+  const int order = lhs.negative_ ? -magnitude : magnitude;
+  return order < 0 ? std::strong_ordering::less : order > 0 ? std::strong_ordering::greater : std::strong_ordering::equal;
+}
+
+void BigInteger::normalize() noexcept(true) {
+  trim(magnitude_);
+  if (magnitude_.empty()) {
+    negative_ = false;
+  }
+}
+
+}// namespace ast
@@ -27,4 +27,29 @@ token_t Binary::type() const noexcept(true) {
   return type_;
 }
 
+quickening_t Binary::quickening() const noexcept(true) {
+  return quickening_;
+}
+
+boost::local_shared_ptr<Object> Binary::call_handler(const boost::local_shared_ptr<Object>& lhs, const boost::local_shared_ptr<Object>& rhs) noexcept(false) {
+  return handler_(lhs, rhs, result_);
+}
+
+bool Binary::guards(type_t lhs_type, type_t rhs_type) const noexcept(true) {
+  return lhs_type == lhs_guard_ && rhs_type == rhs_guard_;
+}
+
+void Binary::quicken(handler_t quickened, type_t lhs_type, type_t rhs_type) noexcept(true) {
+  quickening_ = quickening_t::QUICKENED;
+  handler_ = quickened;
+  lhs_guard_ = lhs_type;
+  rhs_guard_ = rhs_type;
+}
+
+void Binary::deoptimize() noexcept(true) {
+  quickening_ = quickening_t::GENERIC;
+  handler_ = nullptr;
+  result_ = nullptr;
+}
+
 }// namespace ast
@@ -0,0 +1,406 @@
+#include "../../include/ast/flat_tree.hpp"
+
+#include "../../include/ast/big_integer.hpp"
+
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+/// Tag of node is the number of its type_t bit, 0 stands for absent node.
+constexpr uint8_t null_tag = 0;
+
+/// Operator byte of integer node, that keeps bignum in string table.
+constexpr uint8_t big_integer_flag = 1;
+
+uint8_t tag_of(ast::type_t type) noexcept(true) {
+  return static_cast<uint8_t>(std::countr_zero(static_cast<uint32_t>(type)));
+}
+
+/// Image starts with sizes of all arrays. Arrays follow in order of decreasing
+/// element size, so every array is naturally aligned inside 8-byte aligned image.
+struct ImageHeader {
+  uint64_t nodes;
+  uint64_t integers;
+  uint64_t floats;
+  uint64_t strings;
+  uint64_t characters;
+};
+
+template <typename T>
+void append(std::string& image, const std::vector<T>& array) noexcept(false) {
+  image.append(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(T));
+}
+
+template <typename Container>
+void extract(std::string_view& image, Container& array, uint64_t size) noexcept(false) {
+  using T = typename Container::value_type;
+  if (size > image.size() / sizeof(T)) {
+    throw std::runtime_error("Unexpected end of image");
+  }
+  array.resize(size);
+  std::memcpy(array.data(), image.data(), size * sizeof(T));
+  image.remove_prefix(size * sizeof(T));
+}
+
+ast::inferred_t inferred_type_of(const ast::Object& node) noexcept(true) {
+  // clang-format off
+  switch (node.ast_type()) {
+    case ast::type_t::SYMBOL: { return static_cast<const ast::Symbol&>(node).inferred_type(); }
+    case ast::type_t::UNARY: { return static_cast<const ast::Unary&>(node).inferred_type(); }
+    case ast::type_t::BINARY: { return static_cast<const ast::Binary&>(node).inferred_type(); }
+    case ast::type_t::WHILE: { return static_cast<const ast::While&>(node).inferred_type(); }
+    case ast::type_t::FOR: { return static_cast<const ast::For&>(node).inferred_type(); }
+    default: { return ast::inferred_t::UNKNOWN; }
+  }
+  // clang-format on
+}
+
+template <typename T>
+boost::local_shared_ptr<T> annotated(boost::local_shared_ptr<T> node, ast::inferred_t type) noexcept(true) {
+  node->set_inferred_type(type);
+  return node;
+}
+
+}// namespace
+
+namespace ast {
+
+FlatTree FlatTree::flatten(const RootObject& root) noexcept(false) {
+  FlatTree tree;
+  tree.flatten_nodes(root.get());
+  return tree;
+}
+
+boost::local_shared_ptr<RootObject> FlatTree::materialize() const noexcept(false) {
+  auto root = boost::make_local_shared<RootObject>();
+  for (index_t node : roots()) {
+    root->add(materialize_node(node));
+  }
+  return root;
+}
+
+std::string FlatTree::image() const noexcept(false) {
+  const ImageHeader header{kinds_.size(), integers_.size(), floats_.size(), string_offsets_.size() - 1, characters_.size()};
+  std::string image(reinterpret_cast<const char*>(&header), sizeof(header));
+  append(image, integers_);
+  append(image, floats_);
+  append(image, ends_);
+  append(image, payloads_);
+  append(image, string_offsets_);
+  append(image, kinds_);
+  append(image, operators_);
+  append(image, inferred_types_);
+  image.append(characters_);
+  return image;
+}
+
+FlatTree FlatTree::from_image(std::string_view image) noexcept(false) {
+  ImageHeader header{};
+  if (image.size() < sizeof(header)) {
+    throw std::runtime_error("Unexpected end of image");
+  }
+  std::memcpy(&header, image.data(), sizeof(header));
+  image.remove_prefix(sizeof(header));
+  if (header.nodes >= std::numeric_limits<index_t>::max() || header.strings >= std::numeric_limits<index_t>::max()) {
+    throw std::runtime_error("Image is too large");
+  }
+
+  FlatTree tree;
+  extract(image, tree.integers_, header.integers);
+  extract(image, tree.floats_, header.floats);
+  extract(image, tree.ends_, header.nodes);
+  extract(image, tree.payloads_, header.nodes);
+  extract(image, tree.string_offsets_, header.strings + 1);
+  extract(image, tree.kinds_, header.nodes);
+  extract(image, tree.operators_, header.nodes);
+  extract(image, tree.inferred_types_, header.nodes);
+  extract(image, tree.characters_, header.characters);
+  if (!image.empty()) {
+    throw std::runtime_error("Trailing data in image");
+  }
+  tree.validate();
+  return tree;
+}
+
+FlatTree::index_t FlatTree::add_node(type_t kind, token_t op, index_t payload) noexcept(false) {
+  const auto node = static_cast<index_t>(kinds_.size());
+  kinds_.push_back(kind == type_t{0} ? null_tag : tag_of(kind));
+  operators_.push_back(static_cast<uint8_t>(op));
+  inferred_types_.push_back(static_cast<uint8_t>(inferred_t::UNKNOWN));
+  ends_.push_back(node + 1);
+  payloads_.push_back(payload);
+  return node;
+}
+
+FlatTree::index_t FlatTree::add_string(std::string_view string) noexcept(false) {
+  const auto id = static_cast<index_t>(string_offsets_.size() - 1);
+  characters_.append(string);
+  string_offsets_.push_back(static_cast<index_t>(characters_.size()));
+  return id;
+}
+
+void FlatTree::flatten_nodes(const std::vector<boost::local_shared_ptr<Object>>& nodes) noexcept(false) {
+  for (const auto& node : nodes) {
+    flatten_node(node);
+  }
+}
+
+void FlatTree::flatten_node(const boost::local_shared_ptr<Object>& node) noexcept(false) {
+  if (!node) {
+    add_node(type_t{0}, token_t{}, 0);
+    return;
+  }
+  const type_t type = node->ast_type();
+  index_t index = 0;
+  // clang-format off
+  switch (type) {
+    case type_t::INTEGER: {
+      const auto& integer = static_cast<const Integer&>(*node);
+      if (integer.is_big()) {
+        index = add_node(type, token_t{}, add_string(integer.to_string()));
+        operators_[index] = big_integer_flag;
+        break;
+      }
+      index = add_node(type, token_t{}, static_cast<index_t>(integers_.size()));
+      integers_.push_back(integer.value());
+      break;
+    }
+    case type_t::FLOAT: {
+      index = add_node(type, token_t{}, static_cast<index_t>(floats_.size()));
+      floats_.push_back(static_cast<const Float&>(*node).value());
+      break;
+    }
+    case type_t::STRING: { index = add_node(type, token_t{}, add_string(static_cast<const String&>(*node).value())); break; }
+    case type_t::SYMBOL: { index = add_node(type, token_t{}, add_string(static_cast<const Symbol&>(*node).name())); break; }
+    case type_t::ARRAY: { index = add_node(type, token_t{}, 0); flatten_nodes(static_cast<const Array&>(*node).elements()); break; }
+    case type_t::BLOCK: { index = add_node(type, token_t{}, 0); flatten_nodes(static_cast<const Block&>(*node).statements()); break; }
+    // clang-format on
+    case type_t::UNARY: {
+      const auto& unary = static_cast<const Unary&>(*node);
+      index = add_node(type, unary.type(), 0);
+      flatten_node(unary.operand());
+      break;
+    }
+    case type_t::BINARY: {
+      const auto& binary = static_cast<const Binary&>(*node);
+      index = add_node(type, binary.type(), 0);
+      flatten_node(binary.lhs());
+      flatten_node(binary.rhs());
+      break;
+    }
+    case type_t::WHILE: {
+      const auto& while_ = static_cast<const While&>(*node);
+      index = add_node(type, token_t{}, 0);
+      flatten_node(while_.exit_condition());
+      flatten_node(while_.body());
+      break;
+    }
+    case type_t::FOR: {
+      const auto& for_ = static_cast<const For&>(*node);
+      index = add_node(type, token_t{}, 0);
+      flatten_node(for_.loop_init());
+      flatten_node(for_.exit_condition());
+      flatten_node(for_.increment());
+      flatten_node(for_.body());
+      break;
+    }
+    case type_t::IF: {
+      const auto& if_ = static_cast<const If&>(*node);
+      index = add_node(type, token_t{}, 0);
+      flatten_node(if_.condition());
+      flatten_node(if_.body());
+      flatten_node(if_.else_body());
+      break;
+    }
+    case type_t::LAMBDA: {
+      const auto& lambda = static_cast<const Lambda&>(*node);
+      index = add_node(type, token_t{}, add_string(lambda.name()));
+      flatten_nodes(lambda.arguments());
+      flatten_node(lambda.body());
+      break;
+    }
+    case type_t::LAMBDA_CALL: {
+      const auto& call = static_cast<const LambdaCall&>(*node);
+      index = add_node(type, token_t{}, add_string(call.name()));
+      flatten_nodes(call.arguments());
+      break;
+    }
+    case type_t::TYPE_CREATOR: {
+      const auto& creator = static_cast<const TypeCreator&>(*node);
+      index = add_node(type, token_t{}, add_string(creator.name()));
+      flatten_nodes(creator.arguments());
+      break;
+    }
+    case type_t::TYPE_DEFINITION: {
+      const auto& definition = static_cast<const TypeDefinition&>(*node);
+      index = add_node(type, token_t{}, add_string(definition.name()));
+      for (const auto& field : definition.fields()) {
+        add_node(type_t::SYMBOL, token_t{}, add_string(field));
+      }
+      break;
+    }
+    case type_t::TYPE_FIELD: {
+      const auto& field = static_cast<const TypeFieldOperator&>(*node);
+      index = add_node(type, token_t{}, add_string(field.name()));
+      add_string(field.field());
+      break;
+    }
+    default: {
+      throw std::runtime_error("Node can't be flattened");
+    }
+  }
+  ends_[index] = size();
+  inferred_types_[index] = static_cast<uint8_t>(inferred_type_of(*node));
+}
+
+std::vector<boost::local_shared_ptr<Object>> FlatTree::materialize_children(index_t node, index_t last) const noexcept(false) {
+  std::vector<boost::local_shared_ptr<Object>> children;
+  for (; node != last; node = ends_[node]) {
+    children.push_back(materialize_node(node));
+  }
+  return children;
+}
+
+boost::local_shared_ptr<Block> FlatTree::materialize_block(index_t node) const noexcept(false) {
+  return boost::static_pointer_cast<Block>(materialize_node(node));
+}
+
+boost::local_shared_ptr<Object> FlatTree::materialize_node(index_t node) const noexcept(false) {
+  if (is_null(node)) {
+    return nullptr;
+  }
+  // clang-format off
+  switch (kind(node)) {
+    case type_t::INTEGER: { return is_big_integer(node) ? boost::make_local_shared<Integer>(string(node)) : boost::make_local_shared<Integer>(integer(node)); }
+    case type_t::FLOAT: { return boost::make_local_shared<Float>(floating(node)); }
+    case type_t::STRING: { return boost::make_local_shared<String>(std::string(string(node))); }
+    case type_t::SYMBOL: { return annotated(boost::make_local_shared<Symbol>(std::string(string(node))), inferred_type(node)); }
+    case type_t::ARRAY: { return boost::make_local_shared<Array>(materialize_children(node + 1, ends_[node])); }
+    case type_t::BLOCK: { return boost::make_local_shared<Block>(materialize_children(node + 1, ends_[node])); }
+    case type_t::UNARY: { return annotated(boost::make_local_shared<Unary>(op(node), materialize_node(child(node, 0))), inferred_type(node)); }
+    case type_t::BINARY: { return annotated(boost::make_local_shared<Binary>(op(node), materialize_node(child(node, 0)), materialize_node(child(node, 1))), inferred_type(node)); }
+    case type_t::WHILE: { return annotated(boost::make_local_shared<While>(materialize_node(child(node, 0)), materialize_block(child(node, 1))), inferred_type(node)); }
+    // clang-format on
+    case type_t::FOR: {
+      auto for_ = boost::make_local_shared<For>();
+      for_->set_init(materialize_node(child(node, 0)));
+      for_->set_exit_condition(materialize_node(child(node, 1)));
+      for_->set_increment(materialize_node(child(node, 2)));
+      for_->set_body(materialize_block(child(node, 3)));
+      for_->set_inferred_type(inferred_type(node));
+      return for_;
+    }
+    case type_t::IF: {
+      return boost::make_local_shared<If>(materialize_node(child(node, 0)), materialize_block(child(node, 1)), materialize_block(child(node, 2)));
+    }
+    case type_t::LAMBDA: {
+      /// Body is the last child, all before it are arguments.
+      index_t body = node + 1;
+      while (ends_[body] != ends_[node]) {
+        body = ends_[body];
+      }
+      return boost::make_local_shared<Lambda>(std::string(string(node)), materialize_children(node + 1, body), materialize_block(body));
+    }
+    case type_t::LAMBDA_CALL: {
+      return boost::make_local_shared<LambdaCall>(std::string(string(node)), materialize_children(node + 1, ends_[node]));
+    }
+    case type_t::TYPE_CREATOR: {
+      return boost::make_local_shared<TypeCreator>(std::string(string(node)), materialize_children(node + 1, ends_[node]));
+    }
+    case type_t::TYPE_DEFINITION: {
+      std::vector<std::string> fields;
+      for (index_t field : children(node)) {
+        fields.emplace_back(string(field));
+      }
+      return boost::make_local_shared<TypeDefinition>(std::string(string(node)), std::move(fields));
+    }
+    case type_t::TYPE_FIELD: {
+      return boost::make_local_shared<TypeFieldOperator>(std::string(string(node, 0)), std::string(string(node, 1)));
+    }
+    default: {
+      throw std::runtime_error("Unknown node tag");
+    }
+  }
+}
+
+void FlatTree::validate() const noexcept(false) {
+  const index_t strings = static_cast<index_t>(string_offsets_.size() - 1);
+  if (string_offsets_.front() != 0 || string_offsets_.back() != characters_.size()) {
+    throw std::runtime_error("Broken string table");
+  }
+  for (index_t i = 0; i < strings; ++i) {
+    if (string_offsets_[i] > string_offsets_[i + 1]) {
+      throw std::runtime_error("Broken string table");
+    }
+  }
+
+  /// Every subtree must lie inside its parent's subtree.
+  std::vector<index_t> parent_ends{size()};
+  for (index_t node = 0; node < size(); ++node) {
+    while (node >= parent_ends.back()) {
+      parent_ends.pop_back();
+    }
+    if (ends_[node] <= node || ends_[node] > parent_ends.back()) {
+      throw std::runtime_error("Broken tree structure");
+    }
+    parent_ends.push_back(ends_[node]);
+  }
+
+  auto require = [](bool condition) {
+    if (!condition) {
+      throw std::runtime_error("Broken tree structure");
+    }
+  };
+  auto is_block = [this](index_t node) { return kind(node) == type_t::BLOCK; };
+  auto is_leaf = [this](index_t node) { return ends_[node] == node + 1; };
+
+  for (index_t node = 0; node < size(); ++node) {
+    if (kinds_[node] >= 32) {
+      throw std::runtime_error("Unknown node tag");
+    }
+    if (inferred_types_[node] > static_cast<uint8_t>(inferred_t::OBJECT)) {
+      throw std::runtime_error("Unknown inferred type");
+    }
+    if (is_null(node)) {
+      require(is_leaf(node));
+      continue;
+    }
+    const size_t count = children_count(node);
+    // clang-format off
+    switch (kind(node)) {
+      case type_t::INTEGER: {
+        require(is_leaf(node) && payloads_[node] < (is_big_integer(node) ? strings : integers_.size()));
+        require(!is_big_integer(node) || BigInteger::parse(string(node)).has_value());
+        break;
+      }
+      case type_t::FLOAT: { require(is_leaf(node) && payloads_[node] < floats_.size()); break; }
+      case type_t::STRING:
+      case type_t::SYMBOL: { require(is_leaf(node) && payloads_[node] < strings); break; }
+      case type_t::ARRAY:
+      case type_t::BLOCK: { break; }
+      case type_t::UNARY: { require(count == 1); break; }
+      case type_t::BINARY: { require(count == 2); break; }
+      case type_t::WHILE: { require(count == 2 && is_block(child(node, 1))); break; }
+      case type_t::FOR: { require(count == 4 && is_block(child(node, 3))); break; }
+      case type_t::IF: { require(count == 3 && is_block(child(node, 1)) && (is_null(child(node, 2)) || is_block(child(node, 2)))); break; }
+      case type_t::LAMBDA: { require(count >= 1 && payloads_[node] < strings && is_block(child(node, count - 1))); break; }
+      case type_t::LAMBDA_CALL:
+      case type_t::TYPE_CREATOR: { require(payloads_[node] < strings); break; }
+      case type_t::TYPE_DEFINITION: {
+        require(payloads_[node] < strings);
+        for (index_t field : children(node)) {
+          require(kind(field) == type_t::SYMBOL);
+        }
+        break;
+      }
+      case type_t::TYPE_FIELD: { require(is_leaf(node) && strings > 0 && payloads_[node] < strings - 1); break; }
+      default: { throw std::runtime_error("Unknown node tag"); }
+    }
+    // clang-format on
+  }
+}
+
+}// namespace ast
@@ -11,6 +11,10 @@ If::If(boost::local_shared_ptr<Object> exit_condition, boost::local_shared_ptr<B
   , body_(std::move(body))
   , else_body_(std::move(else_body)) {}
 
+boost::local_shared_ptr<Object>& If::condition() noexcept(true) {
+  return exit_condition_;
+}
+
 const boost::local_shared_ptr<Object>& If::condition() const noexcept(true) {
   return exit_condition_;
 }
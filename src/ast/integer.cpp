@@ -1,19 +1,79 @@
 #include "../../include/ast/ast.hpp"
+#include "../../include/ast/big_integer.hpp"
+
+#include <charconv>
+#include <stdexcept>
 
 namespace ast {
 
 Integer::Integer(std::string_view data) noexcept(false)
-  : data_(std::stoi(data.data())) {}
+  : data_(0) {
+  const auto [end, error] = std::from_chars(data.data(), data.data() + data.size(), data_);
+  if (error == std::errc::result_out_of_range) {
+    if (auto big = BigInteger::parse(data)) {
+      assign(std::move(*big));
+      return;
+    }
+  }
+  if (error != std::errc() || end == data.data()) {
+    throw std::invalid_argument("Integer expected: " + std::string(data));
+  }
+}
 
-Integer::Integer(size_t data) noexcept(true)
+Integer::Integer(int64_t data) noexcept(true)
   : data_(data) {}
 
-size_t& Integer::value() noexcept(true) {
+Integer::Integer(BigInteger data) noexcept(false)
+  : data_(0) {
+  assign(std::move(data));
+}
+
+Integer::Integer(const Integer& other) noexcept(false)
+  : Object(other)
+  , data_(other.data_)
+  , big_(other.big_ ? std::make_unique<const BigInteger>(*other.big_) : nullptr) {}
+
+Integer& Integer::operator=(const Integer& other) noexcept(false) {
+  if (this != &other) {
+    other.big_ ? assign(*other.big_) : assign(other.data_);
+  }
+  return *this;
+}
+
+Integer::~Integer() noexcept(true) = default;
+
+int64_t& Integer::value() noexcept(true) {
   return data_;
 }
 
-const size_t& Integer::value() const noexcept(true) {
+const int64_t& Integer::value() const noexcept(true) {
   return data_;
 }
 
+const BigInteger& Integer::big() const noexcept(true) {
+  return *big_;
+}
+
+BigInteger Integer::to_big() const noexcept(false) {
+  return big_ ? *big_ : BigInteger(data_);
+}
+
+void Integer::assign(int64_t data) noexcept(true) {
+  data_ = data;
+  big_.reset();
+}
+
+void Integer::assign(BigInteger data) noexcept(false) {
+  if (data.fits_int64()) {
+    assign(data.to_int64());
+  } else {
+    big_ = std::make_unique<const BigInteger>(std::move(data));
+    data_ = big_value;
+  }
+}
+
+std::string Integer::to_string() const noexcept(false) {
+  return big_ ? big_->to_string() : std::to_string(data_);
+}
+
 }// namespace ast
@@ -9,6 +9,11 @@ Lambda::Lambda(std::string name, std::vector<boost::local_shared_ptr<Object>> ar
   , arguments_(std::move(arguments))
   , body_(std::move(body)) {}
 
+Lambda::Lambda(std::string name, std::vector<boost::local_shared_ptr<Object>> arguments, body_parser_t body_parser) noexcept(true)
+  : name_(std::move(name))
+  , arguments_(std::move(arguments))
+  , body_parser_(std::move(body_parser)) {}
+
 std::string Lambda::name() const noexcept(true) {
   return name_;
 }
@@ -21,4 +26,38 @@ const boost::local_shared_ptr<Block>& Lambda::body() const noexcept(true) {
   return body_;
 }
 
+bool Lambda::is_lazy() const noexcept(true) {
+  return !body_;
+}
+
+boost::local_shared_ptr<Block> Lambda::parse_body() const noexcept(false) {
+  return body_parser_();
+}
+
+void Lambda::set_body(boost::local_shared_ptr<Block> body) noexcept(true) {
+  body_ = std::move(body);
+  /// Parsed body doesn't need tokens anymore.
+  body_parser_ = nullptr;
+}
+
+bool Lambda::is_bound() const noexcept(true) {
+  return frame_size_.has_value();
+}
+
+uint32_t Lambda::frame_size() const noexcept(true) {
+  return frame_size_.value_or(0);
+}
+
+void Lambda::bind(uint32_t frame_size) noexcept(true) {
+  frame_size_ = frame_size;
+}
+
+bool Lambda::is_pure() const noexcept(true) {
+  return pure_;
+}
+
+void Lambda::set_pure(bool pure) noexcept(true) {
+  pure_ = pure;
+}
+
 }// namespace ast
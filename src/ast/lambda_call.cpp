@@ -10,8 +10,38 @@ const std::string& LambdaCall::name() const noexcept(true) {
   return name_;
 }
 
+std::vector<boost::local_shared_ptr<Object>>& LambdaCall::arguments() noexcept(true) {
+  return arguments_;
+}
+
 const std::vector<boost::local_shared_ptr<Object>>& LambdaCall::arguments() const noexcept(true) {
   return arguments_;
 }
 
+LambdaCall::target_t LambdaCall::target() const noexcept(true) {
+  return target_;
+}
+
+const LambdaCall::builtin_t& LambdaCall::builtin() const noexcept(true) {
+  return *builtin_;
+}
+
+Lambda& LambdaCall::lambda() const noexcept(true) {
+  return *lambda_;
+}
+
+void LambdaCall::bind(const builtin_t& builtin) noexcept(true) {
+  target_ = target_t::BUILTIN;
+  builtin_ = &builtin;
+}
+
+void LambdaCall::bind(Lambda& lambda) noexcept(true) {
+  target_ = target_t::LAMBDA;
+  lambda_ = &lambda;
+}
+
+void LambdaCall::bind_variable() noexcept(true) {
+  target_ = target_t::VARIABLE;
+}
+
 }// namespace ast
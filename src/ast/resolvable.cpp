@@ -0,0 +1,22 @@
+#include "../../include/ast/ast.hpp"
+
+namespace ast {
+
+scope_t Resolvable::scope() const noexcept(true) {
+  return scope_;
+}
+
+uint32_t Resolvable::slot() const noexcept(true) {
+  return slot_;
+}
+
+bool Resolvable::in_frame() const noexcept(true) {
+  return scope_ == scope_t::PARAMETER || scope_ == scope_t::LOCAL;
+}
+
+void Resolvable::resolve(scope_t scope, uint32_t slot) noexcept(true) {
+  scope_ = scope;
+  slot_ = slot;
+}
+
+}// namespace ast
@@ -10,6 +10,10 @@ const std::string& TypeCreator::name() const noexcept(true) {
   return name_;
 }
 
+std::vector<boost::local_shared_ptr<Object>>& TypeCreator::arguments() noexcept(true) {
+  return arguments_;
+}
+
 const std::vector<boost::local_shared_ptr<Object>>& TypeCreator::arguments() const noexcept(true) {
   return arguments_;
 }
@@ -8,6 +8,10 @@ While::While(boost::local_shared_ptr<Object> exit_condition, boost::local_shared
   : exit_condition_(std::move(exit_condition))
   , block_(std::move(block)) {}
 
+boost::local_shared_ptr<Object>& While::exit_condition() noexcept(true) {
+  return exit_condition_;
+}
+
 const boost::local_shared_ptr<Object>& While::exit_condition() const noexcept(true) {
   return exit_condition_;
 }
@@ -0,0 +1,221 @@
+#include "../../include/cache/program_cache.hpp"
+
+#include "../../include/ast/flat_tree.hpp"
+#include "../../include/fnv1a.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+/// Must be incremented on every change of entry layout or tree image.
+constexpr uint32_t format_version = 5;
+
+constexpr char magic[8] = {'W', 'E', 'A', 'K', 'P', 'R', 'O', 'G'};
+
+/// Fixed part of entry. It is followed by sources list (hash, path size, path)
+/// and by program image. All fields are read with memcpy, so they may be unaligned.
+struct Header {
+  char magic[8];
+  uint32_t format_version;
+  uint32_t sources_count;
+  uint64_t build_id;
+  uint64_t variant_hash;
+  uint64_t sources_size;
+  uint64_t payload_size;
+  uint64_t payload_hash;
+};
+
+/// @return identifier, that changes with every rebuild of the interpreter
+uint64_t build_id() noexcept(true) {
+  static const uint64_t id = [] {
+    uint64_t hash = fnv1a::create(std::string_view(reinterpret_cast<const char*>(&format_version), sizeof(format_version)));
+    struct stat executable {};
+    if (::stat("/proc/self/exe", &executable) == 0) {
+      const uint64_t stamp[] = {static_cast<uint64_t>(executable.st_size), static_cast<uint64_t>(executable.st_mtim.tv_sec), static_cast<uint64_t>(executable.st_mtim.tv_nsec)};
+      return fnv1a::create(std::string_view(reinterpret_cast<const char*>(stamp), sizeof(stamp)), hash);
+    }
+    return fnv1a::create(__DATE__ " " __TIME__, hash);
+  }();
+  return id;
+}
+
+std::string canonical_path(std::string_view filename) noexcept(false) {
+  return std::filesystem::weakly_canonical(std::filesystem::absolute(filename)).string();
+}
+
+template <typename T>
+void append(std::string& output, T value) noexcept(false) {
+  output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+class MappedFile {
+public:
+  explicit MappedFile(const std::filesystem::path& path) noexcept(true) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    struct stat file {};
+    if (::fstat(fd, &file) == 0 && file.st_size > 0) {
+      void* data = ::mmap(nullptr, static_cast<size_t>(file.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = data;
+        size_ = static_cast<size_t>(file.st_size);
+      }
+    }
+    ::close(fd);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile() noexcept(true) {
+    if (data_) {
+      ::munmap(data_, size_);
+    }
+  }
+
+  std::string_view view() const noexcept(true) {
+    return data_ ? std::string_view(static_cast<const char*>(data_), size_) : std::string_view();
+  }
+
+private:
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}// namespace
+
+ProgramCache::ProgramCache(std::filesystem::path directory) noexcept(true)
+  : directory_(std::move(directory)) {}
+
+std::filesystem::path ProgramCache::default_directory() noexcept(false) {
+  if (const char* xdg_cache = std::getenv("XDG_CACHE_HOME"); xdg_cache && *xdg_cache) {
+    return std::filesystem::path(xdg_cache) / "weak_language";
+  }
+  if (const char* home = std::getenv("HOME"); home && *home) {
+    return std::filesystem::path(home) / ".cache" / "weak_language";
+  }
+  return std::filesystem::temp_directory_path() / "weak_language";
+}
+
+uint64_t ProgramCache::hash_file(const std::string& path) noexcept(true) {
+  const MappedFile file(path);
+  const std::string_view contents = file.view();
+  if (contents.empty()) {
+    /// Empty file cannot be mapped, but it still can be read.
+    std::error_code error;
+    return std::filesystem::is_regular_file(path, error) ? fnv1a::create("") : 0;
+  }
+  return fnv1a::create(contents);
+}
+
+std::filesystem::path ProgramCache::entry_path(std::string_view filename, std::string_view variant) const noexcept(false) {
+  std::ostringstream name;
+  name << std::hex << fnv1a::create(variant, fnv1a::create(canonical_path(filename))) << ".wlc";
+  return directory_ / name.str();
+}
+
+boost::local_shared_ptr<ast::RootObject> ProgramCache::load(std::string_view filename, std::string_view variant) const noexcept(true) {
+  try {
+    const MappedFile file(entry_path(filename, variant));
+    std::string_view data = file.view();
+
+    Header header;
+    if (data.size() < sizeof(header)) {
+      return nullptr;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    data.remove_prefix(sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.format_version != format_version || header.build_id != build_id() || header.variant_hash != fnv1a::create(variant)) {
+      return nullptr;
+    }
+    if (data.size() != header.sources_size + header.payload_size || header.sources_count == 0) {
+      return nullptr;
+    }
+
+    std::string_view sources = data.substr(0, header.sources_size);
+    std::string_view last_path;
+    for (uint32_t i = 0; i < header.sources_count; ++i) {
+      uint64_t hash;
+      uint64_t path_size;
+      if (sources.size() < sizeof(hash) + sizeof(path_size)) {
+        return nullptr;
+      }
+      std::memcpy(&hash, sources.data(), sizeof(hash));
+      std::memcpy(&path_size, sources.data() + sizeof(hash), sizeof(path_size));
+      sources.remove_prefix(sizeof(hash) + sizeof(path_size));
+      if (sources.size() < path_size) {
+        return nullptr;
+      }
+      last_path = sources.substr(0, path_size);
+      sources.remove_prefix(path_size);
+      if (hash_file(std::string(last_path)) != hash) {
+        return nullptr;
+      }
+    }
+    if (last_path != canonical_path(filename)) {
+      return nullptr;
+    }
+
+    const std::string_view payload = data.substr(header.sources_size);
+    if (fnv1a::create(payload) != header.payload_hash) {
+      return nullptr;
+    }
+    return ast::FlatTree::from_image(payload).materialize();
+  } catch (std::exception&) {
+    return nullptr;
+  }
+}
+
+void ProgramCache::store(std::string_view filename, const std::vector<Source>& sources, const ast::RootObject& program, std::string_view variant) const noexcept(true) {
+  static std::atomic<uint64_t> temporaries_count{0};
+  std::filesystem::path temporary;
+  try {
+    std::string sources_image;
+    for (const Source& source : sources) {
+      append<uint64_t>(sources_image, source.hash);
+      append<uint64_t>(sources_image, source.path.size());
+      sources_image += source.path;
+    }
+    const std::string payload = ast::FlatTree::flatten(program).image();
+
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.format_version = format_version;
+    header.sources_count = static_cast<uint32_t>(sources.size());
+    header.build_id = build_id();
+    header.variant_hash = fnv1a::create(variant);
+    header.sources_size = sources_image.size();
+    header.payload_size = payload.size();
+    header.payload_hash = fnv1a::create(payload);
+
+    std::filesystem::create_directories(directory_);
+    const std::filesystem::path entry = entry_path(filename, variant);
+    temporary = entry;
+    temporary += ".tmp." + std::to_string(::getpid()) + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + "." + std::to_string(temporaries_count++);
+    {
+      std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+      output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      output << sources_image << payload;
+      output.close();
+      if (!output) {
+        throw std::runtime_error("Cannot write cache entry");
+      }
+    }
+    std::filesystem::rename(temporary, entry);
+  } catch (std::exception&) {
+    if (!temporary.empty()) {
+      std::error_code error;
+      std::filesystem::remove(temporary, error);
+    }
+  }
+}
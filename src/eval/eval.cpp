@@ -1,8 +1,10 @@
 #include "../../include/eval/eval.hpp"
 
+#include "../../include/common_defs.hpp"
 #include "../../include/cut_last_iterator.hpp"
 #include "../../include/eval/implementation/binary.hpp"
 #include "../../include/eval/implementation/unary.hpp"
+#include "../../include/semantic/semantic_analyzer.hpp"
 #include "../../include/std/builtins.hpp"
 
 #include <boost/range/combine.hpp>
@@ -34,6 +36,31 @@ ALWAYS_INLINE static void do_typecheck(ast::type_t target, ast::type_t expected,
     throw EvalError(error_message);
   }
 }
+/// @return true if value of expression is inferred as integer
+ALWAYS_INLINE static bool is_integer(const ast::Object* expression) noexcept(true) {
+  if (!expression) {
+    return false;
+  }
+  // clang-format off
+  switch (expression->ast_type()) {
+    case ast::type_t::INTEGER: { return true; }
+    case ast::type_t::SYMBOL: { return static_cast<const ast::Symbol*>(expression)->inferred_type() == ast::inferred_t::INTEGER; }
+    case ast::type_t::UNARY: { return static_cast<const ast::Unary*>(expression)->inferred_type() == ast::inferred_t::INTEGER; }
+    case ast::type_t::BINARY: { return static_cast<const ast::Binary*>(expression)->inferred_type() == ast::inferred_t::INTEGER; }
+    default: { return false; }
+  }
+  // clang-format on
+}
+
+/// Bignum is never zero and reads as big_value, so it's true without a test of tag.
+ALWAYS_INLINE static bool is_true(const ast::Integer& condition) noexcept(true) {
+  return condition.value() != 0;
+}
+
+ALWAYS_INLINE static bool is_true(const ast::Float& condition) noexcept(true) {
+  return condition.value() != 0;
+}
+
 /// For some reason this lambda works incorrect with ALWAYS_INLINE specifier
 static bool add_lambda(const boost::local_shared_ptr<ast::Object>& object, Storage& storage) noexcept(false) {
   if (const auto lambda = boost::dynamic_pointer_cast<ast::Lambda>(object)) {
@@ -43,6 +70,58 @@ static bool add_lambda(const boost::local_shared_ptr<ast::Object>& object, Stora
   return false;
 }
 
+/// Frame of bound lambda call, released even if exception was thrown.
+class FrameGuard {
+public:
+  FrameGuard(std::vector<boost::local_shared_ptr<ast::Object>>& frames, size_t& frame_base, size_t frame_size) noexcept(false)
+    : frames_(frames)
+    , frame_base_(frame_base)
+    , caller_frame_base_(frame_base) {
+    frame_base_ = frames_.size();
+    frames_.resize(frames_.size() + frame_size);
+  }
+
+  FrameGuard(const FrameGuard&) = delete;
+  FrameGuard& operator=(const FrameGuard&) = delete;
+
+  ~FrameGuard() noexcept(true) {
+    frames_.resize(frame_base_);
+    frame_base_ = caller_frame_base_;
+  }
+
+private:
+  std::vector<boost::local_shared_ptr<ast::Object>>& frames_;
+  size_t& frame_base_;
+  size_t caller_frame_base_;
+};
+
+/// Profile of running lambda, restored to profile of caller even if exception was thrown.
+class ProfileGuard {
+public:
+  ProfileGuard(Tiering::Profile*& current, Tiering::Profile* profile) noexcept(true)
+    : current_(current)
+    , caller_(current) {
+    current_ = profile;
+  }
+
+  ProfileGuard(const ProfileGuard&) = delete;
+  ProfileGuard& operator=(const ProfileGuard&) = delete;
+
+  ~ProfileGuard() noexcept(true) {
+    current_ = caller_;
+  }
+
+private:
+  Tiering::Profile*& current_;
+  Tiering::Profile* caller_;
+};
+
+ALWAYS_INLINE static void count_back_edge(std::optional<Tiering>& tiering, Tiering::Profile* profile) noexcept(false) {
+  if (profile) {
+    tiering->count_back_edge(*profile);
+  }
+}
+
 Evaluator::Evaluator(const boost::local_shared_ptr<ast::RootObject>& program) noexcept(false) {
   for (const auto& stmt : program->get()) {
     expressions_.emplace_back(stmt);
@@ -59,8 +138,49 @@ void Evaluator::eval() noexcept(false) {
   call_lambda("main", {});
 }
 
+boost::local_shared_ptr<ast::Object> Evaluator::eval_statement(const boost::local_shared_ptr<ast::Object>& statement) noexcept(false) {
+  if (add_lambda(statement, storage_)) {
+    return nullptr;
+  }
+  if (statement->ast_type() == ast::type_t::TYPE_DEFINITION) {
+    add_type_definition(boost::static_pointer_cast<ast::TypeDefinition>(statement));
+    return nullptr;
+  }
+  const size_t depth = storage_.scope_depth();
+  try {
+    return eval(statement);
+  } catch (...) {
+    /// Failed lambda call leaves its scopes open.
+    while (storage_.scope_depth() > depth) {
+      storage_.scope_end();
+    }
+    throw;
+  }
+}
+
+void Evaluator::enable_memoization(size_t capacity) noexcept(true) {
+  if (capacity == 0) {
+    memo_.reset();
+  } else {
+    memo_.emplace(capacity);
+  }
+}
+
+MemoCache::Stats Evaluator::memo_stats() const noexcept(true) {
+  return memo_ ? memo_->stats() : MemoCache::Stats{};
+}
+
+void Evaluator::enable_tiering(Tiering::Thresholds thresholds) noexcept(true) {
+  tiering_.emplace(thresholds);
+  profile_ = nullptr;
+}
+
+std::vector<Tiering::Event> Evaluator::tier_events() const noexcept(false) {
+  return tiering_ ? tiering_->events() : std::vector<Tiering::Event>{};
+}
+
 void Evaluator::add_type_definition(const boost::local_shared_ptr<ast::TypeDefinition>& definition) noexcept(false) {
-  type_creators_.emplace(definition->name(), [&definition](const std::vector<boost::local_shared_ptr<ast::Object>>& names) {
+  type_creators_.insert_or_assign(definition->name(), [definition](const std::vector<boost::local_shared_ptr<ast::Object>>& names) {
     const auto& type_names = definition->fields();
     if (type_names.size() != names.size()) {
       throw EvalError("new {}: wrong arguments size", definition->name());
@@ -83,7 +203,7 @@ boost::local_shared_ptr<ast::Object> Evaluator::eval_type_creation(const boost::
 boost::local_shared_ptr<ast::Object> Evaluator::eval_type_field_access(const boost::local_shared_ptr<ast::TypeFieldOperator>& type_field) noexcept(false) {
   const auto& name = type_field->name();
   const auto& field = type_field->field();
-  const auto& object = storage_.lookup(name);
+  const auto& object = variable(*type_field, name);
   if (object->ast_type() != ast::type_t::TYPE_OBJECT) {
     throw EvalError("Type object expected");
   }
@@ -99,21 +219,75 @@ boost::local_shared_ptr<ast::Object> Evaluator::eval_type_field_access(const boo
 }
 
 boost::local_shared_ptr<ast::Object> Evaluator::call_lambda(std::string_view name, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false) {
-  auto find_lambda = [this, &name] {
-    const auto& lambda = storage_.lookup(name.data()).get();
-    do_typecheck(lambda, ast::type_t::LAMBDA, "Try to call not a lambda");
-    return static_cast<ast::Lambda*>(lambda);
-  };
+  const auto& lambda = storage_.lookup(name.data()).get();
+  do_typecheck(lambda, ast::type_t::LAMBDA, "Try to call not a lambda");
+  return call_lambda(*static_cast<ast::Lambda*>(lambda), arguments);
+}
+
+boost::local_shared_ptr<ast::Object> Evaluator::call_lambda(ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false) {
+  if (memo_ && lambda.is_pure() && memo_->accepts(lambda)) {
+    if (auto key = MemoCache::key(lambda, arguments)) {
+      if (auto cached = memo_->find(*key)) {
+        return *std::move(cached);
+      }
+      auto result = invoke_lambda(lambda, arguments);
+      memo_->insert(std::move(*key), result);
+      return result;
+    }
+  }
+  return invoke_lambda(lambda, arguments);
+}
+
+void Evaluator::compile_lazy_body(ast::Lambda& lambda) noexcept(false) {
+  auto body = lambda.parse_body();
+  auto statements = boost::make_local_shared<ast::RootObject>();
+  statements->add(body);
+  SemanticAnalyzer semantic_analyzer(statements);
+  semantic_analyzer.analyze();
+  if (!lazy_globals_) {
+    lazy_globals_ = SemanticAnalyzer::lambdas(expressions_);
+  }
+  /// Body is bound as part of other lambda, so failed binding leaves lambda lazy.
+  ast::Lambda compiled(lambda.name(), lambda.arguments(), body);
+  SemanticAnalyzer::bind(compiled, *lazy_globals_);
+  lambda.set_body(std::move(body));
+  lambda.bind(compiled.frame_size());
+}
 
-  const auto lambda = find_lambda();
-  const auto& call_args_names = lambda->arguments();
-  const auto& body = lambda->body()->statements();
+boost::local_shared_ptr<ast::Object> Evaluator::invoke_lambda(ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false) {
+  if (lambda.is_lazy()) {
+    compile_lazy_body(lambda);
+  }
+  if (!tiering_) {
+    return eval_lambda_body(lambda, arguments);
+  }
+  if (!lambda.is_bound()) {
+    ProfileGuard profile(profile_, nullptr);
+    return eval_lambda_body(lambda, arguments);
+  }
+  const auto entry = tiering_->enter(lambda, arguments);
+  ProfileGuard profile(profile_, &entry.profile);
+  return eval_lambda_body(entry.target ? *entry.target : lambda, arguments);
+}
+
+boost::local_shared_ptr<ast::Object> Evaluator::eval_lambda_body(ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false) {
+  const auto& call_args_names = lambda.arguments();
+  const auto& body = lambda.body()->statements();
   if (body.empty()) {
     return {};
   }
   if (call_args_names.size() != arguments.size()) {
     throw EvalError("Wrong arguments size");
   }
+  if (lambda.is_bound()) {
+    FrameGuard frame(frames_, frame_base_, lambda.frame_size());
+    std::copy(arguments.begin(), arguments.end(), frames_.begin() + static_cast<ssize_t>(frame_base_));
+    for (const auto& statement : cut_last(body)) {
+      eval(statement);
+    }
+    auto last_statement = eval(*--body.cend());
+    return is_datatype(last_statement.get()) ? last_statement : nullptr;
+  }
   storage_.scope_begin();
   for (size_t i = 0; i < arguments.size(); ++i) {
     const std::string& argument_name = static_cast<ast::Symbol*>(call_args_names[i].get())->name();
@@ -140,6 +314,23 @@ boost::local_shared_ptr<ast::Object> Evaluator::eval_lambda_call(const boost::lo
     }
   }
   const std::string& name = lambda_call->name();
+  switch (lambda_call->target()) {
+    case ast::LambdaCall::target_t::BUILTIN: {
+      return lambda_call->builtin()(arguments).value_or(nullptr);
+    }
+    case ast::LambdaCall::target_t::LAMBDA: {
+      return call_lambda(lambda_call->lambda(), arguments);
+    }
+    case ast::LambdaCall::target_t::VARIABLE: {
+      /// Copied, since frame slot may move while lambda is called.
+      const auto lambda = variable(*lambda_call, name);
+      do_typecheck(lambda.get(), ast::type_t::LAMBDA, "Try to call not a lambda");
+      return call_lambda(static_cast<ast::Lambda&>(*lambda), arguments);
+    }
+    case ast::LambdaCall::target_t::UNRESOLVED: {
+      break;
+    }
+  }
   if (builtins.contains(name)) {
     if (const auto result = builtins.at(name)(arguments)) {
       return result.value();
@@ -150,6 +341,25 @@ boost::local_shared_ptr<ast::Object> Evaluator::eval_lambda_call(const boost::lo
   return call_lambda(name, arguments);
 }
 
+boost::local_shared_ptr<ast::Object>& Evaluator::variable(const ast::Resolvable& resolvable, const std::string& name) noexcept(false) {
+  if (!resolvable.in_frame()) {
+    return storage_.lookup(name);
+  }
+  auto& value = frames_[frame_base_ + resolvable.slot()];
+  if (!value) {
+    throw EvalError("Variable not found: {}", name);
+  }
+  return value;
+}
+
+void Evaluator::assign(const ast::Symbol& symbol, boost::local_shared_ptr<ast::Object> value) noexcept(false) {
+  if (symbol.in_frame()) {
+    frames_[frame_base_ + symbol.slot()] = std::move(value);
+  } else {
+    storage_.overwrite(symbol.name(), std::move(value));
+  }
+}
+
 void Evaluator::eval_block(const boost::local_shared_ptr<ast::Block>& block) noexcept(false) {
   for (const auto& statement : block->statements()) {
     eval(statement);
@@ -159,34 +369,90 @@ void Evaluator::eval_block(const boost::local_shared_ptr<ast::Block>& block) noe
 boost::local_shared_ptr<ast::Object> Evaluator::eval_binary(const boost::local_shared_ptr<ast::Binary>& binary) noexcept(false) {
   const token_t type = binary->type();
   if (type == token_t::ASSIGN) {
-    const auto variable = boost::static_pointer_cast<ast::Symbol>(binary->lhs());
-    storage_.overwrite(variable->name(), eval(binary->rhs()));
+    const auto symbol = boost::static_pointer_cast<ast::Symbol>(binary->lhs());
+    assign(*symbol, eval(binary->rhs()));
     return binary;
   }
   if (token_traits::is_assign_operator(type)) {
-    const auto variable = boost::static_pointer_cast<ast::Symbol>(binary->lhs());
-    storage_.push(
-        variable->name(),
-        eval_context::assign_binary_implementation(type, storage_.lookup(variable->name()), eval(binary->rhs())));
-    return variable;
+    if (const auto& variable_symbol = static_cast<const ast::Symbol&>(*binary->lhs()); variable_symbol.in_frame() && variable_symbol.inferred_type() == ast::inferred_t::INTEGER && is_integer(binary->rhs().get())) {
+      /// Integer is changed in place, as assign_binary_implementation() does, without allocation.
+      const int64_t rhs = eval_integer(binary->rhs());
+      const auto& value = variable(variable_symbol, variable_symbol.name());
+      do_typecheck(value->ast_type(), ast::type_t::INTEGER, "Invalid binary operands");
+      auto& lhs = static_cast<ast::Integer&>(*value);
+      if (int64_t result = 0; rhs != ast::Integer::big_value && lhs.value() != ast::Integer::big_value && eval_context::integral_assign_binary_implementation(type, lhs.value(), rhs, result)) [[likely]] {
+        lhs.value() = result;
+      } else {
+        eval_big_assign_binary(*binary, value, rhs);
+      }
+      return binary->lhs();
+    }
+    const auto symbol = boost::static_pointer_cast<ast::Symbol>(binary->lhs());
+    /// Evaluated first, since call in rhs may move frame slots.
+    const auto rhs = eval(binary->rhs());
+    auto result = eval_context::assign_binary_implementation(type, variable(*symbol, symbol->name()), rhs);
+    if (symbol->in_frame()) {
+      frames_[frame_base_ + symbol->slot()] = std::move(result);
+    } else {
+      storage_.push(symbol->name(), std::move(result));
+    }
+    return symbol;
+  }
+  if (binary->inferred_type() == ast::inferred_t::INTEGER) {
+    return integer_object(binary, eval_integer(binary));
   }
   const auto lhs = eval(binary->lhs());
   const auto rhs = eval(binary->rhs());
-  return eval_context::binary_implementation(lhs->ast_type(), rhs->ast_type(), type, lhs, rhs);
+  const ast::type_t lhs_type = lhs->ast_type();
+  const ast::type_t rhs_type = rhs->ast_type();
+  /// Binary is quickened by operand types of first execution, and falls back to type
+  /// dispatch for good, once its guard fails.
+  switch (binary->quickening()) {
+    case ast::quickening_t::QUICKENED: {
+      if (binary->guards(lhs_type, rhs_type)) {
+        return binary->call_handler(lhs, rhs);
+      }
+      binary->deoptimize();
+      break;
+    }
+    case ast::quickening_t::UNQUICKENED: {
+      if (const auto handler = eval_context::quickened_binary_implementation(lhs_type, rhs_type, type)) {
+        binary->quicken(handler, lhs_type, rhs_type);
+        return binary->call_handler(lhs, rhs);
+      }
+      binary->deoptimize();
+      break;
+    }
+    case ast::quickening_t::GENERIC: {
+      break;
+    }
+  }
+  return eval_context::binary_implementation(lhs_type, rhs_type, type, lhs, rhs);
 }
 
 boost::local_shared_ptr<ast::Object> Evaluator::eval_unary(const boost::local_shared_ptr<ast::Unary>& unary) noexcept(false) {
   auto& operand = unary->operand();
   const token_t type = unary->type();
   const ast::type_t ast_type = operand->ast_type();
+  if (unary->inferred_type() == ast::inferred_t::INTEGER && ast_type == ast::type_t::SYMBOL) {
+    /// Integer is changed in place, so storage needs no update.
+    const auto& symbol = variable(static_cast<ast::Symbol&>(*operand), static_cast<ast::Symbol&>(*operand).name());
+    auto& integer = static_cast<ast::Integer&>(*symbol);
+    if (int64_t result = 0; integer.value() != ast::Integer::big_value && !__builtin_add_overflow(integer.value(), type == token_t::INC ? 1 : -1, &result)) [[likely]] {
+      integer.value() = result;
+    } else {
+      eval_context::integral_unary_implementation(type, integer);
+    }
+    return symbol;
+  }
   if (bool failed = false; eval_context::unary_implementation(type, operand, failed), !failed) {
     return operand;
   }
   do_typecheck(ast_type, ast::type_t::SYMBOL, "Unknown unary operand type");
-  const auto variable = boost::static_pointer_cast<ast::Symbol>(operand);
-  auto& symbol = storage_.lookup(variable->name());
-  if (bool failed = false; eval_context::unary_implementation(type, symbol, failed), !failed) {
-    storage_.overwrite(variable->name(), symbol);
+  const auto& operand_symbol = static_cast<ast::Symbol&>(*operand);
+  auto& symbol = variable(operand_symbol, operand_symbol.name());
+  if (bool failed = false; eval_context::unary_implementation(type, symbol, failed), !failed && !operand_symbol.in_frame()) {
+    storage_.overwrite(operand_symbol.name(), symbol);
   }
   return symbol;
 }
@@ -199,6 +465,16 @@ void Evaluator::eval_array(const boost::local_shared_ptr<ast::Array>& array) noe
 
 void Evaluator::eval_for(const boost::local_shared_ptr<ast::For>& stmt) noexcept(false) {
   storage_.scope_begin();
+  if (stmt->inferred_type() == ast::inferred_t::INTEGER) {
+    eval(stmt->loop_init());
+    while (eval_condition(stmt->exit_condition())) {
+      eval(stmt->body());
+      eval(stmt->increment());
+      count_back_edge(tiering_, profile_);
+    }
+    storage_.scope_end();
+    return;
+  }
   const auto init = eval(stmt->loop_init());
   const auto init_type = eval(boost::static_pointer_cast<ast::Binary>(init)->lhs())->ast_type();
   const auto& exit_cond = stmt->exit_condition();
@@ -206,9 +482,10 @@ void Evaluator::eval_for(const boost::local_shared_ptr<ast::For>& stmt) noexcept
   const auto& body = stmt->body();
   auto implementation = [this, &exit_cond, &increment, &body]<typename Numeric>() {
     auto exit_cond_ = boost::static_pointer_cast<Numeric>(eval(exit_cond));
-    while (exit_cond_->value()) {
+    while (is_true(*exit_cond_)) {
       eval(body);
       eval(increment);
+      count_back_edge(tiering_, profile_);
       exit_cond_ = boost::static_pointer_cast<Numeric>(eval(exit_cond));
     }
   };
@@ -221,13 +498,21 @@ void Evaluator::eval_for(const boost::local_shared_ptr<ast::For>& stmt) noexcept
 }
 
 void Evaluator::eval_while(const boost::local_shared_ptr<ast::While>& stmt) noexcept(false) {
+  if (stmt->inferred_type() == ast::inferred_t::INTEGER) {
+    while (eval_condition(stmt->exit_condition())) {
+      eval(stmt->body());
+      count_back_edge(tiering_, profile_);
+    }
+    return;
+  }
   const auto exit_cond = eval(stmt->exit_condition());
   const auto exit_cond_type = exit_cond->ast_type();
   const auto& body = stmt->body();
   auto implementation = [this, &stmt, &exit_cond, &body]<typename Numeric>() {
     auto exit_cond_ = boost::static_pointer_cast<Numeric>(exit_cond);
-    while (exit_cond_->value()) {
+    while (is_true(*exit_cond_)) {
       eval(body);
+      count_back_edge(tiering_, profile_);
       exit_cond_ = boost::static_pointer_cast<Numeric>(eval(stmt->exit_condition()));
     }
   };
@@ -239,14 +524,112 @@ void Evaluator::eval_while(const boost::local_shared_ptr<ast::While>& stmt) noex
 }
 
 void Evaluator::eval_if(const boost::local_shared_ptr<ast::If>& stmt) noexcept(false) {
-  const auto if_condition = eval(stmt->condition());
-  if (boost::static_pointer_cast<ast::Integer>(if_condition)->value()) {
+  const auto& condition = stmt->condition();
+  const bool value = is_integer(condition.get())
+      ? eval_condition(condition)
+      : is_true(*boost::static_pointer_cast<ast::Integer>(eval(condition)));
+  if (value) {
     eval(stmt->body());
   } else if (auto else_body = stmt->else_body()) {
     eval(else_body);
   }
 }
 
+/// Inlined into its callers, so literal and variable operands of binary are read without
+/// a call.
+ALWAYS_INLINE int64_t Evaluator::eval_integer(const boost::local_shared_ptr<ast::Object>& expression) noexcept(false) {
+  /// Bignum reads as big_value, so literals and variables are read without a test of
+  /// tag, and binary tests the values it has anyway.
+  switch (expression->ast_type()) {
+    case ast::type_t::INTEGER: {
+      return static_cast<const ast::Integer&>(*expression).value();
+    }
+    case ast::type_t::SYMBOL: {
+      const auto& symbol = static_cast<ast::Symbol&>(*expression);
+      return static_cast<const ast::Integer&>(*variable(symbol, symbol.name())).value();
+    }
+    case ast::type_t::BINARY: {
+      return eval_integer_binary(static_cast<const ast::Binary&>(*expression));
+    }
+    default: {
+      return unpack_integer(eval(expression));
+    }
+  }
+}
+
+int64_t Evaluator::eval_integer_binary(const ast::Binary& binary) noexcept(false) {
+  /// Integer binary is never an assignment, so both operands are integers.
+  const int64_t lhs = eval_integer(binary.lhs());
+  if (lhs == ast::Integer::big_value) [[unlikely]] {
+    return eval_big_binary(binary, integer_object(binary.lhs(), lhs));
+  }
+  const int64_t rhs = eval_integer(binary.rhs());
+  if (int64_t result = 0; rhs != ast::Integer::big_value && eval_context::integral_binary_implementation(binary.type(), lhs, rhs, result)) [[likely]] {
+    return result;
+  }
+  return eval_big_binary(binary, lhs, rhs);
+}
+
+int64_t Evaluator::unpack_integer(const boost::local_shared_ptr<ast::Object>& integer) noexcept(true) {
+  const int64_t value = static_cast<const ast::Integer&>(*integer).value();
+  if (value == ast::Integer::big_value) [[unlikely]] {
+    return keep_overflow(integer);
+  }
+  return value;
+}
+
+/// Slow paths of eval_integer() are kept out of line, so they don't grow its frame.
+NEVER_INLINE int64_t Evaluator::keep_overflow(const boost::local_shared_ptr<ast::Object>& integer) noexcept(true) {
+  if (static_cast<const ast::Integer&>(*integer).is_big()) {
+    overflow_ = integer;
+  }
+  return ast::Integer::big_value;
+}
+
+NEVER_INLINE int64_t Evaluator::eval_big_binary(const ast::Binary& binary, boost::local_shared_ptr<ast::Object> lhs) noexcept(false) {
+  const int64_t rhs = eval_integer(binary.rhs());
+  return unpack_integer(eval_context::binary_implementation(ast::type_t::INTEGER, ast::type_t::INTEGER, binary.type(), lhs, integer_object(binary.rhs(), rhs)));
+}
+
+NEVER_INLINE int64_t Evaluator::eval_big_binary(const ast::Binary& binary, int64_t lhs, int64_t rhs) noexcept(false) {
+  return unpack_integer(eval_context::binary_implementation(ast::type_t::INTEGER, ast::type_t::INTEGER, binary.type(), boost::make_local_shared<ast::Integer>(lhs), integer_object(binary.rhs(), rhs)));
+}
+
+NEVER_INLINE void Evaluator::eval_big_assign_binary(const ast::Binary& binary, const boost::local_shared_ptr<ast::Object>& variable, int64_t rhs) noexcept(false) {
+  eval_context::assign_binary_implementation(binary.type(), variable, integer_object(binary.rhs(), rhs));
+}
+
+boost::local_shared_ptr<ast::Object> Evaluator::integer_object(const boost::local_shared_ptr<ast::Object>& expression, int64_t value) noexcept(false) {
+  if (value == ast::Integer::big_value) [[unlikely]] {
+    return big_integer_object(expression);
+  }
+  return boost::make_local_shared<ast::Integer>(value);
+}
+
+NEVER_INLINE boost::local_shared_ptr<ast::Object> Evaluator::big_integer_object(const boost::local_shared_ptr<ast::Object>& expression) noexcept(false) {
+  if (overflow_) {
+    return std::exchange(overflow_, nullptr);
+  }
+  /// Literal and variable are read again, it has no effects.
+  if (expression->ast_type() == ast::type_t::INTEGER) {
+    return expression;
+  }
+  if (expression->ast_type() == ast::type_t::SYMBOL) {
+    const auto& symbol = static_cast<ast::Symbol&>(*expression);
+    return variable(symbol, symbol.name());
+  }
+  return boost::make_local_shared<ast::Integer>(ast::Integer::big_value);
+}
+
+bool Evaluator::eval_condition(const boost::local_shared_ptr<ast::Object>& condition) noexcept(false) {
+  const int64_t value = eval_integer(condition);
+  if (value == ast::Integer::big_value) [[unlikely]] {
+    /// Bignum is never zero, neither is big_value.
+    overflow_.reset();
+  }
+  return value != 0;
+}
+
 boost::local_shared_ptr<ast::Object> Evaluator::eval(const boost::local_shared_ptr<ast::Object>& stmt) noexcept(false) {
   using ast::type_t;
   switch (stmt->ast_type()) {
@@ -261,7 +644,8 @@ boost::local_shared_ptr<ast::Object> Evaluator::eval(const boost::local_shared_p
       return stmt;
     }
     case type_t::SYMBOL: {
-      return storage_.lookup(boost::static_pointer_cast<ast::Symbol>(stmt)->name());
+      const auto& symbol = static_cast<ast::Symbol&>(*stmt);
+      return variable(symbol, symbol.name());
     }
     case type_t::TYPE_FIELD: {
       return eval_type_field_access(boost::static_pointer_cast<ast::TypeFieldOperator>(stmt));
@@ -1,10 +1,10 @@
 #include "../../../include/eval/implementation/binary.hpp"
 
+#include "../../../include/ast/big_integer.hpp"
 #include "../../../include/error/eval_error.hpp"
 
-#include <any>
-#include <boost/pool/pool_alloc.hpp>
-#include <variant>
+#include <algorithm>
+#include <limits>
 
 template <typename LeftOperand, typename RightOperand>
 ALWAYS_INLINE static constexpr bool comparison_implementation(token_t type, LeftOperand l, RightOperand r) noexcept(false) {
@@ -36,35 +36,140 @@ ALWAYS_INLINE static constexpr double floating_point_arithmetic_implementation(t
   // clang-format on
 }
 
-template <typename LeftIntegral, typename RightIntegral>
-ALWAYS_INLINE static constexpr int32_t integral_arithmetic_implementation(token_t type, LeftIntegral l, RightIntegral r) noexcept(false) {
-  // clang-format off
+/// Bignum shift is limited, so a typo in script can't exhaust memory.
+static constexpr int64_t max_big_shift = 1 << 20;
+
+ALWAYS_INLINE static void check_divisor(bool is_zero) noexcept(false) {
+  if (is_zero) {
+    throw EvalError("Division by zero");
+  }
+}
+
+ALWAYS_INLINE static void check_shift(bool is_negative) noexcept(false) {
+  if (is_negative) {
+    throw EvalError("Negative shift");
+  }
+}
+
+/// @param  result - value of operation, if it fits into 64 bits
+/// @throws EvalError if operator is invalid, divisor is zero or shift is negative
+/// @return false if result doesn't fit into 64 bits
+ALWAYS_INLINE static bool integral_arithmetic_implementation(token_t type, int64_t l, int64_t r, int64_t& result) noexcept(false) {
+  switch (type) {
+    case token_t::PLUS: {
+      return !__builtin_add_overflow(l, r, &result);
+    }
+    case token_t::MINUS: {
+      return !__builtin_sub_overflow(l, r, &result);
+    }
+    case token_t::STAR: {
+      return !__builtin_mul_overflow(l, r, &result);
+    }
+    case token_t::SLASH: {
+      check_divisor(r == 0);
+      if (l == std::numeric_limits<int64_t>::min() && r == -1) [[unlikely]] {
+        return false;
+      }
+      result = l / r;
+      return true;
+    }
+    case token_t::MOD: {
+      check_divisor(r == 0);
+      /// INT64_MIN % -1 traps, although remainder is zero.
+      result = r == -1 ? 0 : l % r;
+      return true;
+    }
+    case token_t::SLLI: {
+      check_shift(r < 0);
+      if (l == 0) {
+        result = 0;
+        return true;
+      }
+      if (r >= 63) {
+        return false;
+      }
+      result = static_cast<int64_t>(static_cast<uint64_t>(l) << r);
+      return (result >> r) == l;
+    }
+    case token_t::SRLI: {
+      check_shift(r < 0);
+      result = l >> std::min<int64_t>(r, 63);
+      return true;
+    }
+    // clang-format off
+    case token_t::BIT_AND: { result = l & r; return true; }
+    case token_t::BIT_OR: { result = l | r; return true; }
+    case token_t::BIT_XOR: { result = l ^ r; return true; }
+    // clang-format on
+    default: {
+      result = comparison_implementation(type, l, r);
+      return true;
+    }
+  }
+}
+
+/// @brief  slow path of integer arithmetic, taken once value doesn't fit into 64 bits
+/// @throws EvalError if operator is invalid, divisor is zero or shift is negative or too large
+static ast::BigInteger big_arithmetic_implementation(token_t type, const ast::BigInteger& l, const ast::BigInteger& r) noexcept(false) {
   switch (type) {
+    // clang-format off
     case token_t::PLUS: { return l + r; }
     case token_t::MINUS: { return l - r; }
     case token_t::STAR: { return l * r; }
-    case token_t::SLASH: { return l / r; }
-    case token_t::MOD: { return l % r; }
-    case token_t::SLLI: { return l << r; }
-    case token_t::SRLI: { return l >> r; }
-    default:
-      return comparison_implementation<LeftIntegral, RightIntegral>(type, l, r);
+    case token_t::BIT_AND: { return l & r; }
+    case token_t::BIT_OR: { return l | r; }
+    case token_t::BIT_XOR: { return l ^ r; }
+    // clang-format on
+    case token_t::SLASH:
+    case token_t::MOD: {
+      check_divisor(r.is_zero());
+      auto [quotient, remainder] = ast::BigInteger::divide(l, r);
+      return type == token_t::SLASH ? std::move(quotient) : std::move(remainder);
+    }
+    case token_t::SLLI: {
+      check_shift(r.is_negative());
+      if (l.is_zero()) {
+        return l;
+      }
+      if (!r.fits_int64() || r.to_int64() > max_big_shift) {
+        throw EvalError("Shift is too large: {}", r.to_string());
+      }
+      return l.shift_left(static_cast<uint64_t>(r.to_int64()));
+    }
+    case token_t::SRLI: {
+      check_shift(r.is_negative());
+      return l.shift_right(r.fits_int64() ? static_cast<uint64_t>(r.to_int64()) : std::numeric_limits<uint64_t>::max());
+    }
+    default: {
+      return ast::BigInteger(comparison_implementation(type, l, r));
+    }
   }
-  // clang-format on
 }
 
-template <typename LeftAST, typename RightAST>
-ALWAYS_INLINE static constexpr std::variant<int32_t, double> arithmetic(token_t type, const ast::Object* lhs, const ast::Object* rhs) noexcept(false) {
-  if constexpr (std::is_same_v<ast::Integer, LeftAST> && std::is_same_v<ast::Integer, RightAST>) {
-    return integral_arithmetic_implementation(
-        type,
-        static_cast<const ast::Integer*>(lhs)->value(),
-        static_cast<const ast::Integer*>(rhs)->value());
+/// @brief  compute in 64 bits, fall back to bignum on overflow
+static boost::local_shared_ptr<ast::Object> integer_binary(token_t type, const ast::Integer& l, const ast::Integer& r) noexcept(false) {
+  if (!l.is_big() && !r.is_big()) [[likely]] {
+    if (int64_t result = 0; integral_arithmetic_implementation(type, l.value(), r.value(), result)) [[likely]] {
+      return boost::make_local_shared<ast::Integer>(result);
+    }
   }
+  return boost::make_local_shared<ast::Integer>(big_arithmetic_implementation(type, l.to_big(), r.to_big()));
+}
+
+ALWAYS_INLINE static double as_double(const ast::Integer& integer) noexcept(true) {
+  return integer.is_big() ? integer.big().to_double() : static_cast<double>(integer.value());
+}
+
+ALWAYS_INLINE static double as_double(const ast::Float& floating_point) noexcept(true) {
+  return floating_point.value();
+}
+
+template <typename LeftAST, typename RightAST>
+ALWAYS_INLINE static double arithmetic(token_t type, const ast::Object* lhs, const ast::Object* rhs) noexcept(false) {
   return floating_point_arithmetic_implementation(
       type,
-      static_cast<const LeftAST*>(lhs)->value(),
-      static_cast<const RightAST*>(rhs)->value());
+      as_double(*static_cast<const LeftAST*>(lhs)),
+      as_double(*static_cast<const RightAST*>(rhs)));
 }
 
 ALWAYS_INLINE static constexpr token_t resolve_assign_operator(token_t tok) noexcept(true) {
@@ -92,9 +197,9 @@ ALWAYS_INLINE auto create_binary(
     const boost::local_shared_ptr<ast::Object>& lhs,
     const boost::local_shared_ptr<ast::Object>& rhs) noexcept(false) {
   if constexpr (std::is_same_v<Result, ast::Integer>) {
-    return boost::make_local_shared<Result>(std::get<int32_t>(arithmetic<LeftAST, RightAST>(operation, lhs.get(), rhs.get())));
+    return integer_binary(operation, static_cast<const ast::Integer&>(*lhs), static_cast<const ast::Integer&>(*rhs));
   } else if constexpr (std::is_same_v<Result, ast::Float>) {
-    return boost::make_local_shared<Result>(std::get<double>(arithmetic<LeftAST, RightAST>(operation, lhs.get(), rhs.get())));
+    return boost::make_local_shared<Result>(arithmetic<LeftAST, RightAST>(operation, lhs.get(), rhs.get()));
   }
 }
 
@@ -120,17 +225,109 @@ boost::local_shared_ptr<ast::Object> eval_context::binary_implementation(ast::ty
   }
 }
 
+/// @param  result - result of previous call, changed in place if only binary refers to it,
+///         so value can't be observed elsewhere
+template <typename Result, typename LeftAST, typename RightAST, token_t Operation>
+static boost::local_shared_ptr<ast::Object> quickened_binary(const boost::local_shared_ptr<ast::Object>& lhs, const boost::local_shared_ptr<ast::Object>& rhs, boost::local_shared_ptr<ast::Object>& result) noexcept(false) {
+  if constexpr (std::is_same_v<Result, ast::Integer>) {
+    const auto& l = static_cast<const ast::Integer&>(*lhs);
+    const auto& r = static_cast<const ast::Integer&>(*rhs);
+    int64_t value = 0;
+    /// Bignum result is rare, so it's never reused.
+    if (l.is_big() || r.is_big() || !integral_arithmetic_implementation(Operation, l.value(), r.value(), value)) [[unlikely]] {
+      return integer_binary(Operation, l, r);
+    }
+    if (result && result.local_use_count() == 1) {
+      static_cast<ast::Integer&>(*result).assign(value);
+    } else {
+      result = boost::make_local_shared<ast::Integer>(value);
+    }
+  } else {
+    const double value = arithmetic<LeftAST, RightAST>(Operation, lhs.get(), rhs.get());
+    if (result && result.local_use_count() == 1) {
+      static_cast<Result&>(*result).value() = value;
+    } else {
+      result = boost::make_local_shared<Result>(value);
+    }
+  }
+  return result;
+}
+
+template <typename Result, typename LeftAST, typename RightAST>
+static ast::Binary::handler_t quickened_operation(token_t operation) noexcept(true) {
+  // clang-format off
+  switch (operation) {
+    case token_t::PLUS: { return quickened_binary<Result, LeftAST, RightAST, token_t::PLUS>; }
+    case token_t::MINUS: { return quickened_binary<Result, LeftAST, RightAST, token_t::MINUS>; }
+    case token_t::STAR: { return quickened_binary<Result, LeftAST, RightAST, token_t::STAR>; }
+    case token_t::SLASH: { return quickened_binary<Result, LeftAST, RightAST, token_t::SLASH>; }
+    case token_t::EQ: { return quickened_binary<Result, LeftAST, RightAST, token_t::EQ>; }
+    case token_t::NEQ: { return quickened_binary<Result, LeftAST, RightAST, token_t::NEQ>; }
+    case token_t::GE: { return quickened_binary<Result, LeftAST, RightAST, token_t::GE>; }
+    case token_t::GT: { return quickened_binary<Result, LeftAST, RightAST, token_t::GT>; }
+    case token_t::LE: { return quickened_binary<Result, LeftAST, RightAST, token_t::LE>; }
+    case token_t::LT: { return quickened_binary<Result, LeftAST, RightAST, token_t::LT>; }
+    default: { break; }
+  }
+  if constexpr (std::is_same_v<Result, ast::Integer>) {
+    switch (operation) {
+      case token_t::MOD: { return quickened_binary<Result, LeftAST, RightAST, token_t::MOD>; }
+      case token_t::SLLI: { return quickened_binary<Result, LeftAST, RightAST, token_t::SLLI>; }
+      case token_t::SRLI: { return quickened_binary<Result, LeftAST, RightAST, token_t::SRLI>; }
+      case token_t::BIT_AND: { return quickened_binary<Result, LeftAST, RightAST, token_t::BIT_AND>; }
+      case token_t::BIT_OR: { return quickened_binary<Result, LeftAST, RightAST, token_t::BIT_OR>; }
+      case token_t::BIT_XOR: { return quickened_binary<Result, LeftAST, RightAST, token_t::BIT_XOR>; }
+      default: { break; }
+    }
+  }
+  // clang-format on
+  return nullptr;
+}
+
+ast::Binary::handler_t eval_context::quickened_binary_implementation(ast::type_t left_type, ast::type_t right_type, token_t operation) noexcept(true) {
+  switch (ENUM_PAIR(left_type, right_type)) {
+    case ENUM_PAIR(ast::type_t::INTEGER, ast::type_t::INTEGER): {
+      return quickened_operation<ast::Integer, ast::Integer, ast::Integer>(operation);
+    }
+    case ENUM_PAIR(ast::type_t::INTEGER, ast::type_t::FLOAT): {
+      return quickened_operation<ast::Float, ast::Integer, ast::Float>(operation);
+    }
+    case ENUM_PAIR(ast::type_t::FLOAT, ast::type_t::FLOAT): {
+      return quickened_operation<ast::Float, ast::Float, ast::Float>(operation);
+    }
+    case ENUM_PAIR(ast::type_t::FLOAT, ast::type_t::INTEGER): {
+      return quickened_operation<ast::Float, ast::Float, ast::Integer>(operation);
+    }
+    default: {
+      return nullptr;
+    }
+  }
+}
+
 #undef MAKE_PAIR
 
+bool eval_context::integral_binary_implementation(token_t operation, int64_t lhs, int64_t rhs, int64_t& result) noexcept(false) {
+  return integral_arithmetic_implementation(operation, lhs, rhs, result);
+}
+
+bool eval_context::integral_assign_binary_implementation(token_t operation, int64_t lhs, int64_t rhs, int64_t& result) noexcept(false) {
+  return integral_arithmetic_implementation(resolve_assign_operator(operation), lhs, rhs, result);
+}
+
 boost::local_shared_ptr<ast::Object> eval_context::assign_binary_implementation(token_t type, const boost::local_shared_ptr<ast::Object>& lhs, const boost::local_shared_ptr<ast::Object>& rhs) noexcept(false) {
   if (lhs->ast_type() != rhs->ast_type()) {
     throw EvalError("Invalid binary operands");
   }
   switch (lhs->ast_type()) {
     case ast::type_t::INTEGER: {
-      size_t& l = static_cast<ast::Integer*>(lhs.get())->value();
-      size_t& r = static_cast<ast::Integer*>(rhs.get())->value();
-      l = integral_arithmetic_implementation(resolve_assign_operator(type), l, r);
+      auto& l = static_cast<ast::Integer&>(*lhs);
+      const auto& r = static_cast<const ast::Integer&>(*rhs);
+      const token_t operation = resolve_assign_operator(type);
+      if (int64_t result = 0; !l.is_big() && !r.is_big() && integral_arithmetic_implementation(operation, l.value(), r.value(), result)) [[likely]] {
+        l.assign(result);
+      } else {
+        l.assign(big_arithmetic_implementation(operation, l.to_big(), r.to_big()));
+      }
       return lhs;
     }
     case ast::type_t::FLOAT: {
@@ -1,5 +1,6 @@
 #include "../../../include/eval/implementation/unary.hpp"
 
+#include "../../../include/ast/big_integer.hpp"
 #include "../../../include/error/eval_error.hpp"
 
 template <typename Number>
@@ -13,11 +14,22 @@ ALWAYS_INLINE static void compute_unary(token_t type, Number& unary) noexcept(fa
   // clang-format on
 }
 
+void eval_context::integral_unary_implementation(token_t unary_type, ast::Integer& integer) noexcept(false) {
+  if (unary_type != token_t::INC && unary_type != token_t::DEC) {
+    throw EvalError("Unknown unary operator: {}", dispatch_token(unary_type));
+  }
+  const int64_t step = unary_type == token_t::INC ? 1 : -1;
+  if (int64_t result = 0; !integer.is_big() && !__builtin_add_overflow(integer.value(), step, &result)) [[likely]] {
+    integer.value() = result;
+    return;
+  }
+  integer.assign(integer.to_big() + ast::BigInteger(step));
+}
+
 void eval_context::unary_implementation(token_t unary_type, boost::local_shared_ptr<ast::Object>& expression, bool& failed) noexcept(false) {
   switch (expression->ast_type()) {
     case ast::type_t::INTEGER: {
-      size_t& value = static_cast<ast::Integer*>(expression.get())->value();
-      compute_unary(unary_type, value);
+      integral_unary_implementation(unary_type, static_cast<ast::Integer&>(*expression));
       return;
     }
     case ast::type_t::FLOAT: {
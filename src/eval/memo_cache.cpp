@@ -0,0 +1,107 @@
+#include "../../include/eval/memo_cache.hpp"
+
+#include "../../include/optimizer/tree_utility.hpp"
+
+static void append_bytes(std::string& key, const void* data, size_t size) noexcept(false) {
+  key.append(static_cast<const char*>(data), size);
+}
+
+/// @return new object with the same value, null if value is neither number nor string
+static boost::local_shared_ptr<ast::Object> copy_value(const boost::local_shared_ptr<ast::Object>& value) noexcept(false) {
+  // clang-format off
+  switch (value->ast_type()) {
+    case ast::type_t::INTEGER: { return boost::make_local_shared<ast::Integer>(static_cast<const ast::Integer&>(*value)); }
+    case ast::type_t::FLOAT: { return boost::make_local_shared<ast::Float>(static_cast<const ast::Float&>(*value).value()); }
+    case ast::type_t::STRING: { return boost::make_local_shared<ast::String>(static_cast<const ast::String&>(*value).value()); }
+    default: { return nullptr; }
+  }
+  // clang-format on
+}
+
+MemoCache::MemoCache(size_t capacity) noexcept(true)
+  : capacity_(capacity) {}
+
+bool MemoCache::accepts(const ast::Lambda& lambda) noexcept(false) {
+  const auto [found, inserted] = lambdas_.try_emplace(&lambda, false);
+  if (inserted) {
+    found->second = lambda.is_pure() && optimization::returns_new_value(lambda);
+  }
+  return found->second;
+}
+
+std::optional<std::string> MemoCache::key(const ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false) {
+  std::string key;
+  const ast::Lambda* address = &lambda;
+  append_bytes(key, &address, sizeof(address));
+  for (const auto& argument : arguments) {
+    const auto type = argument->ast_type();
+    append_bytes(key, &type, sizeof(type));
+    switch (type) {
+      case ast::type_t::INTEGER: {
+        /// Bignum arguments are rare, so such calls aren't cached.
+        const auto& integer = static_cast<const ast::Integer&>(*argument);
+        if (integer.is_big()) {
+          return std::nullopt;
+        }
+        append_bytes(key, &integer.value(), sizeof(int64_t));
+        break;
+      }
+      case ast::type_t::FLOAT: {
+        /// Compared by bits, so 0.0 and -0.0 are different keys, and NaN is equal to itself.
+        append_bytes(key, &static_cast<const ast::Float&>(*argument).value(), sizeof(double));
+        break;
+      }
+      case ast::type_t::STRING: {
+        const std::string& value = static_cast<const ast::String&>(*argument).value();
+        const size_t size = value.size();
+        append_bytes(key, &size, sizeof(size));
+        key += value;
+        break;
+      }
+      default: {
+        return std::nullopt;
+      }
+    }
+  }
+  return key;
+}
+
+std::optional<boost::local_shared_ptr<ast::Object>> MemoCache::find(const std::string& key) noexcept(false) {
+  const auto entry = index_.find(key);
+  if (entry == index_.end()) {
+    ++stats_.misses;
+    return std::nullopt;
+  }
+  ++stats_.hits;
+  entries_.splice(entries_.begin(), entries_, entry->second);
+  const auto& result = entry->second->second;
+  return result ? copy_value(result) : nullptr;
+}
+
+void MemoCache::insert(std::string key, const boost::local_shared_ptr<ast::Object>& result) noexcept(false) {
+  boost::local_shared_ptr<ast::Object> value;
+  if (result) {
+    value = copy_value(result);
+    if (!value) {
+      return;
+    }
+  }
+  if (index_.contains(key)) {
+    return;
+  }
+  if (entries_.size() == capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+    ++stats_.evictions;
+  }
+  entries_.emplace_front(std::move(key), std::move(value));
+  index_.emplace(entries_.front().first, entries_.begin());
+}
+
+size_t MemoCache::size() const noexcept(true) {
+  return entries_.size();
+}
+
+const MemoCache::Stats& MemoCache::stats() const noexcept(true) {
+  return stats_;
+}
@@ -0,0 +1,76 @@
+#include "../../include/eval/session.hpp"
+
+#include "../../include/lexer/lexer.hpp"
+#include "../../include/parser/parser.hpp"
+#include "../../include/semantic/semantic_analyzer.hpp"
+
+#include <sstream>
+
+boost::local_shared_ptr<ast::Object> Session::eval(std::string_view input) noexcept(false) {
+  Lexer lexer(std::istringstream{std::string(input)});
+  Parser parser(lexer.tokenize());
+  auto statements = parser.parse();
+  SemanticAnalyzer semantic_analyzer(statements);
+  semantic_analyzer.analyze();
+  /// Names may be defined by previous input, so unknown ones are looked up at runtime.
+  SemanticAnalyzer::bind(*statements, /*free_names_are_globals=*/true);
+
+  boost::local_shared_ptr<ast::Object> result;
+  for (const auto& statement : statements->get()) {
+    result = evaluator_.eval_statement(statement);
+  }
+  return result;
+}
+
+bool Session::is_complete(std::string_view input) noexcept(true) {
+  std::vector<Token> tokens;
+  try {
+    Lexer lexer(std::istringstream{std::string(input)});
+    tokens = lexer.tokenize();
+  } catch (...) {
+    /// Let eval() report the error.
+    return true;
+  }
+  ssize_t depth = 0;
+  for (const Token& token : tokens) {
+    switch (token.type) {
+      case token_t::LEFT_BRACE:
+      case token_t::LEFT_PAREN:
+      case token_t::LEFT_BOX_BRACE: {
+        ++depth;
+        break;
+      }
+      case token_t::RIGHT_BRACE:
+      case token_t::RIGHT_PAREN:
+      case token_t::RIGHT_BOX_BRACE: {
+        --depth;
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+  return depth <= 0;
+}
+
+std::optional<std::string> Session::read_input(std::istream& input, std::ostream& prompt) noexcept(false) {
+  std::string program;
+  std::string line;
+  while (std::getline(input, line)) {
+    /// Empty line finishes unbalanced input, so it will be reported as an error.
+    if (line.empty() && !program.empty()) {
+      break;
+    }
+    program += line;
+    program += '\n';
+    if (is_complete(program)) {
+      break;
+    }
+    prompt << "... ";
+  }
+  if (program.empty() && !input) {
+    return std::nullopt;
+  }
+  return program;
+}
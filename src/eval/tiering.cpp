@@ -0,0 +1,93 @@
+#include "../../include/eval/tiering.hpp"
+
+#include "../../include/optimizer/optimizer.hpp"
+#include "../../include/optimizer/tree_utility.hpp"
+#include "../../include/semantic/semantic_analyzer.hpp"
+
+#include <algorithm>
+
+/// @return type, inferred for parameter, which is always passed value of given type
+static ast::inferred_t parameter_type(ast::type_t type) noexcept(true) {
+  // clang-format off
+  switch (type) {
+    case ast::type_t::INTEGER: { return ast::inferred_t::INTEGER; }
+    case ast::type_t::FLOAT: { return ast::inferred_t::FLOAT; }
+    case ast::type_t::STRING: { return ast::inferred_t::STRING; }
+    default: { return ast::inferred_t::UNKNOWN; }
+  }
+  // clang-format on
+}
+
+static bool is_number(ast::type_t type) noexcept(true) {
+  return type == ast::type_t::INTEGER || type == ast::type_t::FLOAT;
+}
+
+/// @return true if arguments are values of given types
+static bool matches(const std::vector<ast::type_t>& signature, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(true) {
+  if (signature.size() != arguments.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    if (!arguments[i] || arguments[i]->ast_type() != signature[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Tiering::Tiering(Thresholds thresholds) noexcept(true)
+  : thresholds_(thresholds) {}
+
+Tiering::Entry Tiering::enter(const ast::Lambda& lambda, const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false) {
+  Profile& profile = profiles_[&lambda];
+  profile.lambda = &lambda;
+  ++profile.calls;
+  if (!profile.optimized) {
+    if (profile.calls == 1) {
+      for (const auto& argument : arguments) {
+        if (!argument) {
+          profile.polymorphic = true;
+          break;
+        }
+        profile.signature.push_back(argument->ast_type());
+      }
+    } else if (!profile.polymorphic && !matches(profile.signature, arguments)) {
+      profile.polymorphic = true;
+    }
+    if (profile.calls < thresholds_.calls) {
+      return {profile, nullptr};
+    }
+    tier_up(lambda, profile, reason_t::CALLS);
+  }
+  if (!profile.guard.empty() && !matches(profile.guard, arguments)) {
+    if (++profile.misses < thresholds_.calls) {
+      return {profile, nullptr};
+    }
+    profile.polymorphic = true;
+    tier_up(lambda, profile, reason_t::GUARD_MISSES);
+  }
+  return {profile, profile.optimized};
+}
+
+const std::vector<Tiering::Event>& Tiering::events() const noexcept(true) {
+  return events_;
+}
+
+void Tiering::tier_up(const ast::Lambda& lambda, Profile& profile, reason_t reason) noexcept(false) {
+  auto body = boost::static_pointer_cast<ast::Block>(optimization::Cloner::sharing_literals().clone(lambda.body()));
+  auto clone = boost::make_local_shared<ast::Lambda>(lambda.name(), lambda.arguments(), std::move(body));
+  clone->bind(lambda.frame_size());
+  clone->set_pure(lambda.is_pure());
+
+  Event event{lambda.name(), reason, profile.calls, profile.back_edges, {}, 0};
+  profile.guard.clear();
+  if (!profile.polymorphic && std::any_of(profile.signature.begin(), profile.signature.end(), is_number)) {
+    std::transform(profile.signature.begin(), profile.signature.end(), std::back_inserter(event.parameters), parameter_type);
+    SemanticAnalyzer::specialize(*clone, event.parameters);
+    profile.guard = profile.signature;
+  }
+  event.changes = Optimizer::optimize(*clone);
+  profile.optimized = std::move(clone);
+  profile.misses = 0;
+  events_.push_back(std::move(event));
+}
@@ -0,0 +1,551 @@
+#include "../../include/ir/ir.hpp"
+
+#include <algorithm>
+#include <initializer_list>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+using object_t = boost::local_shared_ptr<ast::Object>;
+
+std::string type_name(ast::inferred_t type) noexcept(true) {
+  // clang-format off
+  switch (type) {
+    case ast::inferred_t::INTEGER: { return "integer"; }
+    case ast::inferred_t::FLOAT: { return "float"; }
+    case ast::inferred_t::STRING: { return "string"; }
+    case ast::inferred_t::ARRAY: { return "array"; }
+    case ast::inferred_t::OBJECT: { return "object"; }
+    default: { return "unknown"; }
+  }
+  // clang-format on
+}
+
+std::string opcode_name(ir::opcode_t opcode) noexcept(true) {
+  using ir::opcode_t;
+  // clang-format off
+  switch (opcode) {
+    case opcode_t::CONSTANT: { return "constant"; }
+    case opcode_t::PARAMETER: { return "parameter"; }
+    case opcode_t::LOAD: { return "load"; }
+    case opcode_t::BINARY: { return "binary"; }
+    case opcode_t::UNARY: { return "unary"; }
+    case opcode_t::UPDATE: { return "update"; }
+    case opcode_t::CALL: { return "call"; }
+    case opcode_t::CREATE: { return "create"; }
+    case opcode_t::FIELD: { return "field"; }
+    case opcode_t::PHI: { return "phi"; }
+    case opcode_t::JUMP: { return "jump"; }
+    case opcode_t::BRANCH: { return "branch"; }
+    case opcode_t::RETURN: { return "return"; }
+  }
+  // clang-format on
+  return "unknown";
+}
+
+/// @return type of literal or array of literals, unknown for other nodes
+ast::inferred_t literal_type(const object_t& node) noexcept(true) {
+  // clang-format off
+  switch (node->ast_type()) {
+    case ast::type_t::INTEGER: { return ast::inferred_t::INTEGER; }
+    case ast::type_t::FLOAT: { return ast::inferred_t::FLOAT; }
+    case ast::type_t::STRING: { return ast::inferred_t::STRING; }
+    case ast::type_t::ARRAY: { return ast::inferred_t::ARRAY; }
+    default: { return ast::inferred_t::UNKNOWN; }
+  }
+  // clang-format on
+}
+
+void print_literal(std::ostream& stream, const object_t& node) noexcept(false) {
+  switch (node->ast_type()) {
+    // clang-format off
+    case ast::type_t::INTEGER: { stream << static_cast<const ast::Integer&>(*node).to_string(); return; }
+    case ast::type_t::FLOAT: { stream << static_cast<const ast::Float&>(*node).value(); return; }
+    case ast::type_t::STRING: { stream << '"' << static_cast<const ast::String&>(*node).value() << '"'; return; }
+    // clang-format on
+    case ast::type_t::ARRAY: {
+      stream << '[';
+      const auto& elements = static_cast<const ast::Array&>(*node).elements();
+      for (size_t i = 0; i < elements.size(); ++i) {
+        stream << (i > 0 ? ", " : "");
+        print_literal(stream, elements[i]);
+      }
+      stream << ']';
+      return;
+    }
+    default: {
+      stream << '?';
+      return;
+    }
+  }
+}
+
+/// Cooper, Harvey, Kennedy: "A Simple, Fast Dominance Algorithm".
+///
+/// @param  successors - edges of graph, walked from root
+/// @param  predecessors - reversed edges
+/// @return immediate dominator of each node, root for itself, size for unreachable nodes
+std::vector<size_t> immediate_dominators(size_t root, const std::vector<std::vector<size_t>>& successors, const std::vector<std::vector<size_t>>& predecessors) noexcept(false) {
+  const size_t size = successors.size();
+  /// Reverse postorder by iterative depth-first search.
+  std::vector<size_t> order;
+  std::vector<size_t> number(size, size);
+  std::vector<bool> visited(size, false);
+  std::vector<std::pair<size_t, size_t>> stack = {{root, 0}};
+  visited[root] = true;
+  while (!stack.empty()) {
+    auto& [node, next] = stack.back();
+    if (next < successors[node].size()) {
+      const size_t successor = successors[node][next++];
+      if (!visited[successor]) {
+        visited[successor] = true;
+        stack.emplace_back(successor, 0);
+      }
+      continue;
+    }
+    order.push_back(node);
+    stack.pop_back();
+  }
+  std::reverse(order.begin(), order.end());
+  for (size_t i = 0; i < order.size(); ++i) {
+    number[order[i]] = i;
+  }
+  std::vector<size_t> idom(size, size);
+  idom[root] = root;
+  auto intersect = [&idom, &number](size_t lhs, size_t rhs) {
+    while (lhs != rhs) {
+      while (number[lhs] > number[rhs]) {
+        lhs = idom[lhs];
+      }
+      while (number[rhs] > number[lhs]) {
+        rhs = idom[rhs];
+      }
+    }
+    return lhs;
+  };
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t i = 1; i < order.size(); ++i) {
+      const size_t node = order[i];
+      size_t dominator = size;
+      for (const size_t predecessor : predecessors[node]) {
+        if (idom[predecessor] == size) {
+          continue;
+        }
+        dominator = dominator == size ? predecessor : intersect(predecessor, dominator);
+      }
+      if (dominator != idom[node]) {
+        idom[node] = dominator;
+        changed = true;
+      }
+    }
+  }
+  return idom;
+}
+
+}// namespace
+
+namespace ir {
+
+Function::Function(std::string name, uint32_t parameters) noexcept(true)
+  : name_(std::move(name))
+  , parameters_(parameters) {}
+
+block_t Function::add_block() noexcept(false) {
+  blocks_.emplace_back();
+  return static_cast<block_t>(blocks_.size() - 1);
+}
+
+value_t Function::append(block_t block, Instruction instruction) noexcept(false) {
+  const auto value = static_cast<value_t>(instructions_.size());
+  instruction.block = block;
+  if (is_terminator(instruction.opcode)) {
+    for (const block_t successor : instruction.blocks) {
+      blocks_[successor].predecessors.push_back(block);
+    }
+  }
+  instructions_.push_back(std::move(instruction));
+  blocks_[block].instructions.push_back(value);
+  return value;
+}
+
+value_t Function::add_phi(block_t block, ast::inferred_t type) noexcept(false) {
+  const auto value = static_cast<value_t>(instructions_.size());
+  Instruction phi;
+  phi.opcode = opcode_t::PHI;
+  phi.type = type;
+  phi.block = block;
+  instructions_.push_back(std::move(phi));
+  auto& list = blocks_[block].instructions;
+  const auto position = std::find_if(list.begin(), list.end(), [this](value_t other) { return instructions_[other].opcode != opcode_t::PHI; });
+  list.insert(position, value);
+  return value;
+}
+
+void Function::replace_uses(value_t from, value_t to) noexcept(true) {
+  for (auto& instruction : instructions_) {
+    if (instruction.block == no_block) {
+      continue;
+    }
+    std::replace(instruction.operands.begin(), instruction.operands.end(), from, to);
+  }
+}
+
+void Function::remove(value_t value) noexcept(true) {
+  auto& list = blocks_[instructions_[value].block].instructions;
+  list.erase(std::find(list.begin(), list.end(), value));
+  instructions_[value].block = no_block;
+}
+
+const std::vector<block_t>& Function::successors(block_t block) const noexcept(true) {
+  static const std::vector<block_t> none;
+  const auto& list = blocks_[block].instructions;
+  if (list.empty() || !is_terminator(instructions_[list.back()].opcode)) {
+    return none;
+  }
+  return instructions_[list.back()].blocks;
+}
+
+std::vector<block_t> Function::dominators() const noexcept(false) {
+  std::vector<std::vector<size_t>> successors_list(blocks_.size());
+  std::vector<std::vector<size_t>> predecessors_list(blocks_.size());
+  for (block_t block = 0; block < blocks_.size(); ++block) {
+    successors_list[block].assign(successors(block).begin(), successors(block).end());
+    predecessors_list[block].assign(blocks_[block].predecessors.begin(), blocks_[block].predecessors.end());
+  }
+  const auto idom = immediate_dominators(entry, successors_list, predecessors_list);
+  std::vector<block_t> result(blocks_.size());
+  std::transform(idom.begin(), idom.end(), result.begin(), [this](size_t block) { return block == blocks_.size() ? no_block : static_cast<block_t>(block); });
+  return result;
+}
+
+std::vector<block_t> Function::post_dominators() const noexcept(false) {
+  /// Reversed graph, rooted at virtual exit after all returns.
+  const size_t exit = blocks_.size();
+  std::vector<std::vector<size_t>> successors_list(exit + 1);
+  std::vector<std::vector<size_t>> predecessors_list(exit + 1);
+  for (block_t block = 0; block < blocks_.size(); ++block) {
+    const auto& next = successors(block);
+    if (!blocks_[block].instructions.empty() && instructions_[blocks_[block].instructions.back()].opcode == opcode_t::RETURN) {
+      successors_list[exit].push_back(block);
+      predecessors_list[block].push_back(exit);
+    }
+    for (const block_t successor : next) {
+      successors_list[successor].push_back(block);
+      predecessors_list[block].push_back(successor);
+    }
+  }
+  const auto ipdom = immediate_dominators(exit, successors_list, predecessors_list);
+  std::vector<block_t> result(blocks_.size());
+  std::transform(ipdom.begin(), ipdom.end() - 1, result.begin(), [exit](size_t block) { return block >= exit ? no_block : static_cast<block_t>(block); });
+  return result;
+}
+
+std::vector<size_t> Function::use_counts() const noexcept(false) {
+  std::vector<size_t> uses(instructions_.size(), 0);
+  for (const auto& instruction : instructions_) {
+    if (instruction.block == no_block) {
+      continue;
+    }
+    for (const value_t operand : instruction.operands) {
+      ++uses[operand];
+    }
+  }
+  return uses;
+}
+
+void Function::verify() const noexcept(false) {
+  auto fail = [](block_t block, const std::string& message) {
+    throw std::runtime_error("block" + std::to_string(block) + ": " + message);
+  };
+  if (blocks_.empty()) {
+    throw std::runtime_error("Function without blocks");
+  }
+  /// Position of each value in its block.
+  std::vector<size_t> position(instructions_.size(), 0);
+  std::vector<std::vector<block_t>> expected_predecessors(blocks_.size());
+  for (block_t block = 0; block < blocks_.size(); ++block) {
+    const auto& list = blocks_[block].instructions;
+    if (list.empty() || !is_terminator(instructions_[list.back()].opcode)) {
+      fail(block, "block doesn't end with terminator");
+    }
+    bool phis = true;
+    for (size_t i = 0; i < list.size(); ++i) {
+      const auto& instruction = instructions_[list[i]];
+      if (instruction.block != block) {
+        fail(block, "%" + std::to_string(list[i]) + " belongs to other block");
+      }
+      if (is_terminator(instruction.opcode) && i + 1 != list.size()) {
+        fail(block, "terminator in the middle of block");
+      }
+      if (instruction.opcode == opcode_t::PHI && !phis) {
+        fail(block, "phi %" + std::to_string(list[i]) + " after other instructions");
+      }
+      phis = instruction.opcode == opcode_t::PHI;
+      position[list[i]] = i;
+    }
+    for (const block_t successor : successors(block)) {
+      if (successor >= blocks_.size()) {
+        fail(block, "jump to missing block");
+      }
+      expected_predecessors[successor].push_back(block);
+    }
+  }
+  for (block_t block = 0; block < blocks_.size(); ++block) {
+    auto actual = blocks_[block].predecessors;
+    std::sort(actual.begin(), actual.end());
+    std::sort(expected_predecessors[block].begin(), expected_predecessors[block].end());
+    if (actual != expected_predecessors[block]) {
+      fail(block, "predecessors don't match successors of other blocks");
+    }
+  }
+  const auto idom = dominators();
+  for (block_t block = 0; block < blocks_.size(); ++block) {
+    if (idom[block] == no_block) {
+      fail(block, "block is unreachable");
+    }
+  }
+  auto dominates = [&idom](block_t dominator, block_t block) {
+    while (block != dominator && block != entry) {
+      block = idom[block];
+    }
+    return block == dominator;
+  };
+  for (value_t value = 0; value < instructions_.size(); ++value) {
+    const auto& instruction = instructions_[value];
+    if (instruction.block == no_block) {
+      continue;
+    }
+    const block_t block = instruction.block;
+    const std::string name = "%" + std::to_string(value);
+    auto expect_operands = [&](size_t count) {
+      if (instruction.operands.size() != count) {
+        fail(block, name + " has wrong count of operands");
+      }
+    };
+    auto expect_node = [&](std::initializer_list<ast::type_t> types) {
+      if (!instruction.node || std::find(types.begin(), types.end(), instruction.node->ast_type()) == types.end()) {
+        fail(block, name + " has wrong source node");
+      }
+    };
+    switch (instruction.opcode) {
+      case opcode_t::CONSTANT: {
+        expect_operands(0);
+        expect_node({ast::type_t::INTEGER, ast::type_t::FLOAT, ast::type_t::STRING, ast::type_t::ARRAY});
+        if (instruction.type != literal_type(instruction.node)) {
+          fail(block, name + " has type other than its literal");
+        }
+        break;
+      }
+      case opcode_t::PARAMETER: {
+        expect_operands(0);
+        if (block != entry || instruction.index >= parameters_) {
+          fail(block, name + " is not a parameter of entry block");
+        }
+        break;
+      }
+      case opcode_t::LOAD: {
+        expect_operands(0);
+        expect_node({ast::type_t::SYMBOL});
+        break;
+      }
+      case opcode_t::BINARY:
+      case opcode_t::UPDATE: {
+        expect_operands(2);
+        expect_node({ast::type_t::BINARY});
+        break;
+      }
+      case opcode_t::UNARY: {
+        expect_operands(1);
+        expect_node({ast::type_t::UNARY});
+        break;
+      }
+      case opcode_t::FIELD: {
+        expect_operands(1);
+        expect_node({ast::type_t::TYPE_FIELD});
+        break;
+      }
+      case opcode_t::CALL: {
+        expect_node({ast::type_t::LAMBDA_CALL});
+        const auto& call = static_cast<const ast::LambdaCall&>(*instruction.node);
+        const bool has_callee = call.target() == ast::LambdaCall::target_t::VARIABLE && call.in_frame();
+        expect_operands(call.arguments().size() + (has_callee ? 1 : 0));
+        break;
+      }
+      case opcode_t::CREATE: {
+        expect_operands(0);
+        expect_node({ast::type_t::TYPE_CREATOR});
+        break;
+      }
+      case opcode_t::PHI: {
+        if (instruction.blocks != blocks_[block].predecessors || instruction.operands.size() != instruction.blocks.size()) {
+          fail(block, name + " doesn't match predecessors");
+        }
+        break;
+      }
+      case opcode_t::JUMP: {
+        expect_operands(0);
+        if (instruction.blocks.size() != 1) {
+          fail(block, name + " has wrong count of successors");
+        }
+        break;
+      }
+      case opcode_t::BRANCH: {
+        expect_operands(1);
+        if (instruction.blocks.size() != 2) {
+          fail(block, name + " has wrong count of successors");
+        }
+        break;
+      }
+      case opcode_t::RETURN: {
+        if (instruction.operands.size() > 1 || !instruction.blocks.empty()) {
+          fail(block, name + " has wrong operands");
+        }
+        break;
+      }
+    }
+    for (size_t i = 0; i < instruction.operands.size(); ++i) {
+      const value_t operand = instruction.operands[i];
+      if (operand >= instructions_.size() || instructions_[operand].block == no_block || is_terminator(instructions_[operand].opcode)) {
+        fail(block, name + " uses missing value");
+      }
+      const block_t definition = instructions_[operand].block;
+      if (instruction.opcode == opcode_t::PHI) {
+        /// Value comes along edge from predecessor, so it must be available at its end.
+        if (!dominates(definition, instruction.blocks[i])) {
+          fail(block, name + " uses %" + std::to_string(operand) + ", which doesn't dominate incoming edge");
+        }
+      } else if (definition == block ? position[operand] >= position[value] : !dominates(definition, block)) {
+        fail(block, name + " uses %" + std::to_string(operand) + " before its definition");
+      }
+    }
+    /// Unary and update change their operand in place, so they keep its type.
+    if ((instruction.opcode == opcode_t::UNARY || instruction.opcode == opcode_t::UPDATE) && instruction.type != instructions_[instruction.operands[0]].type) {
+      fail(block, name + " has type other than its operand");
+    }
+    if (instruction.opcode == opcode_t::BINARY && instruction.type != static_cast<const ast::Binary&>(*instruction.node).inferred_type()) {
+      fail(block, name + " has type other than its source node");
+    }
+    if (instruction.opcode == opcode_t::PHI && instruction.type != ast::inferred_t::UNKNOWN) {
+      for (const value_t operand : instruction.operands) {
+        if (operand != value && instructions_[operand].type != instruction.type) {
+          fail(block, name + " has type, which differs from its operands");
+        }
+      }
+    }
+  }
+}
+
+std::string Function::dump() const noexcept(false) {
+  std::ostringstream stream;
+  stream << "function " << name_ << "(" << parameters_ << ")\n";
+  /// Values are numbered in order of blocks, so removed instructions and terminators leave no gaps.
+  std::vector<size_t> numbers(instructions_.size(), 0);
+  size_t count = 0;
+  for (const auto& block : blocks_) {
+    for (const value_t value : block.instructions) {
+      if (!is_terminator(instructions_[value].opcode)) {
+        numbers[value] = count++;
+      }
+    }
+  }
+  auto print_operands = [&stream, &numbers](const std::vector<value_t>& operands, size_t from) {
+    for (size_t i = from; i < operands.size(); ++i) {
+      stream << (i > from ? ", " : "") << '%' << numbers[operands[i]];
+    }
+  };
+  for (block_t block = 0; block < blocks_.size(); ++block) {
+    stream << "block" << block << ":";
+    const auto& predecessors = blocks_[block].predecessors;
+    for (size_t i = 0; i < predecessors.size(); ++i) {
+      stream << (i == 0 ? " ; preds " : ", ") << "block" << predecessors[i];
+    }
+    stream << '\n';
+    for (const value_t value : blocks_[block].instructions) {
+      const auto& instruction = instructions_[value];
+      stream << "  ";
+      if (!is_terminator(instruction.opcode)) {
+        stream << '%' << numbers[value] << " = ";
+      }
+      stream << opcode_name(instruction.opcode);
+      switch (instruction.opcode) {
+        case opcode_t::CONSTANT: {
+          stream << ' ';
+          print_literal(stream, instruction.node);
+          break;
+        }
+        case opcode_t::PARAMETER: {
+          stream << ' ' << instruction.index;
+          break;
+        }
+        case opcode_t::LOAD: {
+          stream << ' ' << static_cast<const ast::Symbol&>(*instruction.node).name();
+          break;
+        }
+        case opcode_t::BINARY:
+        case opcode_t::UNARY:
+        case opcode_t::UPDATE: {
+          stream << ' ' << dispatch_token(instruction.op) << ' ';
+          print_operands(instruction.operands, 0);
+          break;
+        }
+        case opcode_t::CALL: {
+          const auto& call = static_cast<const ast::LambdaCall&>(*instruction.node);
+          const bool has_callee = call.target() == ast::LambdaCall::target_t::VARIABLE && call.in_frame();
+          stream << ' ';
+          if (has_callee) {
+            stream << '%' << numbers[instruction.operands[0]];
+          } else {
+            stream << call.name();
+          }
+          stream << '(';
+          print_operands(instruction.operands, has_callee ? 1 : 0);
+          stream << ')';
+          break;
+        }
+        case opcode_t::CREATE: {
+          const auto& creator = static_cast<const ast::TypeCreator&>(*instruction.node);
+          stream << ' ' << creator.name() << '(';
+          for (size_t i = 0; i < creator.arguments().size(); ++i) {
+            stream << (i > 0 ? ", " : "");
+            print_literal(stream, creator.arguments()[i]);
+          }
+          stream << ')';
+          break;
+        }
+        case opcode_t::FIELD: {
+          stream << " %" << numbers[instruction.operands[0]] << '.' << static_cast<const ast::TypeFieldOperator&>(*instruction.node).field();
+          break;
+        }
+        case opcode_t::PHI: {
+          for (size_t i = 0; i < instruction.operands.size(); ++i) {
+            stream << (i > 0 ? ", " : " ") << "[%" << numbers[instruction.operands[i]] << ", block" << instruction.blocks[i] << ']';
+          }
+          break;
+        }
+        case opcode_t::JUMP: {
+          stream << " block" << instruction.blocks[0];
+          break;
+        }
+        case opcode_t::BRANCH: {
+          stream << " %" << numbers[instruction.operands[0]] << ", block" << instruction.blocks[0] << ", block" << instruction.blocks[1];
+          break;
+        }
+        case opcode_t::RETURN: {
+          if (!instruction.operands.empty()) {
+            stream << " %" << numbers[instruction.operands[0]];
+          }
+          break;
+        }
+      }
+      if (!is_terminator(instruction.opcode)) {
+        stream << " : " << type_name(instruction.type);
+      }
+      stream << '\n';
+    }
+  }
+  return stream.str();
+}
+
+}// namespace ir
@@ -0,0 +1,447 @@
+#include "../../include/ir/ir.hpp"
+
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+using object_t = boost::local_shared_ptr<ast::Object>;
+using ir::block_t;
+using ir::Instruction;
+using ir::opcode_t;
+using ir::value_t;
+
+bool is_literal(const object_t& node) noexcept(true) {
+  const auto type = node->ast_type();
+  return type == ast::type_t::INTEGER || type == ast::type_t::FLOAT || type == ast::type_t::STRING;
+}
+
+ast::inferred_t literal_type(const object_t& node) noexcept(true) {
+  // clang-format off
+  switch (node->ast_type()) {
+    case ast::type_t::INTEGER: { return ast::inferred_t::INTEGER; }
+    case ast::type_t::FLOAT: { return ast::inferred_t::FLOAT; }
+    case ast::type_t::STRING: { return ast::inferred_t::STRING; }
+    default: { return ast::inferred_t::ARRAY; }
+  }
+  // clang-format on
+}
+
+/// Builds SSA form by walking body in evaluation order. Frame slots map to their
+/// current values; loop headers get phis for all defined slots, and the phis, which
+/// turn out to merge only one value, are removed at the end.
+class Lowering {
+public:
+  explicit Lowering(const ast::Lambda& lambda) noexcept(false)
+    : lambda_(lambda)
+    , function_(lambda.name(), static_cast<uint32_t>(lambda.arguments().size()))
+    , environment_(lambda.frame_size()) {}
+
+  ir::Function run() noexcept(false) {
+    current_ = function_.add_block();
+    for (uint32_t i = 0; i < function_.parameters(); ++i) {
+      Instruction parameter;
+      parameter.opcode = opcode_t::PARAMETER;
+      parameter.index = i;
+      environment_[i] = append(std::move(parameter));
+    }
+    const auto& statements = lambda_.body()->statements();
+    std::optional<value_t> result;
+    for (const auto& statement : statements) {
+      result = lower(statement);
+    }
+    Instruction ret;
+    ret.opcode = opcode_t::RETURN;
+    if (result) {
+      ret.operands.push_back(*result);
+    }
+    append(std::move(ret));
+    remove_trivial_phis();
+    infer_types();
+    return std::move(function_);
+  }
+
+private:
+  value_t append(Instruction instruction) noexcept(false) {
+    return function_.append(current_, std::move(instruction));
+  }
+
+  value_t append(opcode_t opcode, ast::inferred_t type, token_t op, std::vector<value_t> operands, object_t node) noexcept(false) {
+    Instruction instruction;
+    instruction.opcode = opcode;
+    instruction.type = type;
+    instruction.op = op;
+    instruction.operands = std::move(operands);
+    instruction.node = std::move(node);
+    return append(std::move(instruction));
+  }
+
+  void jump(block_t target) noexcept(false) {
+    Instruction instruction;
+    instruction.opcode = opcode_t::JUMP;
+    instruction.blocks = {target};
+    append(std::move(instruction));
+  }
+
+  void branch(value_t condition, block_t taken, block_t other) noexcept(false) {
+    Instruction instruction;
+    instruction.opcode = opcode_t::BRANCH;
+    instruction.operands = {condition};
+    instruction.blocks = {taken, other};
+    append(std::move(instruction));
+  }
+
+  /// @return value of expression
+  value_t value(const object_t& node) noexcept(false) {
+    const auto result = lower(node);
+    if (!result) {
+      throw std::runtime_error("Statement is used as value");
+    }
+    return *result;
+  }
+
+  value_t read(const ast::Symbol& symbol) noexcept(false) {
+    const auto& slot = environment_[symbol.slot()];
+    if (!slot) {
+      throw std::runtime_error("Variable may be read before assignment: " + symbol.name());
+    }
+    return *slot;
+  }
+
+  const ast::Symbol& frame_symbol(const object_t& node) noexcept(false) {
+    if (node->ast_type() != ast::type_t::SYMBOL || !static_cast<const ast::Symbol&>(*node).in_frame()) {
+      throw std::runtime_error("Assignment out of lambda frame");
+    }
+    return static_cast<const ast::Symbol&>(*node);
+  }
+
+  /// @return value of expression, none for statements and assignments, which values
+  ///         are nodes of tree
+  std::optional<value_t> lower(const object_t& node) noexcept(false) {
+    switch (node->ast_type()) {
+      case ast::type_t::INTEGER:
+      case ast::type_t::FLOAT:
+      case ast::type_t::STRING: {
+        return append(opcode_t::CONSTANT, literal_type(node), token_t::NONE, {}, node);
+      }
+      case ast::type_t::ARRAY: {
+        /// Elements are replaced by their values in place, that only literals survive.
+        for (const auto& element : static_cast<const ast::Array&>(*node).elements()) {
+          if (!is_literal(element)) {
+            throw std::runtime_error("Array of expressions");
+          }
+        }
+        return append(opcode_t::CONSTANT, ast::inferred_t::ARRAY, token_t::NONE, {}, node);
+      }
+      case ast::type_t::SYMBOL: {
+        const auto& symbol = static_cast<const ast::Symbol&>(*node);
+        if (symbol.in_frame()) {
+          return read(symbol);
+        }
+        return append(opcode_t::LOAD, ast::inferred_t::UNKNOWN, token_t::NONE, {}, node);
+      }
+      case ast::type_t::TYPE_FIELD: {
+        const auto& field = static_cast<const ast::TypeFieldOperator&>(*node);
+        if (!field.in_frame()) {
+          throw std::runtime_error("Field of variable out of lambda frame");
+        }
+        const auto& slot = environment_[field.slot()];
+        if (!slot) {
+          throw std::runtime_error("Variable may be read before assignment: " + field.name());
+        }
+        return append(opcode_t::FIELD, ast::inferred_t::UNKNOWN, token_t::NONE, {*slot}, node);
+      }
+      case ast::type_t::TYPE_CREATOR: {
+        /// Evaluator stores arguments as they are written.
+        for (const auto& argument : static_cast<const ast::TypeCreator&>(*node).arguments()) {
+          if (!is_literal(argument)) {
+            throw std::runtime_error("Type creation with expressions");
+          }
+        }
+        return append(opcode_t::CREATE, ast::inferred_t::OBJECT, token_t::NONE, {}, node);
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        return lower_call(node);
+      }
+      case ast::type_t::BINARY: {
+        return lower_binary(node);
+      }
+      case ast::type_t::UNARY: {
+        const auto& unary = static_cast<const ast::Unary&>(*node);
+        const auto& operand = unary.operand();
+        value_t changed = 0;
+        if (operand->ast_type() == ast::type_t::SYMBOL && static_cast<const ast::Symbol&>(*operand).in_frame()) {
+          changed = read(static_cast<const ast::Symbol&>(*operand));
+        } else if (is_literal(operand)) {
+          changed = value(operand);
+        } else {
+          throw std::runtime_error("Unary operand out of lambda frame");
+        }
+        const value_t result = append(opcode_t::UNARY, function_.instruction(changed).type, unary.type(), {changed}, node);
+        if (operand->ast_type() == ast::type_t::SYMBOL) {
+          environment_[static_cast<const ast::Symbol&>(*operand).slot()] = result;
+        }
+        return result;
+      }
+      case ast::type_t::BLOCK: {
+        for (const auto& statement : static_cast<const ast::Block&>(*node).statements()) {
+          lower(statement);
+        }
+        return std::nullopt;
+      }
+      case ast::type_t::IF: {
+        lower_if(static_cast<const ast::If&>(*node));
+        return std::nullopt;
+      }
+      case ast::type_t::WHILE: {
+        const auto& while_ = static_cast<const ast::While&>(*node);
+        lower_loop(while_.exit_condition(), *while_.body(), nullptr);
+        return std::nullopt;
+      }
+      case ast::type_t::FOR: {
+        const auto& for_ = static_cast<const ast::For&>(*node);
+        if (!for_.loop_init() || !for_.exit_condition() || !for_.increment()) {
+          throw std::runtime_error("For loop without init, condition or increment");
+        }
+        lower(for_.loop_init());
+        /// Evaluator picks numeric type of condition by counter.
+        const auto* init = for_.loop_init()->ast_type() == ast::type_t::BINARY ? &static_cast<const ast::Binary&>(*for_.loop_init()) : nullptr;
+        if (!init || init->type() != token_t::ASSIGN || function_.instruction(read(frame_symbol(init->lhs()))).type != ast::inferred_t::INTEGER) {
+          throw std::runtime_error("For loop without integral counter");
+        }
+        lower_loop(for_.exit_condition(), *for_.body(), &for_.increment());
+        return std::nullopt;
+      }
+      default: {
+        throw std::runtime_error("Construct can't be lowered");
+      }
+    }
+  }
+
+  std::optional<value_t> lower_call(const object_t& node) noexcept(false) {
+    const auto& call = static_cast<const ast::LambdaCall&>(*node);
+    std::vector<value_t> operands;
+    for (const auto& argument : call.arguments()) {
+      operands.push_back(value(argument));
+    }
+    /// Variable callee is read after arguments.
+    if (call.target() == ast::LambdaCall::target_t::VARIABLE && call.in_frame()) {
+      const auto& slot = environment_[call.slot()];
+      if (!slot) {
+        throw std::runtime_error("Variable may be read before assignment: " + call.name());
+      }
+      operands.insert(operands.begin(), *slot);
+    }
+    return append(opcode_t::CALL, ast::inferred_t::UNKNOWN, token_t::NONE, std::move(operands), node);
+  }
+
+  std::optional<value_t> lower_binary(const object_t& node) noexcept(false) {
+    const auto& binary = static_cast<const ast::Binary&>(*node);
+    const token_t type = binary.type();
+    if (type == token_t::ASSIGN) {
+      const auto& symbol = frame_symbol(binary.lhs());
+      environment_[symbol.slot()] = value(binary.rhs());
+      return std::nullopt;
+    }
+    if (token_traits::is_assign_operator(type)) {
+      const auto& symbol = frame_symbol(binary.lhs());
+      /// Right side is evaluated before variable is read.
+      const value_t rhs = value(binary.rhs());
+      const value_t lhs = read(symbol);
+      environment_[symbol.slot()] = append(opcode_t::UPDATE, function_.instruction(lhs).type, type, {lhs, rhs}, node);
+      return std::nullopt;
+    }
+    const value_t lhs = value(binary.lhs());
+    const value_t rhs = value(binary.rhs());
+    return append(opcode_t::BINARY, binary.inferred_type(), type, {lhs, rhs}, node);
+  }
+
+  void lower_if(const ast::If& if_) noexcept(false) {
+    const value_t condition = value(if_.condition());
+    const block_t then_block = function_.add_block();
+    const block_t else_block = function_.add_block();
+    branch(condition, then_block, else_block);
+    const auto before = environment_;
+
+    current_ = then_block;
+    lower(if_.body());
+    const block_t then_end = current_;
+    auto then_environment = std::move(environment_);
+
+    environment_ = before;
+    current_ = else_block;
+    if (if_.else_body()) {
+      lower(if_.else_body());
+    }
+    const block_t else_end = current_;
+
+    const block_t merge = function_.add_block();
+    current_ = then_end;
+    jump(merge);
+    current_ = else_end;
+    jump(merge);
+    current_ = merge;
+    for (size_t slot = 0; slot < environment_.size(); ++slot) {
+      auto& value = environment_[slot];
+      const auto& then_value = then_environment[slot];
+      if (!value || !then_value) {
+        /// Variable, assigned only in one branch, may be missing after if.
+        value.reset();
+        continue;
+      }
+      if (*value != *then_value) {
+        const value_t phi = function_.add_phi(merge, ast::inferred_t::UNKNOWN);
+        auto& instruction = function_.instruction(phi);
+        instruction.operands = {*then_value, *value};
+        instruction.blocks = {then_end, else_end};
+        value = phi;
+      }
+    }
+  }
+
+  /// @param  increment - statement after body, null for while loop
+  void lower_loop(const object_t& exit_condition, const ast::Block& body, const object_t* increment) noexcept(false) {
+    const block_t preheader = current_;
+    const block_t header = function_.add_block();
+    jump(header);
+    std::vector<std::pair<size_t, value_t>> phis;
+    for (size_t slot = 0; slot < environment_.size(); ++slot) {
+      if (auto& value = environment_[slot]) {
+        const value_t phi = function_.add_phi(header, ast::inferred_t::UNKNOWN);
+        auto& instruction = function_.instruction(phi);
+        instruction.operands = {*value};
+        instruction.blocks = {preheader};
+        phis.emplace_back(slot, phi);
+        value = phi;
+      }
+    }
+    current_ = header;
+    const value_t condition = value(exit_condition);
+    const block_t body_block = function_.add_block();
+    const block_t exit = function_.add_block();
+    branch(condition, body_block, exit);
+    /// Only header runs before exit, so variables of body don't survive loop.
+    const auto after = environment_;
+
+    current_ = body_block;
+    for (const auto& statement : body.statements()) {
+      lower(statement);
+    }
+    if (increment) {
+      lower(*increment);
+    }
+    const block_t latch = current_;
+    jump(header);
+    for (const auto& [slot, phi] : phis) {
+      auto& instruction = function_.instruction(phi);
+      instruction.operands.push_back(*environment_[slot]);
+      instruction.blocks.push_back(latch);
+    }
+    environment_ = after;
+    current_ = exit;
+  }
+
+  /// @brief  remove phis, which merge the only value (besides themselves)
+  void remove_trivial_phis() noexcept(false) {
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (value_t value = 0; value < function_.instructions_count(); ++value) {
+        const auto& instruction = function_.instruction(value);
+        if (instruction.opcode != opcode_t::PHI || instruction.block == ir::no_block) {
+          continue;
+        }
+        std::optional<value_t> same;
+        bool trivial = true;
+        for (const value_t operand : instruction.operands) {
+          if (operand == value || operand == same) {
+            continue;
+          }
+          trivial = !same;
+          same = operand;
+        }
+        if (trivial && same) {
+          function_.replace_uses(value, *same);
+          function_.remove(value);
+          changed = true;
+        }
+      }
+    }
+  }
+
+  /// @brief  give phis types, which all their operands share, first optimistically
+  ///         over loops, then drop types, that loops don't keep
+  void infer_types() noexcept(false) {
+    const size_t count = function_.instructions_count();
+    auto is_derived = [this](value_t value) {
+      const auto& instruction = function_.instruction(value);
+      return instruction.block != ir::no_block && (instruction.opcode == opcode_t::PHI || instruction.opcode == opcode_t::UNARY || instruction.opcode == opcode_t::UPDATE);
+    };
+    /// Types of derived values, not known yet.
+    std::vector<bool> top(count, false);
+    for (value_t value = 0; value < count; ++value) {
+      top[value] = is_derived(value);
+    }
+    auto join = [this, &top](value_t value, bool optimistic) -> std::optional<ast::inferred_t> {
+      const auto& instruction = function_.instruction(value);
+      std::optional<ast::inferred_t> type;
+      for (size_t i = 0; i < instruction.operands.size(); ++i) {
+        const value_t operand = instruction.operands[i];
+        if (operand == value || (optimistic && top[operand])) {
+          continue;
+        }
+        const auto operand_type = top[operand] ? ast::inferred_t::UNKNOWN : function_.instruction(operand).type;
+        type = !type || *type == operand_type ? operand_type : ast::inferred_t::UNKNOWN;
+        if (instruction.opcode != opcode_t::PHI) {
+          break;
+        }
+      }
+      return type;
+    };
+    for (bool optimistic : {true, false}) {
+      for (bool changed = true; changed;) {
+        changed = false;
+        for (value_t value = 0; value < count; ++value) {
+          if (!is_derived(value)) {
+            continue;
+          }
+          const auto type = join(value, optimistic);
+          if (type && (top[value] || *type != function_.instruction(value).type)) {
+            function_.instruction(value).type = *type;
+            top[value] = false;
+            changed = true;
+          }
+        }
+      }
+      if (optimistic) {
+        for (value_t value = 0; value < count; ++value) {
+          if (top[value]) {
+            function_.instruction(value).type = ast::inferred_t::UNKNOWN;
+            top[value] = false;
+          }
+        }
+      }
+    }
+  }
+
+  const ast::Lambda& lambda_;
+  ir::Function function_;
+  std::vector<std::optional<value_t>> environment_;
+  block_t current_ = 0;
+};
+
+}// namespace
+
+namespace ir {
+
+Function Function::lower(const ast::Lambda& lambda) noexcept(false) {
+  if (lambda.is_lazy() || !lambda.is_bound()) {
+    throw std::runtime_error("Lambda is not bound");
+  }
+  /// Empty body returns nothing before arguments are checked.
+  if (lambda.body()->statements().empty()) {
+    throw std::runtime_error("Empty body");
+  }
+  return Lowering(lambda).run();
+}
+
+}// namespace ir
@@ -0,0 +1,485 @@
+#include "../../include/ir/ir.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <variant>
+
+namespace {
+
+using object_t = boost::local_shared_ptr<ast::Object>;
+using ir::block_t;
+using ir::Instruction;
+using ir::no_block;
+using ir::opcode_t;
+using ir::value_t;
+
+/// Turns control flow graph back into statements.
+///
+/// Loop header becomes while loop, which condition is the branch value of header;
+/// other branches become ifs, that end at their post-dominator. Phis, parameters and
+/// values, which are used more than once or out of their block, live in frame slots;
+/// other values are inlined into their user while it keeps order of evaluation.
+/// Unary and update change object of operand in place, so they keep it in its slot.
+class Materializer {
+public:
+  Materializer(const ir::Function& function, ast::Lambda& lambda) noexcept(false)
+    : function_(function)
+    , lambda_(lambda)
+    , uses_(function.use_counts())
+    , users_(function.instructions_count(), 0)
+    , dominators_(function.dominators())
+    , post_dominators_(function.post_dominators())
+    , representation_(function.instructions_count()) {
+    for (value_t value = 0; value < function_.instructions_count(); ++value) {
+      const auto& instruction = function_.instruction(value);
+      if (instruction.block == no_block) {
+        continue;
+      }
+      for (const value_t operand : instruction.operands) {
+        users_[operand] = value;
+      }
+    }
+    for (uint32_t i = 0; i < function_.parameters(); ++i) {
+      const auto& argument = static_cast<const ast::Symbol&>(*lambda_.arguments()[i]);
+      slots_.push_back({argument.name(), ast::scope_t::PARAMETER, ast::inferred_t::UNKNOWN});
+    }
+    for (value_t value = 0; value < function_.instructions_count(); ++value) {
+      const auto& instruction = function_.instruction(value);
+      if (instruction.block == no_block) {
+        continue;
+      }
+      if (instruction.opcode == opcode_t::PARAMETER) {
+        representation_[value] = Slot{instruction.index};
+      } else if (instruction.opcode == opcode_t::CONSTANT) {
+        representation_[value] = instruction.node;
+      } else if (instruction.opcode == opcode_t::PHI) {
+        representation_[value] = Slot{slot_of(value)};
+      }
+    }
+  }
+
+  void run() noexcept(false) {
+    std::vector<object_t> statements;
+    emit_region(ir::Function::entry, no_block, statements);
+    if (result_) {
+      statements.push_back(std::move(*result_));
+    } else if (statements.empty() || may_be_value(statements.back())) {
+      /// Block is not a value, so lambda returns nothing.
+      statements.push_back(boost::make_local_shared<ast::Block>(std::vector<object_t>{}));
+    }
+    lambda_.set_body(boost::make_local_shared<ast::Block>(std::move(statements)));
+    lambda_.bind(static_cast<uint32_t>(slots_.size()));
+  }
+
+private:
+  struct Slot {
+    uint32_t index;
+  };
+
+  struct SlotInfo {
+    std::string name;
+    ast::scope_t scope;
+    ast::inferred_t type;
+  };
+
+  /// Literal node or frame slot, which holds value. Empty until value is computed.
+  using representation_t = std::variant<std::monostate, object_t, Slot>;
+
+  static bool may_be_value(const object_t& statement) noexcept(true) {
+    switch (statement->ast_type()) {
+      case ast::type_t::IF:
+      case ast::type_t::WHILE:
+      case ast::type_t::FOR:
+      case ast::type_t::BLOCK: {
+        return false;
+      }
+      case ast::type_t::BINARY: {
+        const token_t type = static_cast<const ast::Binary&>(*statement).type();
+        return type != token_t::ASSIGN && !token_traits::is_assign_operator(type);
+      }
+      default: {
+        return true;
+      }
+    }
+  }
+
+  bool dominates(block_t dominator, block_t block) const noexcept(true) {
+    while (block != dominator && block != ir::Function::entry) {
+      block = dominators_[block];
+    }
+    return block == dominator;
+  }
+
+  bool is_loop_header(block_t block) const noexcept(true) {
+    const auto& predecessors = function_.block(block).predecessors;
+    return std::any_of(predecessors.begin(), predecessors.end(), [this, block](block_t predecessor) { return dominates(block, predecessor); });
+  }
+
+  /// @return slot of value, allocated on first call
+  uint32_t slot_of(value_t value) noexcept(false) {
+    const auto [it, inserted] = value_slots_.try_emplace(value, static_cast<uint32_t>(slots_.size()));
+    if (inserted) {
+      slots_.push_back({"@ssa" + std::to_string(value), ast::scope_t::LOCAL, function_.instruction(value).type});
+    }
+    return it->second;
+  }
+
+  object_t symbol(uint32_t slot) const noexcept(false) {
+    const auto& info = slots_[slot];
+    auto result = boost::make_local_shared<ast::Symbol>(info.name);
+    result->resolve(info.scope, slot);
+    result->set_inferred_type(info.type);
+    return result;
+  }
+
+  object_t assignment(uint32_t slot, object_t value) const noexcept(false) {
+    return boost::make_local_shared<ast::Binary>(token_t::ASSIGN, symbol(slot), std::move(value));
+  }
+
+  /// @return true if value is written into its user
+  bool is_inlined(value_t value) const noexcept(true) {
+    const auto& instruction = function_.instruction(value);
+    if (uses_[value] != 1 || !std::holds_alternative<std::monostate>(representation_[value]) || instruction.opcode == opcode_t::UNARY || instruction.opcode == opcode_t::UPDATE) {
+      return false;
+    }
+    const auto& user = function_.instruction(users_[value]);
+    if (user.block != instruction.block || user.opcode == opcode_t::PHI) {
+      return false;
+    }
+    /// Changed object, field owner and callee are read from variables.
+    const bool in_slot = user.opcode == opcode_t::UNARY || user.opcode == opcode_t::UPDATE || user.opcode == opcode_t::FIELD || (user.opcode == opcode_t::CALL && has_callee(user));
+    return !in_slot || user.operands[0] != value;
+  }
+
+  static bool has_callee(const Instruction& call) noexcept(true) {
+    const auto& node = static_cast<const ast::LambdaCall&>(*call.node);
+    return node.target() == ast::LambdaCall::target_t::VARIABLE && node.in_frame();
+  }
+
+  void emit(object_t statement) noexcept(false) {
+    output_->push_back(std::move(statement));
+  }
+
+  /// @brief  store all pending values into their slots in order of evaluation
+  void flush() noexcept(false) {
+    for (auto& [value, tree] : pending_) {
+      const uint32_t slot = slot_of(value);
+      emit(assignment(slot, std::move(tree)));
+      representation_[value] = Slot{slot};
+    }
+    pending_.clear();
+  }
+
+  /// @brief  keep tree of value for its user, store it into slot, or evaluate it as
+  ///         statement if it has no uses
+  void define(value_t value, object_t tree) noexcept(false) {
+    if (uses_[value] == 0) {
+      flush();
+      emit(std::move(tree));
+    } else if (is_inlined(value)) {
+      pending_.emplace_back(value, std::move(tree));
+    } else {
+      flush();
+      const uint32_t slot = slot_of(value);
+      emit(assignment(slot, std::move(tree)));
+      representation_[value] = Slot{slot};
+    }
+  }
+
+  object_t read(value_t value) noexcept(false) {
+    const auto& representation = representation_[value];
+    if (const auto* slot = std::get_if<Slot>(&representation)) {
+      return symbol(slot->index);
+    }
+    if (const auto* node = std::get_if<object_t>(&representation)) {
+      return *node;
+    }
+    throw std::runtime_error("Value %" + std::to_string(value) + " is used before its definition");
+  }
+
+  /// @return trees of operands; pending operands are taken if they are the last
+  ///         pending values, in order of operands, otherwise all pending values are
+  ///         stored first
+  std::vector<object_t> take_operands(const Instruction& instruction, size_t from) noexcept(false) {
+    std::vector<value_t> inlined;
+    for (size_t i = from; i < instruction.operands.size(); ++i) {
+      const value_t operand = instruction.operands[i];
+      if (std::any_of(pending_.begin(), pending_.end(), [operand](const auto& entry) { return entry.first == operand; })) {
+        inlined.push_back(operand);
+      }
+    }
+    bool in_order = inlined.size() <= pending_.size();
+    for (size_t i = 0; in_order && i < inlined.size(); ++i) {
+      in_order = pending_[pending_.size() - inlined.size() + i].first == inlined[i];
+    }
+    std::unordered_map<value_t, object_t> trees;
+    if (in_order) {
+      for (size_t i = pending_.size() - inlined.size(); i < pending_.size(); ++i) {
+        trees.emplace(pending_[i].first, std::move(pending_[i].second));
+      }
+      pending_.resize(pending_.size() - inlined.size());
+    } else {
+      flush();
+    }
+    std::vector<object_t> result;
+    for (size_t i = from; i < instruction.operands.size(); ++i) {
+      const value_t operand = instruction.operands[i];
+      const auto it = trees.find(operand);
+      result.push_back(it != trees.end() ? std::move(it->second) : read(operand));
+    }
+    return result;
+  }
+
+  /// @return slot of operand, literal is stored into slot of user first
+  uint32_t operand_slot(value_t user, value_t operand) noexcept(false) {
+    if (const auto* slot = std::get_if<Slot>(&representation_[operand])) {
+      return slot->index;
+    }
+    flush();
+    const uint32_t slot = slot_of(user);
+    emit(assignment(slot, read(operand)));
+    return slot;
+  }
+
+  void emit_instruction(value_t value) noexcept(false) {
+    const auto& instruction = function_.instruction(value);
+    switch (instruction.opcode) {
+      case opcode_t::LOAD:
+      case opcode_t::CREATE: {
+        define(value, instruction.node);
+        return;
+      }
+      case opcode_t::BINARY: {
+        auto operands = take_operands(instruction, 0);
+        auto binary = boost::make_local_shared<ast::Binary>(instruction.op, std::move(operands[0]), std::move(operands[1]));
+        binary->set_inferred_type(static_cast<const ast::Binary&>(*instruction.node).inferred_type());
+        define(value, std::move(binary));
+        return;
+      }
+      case opcode_t::FIELD: {
+        const auto& source = static_cast<const ast::TypeFieldOperator&>(*instruction.node);
+        const uint32_t slot = operand_slot(value, instruction.operands[0]);
+        auto field = boost::make_local_shared<ast::TypeFieldOperator>(slots_[slot].name, source.field());
+        field->resolve(slots_[slot].scope, slot);
+        define(value, std::move(field));
+        return;
+      }
+      case opcode_t::CALL: {
+        const auto& source = static_cast<const ast::LambdaCall&>(*instruction.node);
+        std::optional<uint32_t> callee;
+        if (has_callee(instruction)) {
+          callee = operand_slot(value, instruction.operands[0]);
+        }
+        auto call = boost::make_local_shared<ast::LambdaCall>(source.name(), take_operands(instruction, callee ? 1 : 0));
+        switch (source.target()) {
+          // clang-format off
+          case ast::LambdaCall::target_t::BUILTIN: { call->bind(source.builtin()); break; }
+          case ast::LambdaCall::target_t::LAMBDA: { call->bind(source.lambda()); break; }
+          case ast::LambdaCall::target_t::VARIABLE: { call->bind_variable(); break; }
+          case ast::LambdaCall::target_t::UNRESOLVED: { break; }
+          // clang-format on
+        }
+        if (callee) {
+          call->resolve(slots_[*callee].scope, *callee);
+        } else {
+          call->resolve(source.in_frame() ? ast::scope_t::UNRESOLVED : source.scope());
+        }
+        define(value, std::move(call));
+        return;
+      }
+      case opcode_t::UNARY: {
+        const auto& source = static_cast<const ast::Unary&>(*instruction.node);
+        const value_t operand = instruction.operands[0];
+        flush();
+        auto unary = boost::make_local_shared<ast::Unary>(instruction.op, read(operand));
+        unary->set_inferred_type(source.inferred_type());
+        emit(std::move(unary));
+        representation_[value] = representation_[operand];
+        return;
+      }
+      case opcode_t::UPDATE: {
+        const auto& source = static_cast<const ast::Binary&>(*instruction.node);
+        auto rhs = std::move(take_operands(instruction, 1)[0]);
+        flush();
+        const uint32_t slot = operand_slot(value, instruction.operands[0]);
+        auto update = boost::make_local_shared<ast::Binary>(instruction.op, symbol(slot), std::move(rhs));
+        update->set_inferred_type(source.inferred_type());
+        emit(std::move(update));
+        representation_[value] = Slot{slot};
+        return;
+      }
+      default: {
+        return;
+      }
+    }
+  }
+
+  /// @brief  emit all instructions of block but phis and terminator
+  void emit_instructions(block_t block, std::vector<object_t>& output) noexcept(false) {
+    output_ = &output;
+    for (const value_t value : function_.block(block).instructions) {
+      if (!ir::is_terminator(function_.instruction(value).opcode)) {
+        emit_instruction(value);
+      }
+    }
+  }
+
+  /// @brief  assign phis of successor in parallel, as edge from block passes them values
+  void emit_copies(block_t block, block_t successor, std::vector<object_t>& output) noexcept(false) {
+    output_ = &output;
+    const auto& predecessors = function_.block(successor).predecessors;
+    const size_t edge = static_cast<size_t>(std::find(predecessors.begin(), predecessors.end(), block) - predecessors.begin());
+    /// Destination slot and source, which is a slot or a literal.
+    std::vector<std::pair<uint32_t, representation_t>> copies;
+    for (const value_t phi : function_.block(successor).instructions) {
+      const auto& instruction = function_.instruction(phi);
+      if (instruction.opcode != opcode_t::PHI) {
+        break;
+      }
+      const uint32_t destination = std::get<Slot>(representation_[phi]).index;
+      const auto& source = representation_[instruction.operands[edge]];
+      if (const auto* slot = std::get_if<Slot>(&source); slot && slot->index == destination) {
+        continue;
+      }
+      copies.emplace_back(destination, source);
+    }
+    auto reads = [&copies](uint32_t slot) {
+      return std::any_of(copies.begin(), copies.end(), [slot](const auto& copy) {
+        const auto* source = std::get_if<Slot>(&copy.second);
+        return source && source->index == slot;
+      });
+    };
+    auto source_tree = [this](const representation_t& source) {
+      const auto* slot = std::get_if<Slot>(&source);
+      return slot ? symbol(slot->index) : std::get<object_t>(source);
+    };
+    while (!copies.empty()) {
+      const auto ready = std::find_if(copies.begin(), copies.end(), [&reads](const auto& copy) { return !reads(copy.first); });
+      if (ready != copies.end()) {
+        emit(assignment(ready->first, source_tree(ready->second)));
+        copies.erase(ready);
+        continue;
+      }
+      /// Cycle: save the first destination, so its readers take the saved value.
+      const uint32_t saved = copies.front().first;
+      const uint32_t temporary = static_cast<uint32_t>(slots_.size());
+      slots_.push_back({"@ssa_copy" + std::to_string(temporary), ast::scope_t::LOCAL, slots_[saved].type});
+      emit(assignment(temporary, symbol(saved)));
+      for (auto& copy : copies) {
+        if (const auto* source = std::get_if<Slot>(&copy.second); source && source->index == saved) {
+          copy.second = Slot{temporary};
+        }
+      }
+    }
+  }
+
+  /// @brief  emit blocks from start until stop block, which is not emitted
+  void emit_region(block_t block, block_t stop, std::vector<object_t>& output) noexcept(false) {
+    while (block != stop) {
+      if (block == no_block) {
+        throw std::runtime_error("Control flow leaves region before its end");
+      }
+      if (is_loop_header(block)) {
+        block = emit_loop(block, output);
+        continue;
+      }
+      emit_instructions(block, output);
+      const auto& terminator = function_.instruction(function_.block(block).instructions.back());
+      switch (terminator.opcode) {
+        case opcode_t::JUMP: {
+          flush();
+          emit_copies(block, terminator.blocks[0], output);
+          block = terminator.blocks[0];
+          break;
+        }
+        case opcode_t::BRANCH: {
+          auto condition = std::move(take_operands(terminator, 0)[0]);
+          flush();
+          const block_t merge = post_dominators_[block];
+          std::vector<object_t> branches[2];
+          for (size_t i = 0; i < 2; ++i) {
+            const block_t successor = terminator.blocks[i];
+            emit_copies(block, successor, branches[i]);
+            if (successor != merge) {
+              emit_region(successor, merge, branches[i]);
+            }
+          }
+          output_ = &output;
+          emit(boost::make_local_shared<ast::If>(std::move(condition), boost::make_local_shared<ast::Block>(std::move(branches[0])), boost::make_local_shared<ast::Block>(std::move(branches[1]))));
+          block = merge;
+          break;
+        }
+        case opcode_t::RETURN: {
+          if (!terminator.operands.empty()) {
+            auto result = std::move(take_operands(terminator, 0)[0]);
+            flush();
+            result_ = std::move(result);
+          } else {
+            flush();
+          }
+          block = no_block;
+          break;
+        }
+        default: {
+          throw std::runtime_error("Block without terminator");
+        }
+      }
+      if (block == no_block && stop != no_block) {
+        throw std::runtime_error("Return inside of loop or branch");
+      }
+    }
+  }
+
+  /// @return exit block of loop
+  block_t emit_loop(block_t header, std::vector<object_t>& output) noexcept(false) {
+    const auto& terminator = function_.instruction(function_.block(header).instructions.back());
+    const block_t exit = post_dominators_[header];
+    if (terminator.opcode != opcode_t::BRANCH || terminator.blocks[1] != exit || terminator.blocks[0] == exit) {
+      throw std::runtime_error("Loop header doesn't branch into body and exit");
+    }
+    const auto condition_type = function_.instruction(terminator.operands[0]).type;
+    /// Header runs before the first check of condition and after each iteration.
+    emit_instructions(header, output);
+    auto condition = std::move(take_operands(terminator, 0)[0]);
+    flush();
+    std::vector<object_t> body;
+    emit_copies(header, terminator.blocks[0], body);
+    emit_region(terminator.blocks[0], header, body);
+    emit_instructions(header, body);
+    take_operands(terminator, 0);
+    flush();
+    output_ = &output;
+    auto loop = boost::make_local_shared<ast::While>(std::move(condition), boost::make_local_shared<ast::Block>(std::move(body)));
+    loop->set_inferred_type(condition_type);
+    emit(std::move(loop));
+    emit_copies(header, exit, output);
+    return exit;
+  }
+
+  const ir::Function& function_;
+  ast::Lambda& lambda_;
+  std::vector<size_t> uses_;
+  /// The last user of each value.
+  std::vector<value_t> users_;
+  std::vector<block_t> dominators_;
+  std::vector<block_t> post_dominators_;
+  std::vector<representation_t> representation_;
+  std::vector<SlotInfo> slots_;
+  std::unordered_map<value_t, uint32_t> value_slots_;
+  /// Values, which trees wait for their user, in order of evaluation.
+  std::vector<std::pair<value_t, object_t>> pending_;
+  std::vector<object_t>* output_ = nullptr;
+  std::optional<object_t> result_;
+};
+
+}// namespace
+
+namespace ir {
+
+void Function::materialize(ast::Lambda& lambda) const noexcept(false) {
+  Materializer(*this, lambda).run();
+}
+
+}// namespace ir
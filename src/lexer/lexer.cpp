@@ -2,10 +2,95 @@
 
 #include "../../include/grammar.hpp"
 
+#include <algorithm>
+#include <array>
+#include <iterator>
 #include <sstream>
 
+namespace {
+
+/// String literal recognition states, as they are seen by Lexer::process_string_literal().
+/// Any other token cannot contain a whitespace or quote, so outside of string literal
+/// each whitespace is a token boundary.
+enum struct scan_state_t : uint8_t {
+  OUTSIDE,// Not in string literal
+  OPENED, // Right after opening quote, next character is taken as is
+  INSIDE, // Inside string literal
+  ESCAPED // After backslash inside string literal
+};
+
+constexpr size_t scan_states_count = 4;
+
+constexpr scan_state_t scan_step(scan_state_t state, char c) noexcept(true) {
+  // clang-format off
+  switch (state) {
+    case scan_state_t::OUTSIDE: { return c == '\"' ? scan_state_t::OPENED : scan_state_t::OUTSIDE; }
+    case scan_state_t::OPENED: { return c == '\"' ? scan_state_t::OUTSIDE : scan_state_t::INSIDE; }
+    case scan_state_t::INSIDE: { return c == '\"' ? scan_state_t::OUTSIDE : (c == '\\' ? scan_state_t::ESCAPED : scan_state_t::INSIDE); }
+    default: { return scan_state_t::INSIDE; }
+  }
+  // clang-format on
+}
+
+/// Speculative scan runs the automaton from all states at once. Their tuple is
+/// packed into one byte (2 bits per lane), so scan does one table lookup per character.
+struct SpeculativeScanTable {
+  constexpr SpeculativeScanTable() noexcept(true)
+    : next{} {
+    for (size_t lanes = 0; lanes < 256; ++lanes) {
+      for (size_t c = 0; c < 256; ++c) {
+        uint8_t result = 0;
+        for (size_t lane = 0; lane < scan_states_count; ++lane) {
+          const auto state = static_cast<scan_state_t>((lanes >> (lane * 2)) & 0b11);
+          result |= static_cast<uint8_t>(scan_step(state, static_cast<char>(c))) << (lane * 2);
+        }
+        next[lanes][c] = result;
+      }
+    }
+  }
+  uint8_t next[256][256];
+};
+
+constexpr SpeculativeScanTable speculative_scan_table;
+
+/// @return state reached at the end of chunk for every possible state at the chunk start
+std::array<scan_state_t, scan_states_count> speculative_scan(std::string_view chunk) noexcept(true) {
+  /// Lane N starts from state N.
+  uint8_t lanes = 0b11100100;
+  for (char c : chunk) {
+    lanes = speculative_scan_table.next[lanes][static_cast<unsigned char>(c)];
+  }
+  std::array<scan_state_t, scan_states_count> transition{};
+  for (size_t lane = 0; lane < scan_states_count; ++lane) {
+    transition[lane] = static_cast<scan_state_t>((lanes >> (lane * 2)) & 0b11);
+  }
+  return transition;
+}
+
+bool is_space(char c) noexcept(true) {
+  switch (c) {
+    case ' ':
+    case '\n':
+    case '\r':
+    case '\f':
+    case '\v':
+    case '\t':
+      return true;
+    default:
+      return false;
+  }
+}
+
+}// namespace
+
 Lexer::Lexer(std::istringstream data)
-  : input_(std::istreambuf_iterator<char>(data), std::istreambuf_iterator<char>())
+  : data_(std::istreambuf_iterator<char>(data), std::istreambuf_iterator<char>())
+  , input_(data_.data(), data_.size())
+  , keywords_(test_keywords)
+  , operators_(test_operators) {}
+
+Lexer::Lexer(std::string_view chunk) noexcept(true)
+  : input_(chunk)
   , keywords_(test_keywords)
   , operators_(test_operators) {}
 
@@ -82,6 +167,85 @@ std::vector<Token> Lexer::tokenize() {
   return tokens;
 }
 
+std::vector<Token> Lexer::tokenize_parallel(ThreadPool& pool, size_t min_chunk_size) {
+  const size_t chunks_count = std::min(pool.size() * 4, input_.size() / std::max<size_t>(min_chunk_size, 1));
+  if (pool.size() < 2 || chunks_count < 2) {
+    return tokenize();
+  }
+  const std::vector<size_t> split_points = find_split_points(pool, chunks_count);
+
+  std::vector<std::future<std::vector<Token>>> chunks;
+  chunks.reserve(split_points.size() - 1);
+  for (size_t i = 0; i < split_points.size() - 1; ++i) {
+    chunks.emplace_back(pool.submit([chunk = input_.substr(split_points[i], split_points[i + 1] - split_points[i])] {
+      Lexer lexer(chunk);
+      std::vector<Token> tokens = lexer.tokenize();
+      tokens.pop_back();/// END_OF_DATA
+      return tokens;
+    }));
+  }
+  /// All chunks must be finished before an exception leaves this function.
+  for (auto& chunk : chunks) {
+    chunk.wait();
+  }
+  /// get() rethrows the error of first failed chunk, the same one serial lexer stops on.
+  std::vector<std::vector<Token>> chunk_tokens;
+  chunk_tokens.reserve(chunks.size());
+  size_t tokens_count = 1;
+  for (auto& chunk : chunks) {
+    chunk_tokens.emplace_back(chunk.get());
+    tokens_count += chunk_tokens.back().size();
+  }
+
+  std::vector<Token> tokens;
+  tokens.reserve(tokens_count);
+  for (auto& chunk : chunk_tokens) {
+    std::move(chunk.begin(), chunk.end(), std::back_inserter(tokens));
+  }
+  tokens.emplace_back(Token{"", token_t::END_OF_DATA});
+
+  return tokens;
+}
+
+std::vector<size_t> Lexer::find_split_points(ThreadPool& pool, size_t chunks_count) const {
+  std::vector<size_t> nominal_points;
+  nominal_points.reserve(chunks_count + 1);
+  for (size_t i = 0; i < chunks_count; ++i) {
+    nominal_points.push_back(input_.size() / chunks_count * i);
+  }
+  nominal_points.push_back(input_.size());
+
+  /// Chunk may start inside string literal, so first we find how each chunk
+  /// transforms each possible starting state.
+  std::vector<std::future<std::array<scan_state_t, scan_states_count>>> transitions;
+  transitions.reserve(chunks_count);
+  for (size_t i = 0; i < chunks_count; ++i) {
+    transitions.emplace_back(pool.submit([chunk = input_.substr(nominal_points[i], nominal_points[i + 1] - nominal_points[i])] {
+      return speculative_scan(chunk);
+    }));
+  }
+
+  /// Then the real starting states are resolved in order and each nominal point is moved
+  /// forward to the nearest whitespace outside of string literal. If there is no such
+  /// whitespace before the next nominal point, chunks are merged.
+  std::vector<size_t> split_points{0};
+  scan_state_t state = scan_state_t::OUTSIDE;
+  for (size_t i = 1; i < chunks_count; ++i) {
+    state = transitions[i - 1].get()[static_cast<size_t>(state)];
+    scan_state_t position_state = state;
+    for (size_t position = nominal_points[i]; position < nominal_points[i + 1]; ++position) {
+      if (position_state == scan_state_t::OUTSIDE && is_space(input_[position])) {
+        split_points.push_back(position);
+        break;
+      }
+      position_state = scan_step(position_state, input_[position]);
+    }
+  }
+  split_points.push_back(input_.size());
+
+  return split_points;
+}
+
 Token Lexer::process_digit() {
   std::string digit(1, previous());
   size_t dots_reached = 0;
@@ -107,21 +271,27 @@ Token Lexer::process_digit() {
 }
 
 Token Lexer::process_string_literal() {
+  if (!has_next()) {
+    throw LexicalError("Closing '\\\"' expected");
+  }
   peek();/// Eat opening "
 
   if (previous() == '\"') {
     return Token{"", token_t::STRING_LITERAL};
   }
   std::string literal(1, previous());
-  while (current() != '\"') {
-    if (has_next() && current() == '\\') {
+  while (has_next() && current() != '\"') {
+    if (current() == '\\') {
       peek();
     }
-    if (current() == '\0') {
+    if (!has_next() || current() == '\0') {
       throw LexicalError("Closing '\\\"' expected");
     }
     literal += peek();
   }
+  if (!has_next()) {
+    throw LexicalError("Closing '\\\"' expected");
+  }
   peek();/// Eat closing "
 
   return Token{std::move(literal), token_t::STRING_LITERAL};
@@ -0,0 +1,194 @@
+#include "../../include/lexer/module_loader.hpp"
+
+#include "../../include/fnv1a.hpp"
+#include "../../include/lexer/lexer.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+/// Files smaller than that are tokenized serially even if pool is set.
+constexpr size_t parallel_tokenize_threshold = 1 << 20;
+
+/// @return canonical path of request, relative one is resolved against the requester's directory
+std::string resolve_path(std::string_view requester, std::string_view request) noexcept(false) {
+  std::filesystem::path path = std::filesystem::path(requester).parent_path() / request;
+  return std::filesystem::weakly_canonical(path).string();
+}
+
+}// namespace
+
+ModuleLoader::ModuleLoader(ThreadPool* pool) noexcept(true)
+  : pool_(pool) {}
+
+void ModuleLoader::load(std::string_view filename) noexcept(false) {
+  const std::string root = std::filesystem::weakly_canonical(std::filesystem::absolute(filename)).string();
+  if (indices_.contains(root)) {
+    return;
+  }
+  std::unordered_map<std::string, PendingModule> pending = discover(root);
+  sort(root, pending);
+}
+
+const std::vector<ModuleLoader::Module>& ModuleLoader::modules() const noexcept(true) {
+  return modules_;
+}
+
+std::vector<ModuleLoader::Module> ModuleLoader::take_modules() noexcept(true) {
+  std::vector<Module> modules = std::move(modules_);
+  modules_.clear();
+  indices_.clear();
+  return modules;
+}
+
+std::vector<Token> ModuleLoader::take_tokens() noexcept(false) {
+  size_t tokens_count = 1;
+  for (const Module& module : modules_) {
+    tokens_count += module.tokens.size();
+  }
+  std::vector<Token> tokens;
+  tokens.reserve(tokens_count);
+  for (Module& module : modules_) {
+    std::move(module.tokens.begin(), module.tokens.end(), std::back_inserter(tokens));
+  }
+  tokens.push_back(Token{"", token_t::END_OF_DATA});
+  modules_.clear();
+  indices_.clear();
+  return tokens;
+}
+
+ModuleLoader::PendingModule ModuleLoader::read_module(std::string path, bool parallel_tokenize) const noexcept(false) {
+  std::ifstream file(path);
+  if (!file) {
+    throw LoadError("Cannot open file: {}", path);
+  }
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  std::string data = std::move(contents).str();
+  const uint64_t source_hash = fnv1a::create(data);
+  parallel_tokenize = parallel_tokenize && data.size() >= parallel_tokenize_threshold;
+
+  Lexer lexer(std::istringstream{std::move(data)});
+  std::vector<Token> tokens = parallel_tokenize ? lexer.tokenize_parallel(*pool_) : lexer.tokenize();
+  tokens.pop_back();// END_OF_DATA
+
+  PendingModule pending;
+  pending.module.path = std::move(path);
+  pending.module.source_hash = source_hash;
+  pending.module.tokens.reserve(tokens.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (tokens[i].type != token_t::LOAD) {
+      pending.module.tokens.push_back(std::move(tokens[i]));
+      continue;
+    }
+    if (i + 2 >= tokens.size() || tokens[i + 1].type != token_t::STRING_LITERAL || tokens[i + 2].type != token_t::SEMICOLON) {
+      throw LoadError("In {}: expected `load \"filename\";`", pending.module.path);
+    }
+    pending.requests.push_back(resolve_path(pending.module.path, tokens[i + 1].data));
+    i += 2;
+  }
+  return pending;
+}
+
+std::unordered_map<std::string, ModuleLoader::PendingModule> ModuleLoader::discover(const std::string& root) const noexcept(false) {
+  std::unordered_map<std::string, PendingModule> pending;
+  std::vector<std::string> level{root};
+  pending.emplace(root, PendingModule{});
+
+  while (!level.empty()) {
+    std::vector<PendingModule> modules;
+    modules.reserve(level.size());
+    if (!pool_ || pool_->size() < 2 || level.size() < 2) {
+      for (std::string& path : level) {
+        modules.push_back(read_module(std::move(path), /*parallel_tokenize=*/pool_ != nullptr));
+      }
+    } else {
+      std::vector<std::future<PendingModule>> futures;
+      futures.reserve(level.size());
+      for (std::string& path : level) {
+        futures.push_back(pool_->submit([this, path = std::move(path)]() mutable {
+          return read_module(std::move(path), /*parallel_tokenize=*/false);
+        }));
+      }
+      /// Wait for all files to be sure no task outlives this function,
+      /// then report the first error in level order.
+      for (auto& future : futures) {
+        future.wait();
+      }
+      for (auto& future : futures) {
+        modules.push_back(future.get());
+      }
+    }
+
+    level.clear();
+    for (PendingModule& module : modules) {
+      for (const std::string& request : module.requests) {
+        if (!indices_.contains(request) && pending.emplace(request, PendingModule{}).second) {
+          level.push_back(request);
+        }
+      }
+      pending[module.module.path] = std::move(module);
+    }
+  }
+  return pending;
+}
+
+void ModuleLoader::sort(const std::string& root, std::unordered_map<std::string, PendingModule>& pending) noexcept(false) {
+  struct Frame {
+    PendingModule* module;
+    size_t next_request = 0;
+  };
+
+  std::unordered_map<std::string, state_t> states;
+  /// Explicit stack instead of recursion, so deep load chains don't overflow call stack.
+  std::vector<Frame> stack;
+  std::vector<std::string> paths_stack;
+
+  auto open = [&](const std::string& path) {
+    states.emplace(path, state_t::IN_PROGRESS);
+    paths_stack.push_back(path);
+    stack.push_back(Frame{&pending.at(path)});
+  };
+
+  open(root);
+  while (!stack.empty()) {
+    Frame& top = stack.back();
+    Module& module = top.module->module;
+    if (top.next_request < top.module->requests.size()) {
+      const std::string& path = top.module->requests[top.next_request++];
+      if (auto index = indices_.find(path); index != indices_.end()) {
+        module.dependencies.push_back(index->second);
+      } else if (!states.contains(path)) {
+        open(path);
+      } else {
+        throw LoadError("Cyclic load: {}", cycle_trace(paths_stack, path));
+      }
+      continue;
+    }
+    const size_t index = modules_.size();
+    states[module.path] = state_t::LOADED;
+    indices_.emplace(module.path, index);
+    modules_.push_back(std::move(module));
+    stack.pop_back();
+    paths_stack.pop_back();
+    if (!stack.empty()) {
+      stack.back().module->module.dependencies.push_back(index);
+    }
+  }
+}
+
+std::string ModuleLoader::cycle_trace(const std::vector<std::string>& stack, const std::string& path) const noexcept(false) {
+  std::string trace;
+  auto begin = std::find(stack.begin(), stack.end(), path);
+  for (auto it = begin; it != stack.end(); ++it) {
+    trace += *it;
+    trace += " -> ";
+  }
+  trace += path;
+  return trace;
+}
@@ -1,48 +1,223 @@
-#include "../include/lexer/preprocessor.hpp"
+#include "../include/cache/program_cache.hpp"
+#include "../include/eval/session.hpp"
+#include "../include/ir/ir.hpp"
+#include "../include/lexer/module_loader.hpp"
+#include "../include/optimizer/optimizer.hpp"
+#include "../include/parser/module_parser.hpp"
+#include "../include/semantic/semantic_analyzer.hpp"
 #include "../include/tests/test_crc32.hpp"
 #include "../include/tests/test_eval.hpp"
+#include "../include/tests/test_flat_tree.hpp"
+#include "../include/tests/test_fnv1a.hpp"
 #include "../include/tests/test_format.hpp"
+#include "../include/tests/test_ir.hpp"
 #include "../include/tests/test_lexer.hpp"
+#include "../include/tests/test_module_loader.hpp"
+#include "../include/tests/test_parser.hpp"
+#include "../include/tests/test_program_cache.hpp"
 #include "../include/tests/test_semantic.hpp"
+#include "../include/tests/test_session.hpp"
 #include "../include/tests/test_storage.hpp"
+#include "../include/tests/test_tree_shaker.hpp"
 
+#include "../include/thread_pool.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <cstring>
 #include <iostream>
 
 std::ostringstream ostream_buffer;
 std::ostream& default_stdout = ostream_buffer;
 
-void eval(std::string_view program) {
-  trace_error("", [&program] {
-    Lexer lexer(std::istringstream{program.data()});
-    Parser parser(lexer.tokenize());
-    auto parsed_program = parser.parse();
-    SemanticAnalyzer semantic_analyzer(parsed_program);
-    semantic_analyzer.analyze();
-    Evaluator evaluator(parsed_program);
-    evaluator.eval();
-    try {
-      auto& ostream = dynamic_cast<std::ostringstream&>(default_stdout);
-      std::cout << ostream.str() << '\n';
-      ostream.str("");
-    } catch (std::bad_cast&) {}
-    default_stdout.clear();
-  });
+ThreadPool& front_end_pool() {
+  static ThreadPool pool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+void flush_stdout() {
+  try {
+    auto& ostream = dynamic_cast<std::ostringstream&>(default_stdout);
+    std::cout << ostream.str() << '\n';
+    ostream.str("");
+  } catch (std::bad_cast&) {}
+  default_stdout.clear();
 }
 
-void eval_file(std::string_view filename) {
-  std::string processed_file = preprocess_file(filename);
-  eval(processed_file);
+struct OptimizerOptions {
+  /// 0 evaluates program as is, 1 runs all passes once, 2 repeats them until nothing changes.
+  unsigned level = 0;
+  /// Replace passes of level, if not empty.
+  std::vector<Optimizer::Pass> passes;
+  bool print_stats = false;
+  /// Print SSA form of top-level lambdas after passes.
+  bool dump_ir = false;
+};
+
+struct MemoOptions {
+  bool enabled = false;
+  bool print_stats = false;
+};
+
+struct TieringOptions {
+  bool enabled = false;
+  bool print_trace = false;
+  Tiering::Thresholds thresholds;
+};
+
+std::string_view tier_reason_name(Tiering::reason_t reason) {
+  // clang-format off
+  switch (reason) {
+    case Tiering::reason_t::CALLS: { return "calls"; }
+    case Tiering::reason_t::BACK_EDGES: { return "back edges"; }
+    case Tiering::reason_t::GUARD_MISSES: { return "guard misses"; }
+  }
+  // clang-format on
+  return {};
 }
 
-[[noreturn]] void run_repr() {
+std::string_view inferred_type_name(ast::inferred_t type) {
+  // clang-format off
+  switch (type) {
+    case ast::inferred_t::INTEGER: { return "integer"; }
+    case ast::inferred_t::FLOAT: { return "float"; }
+    case ast::inferred_t::STRING: { return "string"; }
+    default: { return "unknown"; }
+  }
+  // clang-format on
+}
+
+void print_tier_trace(const std::vector<Tiering::Event>& events) {
+  for (const auto& event : events) {
+    std::cerr << "Tier-up " << event.lambda << " on " << tier_reason_name(event.reason) << ": " << event.calls << " call(s), " << event.back_edges << " back edge(s), ";
+    if (event.parameters.empty()) {
+      std::cerr << "generic";
+    } else {
+      std::cerr << "specialized (";
+      for (size_t i = 0; i < event.parameters.size(); ++i) {
+        std::cerr << (i > 0 ? ", " : "") << inferred_type_name(event.parameters[i]);
+      }
+      std::cerr << ")";
+    }
+    std::cerr << ", " << event.changes << " change(s)\n";
+  }
+}
+
+void optimize(boost::local_shared_ptr<ast::RootObject>& program, const OptimizerOptions& optimization) {
+  if (optimization.level > 0 || !optimization.passes.empty()) {
+    Optimizer optimizer = optimization.passes.empty() ? Optimizer(program, optimization.level) : Optimizer(program, optimization.passes, optimization.level > 1);
+    optimizer.optimize();
+    if (optimization.print_stats) {
+      std::chrono::nanoseconds total{0};
+      for (const auto& pass : optimizer.stats()) {
+        std::cerr << "Optimizer pass " << pass.name << ": " << pass.changes << " change(s) in " << pass.runs << " run(s), " << std::chrono::duration<double, std::milli>(pass.time).count() << " ms\n";
+        total += pass.time;
+      }
+      std::cerr << "Optimizer: " << optimizer.iterations() << " iteration(s), " << std::chrono::duration<double, std::milli>(total).count() << " ms\n";
+    }
+  }
+}
+
+void eval(boost::local_shared_ptr<ast::RootObject>& program, const OptimizerOptions& optimization, MemoOptions memo, TieringOptions tiering) {
+  if (optimization.dump_ir) {
+    for (const auto& expression : program->get()) {
+      if (expression->ast_type() != ast::type_t::LAMBDA) {
+        continue;
+      }
+      const auto& lambda = static_cast<const ast::Lambda&>(*expression);
+      try {
+        std::cerr << ir::Function::lower(lambda).dump();
+      } catch (std::runtime_error& error) {
+        std::cerr << "function " << lambda.name() << ": not lowered, " << error.what() << "\n";
+      }
+    }
+  }
+  Evaluator evaluator(program);
+  if (memo.enabled) {
+    evaluator.enable_memoization();
+  }
+  if (tiering.enabled) {
+    evaluator.enable_tiering(tiering.thresholds);
+  }
+  evaluator.eval();
+  flush_stdout();
+  if (memo.print_stats) {
+    const auto stats = evaluator.memo_stats();
+    std::cerr << "Memoization: " << stats.hits << " hit(s), " << stats.misses << " miss(es), " << stats.evictions << " eviction(s)\n";
+  }
+  if (tiering.print_trace) {
+    print_tier_trace(evaluator.tier_events());
+  }
+}
+
+/// @return options, that change compiled program, to key its cache entry
+std::string cache_variant(const ModuleParserOptions& options, const OptimizerOptions& optimization) {
+  std::string variant = options.tree_shaking ? "shake" : "no-shake";
+  variant += ";O" + std::to_string(optimization.level);
+  if (!optimization.passes.empty()) {
+    variant += ";passes=";
+    for (const auto& pass : optimization.passes) {
+      variant += pass.name;
+      variant += ',';
+    }
+  }
+  return variant;
+}
+
+/// @param use_cache - load and store optimized program; lazily parsed programs are not cached
+/// @param print_shaking_stats - report declarations removed by tree shaking
+/// @param optimization - level or passes of optimizer and whether its stats are reported
+/// @param memo - cache results of pure lambdas
+/// @param tiering - optimize hot lambdas while program runs and whether tier-up events are reported
+void eval_file(std::string_view filename, bool use_cache, ModuleParserOptions options, bool print_shaking_stats, OptimizerOptions optimization, MemoOptions memo, TieringOptions tiering) {
+  trace_error(filename, [&filename, use_cache, options, print_shaking_stats, optimization, memo, tiering] {
+    const ProgramCache cache(ProgramCache::default_directory());
+    const bool cached = use_cache && !options.lazy_bodies;
+    const std::string variant = cache_variant(options, optimization);
+    if (cached) {
+      if (auto program = cache.load(filename, variant)) {
+        /// Bindings refer to nodes, so they are not cached.
+        SemanticAnalyzer::bind(*program);
+        eval(program, optimization, memo, tiering);
+        return;
+      }
+    }
+    ModuleLoader loader(&front_end_pool());
+    loader.load(filename);
+    std::vector<ProgramCache::Source> sources;
+    for (const auto& module : loader.modules()) {
+      sources.push_back({module.path, module.source_hash});
+    }
+    TreeShaker::Stats shaking_stats;
+    auto program = parse_modules(loader.take_modules(), &front_end_pool(), options, &shaking_stats);
+    if (print_shaking_stats) {
+      std::cerr << "Tree shaking: " << shaking_stats.declarations << " declaration(s), " << shaking_stats.nodes << " node(s) removed\n";
+    }
+    optimize(program, optimization);
+    /// Stored before evaluation, since evaluator changes literals in place.
+    if (cached) {
+      cache.store(filename, sources, *program, variant);
+    }
+    eval(program, optimization, memo, tiering);
+  });
+}
+
+void run_repr() {
+  Session session;
   while (true) {
     std::cout << ">>> ";
 
-    std::string program;
-    std::getline(std::cin, program);
+    const auto input = Session::read_input(std::cin, std::cout);
+    if (!input) {
+      return;
+    }
+    const std::string& program = *input;
 
-    eval(program);
+    trace_error(program, [&session, &program] {
+      session.eval(program);
+      flush_stdout();
+    });
   }
 }
 
@@ -50,34 +225,149 @@ float run_tests() {
   auto start = std::chrono::high_resolution_clock::now();
 
   run_crc32_tests();
+  run_fnv1a_tests();
   run_format_tests();
   run_lexer_tests();
+  run_parser_tests();
+  run_module_loader_tests();
+  run_program_cache_tests();
   run_semantic_analyzer_tests();
+  run_flat_tree_tests();
+  run_tree_shaker_tests();
   run_storage_tests();
   run_eval_tests();
+  run_ir_tests();
+  run_session_tests();
   //run_eval_speed_tests();
 
   auto time_spent = std::chrono::high_resolution_clock::now() - start;
   return std::chrono::duration_cast<std::chrono::duration<float>>(time_spent).count();
 }
 
+/// @return false if value is not a positive number
+bool parse_threshold(std::string_view value, size_t& threshold) {
+  const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), threshold);
+  return error == std::errc() && end == value.data() + value.size() && threshold > 0;
+}
+
+void print_usage(std::string_view program) {
+  std::cout << "Usage: " << program << " [options] file.wl\n"
+            << "       " << program << " test\n"
+            << "Without arguments starts interactive session.\n"
+            << "Options:\n"
+            << "  --cache          load and store analyzed and optimized program in\n"
+            << "                   $XDG_CACHE_HOME/weak_language (~/.cache/weak_language)\n"
+            << "  --no-cache       don't use program cache (default)\n"
+            << "  --lazy           parse and analyze lambda bodies on first call, not cached\n"
+            << "  --no-shake       keep declarations unreachable from main\n"
+            << "  --shake-stats    report declarations removed by tree shaking\n"
+            << "  -O0, -O1, -O2    optimizer level, -O is -O1\n"
+            << "  --passes=a,b     run given optimizer passes instead of level pipeline\n"
+            << "  --opt-stats      report optimizer passes\n"
+            << "  --dump-ir        print SSA form of top-level lambdas\n"
+            << "  --memoize        cache results of pure lambdas\n"
+            << "  --memo-stats     --memoize and report its counters\n"
+            << "  --tier           optimize hot lambdas while program runs\n"
+            << "  --tier-trace     --tier and report tier-up events\n"
+            << "  --tier-calls=N   calls, that make lambda hot, 1000 by default\n"
+            << "  --tier-back-edges=N\n"
+            << "                   loop iterations, that make lambda hot, 10000 by default\n"
+            << "  --help           print this message\n";
+}
+
 int main(int argc, char* argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+      print_usage(argv[0]);
+      return 0;
+    }
+  }
   if (argc == 1) {
     run_repr();
-  } else if (argc == 2) {
-    if (strcmp(argv[1], "test") == 0) {
-      constexpr size_t tests_to_run = 2;
-      float times[tests_to_run];
-      for (float& time : times) {
-        time = run_tests();
+    return 0;
+  }
+  if (argc == 2 && strcmp(argv[1], "test") == 0) {
+    constexpr size_t tests_to_run = 2;
+    float times[tests_to_run];
+    for (float& time : times) {
+      time = run_tests();
+    }
+    for (size_t i = 0; i < tests_to_run; ++i) {
+      std::cout << "Test " << i << ": " << times[i] << " s.\n";
+    }
+    return 0;
+  }
+
+  bool use_cache = false;
+  bool print_shaking_stats = false;
+  MemoOptions memo;
+  TieringOptions tiering;
+  OptimizerOptions optimization;
+  ModuleParserOptions options;
+  options.tree_shaking = true;
+  for (int i = 1; i < argc - 1; ++i) {
+    if (strcmp(argv[i], "--cache") == 0) {
+      use_cache = true;
+    } else if (strcmp(argv[i], "--no-cache") == 0) {
+      use_cache = false;
+    } else if (strcmp(argv[i], "--lazy") == 0) {
+      options.lazy_bodies = true;
+    } else if (strcmp(argv[i], "--no-shake") == 0) {
+      options.tree_shaking = false;
+    } else if (strcmp(argv[i], "--shake-stats") == 0) {
+      print_shaking_stats = true;
+    } else if (strcmp(argv[i], "-O0") == 0) {
+      optimization.level = 0;
+    } else if (strcmp(argv[i], "-O1") == 0 || strcmp(argv[i], "-O") == 0) {
+      optimization.level = 1;
+    } else if (strcmp(argv[i], "-O2") == 0) {
+      optimization.level = 2;
+    } else if (strncmp(argv[i], "--passes=", 9) == 0) {
+      optimization.passes.clear();
+      std::string_view names(argv[i] + 9);
+      while (!names.empty()) {
+        const auto name = names.substr(0, names.find(','));
+        const auto* pass = Optimizer::find_pass(name);
+        if (!pass) {
+          std::cerr << "Unknown optimizer pass: " << name << "\n";
+          return 1;
+        }
+        optimization.passes.push_back(*pass);
+        names.remove_prefix(std::min(names.size(), name.size() + 1));
+      }
+    } else if (strcmp(argv[i], "--opt-stats") == 0) {
+      optimization.print_stats = true;
+    } else if (strcmp(argv[i], "--dump-ir") == 0) {
+      optimization.dump_ir = true;
+    } else if (strcmp(argv[i], "--memoize") == 0) {
+      memo.enabled = true;
+    } else if (strcmp(argv[i], "--memo-stats") == 0) {
+      memo.enabled = true;
+      memo.print_stats = true;
+    } else if (strcmp(argv[i], "--tier") == 0) {
+      tiering.enabled = true;
+    } else if (strcmp(argv[i], "--tier-trace") == 0) {
+      tiering.enabled = true;
+      tiering.print_trace = true;
+    } else if (strncmp(argv[i], "--tier-calls=", 13) == 0) {
+      if (!parse_threshold(argv[i] + 13, tiering.thresholds.calls)) {
+        std::cerr << "Invalid threshold: " << argv[i] << "\n";
+        return 1;
       }
-      for (size_t i = 0; i < tests_to_run; ++i) {
-        std::cout << "Test " << i << ": " << times[i] << " s.\n";
+      tiering.enabled = true;
+    } else if (strncmp(argv[i], "--tier-back-edges=", 18) == 0) {
+      if (!parse_threshold(argv[i] + 18, tiering.thresholds.back_edges)) {
+        std::cerr << "Invalid threshold: " << argv[i] << "\n";
+        return 1;
       }
+      tiering.enabled = true;
     } else {
-      eval_file(argv[1]);
+      std::cerr << "Unknown option: " << argv[i] << "\n";
+      print_usage(argv[0]);
+      return 1;
     }
   }
+  eval_file(argv[argc - 1], use_cache, options, print_shaking_stats, optimization, memo, tiering);
 
   return 0;
 }
@@ -0,0 +1,350 @@
+#include "../../include/optimizer/common_subexpression_eliminator.hpp"
+
+#include "../../include/optimizer/tree_utility.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using namespace optimization;
+
+/// Temporary costs an assignment and an allocation, so it must save evaluation of
+/// that many nodes.
+constexpr size_t min_saving = 4;
+/// Call costs more than other nodes, since arguments are copied into frame.
+constexpr size_t call_cost = 4;
+constexpr size_t no_parent = std::numeric_limits<size_t>::max();
+
+/// How the value of expression is used.
+enum struct use_t {
+  /// Read and dropped.
+  CONSUMED,
+  /// Assigned to variable, which never changes it or gives it away.
+  STORED,
+  /// Kept, or passed where it may be changed.
+  KEPT
+};
+
+/// Numbered expression.
+struct Occurrence {
+  object_t* node = nullptr;
+  size_t statement = 0;
+  /// Position in evaluation order.
+  size_t order = 0;
+  size_t cost = 0;
+  use_t use = use_t::KEPT;
+  /// Nearest enclosing occurrence.
+  size_t parent = no_parent;
+  /// Replaced by read of temporary; the first occurrence is moved into temporary instead.
+  bool replaced = false;
+};
+
+/// Value number and cost of expression; expression without number has empty key.
+struct Value {
+  std::string key;
+  size_t cost = 1;
+};
+
+bool is_commutative(token_t type) noexcept(true) {
+  return type == token_t::PLUS || type == token_t::STAR || type == token_t::EQ || type == token_t::NEQ || type == token_t::BIT_AND || type == token_t::BIT_OR || type == token_t::BIT_XOR;
+}
+
+/// @return true if expression has no effects but possible runtime error
+bool is_clean(const object_t& node) noexcept(true) {
+  switch (node->ast_type()) {
+    case ast::type_t::INTEGER:
+    case ast::type_t::FLOAT:
+    case ast::type_t::STRING:
+    case ast::type_t::SYMBOL:
+    case ast::type_t::TYPE_FIELD: {
+      return true;
+    }
+    case ast::type_t::BINARY: {
+      const auto& binary = static_cast<const ast::Binary&>(*node);
+      return !is_assignment(binary.type()) && is_clean(binary.lhs()) && is_clean(binary.rhs());
+    }
+    case ast::type_t::LAMBDA_CALL: {
+      const auto& call = static_cast<const ast::LambdaCall&>(*node);
+      const auto& arguments = call.arguments();
+      return reads_arguments(call) && !is_output(call) && std::all_of(arguments.begin(), arguments.end(), is_clean);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+class NumberingPass {
+public:
+  explicit NumberingPass(ast::Lambda& lambda) noexcept(true)
+    : lambda_(lambda) {}
+
+  size_t run() noexcept(false) {
+    if (lambda_.is_lazy() || !lambda_.is_bound()) {
+      return 0;
+    }
+    frame_size_ = lambda_.frame_size();
+    aliases_ = AliasAnalysis(lambda_);
+    versions_.assign(frame_size_, 0);
+    number_block(*lambda_.body());
+    lambda_.bind(frame_size_);
+    return reused_;
+  }
+
+private:
+  void number_block(ast::Block& block) noexcept(false) {
+    auto& statements = block.statements();
+    for (const auto& statement : statements) {
+      if (statement->ast_type() == ast::type_t::LAMBDA) {
+        reused_ += NumberingPass(static_cast<ast::Lambda&>(*statement)).run();
+        continue;
+      }
+      for_each_block(statement, [this](ast::Block& nested) { number_block(nested); });
+    }
+    occurrences_.clear();
+    values_.clear();
+    forget();
+    for (size_t i = 0; i < statements.size(); ++i) {
+      number_statement(statements[i], i);
+    }
+    auto temporaries = reuse();
+    std::sort(temporaries.begin(), temporaries.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    /// From the end, so positions of earlier statements stay valid.
+    for (auto it = temporaries.rbegin(); it != temporaries.rend(); ++it) {
+      statements.insert(statements.begin() + static_cast<ssize_t>(it->first.first), std::move(it->second));
+    }
+  }
+
+  void number_statement(const object_t& statement, size_t index) noexcept(false) {
+    switch (statement->ast_type()) {
+      case ast::type_t::BINARY: {
+        auto& binary = static_cast<ast::Binary&>(*statement);
+        if (!is_assignment(binary.type()) || !is_clean(binary.rhs())) {
+          apply_effects(statement);
+          return;
+        }
+        const auto& symbol = static_cast<const ast::Symbol&>(*binary.lhs());
+        use_t use = use_t::CONSUMED;
+        if (binary.type() == token_t::ASSIGN) {
+          use = symbol.in_frame() && !aliases_.is_kept(symbol.slot()) && !aliases_.is_shared(symbol.slot()) ? use_t::STORED : use_t::KEPT;
+        }
+        visit(binary.rhs(), use, index, no_parent);
+        apply_effects(statement);
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        auto& call = static_cast<ast::LambdaCall&>(*statement);
+        auto& arguments = call.arguments();
+        if (!reads_arguments(call) || !std::all_of(arguments.begin(), arguments.end(), is_clean)) {
+          apply_effects(statement);
+          return;
+        }
+        const bool builtin = call.target() == ast::LambdaCall::target_t::BUILTIN;
+        for (auto& argument : arguments) {
+          visit(argument, builtin ? use_t::CONSUMED : use_t::KEPT, index, no_parent);
+        }
+        return;
+      }
+      case ast::type_t::IF: {
+        auto& if_ = static_cast<ast::If&>(*statement);
+        if (is_clean(if_.condition())) {
+          visit(if_.condition(), use_t::CONSUMED, index, no_parent);
+        }
+        apply_effects(statement);
+        return;
+      }
+      default: {
+        apply_effects(statement);
+        return;
+      }
+    }
+  }
+
+  /// @brief  change value numbers of variables, which node may change
+  void apply_effects(const object_t& node) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::LAMBDA: {
+        /// Declaration is stored in storage.
+        forget();
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        if (!reads_arguments(static_cast<const ast::LambdaCall&>(*node))) {
+          forget();
+        }
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    for_each_child(node, [this](const object_t& child) { apply_effects(child); });
+    /// Change is done after operands are evaluated.
+    if (const auto* symbol = changed_symbol(node)) {
+      if (symbol->in_frame()) {
+        ++versions_[symbol->slot()];
+      }
+      if (!symbol->in_frame() || aliases_.is_shared(symbol->slot())) {
+        ++shared_epoch_;
+      }
+    } else if (const auto* assigned = assigned_symbol(node)) {
+      ++versions_[assigned->slot()];
+    }
+  }
+
+  void forget() noexcept(true) {
+    ++epoch_;
+  }
+
+  Value visit(object_t& node, use_t use, size_t statement, size_t parent) noexcept(false) {
+    switch (node->ast_type()) {
+      case ast::type_t::INTEGER: {
+        return {"i" + static_cast<const ast::Integer&>(*node).to_string()};
+      }
+      case ast::type_t::FLOAT: {
+        return {"f" + std::to_string(std::bit_cast<uint64_t>(static_cast<const ast::Float&>(*node).value()))};
+      }
+      case ast::type_t::SYMBOL: {
+        const auto& symbol = static_cast<const ast::Symbol&>(*node);
+        if (!symbol.in_frame()) {
+          return {};
+        }
+        const uint32_t slot = symbol.slot();
+        std::string key = "s" + std::to_string(slot) + "." + std::to_string(versions_[slot]) + "." + std::to_string(epoch_);
+        if (aliases_.is_shared(slot)) {
+          key += "." + std::to_string(shared_epoch_);
+        }
+        return {std::move(key)};
+      }
+      case ast::type_t::BINARY: {
+        auto& binary = static_cast<ast::Binary&>(*node);
+        const size_t index = occurrences_.size();
+        occurrences_.push_back({&node, statement, 0, 0, use, parent});
+        auto lhs = visit(binary.lhs(), use_t::CONSUMED, statement, index);
+        auto rhs = visit(binary.rhs(), use_t::CONSUMED, statement, index);
+        if (lhs.key.empty() || rhs.key.empty()) {
+          return {};
+        }
+        /// Strings are concatenated in order.
+        if (is_commutative(binary.type()) && binary.inferred_type() == ast::inferred_t::INTEGER && rhs.key < lhs.key) {
+          std::swap(lhs, rhs);
+        }
+        return number(index, "(" + std::to_string(static_cast<int>(binary.type())) + " " + lhs.key + " " + rhs.key + ")", 1 + lhs.cost + rhs.cost);
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        auto& call = static_cast<ast::LambdaCall&>(*node);
+        const bool builtin = call.target() == ast::LambdaCall::target_t::BUILTIN;
+        const size_t index = occurrences_.size();
+        occurrences_.push_back({&node, statement, 0, 0, use, parent});
+        std::string key = builtin ? "b" + call.name() : "l" + std::to_string(reinterpret_cast<uintptr_t>(&call.lambda()));
+        size_t cost = call_cost;
+        bool numbered = true;
+        for (auto& argument : call.arguments()) {
+          /// Lambda may give its argument back.
+          auto value = visit(argument, builtin ? use_t::CONSUMED : use_t::KEPT, statement, index);
+          numbered &= !value.key.empty();
+          key += " " + value.key;
+          cost += value.cost;
+        }
+        return numbered ? number(index, "(" + key + ")", cost) : Value{};
+      }
+      default: {
+        return {};
+      }
+    }
+  }
+
+  Value number(size_t index, std::string key, size_t cost) noexcept(false) {
+    auto& occurrence = occurrences_[index];
+    occurrence.order = order_++;
+    occurrence.cost = cost;
+    values_[key].push_back(index);
+    return {std::move(key), cost};
+  }
+
+  /// @return true if occurrence is inside of expression, replaced by read
+  bool is_replaced(size_t index) const noexcept(true) {
+    for (; index != no_parent; index = occurrences_[index].parent) {
+      if (occurrences_[index].replaced) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// @brief  replace repeated expressions by reads of temporaries
+  /// @return assignments of temporaries, with statement and evaluation order of the first occurrence
+  std::vector<std::pair<std::pair<size_t, size_t>, object_t>> reuse() noexcept(false) {
+    std::vector<const std::vector<size_t>*> groups;
+    for (const auto& [_, group] : values_) {
+      if (group.size() > 1) {
+        groups.push_back(&group);
+      }
+    }
+    /// Larger expressions first, so their parts are not reused twice.
+    std::sort(groups.begin(), groups.end(), [this](const auto* lhs, const auto* rhs) {
+      return occurrences_[lhs->front()].cost != occurrences_[rhs->front()].cost ? occurrences_[lhs->front()].cost > occurrences_[rhs->front()].cost : occurrences_[lhs->front()].order < occurrences_[rhs->front()].order;
+    });
+    std::vector<std::pair<std::pair<size_t, size_t>, object_t>> temporaries;
+    for (const auto* group : groups) {
+      std::vector<size_t> alive;
+      std::copy_if(group->begin(), group->end(), std::back_inserter(alive), [this](size_t index) { return !is_replaced(index); });
+      const bool readable = std::none_of(alive.begin(), alive.end(), [this](size_t index) { return occurrences_[index].use == use_t::KEPT; });
+      if (alive.size() < 2 || !readable || occurrences_[alive.front()].cost * (alive.size() - 1) < min_saving) {
+        continue;
+      }
+      auto& first = occurrences_[alive.front()];
+      const uint32_t slot = frame_size_++;
+      aliases_.add_slot();
+      versions_.push_back(0);
+      const std::string name = "@value" + std::to_string(slot);
+      const auto& expression = *first.node;
+      const auto inferred = expression->ast_type() == ast::type_t::BINARY ? static_cast<const ast::Binary&>(*expression).inferred_type() : ast::inferred_t::UNKNOWN;
+      auto target = boost::make_local_shared<ast::Symbol>(name);
+      target->resolve(ast::scope_t::LOCAL, slot);
+      temporaries.push_back({{first.statement, first.order}, boost::make_local_shared<ast::Binary>(token_t::ASSIGN, std::move(target), expression)});
+      for (size_t index : alive) {
+        auto read = boost::make_local_shared<ast::Symbol>(name);
+        read->resolve(ast::scope_t::LOCAL, slot);
+        read->set_inferred_type(inferred);
+        *occurrences_[index].node = std::move(read);
+        occurrences_[index].replaced = index != alive.front();
+      }
+      reused_ += alive.size() - 1;
+    }
+    return temporaries;
+  }
+
+  ast::Lambda& lambda_;
+  uint32_t frame_size_ = 0;
+  size_t reused_ = 0;
+  AliasAnalysis aliases_;
+  /// Slot -> count of assignments and changes so far.
+  std::vector<size_t> versions_;
+  /// Changed when all values are forgotten.
+  size_t epoch_ = 0;
+  /// Changed when value of variable, that may share it, is changed in place.
+  size_t shared_epoch_ = 0;
+  size_t order_ = 0;
+  std::vector<Occurrence> occurrences_;
+  /// Value number -> occurrences in evaluation order.
+  std::unordered_map<std::string, std::vector<size_t>> values_;
+};
+
+}// namespace
+
+CommonSubexpressionEliminator::CommonSubexpressionEliminator(ast::Lambda& lambda) noexcept(true)
+  : lambda_(lambda) {}
+
+size_t CommonSubexpressionEliminator::run() noexcept(false) {
+  return NumberingPass(lambda_).run();
+}
@@ -0,0 +1,372 @@
+#include "../../include/optimizer/constant_folder.hpp"
+
+#include "../../include/error/eval_error.hpp"
+#include "../../include/eval/implementation/binary.hpp"
+#include "../../include/eval/implementation/unary.hpp"
+#include "../../include/optimizer/tree_utility.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+using namespace optimization;
+
+/// @return literal with value of expression over literals, null if it can't be computed
+///         without evaluator, or evaluation fails
+object_t fold(const object_t& expression) noexcept(false) {
+  if (expression->ast_type() == ast::type_t::BINARY) {
+    const auto& binary = static_cast<const ast::Binary&>(*expression);
+    const token_t type = binary.type();
+    const auto& lhs = binary.lhs();
+    const auto& rhs = binary.rhs();
+    if (type == token_t::ASSIGN || token_traits::is_assign_operator(type) || !is_number(lhs) || !is_number(rhs)) {
+      return nullptr;
+    }
+    /// Integral division by zero throws, so it's left for runtime.
+    try {
+      return eval_context::binary_implementation(lhs->ast_type(), rhs->ast_type(), type, lhs, rhs);
+    } catch (EvalError&) {
+      return nullptr;
+    }
+  }
+  if (expression->ast_type() == ast::type_t::UNARY) {
+    const auto& unary = static_cast<const ast::Unary&>(*expression);
+    if (!is_number(unary.operand())) {
+      return nullptr;
+    }
+    auto result = copy_number(unary.operand());
+    bool failed = false;
+    eval_context::unary_implementation(unary.type(), result, failed);
+    return failed ? nullptr : result;
+  }
+  return nullptr;
+}
+
+/// Variable, which is never changed in place, passed to lambda or returned, is called stable.
+class FoldingPass {
+public:
+  explicit FoldingPass(ast::Lambda& lambda) noexcept(true)
+    : lambda_(lambda) {}
+
+  size_t changes() const noexcept(true) {
+    return changes_;
+  }
+
+  void run() noexcept(false) {
+    auto& statements = lambda_.body()->statements();
+    if (lambda_.is_bound()) {
+      for (size_t i = 0; i < statements.size(); ++i) {
+        collect(statements[i], is_last(statements, i) ? use_t::ESCAPE : use_t::VALUE);
+      }
+      stabilize();
+    }
+    constants_t constants;
+    rewrite_block(*lambda_.body(), constants, /*is_body=*/true);
+  }
+
+private:
+  /// How the value of expression is used.
+  enum struct use_t {
+    /// Read and dropped.
+    VALUE,
+    /// Assigned to variable, that is stable if target slot is.
+    ASSIGNMENT,
+    /// Kept, returned or passed where it may be changed.
+    ESCAPE
+  };
+
+  struct Slot {
+    size_t assignments = 0;
+    size_t reads = 0;
+    size_t substituted = 0;
+    bool stable = true;
+    /// Slots, this one is assigned to.
+    std::vector<uint32_t> assigned_to;
+  };
+
+  /// Slot -> literal, assigned to it in dominating statement.
+  using constants_t = std::unordered_map<uint32_t, object_t>;
+
+  static bool is_last(const std::vector<object_t>& statements, size_t index) noexcept(true) {
+    return index + 1 == statements.size();
+  }
+
+  void mark_unstable(const ast::Resolvable& variable) noexcept(false) {
+    if (variable.in_frame()) {
+      slots_[variable.slot()].stable = false;
+    }
+  }
+
+  /// @return true if variable is a local, which value is always the same literal
+  bool is_constant(const ast::Symbol& symbol) const noexcept(true) {
+    if (symbol.scope() != ast::scope_t::LOCAL) {
+      return false;
+    }
+    const auto slot = slots_.find(symbol.slot());
+    return slot != slots_.end() && slot->second.stable && slot->second.assignments == 1;
+  }
+
+  bool is_safe(use_t use, uint32_t target) const noexcept(true) {
+    if (use == use_t::ASSIGNMENT) {
+      const auto slot = slots_.find(target);
+      return slot != slots_.end() && slot->second.stable;
+    }
+    return use == use_t::VALUE;
+  }
+
+  /// @brief  count assignments and reads of variables, find unstable ones
+  void collect(const object_t& node, use_t use, uint32_t target = 0) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::SYMBOL: {
+        const auto& symbol = static_cast<const ast::Symbol&>(*node);
+        if (!symbol.in_frame()) {
+          return;
+        }
+        auto& slot = slots_[symbol.slot()];
+        ++slot.reads;
+        if (use == use_t::ESCAPE) {
+          slot.stable = false;
+        } else if (use == use_t::ASSIGNMENT) {
+          slot.assigned_to.push_back(target);
+        }
+        return;
+      }
+      case ast::type_t::TYPE_FIELD: {
+        mark_unstable(static_cast<const ast::TypeFieldOperator&>(*node));
+        return;
+      }
+      case ast::type_t::BINARY: {
+        const auto& binary = static_cast<const ast::Binary&>(*node);
+        if (const ast::Symbol* symbol = assigned_symbol(node)) {
+          ++slots_[symbol->slot()].assignments;
+          collect(binary.rhs(), use_t::ASSIGNMENT, symbol->slot());
+        } else if (binary.type() == token_t::ASSIGN) {
+          collect(binary.rhs(), use_t::ESCAPE);
+        } else if (token_traits::is_assign_operator(binary.type())) {
+          mark_unstable(static_cast<const ast::Symbol&>(*binary.lhs()));
+          collect(binary.rhs(), use_t::VALUE);
+        } else {
+          collect(binary.lhs(), use_t::VALUE);
+          collect(binary.rhs(), use_t::VALUE);
+        }
+        return;
+      }
+      case ast::type_t::UNARY: {
+        const auto& operand = static_cast<const ast::Unary&>(*node).operand();
+        if (operand->ast_type() == ast::type_t::SYMBOL) {
+          mark_unstable(static_cast<const ast::Symbol&>(*operand));
+        }
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        const auto& call = static_cast<const ast::LambdaCall&>(*node);
+        if (call.target() == ast::LambdaCall::target_t::VARIABLE) {
+          mark_unstable(call);
+        }
+        const use_t arguments_use = is_output(call) ? use_t::VALUE : use_t::ESCAPE;
+        for (const auto& argument : call.arguments()) {
+          collect(argument, arguments_use);
+        }
+        return;
+      }
+      case ast::type_t::ARRAY: {
+        for (const auto& element : static_cast<const ast::Array&>(*node).elements()) {
+          collect(element, use_t::ESCAPE);
+        }
+        return;
+      }
+      case ast::type_t::TYPE_CREATOR: {
+        for (const auto& argument : static_cast<const ast::TypeCreator&>(*node).arguments()) {
+          collect(argument, use_t::ESCAPE);
+        }
+        return;
+      }
+      case ast::type_t::BLOCK: {
+        for (const auto& statement : static_cast<const ast::Block&>(*node).statements()) {
+          collect(statement, use_t::VALUE);
+        }
+        return;
+      }
+      case ast::type_t::IF: {
+        const auto& if_ = static_cast<const ast::If&>(*node);
+        collect(if_.condition(), use_t::VALUE);
+        collect(if_.body(), use_t::VALUE);
+        collect(if_.else_body(), use_t::VALUE);
+        return;
+      }
+      case ast::type_t::WHILE: {
+        const auto& while_ = static_cast<const ast::While&>(*node);
+        collect(while_.exit_condition(), use_t::VALUE);
+        collect(while_.body(), use_t::VALUE);
+        return;
+      }
+      case ast::type_t::FOR: {
+        const auto& for_ = static_cast<const ast::For&>(*node);
+        collect(for_.loop_init(), use_t::VALUE);
+        collect(for_.exit_condition(), use_t::VALUE);
+        collect(for_.increment(), use_t::VALUE);
+        collect(for_.body(), use_t::VALUE);
+        return;
+      }
+      default: {
+        return;
+      }
+    }
+  }
+
+  /// @brief  variable, assigned to unstable one, shares value with it
+  void stabilize() noexcept(false) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (auto& [index, slot] : slots_) {
+        if (slot.stable && std::any_of(slot.assigned_to.begin(), slot.assigned_to.end(), [this](uint32_t target) { return !slots_.at(target).stable; })) {
+          slot.stable = false;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  /// @param  constants - copied, since assignments of nested block don't dominate statements after it
+  void rewrite_block(ast::Block& block, constants_t constants, bool is_body = false) noexcept(false) {
+    auto& statements = block.statements();
+    for (size_t i = 0; i < statements.size(); ++i) {
+      rewrite(statements[i], is_body && is_last(statements, i) ? use_t::ESCAPE : use_t::VALUE, 0, constants);
+      const ast::Symbol* symbol = assigned_symbol(statements[i]);
+      const object_t rhs = symbol ? static_cast<const ast::Binary&>(*statements[i]).rhs() : nullptr;
+      if (symbol && is_constant(*symbol) && is_number(rhs)) {
+        constants[symbol->slot()] = rhs;
+      }
+    }
+  }
+
+  void rewrite(object_t& node, use_t use, uint32_t target, constants_t& constants) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::SYMBOL: {
+        const auto& symbol = static_cast<const ast::Symbol&>(*node);
+        if (!is_constant(symbol)) {
+          return;
+        }
+        if (const auto constant = constants.find(symbol.slot()); constant != constants.end()) {
+          ++slots_[symbol.slot()].substituted;
+          ++changes_;
+          node = copy_number(constant->second);
+        }
+        return;
+      }
+      case ast::type_t::BINARY: {
+        auto& binary = static_cast<ast::Binary&>(*node);
+        if (const ast::Symbol* symbol = assigned_symbol(node)) {
+          rewrite(binary.rhs(), use_t::ASSIGNMENT, symbol->slot(), constants);
+          return;
+        }
+        if (binary.type() == token_t::ASSIGN) {
+          rewrite(binary.rhs(), use_t::ESCAPE, 0, constants);
+          return;
+        }
+        if (token_traits::is_assign_operator(binary.type())) {
+          rewrite(binary.rhs(), use_t::VALUE, 0, constants);
+          return;
+        }
+        rewrite(binary.lhs(), use_t::VALUE, 0, constants);
+        rewrite(binary.rhs(), use_t::VALUE, 0, constants);
+        break;
+      }
+      case ast::type_t::UNARY: {
+        break;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        auto& call = static_cast<ast::LambdaCall&>(*node);
+        const use_t arguments_use = is_output(call) ? use_t::VALUE : use_t::ESCAPE;
+        for (auto& argument : call.arguments()) {
+          rewrite(argument, arguments_use, 0, constants);
+        }
+        return;
+      }
+      case ast::type_t::ARRAY: {
+        for (auto& element : static_cast<ast::Array&>(*node).elements()) {
+          rewrite(element, use_t::ESCAPE, 0, constants);
+        }
+        return;
+      }
+      case ast::type_t::TYPE_CREATOR: {
+        for (auto& argument : static_cast<ast::TypeCreator&>(*node).arguments()) {
+          rewrite(argument, use_t::ESCAPE, 0, constants);
+        }
+        return;
+      }
+      case ast::type_t::BLOCK: {
+        rewrite_block(static_cast<ast::Block&>(*node), constants);
+        return;
+      }
+      case ast::type_t::IF: {
+        auto& if_ = static_cast<ast::If&>(*node);
+        rewrite(if_.condition(), use_t::VALUE, 0, constants);
+        rewrite_block(*if_.body(), constants);
+        if (if_.else_body()) {
+          rewrite_block(*if_.else_body(), constants);
+        }
+        return;
+      }
+      case ast::type_t::WHILE: {
+        auto& while_ = static_cast<ast::While&>(*node);
+        rewrite(while_.exit_condition(), use_t::VALUE, 0, constants);
+        rewrite_block(*while_.body(), constants);
+        return;
+      }
+      case ast::type_t::FOR: {
+        auto& for_ = static_cast<ast::For&>(*node);
+        auto init = for_.loop_init();
+        auto exit_condition = for_.exit_condition();
+        auto increment = for_.increment();
+        rewrite(init, use_t::VALUE, 0, constants);
+        rewrite(exit_condition, use_t::VALUE, 0, constants);
+        rewrite(increment, use_t::VALUE, 0, constants);
+        for_.set_init(std::move(init));
+        for_.set_exit_condition(std::move(exit_condition));
+        for_.set_increment(std::move(increment));
+        rewrite_block(*for_.body(), constants);
+        return;
+      }
+      case ast::type_t::LAMBDA: {
+        auto& lambda = static_cast<ast::Lambda&>(*node);
+        if (!lambda.is_lazy()) {
+          changes_ += ConstantFolder(lambda).run();
+        }
+        return;
+      }
+      default: {
+        return;
+      }
+    }
+    if (is_safe(use, target)) {
+      if (auto folded = fold(node)) {
+        node = std::move(folded);
+        ++changes_;
+      }
+    }
+  }
+
+  ast::Lambda& lambda_;
+  std::unordered_map<uint32_t, Slot> slots_;
+  size_t changes_ = 0;
+};
+
+}// namespace
+
+ConstantFolder::ConstantFolder(ast::Lambda& lambda) noexcept(true)
+  : lambda_(lambda) {}
+
+size_t ConstantFolder::run() noexcept(false) {
+  FoldingPass pass(lambda_);
+  pass.run();
+  return pass.changes();
+}
@@ -0,0 +1,188 @@
+#include "../../include/optimizer/dead_code_eliminator.hpp"
+
+#include "../../include/optimizer/tree_utility.hpp"
+
+#include <unordered_map>
+
+namespace {
+
+using namespace optimization;
+
+/// Slot -> count of reads.
+using reads_t = std::unordered_map<uint32_t, size_t>;
+
+void count_read(const ast::Resolvable& variable, reads_t& reads) noexcept(false) {
+  if (variable.in_frame()) {
+    ++reads[variable.slot()];
+  }
+}
+
+/// @note   nested lambdas have own frames, so they are skipped
+void count_reads(const object_t& node, reads_t& reads) noexcept(false) {
+  if (!node) {
+    return;
+  }
+  switch (node->ast_type()) {
+    case ast::type_t::SYMBOL: {
+      count_read(static_cast<const ast::Symbol&>(*node), reads);
+      return;
+    }
+    case ast::type_t::TYPE_FIELD: {
+      count_read(static_cast<const ast::TypeFieldOperator&>(*node), reads);
+      return;
+    }
+    case ast::type_t::BINARY: {
+      /// Compound assignment reads its variable, plain one doesn't.
+      const auto& binary = static_cast<const ast::Binary&>(*node);
+      if (binary.type() != token_t::ASSIGN) {
+        count_reads(binary.lhs(), reads);
+      }
+      count_reads(binary.rhs(), reads);
+      return;
+    }
+    case ast::type_t::LAMBDA_CALL: {
+      const auto& call = static_cast<const ast::LambdaCall&>(*node);
+      if (call.target() == ast::LambdaCall::target_t::VARIABLE) {
+        count_read(call, reads);
+      }
+      break;
+    }
+    case ast::type_t::LAMBDA: {
+      return;
+    }
+    default: {
+      break;
+    }
+  }
+  for_each_child(node, [&reads](const object_t& child) { count_reads(child, reads); });
+}
+
+class Sweeper {
+public:
+  explicit Sweeper(ast::Lambda& lambda) noexcept(true)
+    : lambda_(lambda) {}
+
+  size_t run() noexcept(false) {
+    size_t total = 0;
+    size_t changes = 0;
+    do {
+      reads_.clear();
+      if (lambda_.is_bound()) {
+        count_reads(lambda_.body(), reads_);
+      }
+      changes = sweep(*lambda_.body(), /*is_body=*/true);
+      total += changes;
+    } while (changes > 0);
+    return total;
+  }
+
+private:
+  bool is_dead_store(const object_t& statement) const noexcept(true) {
+    const ast::Symbol* symbol = assigned_symbol(statement);
+    return symbol && lambda_.is_bound() && !reads_.contains(symbol->slot());
+  }
+
+  /// @return true if loop does nothing, or never ends without doing anything
+  static bool is_empty_loop(const object_t& statement) noexcept(true) {
+    if (statement->ast_type() == ast::type_t::WHILE) {
+      const auto& while_ = static_cast<const ast::While&>(*statement);
+      const auto condition_type = while_.exit_condition()->ast_type();
+      const bool simple_condition = condition_type == ast::type_t::INTEGER || condition_type == ast::type_t::FLOAT || condition_type == ast::type_t::SYMBOL;
+      return simple_condition && while_.body()->statements().empty();
+    }
+    if (statement->ast_type() == ast::type_t::FOR) {
+      const auto& for_ = static_cast<const ast::For&>(*statement);
+      return !for_.exit_condition() && for_.body()->statements().empty();
+    }
+    return false;
+  }
+
+  static bool is_integer_literal(const object_t& node) noexcept(true) {
+    return node->ast_type() == ast::type_t::INTEGER;
+  }
+
+  /// @brief  process nested blocks first, so statement may become empty
+  size_t sweep(ast::Block& block, bool is_body = false) noexcept(false) {
+    auto& statements = block.statements();
+    size_t changes = 0;
+    for (size_t i = 0; i < statements.size();) {
+      const object_t statement = statements[i];
+      const auto erase = [&statements, &i] { statements.erase(statements.begin() + static_cast<ssize_t>(i)); };
+      if (statement->ast_type() == ast::type_t::LAMBDA) {
+        auto& lambda = static_cast<ast::Lambda&>(*statement);
+        if (!lambda.is_lazy()) {
+          changes += Sweeper(lambda).run();
+        }
+        ++i;
+        continue;
+      }
+      for_each_block(statement, [this, &changes](ast::Block& nested) { changes += sweep(nested); });
+      if (is_empty_loop(statement)) {
+        erase();
+        ++changes;
+        continue;
+      }
+      if (is_body && i + 1 == statements.size()) {
+        break;
+      }
+      switch (statement->ast_type()) {
+        case ast::type_t::IF: {
+          const auto& if_ = static_cast<const ast::If&>(*statement);
+          if (is_integer_literal(if_.condition())) {
+            /// Variables of lambda live in frame, so statements of branch may be moved out.
+            const auto& branch = !is_zero(static_cast<const ast::Integer&>(*if_.condition())) ? if_.body() : if_.else_body();
+            const auto branch_statements = branch ? branch->statements() : std::vector<object_t>{};
+            erase();
+            statements.insert(statements.begin() + static_cast<ssize_t>(i), branch_statements.begin(), branch_statements.end());
+            ++changes;
+            continue;
+          }
+          const bool empty = if_.body()->statements().empty() && (!if_.else_body() || if_.else_body()->statements().empty());
+          if (empty && !has_effects(if_.condition())) {
+            erase();
+            ++changes;
+            continue;
+          }
+          break;
+        }
+        case ast::type_t::WHILE: {
+          const auto& condition = static_cast<const ast::While&>(*statement).exit_condition();
+          if (is_integer_literal(condition) && is_zero(static_cast<const ast::Integer&>(*condition))) {
+            erase();
+            ++changes;
+            continue;
+          }
+          break;
+        }
+        default: {
+          if (is_dead_store(statement)) {
+            /// Value may be still needed for its effects.
+            statements[i] = static_cast<const ast::Binary&>(*statement).rhs();
+            ++changes;
+            continue;
+          }
+          if (!has_effects(statement)) {
+            erase();
+            ++changes;
+            continue;
+          }
+          break;
+        }
+      }
+      ++i;
+    }
+    return changes;
+  }
+
+  ast::Lambda& lambda_;
+  reads_t reads_;
+};
+
+}// namespace
+
+DeadCodeEliminator::DeadCodeEliminator(ast::Lambda& lambda) noexcept(true)
+  : lambda_(lambda) {}
+
+size_t DeadCodeEliminator::run() noexcept(false) {
+  return Sweeper(lambda_).run();
+}
@@ -0,0 +1,425 @@
+#include "../../include/optimizer/inliner.hpp"
+
+#include "../../include/optimizer/tree_utility.hpp"
+#include "../../include/std/builtins.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using namespace optimization;
+
+/// Count of nodes, that may be added to one caller, so chains of calls don't blow it up.
+constexpr size_t max_growth = 1000;
+
+/// @return true if node of callee body calls target, directly or through other lambdas
+bool calls(const object_t& node, const ast::Lambda& target, std::unordered_set<const ast::Lambda*>& visited) noexcept(false) {
+  if (!node) {
+    return false;
+  }
+  if (node->ast_type() == ast::type_t::LAMBDA_CALL) {
+    const auto& call = static_cast<const ast::LambdaCall&>(*node);
+    if (call.target() == ast::LambdaCall::target_t::LAMBDA) {
+      const auto& callee = call.lambda();
+      if (&callee == &target) {
+        return true;
+      }
+      if (visited.insert(&callee).second && !callee.is_lazy() && calls(callee.body(), target, visited)) {
+        return true;
+      }
+    }
+  }
+  bool found = false;
+  for_each_child(node, [&](const object_t& child) { found = found || calls(child, target, visited); });
+  return found;
+}
+
+/// Facts about lambda, that decide whether its copy behaves as its call.
+///
+/// Evaluator assigns literals and arrays of body without copying and changes numbers
+/// in place, so literals of body live across calls. Copy of body has own literals
+/// at each call site, so such literals must never be changed or leave the body.
+class Callee {
+public:
+  Callee(const ast::Lambda& lambda, size_t budget) noexcept(false) {
+    if (!lambda.is_bound() || lambda.is_lazy() || lambda.body()->statements().empty()) {
+      return;
+    }
+    size_ = count_nodes(lambda.body());
+    if (size_ > budget) {
+      return;
+    }
+    assignments_ = Assignments(lambda);
+    std::unordered_set<const ast::Lambda*> visited;
+    if (!check(lambda.body()) || calls(lambda.body(), lambda, visited)) {
+      return;
+    }
+    inlinable_ = true;
+    const auto& statements = lambda.body()->statements();
+    value_ = assignments_.is_value(statements.back());
+    reads_.assign(lambda.arguments().size(), 0);
+    expression_ = statements.size() == 1 && is_expression_body(statements.back());
+  }
+
+  bool inlinable() const noexcept(true) {
+    return inlinable_;
+  }
+
+  /// @return true if last statement may be assigned to variable of caller
+  bool has_value() const noexcept(true) {
+    return value_;
+  }
+
+  /// @return true if call may be replaced by body with arguments in place of parameters
+  bool is_expression() const noexcept(true) {
+    return expression_;
+  }
+
+  size_t size() const noexcept(true) {
+    return size_;
+  }
+
+  /// @return true if arguments may replace parameters of expression body
+  bool accepts(const std::vector<object_t>& arguments) const noexcept(true) {
+    for (size_t i = 0; i < arguments.size(); ++i) {
+      if (has_effects(arguments[i])) {
+        return false;
+      }
+      /// Expression would be evaluated more than once.
+      const auto type = arguments[i]->ast_type();
+      if (reads_[i] > 1 && type != ast::type_t::INTEGER && type != ast::type_t::FLOAT && type != ast::type_t::STRING && type != ast::type_t::SYMBOL) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  /// @return true if variable may hold literal or object of body
+  bool is_shared(const ast::Resolvable& variable) const noexcept(true) {
+    return !variable.in_frame() || assignments_.is_shared(variable.slot());
+  }
+
+  /// @return true if argument of lambda or builtin, that may change it, is not a literal of body
+  bool is_safe_argument(const object_t& argument) const noexcept(true) {
+    return is_fresh(argument) || (argument->ast_type() == ast::type_t::SYMBOL && !is_shared(static_cast<const ast::Symbol&>(*argument)));
+  }
+
+  /// @return true if node reads only own frame and keeps literals of body in place
+  bool check(const object_t& node) const noexcept(false) {
+    if (!node) {
+      return true;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::LAMBDA:
+      case ast::type_t::TYPE_DEFINITION:
+      case ast::type_t::ARRAY: {
+        return false;
+      }
+      case ast::type_t::SYMBOL: {
+        if (!static_cast<const ast::Symbol&>(*node).in_frame()) {
+          return false;
+        }
+        break;
+      }
+      case ast::type_t::TYPE_FIELD: {
+        if (!static_cast<const ast::TypeFieldOperator&>(*node).in_frame()) {
+          return false;
+        }
+        break;
+      }
+      case ast::type_t::UNARY: {
+        const auto& operand = static_cast<const ast::Unary&>(*node).operand();
+        if (operand->ast_type() != ast::type_t::SYMBOL || is_shared(static_cast<const ast::Symbol&>(*operand))) {
+          return false;
+        }
+        break;
+      }
+      case ast::type_t::BINARY: {
+        const auto& binary = static_cast<const ast::Binary&>(*node);
+        if (token_traits::is_assign_operator(binary.type()) && is_shared(static_cast<const ast::Symbol&>(*binary.lhs()))) {
+          return false;
+        }
+        break;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        const auto& call = static_cast<const ast::LambdaCall&>(*node);
+        if (call.target() == ast::LambdaCall::target_t::UNRESOLVED || (call.target() == ast::LambdaCall::target_t::VARIABLE && !call.in_frame())) {
+          return false;
+        }
+        const bool pure_target = is_output(call) || (call.target() == ast::LambdaCall::target_t::BUILTIN && is_pure_builtin(call.name())) || (call.target() == ast::LambdaCall::target_t::LAMBDA && call.lambda().is_pure());
+        const auto& arguments = call.arguments();
+        if (!pure_target && !std::all_of(arguments.begin(), arguments.end(), [this](const object_t& argument) { return is_safe_argument(argument); })) {
+          return false;
+        }
+        break;
+      }
+      case ast::type_t::TYPE_CREATOR: {
+        const auto& arguments = static_cast<const ast::TypeCreator&>(*node).arguments();
+        if (!std::all_of(arguments.begin(), arguments.end(), [this](const object_t& argument) { return is_safe_argument(argument); })) {
+          return false;
+        }
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    bool result = true;
+    for_each_child(node, [this, &result](const object_t& child) { result = result && check(child); });
+    return result;
+  }
+
+  /// @brief  count reads of parameters
+  /// @return true if expression has no assignments, so parameters may be replaced
+  bool is_substitutable(const object_t& node) noexcept(false) {
+    switch (node->ast_type()) {
+      case ast::type_t::INTEGER:
+      case ast::type_t::FLOAT:
+      case ast::type_t::STRING: {
+        return true;
+      }
+      case ast::type_t::SYMBOL: {
+        const auto& symbol = static_cast<const ast::Symbol&>(*node);
+        if (symbol.scope() != ast::scope_t::PARAMETER) {
+          return false;
+        }
+        ++reads_[symbol.slot()];
+        return true;
+      }
+      case ast::type_t::BINARY: {
+        const auto& binary = static_cast<const ast::Binary&>(*node);
+        return !is_assignment(binary.type()) && is_substitutable(binary.lhs()) && is_substitutable(binary.rhs());
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        const auto& call = static_cast<const ast::LambdaCall&>(*node);
+        if (call.target() != ast::LambdaCall::target_t::BUILTIN && call.target() != ast::LambdaCall::target_t::LAMBDA) {
+          return false;
+        }
+        return std::all_of(call.arguments().begin(), call.arguments().end(), [this](const object_t& argument) { return is_substitutable(argument); });
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+
+  /// Body, that is a parameter, gives argument itself, as call does.
+  bool is_expression_body(const object_t& statement) noexcept(false) {
+    const bool parameter = statement->ast_type() == ast::type_t::SYMBOL && static_cast<const ast::Symbol&>(*statement).scope() == ast::scope_t::PARAMETER;
+    return (is_fresh(statement) || parameter) && is_substitutable(statement);
+  }
+
+  bool inlinable_ = false;
+  bool value_ = false;
+  bool expression_ = false;
+  size_t size_ = 0;
+  Assignments assignments_;
+  /// Parameter -> count of reads in expression body.
+  std::vector<size_t> reads_;
+};
+
+class InliningPass {
+public:
+  InliningPass(ast::Lambda& caller, size_t budget) noexcept(true)
+    : caller_(caller)
+    , budget_(budget) {}
+
+  size_t run() noexcept(false) {
+    if (caller_.is_lazy() || !caller_.is_bound()) {
+      return 0;
+    }
+    frame_size_ = caller_.frame_size();
+    inline_block(*caller_.body());
+    caller_.bind(frame_size_);
+    return inlined_;
+  }
+
+private:
+  const Callee& callee(const ast::Lambda& lambda) noexcept(false) {
+    auto found = callees_.find(&lambda);
+    if (found == callees_.end()) {
+      found = callees_.try_emplace(&lambda, lambda, budget_).first;
+    }
+    return found->second;
+  }
+
+  /// @return callee, which body may replace call, null otherwise
+  const Callee* inlinable(const ast::LambdaCall& call) noexcept(false) {
+    if (call.target() != ast::LambdaCall::target_t::LAMBDA || call.arguments().size() != call.lambda().arguments().size()) {
+      return nullptr;
+    }
+    const Callee& found = callee(call.lambda());
+    return found.inlinable() && growth_ + found.size() <= max_growth ? &found : nullptr;
+  }
+
+  void inline_block(ast::Block& block) noexcept(false) {
+    auto& statements = block.statements();
+    for (size_t i = 0; i < statements.size();) {
+      if (statements[i]->ast_type() == ast::type_t::LAMBDA) {
+        inlined_ += InliningPass(static_cast<ast::Lambda&>(*statements[i]), budget_).run();
+        ++i;
+        continue;
+      }
+      if (auto expanded = expand(statements[i])) {
+        statements.erase(statements.begin() + static_cast<ssize_t>(i));
+        /// Not skipped, since copied statements may call other lambdas.
+        statements.insert(statements.begin() + static_cast<ssize_t>(i), expanded->begin(), expanded->end());
+        continue;
+      }
+      rewrite(statements[i]);
+      ++i;
+    }
+  }
+
+  /// @return statements, that replace call or assignment of call, std::nullopt if
+  ///         statement isn't such call or it's left for expression form
+  std::optional<std::vector<object_t>> expand(const object_t& statement) noexcept(false) {
+    ast::LambdaCall* call = nullptr;
+    ast::Binary* assignment = nullptr;
+    if (statement->ast_type() == ast::type_t::LAMBDA_CALL) {
+      call = static_cast<ast::LambdaCall*>(statement.get());
+    } else if (assigned_symbol(statement)) {
+      assignment = static_cast<ast::Binary*>(statement.get());
+      if (assignment->rhs()->ast_type() == ast::type_t::LAMBDA_CALL) {
+        call = static_cast<ast::LambdaCall*>(assignment->rhs().get());
+      }
+    }
+    if (!call) {
+      return std::nullopt;
+    }
+    const Callee* found = inlinable(*call);
+    if (!found || (assignment && !found->has_value()) || (found->is_expression() && found->accepts(call->arguments()))) {
+      return std::nullopt;
+    }
+    const auto& lambda = call->lambda();
+    std::vector<uint32_t> slots(lambda.frame_size());
+    for (auto& slot : slots) {
+      slot = frame_size_++;
+    }
+    const Cloner cloner(slots);
+    std::vector<object_t> statements;
+    const auto& parameters = lambda.arguments();
+    for (size_t i = 0; i < parameters.size(); ++i) {
+      auto parameter = boost::make_local_shared<ast::Symbol>(static_cast<const ast::Symbol&>(*parameters[i]).name());
+      parameter->resolve(ast::scope_t::LOCAL, slots[i]);
+      statements.push_back(boost::make_local_shared<ast::Binary>(token_t::ASSIGN, std::move(parameter), call->arguments()[i]));
+    }
+    const auto& body = lambda.body()->statements();
+    for (size_t i = 0; i + 1 < body.size(); ++i) {
+      statements.push_back(cloner.clone(body[i]));
+    }
+    if (assignment) {
+      assignment->rhs() = cloner.clone(body.back());
+      statements.push_back(statement);
+    } else {
+      statements.push_back(cloner.clone(body.back()));
+    }
+    growth_ += found->size();
+    ++inlined_;
+    return statements;
+  }
+
+  /// @brief  replace calls of expression bodies inside node, inline nested blocks
+  void rewrite(object_t& node) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::BLOCK: {
+        inline_block(static_cast<ast::Block&>(*node));
+        return;
+      }
+      case ast::type_t::IF: {
+        auto& if_ = static_cast<ast::If&>(*node);
+        rewrite(if_.condition());
+        inline_block(*if_.body());
+        if (if_.else_body()) {
+          inline_block(*if_.else_body());
+        }
+        return;
+      }
+      case ast::type_t::WHILE: {
+        auto& while_ = static_cast<ast::While&>(*node);
+        rewrite(while_.exit_condition());
+        inline_block(*while_.body());
+        return;
+      }
+      case ast::type_t::FOR: {
+        auto& for_ = static_cast<ast::For&>(*node);
+        object_t init = for_.loop_init();
+        object_t exit_condition = for_.exit_condition();
+        object_t increment = for_.increment();
+        rewrite(init);
+        rewrite(exit_condition);
+        rewrite(increment);
+        for_.set_init(std::move(init));
+        for_.set_exit_condition(std::move(exit_condition));
+        for_.set_increment(std::move(increment));
+        inline_block(*for_.body());
+        return;
+      }
+      case ast::type_t::UNARY: {
+        rewrite(static_cast<ast::Unary&>(*node).operand());
+        return;
+      }
+      case ast::type_t::BINARY: {
+        rewrite(static_cast<ast::Binary&>(*node).lhs());
+        rewrite(static_cast<ast::Binary&>(*node).rhs());
+        return;
+      }
+      case ast::type_t::ARRAY: {
+        for (auto& element : static_cast<ast::Array&>(*node).elements()) {
+          rewrite(element);
+        }
+        return;
+      }
+      case ast::type_t::TYPE_CREATOR: {
+        for (auto& argument : static_cast<ast::TypeCreator&>(*node).arguments()) {
+          rewrite(argument);
+        }
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        auto& call = static_cast<ast::LambdaCall&>(*node);
+        for (auto& argument : call.arguments()) {
+          rewrite(argument);
+        }
+        const Callee* found = inlinable(call);
+        if (!found || !found->is_expression() || !found->accepts(call.arguments())) {
+          return;
+        }
+        node = Cloner(call.arguments()).clone(call.lambda().body()->statements().back());
+        growth_ += found->size();
+        ++inlined_;
+        /// Copied expression may call other lambdas.
+        rewrite(node);
+        return;
+      }
+      default: {
+        return;
+      }
+    }
+  }
+
+  ast::Lambda& caller_;
+  size_t budget_;
+  uint32_t frame_size_ = 0;
+  size_t growth_ = 0;
+  size_t inlined_ = 0;
+  /// Analyzed once per caller, since inlining changes bodies of callers.
+  std::unordered_map<const ast::Lambda*, Callee> callees_;
+};
+
+}// namespace
+
+Inliner::Inliner(ast::Lambda& caller, size_t budget) noexcept(true)
+  : caller_(caller)
+  , budget_(budget) {}
+
+size_t Inliner::run() noexcept(false) {
+  return InliningPass(caller_, budget_).run();
+}
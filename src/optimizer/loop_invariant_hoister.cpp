@@ -0,0 +1,241 @@
+#include "../../include/optimizer/loop_invariant_hoister.hpp"
+
+#include "../../include/optimizer/tree_utility.hpp"
+
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+using namespace optimization;
+
+/// @return true if builtin only reads arguments and gives new number
+bool is_scalar_builtin(const ast::LambdaCall& call) noexcept(true) {
+  if (call.target() != ast::LambdaCall::target_t::BUILTIN) {
+    return false;
+  }
+  const auto& name = call.name();
+  return name == "array-length" || name == "procedure-arity" || name == "integer?" || name == "float?" || name == "string?" || name == "array?" || name == "procedure?";
+}
+
+class HoistingPass {
+public:
+  explicit HoistingPass(ast::Lambda& lambda) noexcept(true)
+    : lambda_(lambda) {}
+
+  size_t run() noexcept(false) {
+    if (lambda_.is_lazy() || !lambda_.is_bound()) {
+      return 0;
+    }
+    frame_size_ = lambda_.frame_size();
+    aliases_ = AliasAnalysis(lambda_);
+    hoist_block(*lambda_.body());
+    lambda_.bind(frame_size_);
+    return hoisted_;
+  }
+
+private:
+  void hoist_block(ast::Block& block) noexcept(false) {
+    auto& statements = block.statements();
+    for (size_t i = 0; i < statements.size(); ++i) {
+      const auto& statement = statements[i];
+      if (statement->ast_type() == ast::type_t::LAMBDA) {
+        hoisted_ += HoistingPass(static_cast<ast::Lambda&>(*statement)).run();
+        continue;
+      }
+      /// Inner loops first, so their temporaries may be moved further out.
+      for_each_block(statement, [this](ast::Block& nested) { hoist_block(nested); });
+      if (statement->ast_type() != ast::type_t::WHILE && statement->ast_type() != ast::type_t::FOR) {
+        continue;
+      }
+      auto temporaries = hoist_loop(statement);
+      statements.insert(statements.begin() + static_cast<ssize_t>(i), temporaries.begin(), temporaries.end());
+      i += temporaries.size();
+    }
+  }
+
+  /// @return assignments of temporaries
+  std::vector<object_t> hoist_loop(const object_t& loop) noexcept(false) {
+    assigned_.clear();
+    if (!collect_changes(loop)) {
+      return {};
+    }
+    temporaries_.clear();
+    if (loop->ast_type() == ast::type_t::WHILE) {
+      auto& while_ = static_cast<ast::While&>(*loop);
+      hoist(while_.exit_condition(), /*consumed=*/true, /*lambdas=*/true);
+      hoist_statements(*while_.body());
+    } else {
+      auto& for_ = static_cast<ast::For&>(*loop);
+      if (object_t exit_condition = for_.exit_condition()) {
+        hoist(exit_condition, /*consumed=*/true, /*lambdas=*/true);
+        for_.set_exit_condition(std::move(exit_condition));
+      }
+      if (object_t increment = for_.increment()) {
+        hoist(increment, /*consumed=*/false, /*lambdas=*/false);
+        for_.set_increment(std::move(increment));
+      }
+      hoist_statements(*for_.body());
+    }
+    return std::move(temporaries_);
+  }
+
+  /// @brief  find variables, assigned or changed in loop
+  /// @return false if loop may change value, shared with other variable
+  bool collect_changes(const object_t& node) noexcept(false) {
+    if (!node) {
+      return true;
+    }
+    if (const auto* symbol = changed_symbol(node)) {
+      if (!symbol->in_frame() || aliases_.is_shared(symbol->slot())) {
+        return false;
+      }
+      assigned_.insert(symbol->slot());
+    }
+    if (const auto* symbol = assigned_symbol(node)) {
+      assigned_.insert(symbol->slot());
+    }
+    if (node->ast_type() == ast::type_t::LAMBDA_CALL) {
+      const auto& call = static_cast<const ast::LambdaCall&>(*node);
+      const auto& arguments = call.arguments();
+      if (!reads_arguments(call) && !std::all_of(arguments.begin(), arguments.end(), is_literal)) {
+        return false;
+      }
+    }
+    bool result = true;
+    for_each_child(node, [this, &result](const object_t& child) { result = result && collect_changes(child); });
+    return result;
+  }
+
+  void hoist_statements(ast::Block& block) noexcept(false) {
+    for (auto& statement : block.statements()) {
+      hoist(statement, /*consumed=*/false, /*lambdas=*/false);
+    }
+  }
+
+  /// @return true if node gives the same value in each iteration
+  bool is_invariant(const object_t& node, bool lambdas) const noexcept(true) {
+    switch (node->ast_type()) {
+      case ast::type_t::INTEGER:
+      case ast::type_t::FLOAT:
+      case ast::type_t::STRING: {
+        return true;
+      }
+      case ast::type_t::SYMBOL: {
+        const auto& symbol = static_cast<const ast::Symbol&>(*node);
+        return symbol.in_frame() && !assigned_.contains(symbol.slot());
+      }
+      case ast::type_t::BINARY: {
+        const auto& binary = static_cast<const ast::Binary&>(*node);
+        return !is_assignment(binary.type()) && is_invariant(binary.lhs(), lambdas) && is_invariant(binary.rhs(), lambdas);
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        const auto& call = static_cast<const ast::LambdaCall&>(*node);
+        const bool pure = is_scalar_builtin(call) || (lambdas && call.target() == ast::LambdaCall::target_t::LAMBDA && call.lambda().is_pure());
+        const auto& arguments = call.arguments();
+        return pure && std::all_of(arguments.begin(), arguments.end(), [this, lambdas](const object_t& argument) { return is_invariant(argument, lambdas); });
+      }
+      default: {
+        return false;
+      }
+    }
+  }
+
+  /// @return true if node reads some variable or calls something, so it's worth a temporary
+  static bool reads_state(const object_t& node) noexcept(true) {
+    if (node->ast_type() == ast::type_t::SYMBOL || node->ast_type() == ast::type_t::LAMBDA_CALL) {
+      return true;
+    }
+    bool result = false;
+    for_each_child(node, [&result](const object_t& child) { result = result || reads_state(child); });
+    return result;
+  }
+
+  /// @param consumed - value of node is only read, not kept by variable or array
+  /// @param lambdas - calls of pure lambdas may be moved, since node is always evaluated
+  void hoist(object_t& node, bool consumed, bool lambdas) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    const auto type = node->ast_type();
+    if (consumed && (type == ast::type_t::BINARY || type == ast::type_t::LAMBDA_CALL) && is_invariant(node, lambdas) && !has_effects(node) && reads_state(node)) {
+      node = temporary(node);
+      return;
+    }
+    switch (type) {
+      case ast::type_t::BINARY: {
+        auto& binary = static_cast<ast::Binary&>(*node);
+        if (binary.type() == token_t::ASSIGN) {
+          /// Temporary may be assigned only to variable, that never changes it or gives it away.
+          const auto* symbol = assigned_symbol(node);
+          hoist(binary.rhs(), symbol && !aliases_.is_kept(symbol->slot()) && !aliases_.is_shared(symbol->slot()), lambdas);
+        } else {
+          if (!token_traits::is_assign_operator(binary.type())) {
+            hoist(binary.lhs(), /*consumed=*/true, lambdas);
+          }
+          hoist(binary.rhs(), /*consumed=*/true, lambdas);
+        }
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        auto& call = static_cast<ast::LambdaCall&>(*node);
+        const bool reader = reads_arguments(call);
+        for (auto& argument : call.arguments()) {
+          hoist(argument, reader, lambdas);
+        }
+        return;
+      }
+      case ast::type_t::IF: {
+        auto& if_ = static_cast<ast::If&>(*node);
+        hoist(if_.condition(), /*consumed=*/true, lambdas);
+        hoist_statements(*if_.body());
+        if (if_.else_body()) {
+          hoist_statements(*if_.else_body());
+        }
+        return;
+      }
+      case ast::type_t::BLOCK: {
+        hoist_statements(static_cast<ast::Block&>(*node));
+        return;
+      }
+      default: {
+        /// Inner loops are already processed, arrays and objects keep their elements.
+        return;
+      }
+    }
+  }
+
+  /// @return read of new variable, assigned with expression before loop
+  object_t temporary(const object_t& expression) noexcept(false) {
+    const uint32_t slot = frame_size_++;
+    aliases_.add_slot();
+    const std::string name = "@invariant" + std::to_string(slot);
+    auto target = boost::make_local_shared<ast::Symbol>(name);
+    target->resolve(ast::scope_t::LOCAL, slot);
+    auto read = boost::make_local_shared<ast::Symbol>(name);
+    read->resolve(ast::scope_t::LOCAL, slot);
+    if (expression->ast_type() == ast::type_t::BINARY) {
+      read->set_inferred_type(static_cast<const ast::Binary&>(*expression).inferred_type());
+    }
+    temporaries_.push_back(boost::make_local_shared<ast::Binary>(token_t::ASSIGN, std::move(target), expression));
+    ++hoisted_;
+    return read;
+  }
+
+  ast::Lambda& lambda_;
+  uint32_t frame_size_ = 0;
+  size_t hoisted_ = 0;
+  AliasAnalysis aliases_;
+  /// Slots, assigned or changed in current loop.
+  std::unordered_set<uint32_t> assigned_;
+  std::vector<object_t> temporaries_;
+};
+
+}// namespace
+
+LoopInvariantHoister::LoopInvariantHoister(ast::Lambda& lambda) noexcept(true)
+  : lambda_(lambda) {}
+
+size_t LoopInvariantHoister::run() noexcept(false) {
+  return HoistingPass(lambda_).run();
+}
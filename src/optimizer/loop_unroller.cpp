@@ -0,0 +1,313 @@
+#include "../../include/optimizer/loop_unroller.hpp"
+
+#include "../../include/optimizer/tree_utility.hpp"
+#include "../../include/std/builtins.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace {
+
+using namespace optimization;
+
+/// Finds whether copies of loop body behave as its iterations.
+class Copyability {
+public:
+  Copyability(const AliasAnalysis& aliases, uint32_t counter) noexcept(true)
+    : aliases_(aliases)
+    , counter_(counter) {}
+
+  bool check(const ast::Block& body) noexcept(false) {
+    for (const auto& statement : body.statements()) {
+      visit(statement, /*consumed=*/true);
+    }
+    return copyable_;
+  }
+
+private:
+  /// @param consumed - value of node is only read, not kept by variable or changed
+  void visit(const object_t& node, bool consumed) noexcept(false) {
+    if (!node || !copyable_) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::INTEGER:
+      case ast::type_t::FLOAT:
+      case ast::type_t::STRING: {
+        /// Each copy has own literal, which would start from initial value.
+        copyable_ = consumed;
+        return;
+      }
+      case ast::type_t::SYMBOL: {
+        copyable_ = consumed || !is_variable(node, counter_);
+        return;
+      }
+      case ast::type_t::TYPE_FIELD: {
+        const auto& field = static_cast<const ast::TypeFieldOperator&>(*node);
+        copyable_ = !field.in_frame() || field.slot() != counter_;
+        return;
+      }
+      case ast::type_t::BINARY: {
+        const auto& binary = static_cast<const ast::Binary&>(*node);
+        const token_t type = binary.type();
+        if (!is_assignment(type)) {
+          visit(binary.lhs(), /*consumed=*/true);
+          visit(binary.rhs(), /*consumed=*/true);
+          return;
+        }
+        const auto& symbol = static_cast<const ast::Symbol&>(*binary.lhs());
+        /// Variables out of frame live in scope of loop.
+        if (!symbol.in_frame() || symbol.slot() == counter_) {
+          copyable_ = false;
+          return;
+        }
+        /// Literal of variable, that never changes or gives away its value, stays as is.
+        if (type == token_t::ASSIGN && is_literal(binary.rhs()) && !aliases_.is_kept(symbol.slot())) {
+          return;
+        }
+        visit(binary.rhs(), /*consumed=*/type != token_t::ASSIGN);
+        return;
+      }
+      case ast::type_t::UNARY: {
+        visit(static_cast<const ast::Unary&>(*node).operand(), /*consumed=*/false);
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        const auto& call = static_cast<const ast::LambdaCall&>(*node);
+        if (call.target() == ast::LambdaCall::target_t::VARIABLE && call.in_frame() && call.slot() == counter_) {
+          copyable_ = false;
+          return;
+        }
+        const bool reader = is_output(call) || (call.target() == ast::LambdaCall::target_t::BUILTIN && is_pure_builtin(call.name()));
+        for (const auto& argument : call.arguments()) {
+          visit(argument, reader);
+        }
+        return;
+      }
+      case ast::type_t::ARRAY: {
+        for (const auto& element : static_cast<const ast::Array&>(*node).elements()) {
+          visit(element, /*consumed=*/false);
+        }
+        return;
+      }
+      case ast::type_t::TYPE_CREATOR: {
+        for (const auto& argument : static_cast<const ast::TypeCreator&>(*node).arguments()) {
+          visit(argument, /*consumed=*/false);
+        }
+        return;
+      }
+      case ast::type_t::BLOCK:
+      case ast::type_t::IF:
+      case ast::type_t::WHILE:
+      case ast::type_t::FOR: {
+        /// Values of statements in blocks and conditions are only read.
+        for_each_child(node, [this](const object_t& child) { visit(child, /*consumed=*/true); });
+        return;
+      }
+      default: {
+        copyable_ = false;
+        return;
+      }
+    }
+  }
+
+  const AliasAnalysis& aliases_;
+  uint32_t counter_;
+  bool copyable_ = true;
+};
+
+/// @brief  replace reads of counter by its value
+void substitute(object_t& node, uint32_t slot, size_t value) noexcept(false) {
+  if (!node) {
+    return;
+  }
+  if (is_variable(node, slot)) {
+    node = boost::make_local_shared<ast::Integer>(value);
+    return;
+  }
+  switch (node->ast_type()) {
+    // clang-format off
+    case ast::type_t::BINARY: { substitute(static_cast<ast::Binary&>(*node).lhs(), slot, value); substitute(static_cast<ast::Binary&>(*node).rhs(), slot, value); return; }
+    case ast::type_t::UNARY: { substitute(static_cast<ast::Unary&>(*node).operand(), slot, value); return; }
+    case ast::type_t::LAMBDA_CALL: { for (auto& argument : static_cast<ast::LambdaCall&>(*node).arguments()) { substitute(argument, slot, value); } return; }
+    case ast::type_t::ARRAY: { for (auto& element : static_cast<ast::Array&>(*node).elements()) { substitute(element, slot, value); } return; }
+    case ast::type_t::TYPE_CREATOR: { for (auto& argument : static_cast<ast::TypeCreator&>(*node).arguments()) { substitute(argument, slot, value); } return; }
+    case ast::type_t::BLOCK: { for (auto& statement : static_cast<ast::Block&>(*node).statements()) { substitute(statement, slot, value); } return; }
+    // clang-format on
+    case ast::type_t::IF: {
+      auto& if_ = static_cast<ast::If&>(*node);
+      substitute(if_.condition(), slot, value);
+      for_each_block(node, [slot, value](ast::Block& block) {
+        for (auto& statement : block.statements()) {
+          substitute(statement, slot, value);
+        }
+      });
+      return;
+    }
+    case ast::type_t::WHILE: {
+      auto& while_ = static_cast<ast::While&>(*node);
+      substitute(while_.exit_condition(), slot, value);
+      for (auto& statement : while_.body()->statements()) {
+        substitute(statement, slot, value);
+      }
+      return;
+    }
+    case ast::type_t::FOR: {
+      auto& for_ = static_cast<ast::For&>(*node);
+      object_t init = for_.loop_init();
+      object_t condition = for_.exit_condition();
+      object_t increment = for_.increment();
+      substitute(init, slot, value);
+      substitute(condition, slot, value);
+      substitute(increment, slot, value);
+      for_.set_init(std::move(init));
+      for_.set_exit_condition(std::move(condition));
+      for_.set_increment(std::move(increment));
+      for (auto& statement : for_.body()->statements()) {
+        substitute(statement, slot, value);
+      }
+      return;
+    }
+    default: {
+      return;
+    }
+  }
+}
+
+class UnrollingPass {
+public:
+  UnrollingPass(ast::Lambda& lambda, size_t factor, size_t full_limit, size_t size_limit) noexcept(true)
+    : lambda_(lambda)
+    , factor_(factor)
+    , full_limit_(full_limit)
+    , size_limit_(size_limit) {}
+
+  size_t run() noexcept(false) {
+    if (lambda_.is_lazy() || !lambda_.is_bound()) {
+      return 0;
+    }
+    aliases_ = AliasAnalysis(lambda_);
+    unroll_block(*lambda_.body(), /*is_lambda_body=*/true);
+    return unrolled_;
+  }
+
+private:
+  void unroll_block(ast::Block& block, bool is_lambda_body) noexcept(false) {
+    auto& statements = block.statements();
+    std::vector<object_t> unrolled;
+    bool changed = false;
+    for (size_t i = 0; i < statements.size(); ++i) {
+      const auto& statement = statements[i];
+      if (statement->ast_type() == ast::type_t::LAMBDA) {
+        unrolled_ += UnrollingPass(static_cast<ast::Lambda&>(*statement), factor_, full_limit_, size_limit_).run();
+        unrolled.push_back(statement);
+        continue;
+      }
+      /// Inner loops first, so outer loops are unrolled only if they stay small.
+      for_each_block(statement, [this](ast::Block& nested) { unroll_block(nested, /*is_lambda_body=*/false); });
+      /// The last statement of lambda is its value.
+      const bool is_value = is_lambda_body && i + 1 == statements.size();
+      if (statement->ast_type() == ast::type_t::FOR && !is_value && unroll(boost::static_pointer_cast<ast::For>(statement), unrolled)) {
+        changed = true;
+        continue;
+      }
+      unrolled.push_back(statement);
+    }
+    if (changed) {
+      statements = std::move(unrolled);
+    }
+  }
+
+  /// @param  statements - receives statements, that replace loop
+  /// @return false if loop is left as is
+  bool unroll(const boost::local_shared_ptr<ast::For>& for_, std::vector<object_t>& statements) noexcept(false) {
+    const auto induction = find_induction(*for_);
+    const auto trips = induction ? trip_count(*induction) : std::nullopt;
+    if (!trips || *trips == 0 || !Copyability(aliases_, induction->slot).check(*for_->body())) {
+      return false;
+    }
+    const size_t size = std::max<size_t>(count_nodes(for_->body()) - 1 + count_nodes(for_->increment()), 1);
+    if (*trips <= full_limit_ && *trips * size <= size_limit_) {
+      unroll_fully(*for_, *induction, *trips, statements);
+      ++unrolled_;
+      return true;
+    }
+    const size_t factor = std::min(factor_, size_limit_ / size);
+    if (factor < 2 || *trips < factor) {
+      return false;
+    }
+    unroll_partially(for_, *induction, *trips, factor, statements);
+    ++unrolled_;
+    return true;
+  }
+
+  void unroll_fully(const ast::For& for_, const Induction& induction, size_t trips, std::vector<object_t>& statements) noexcept(false) {
+    std::vector<object_t> copies;
+    for (size_t trip = 0; trip < trips; ++trip) {
+      for (const auto& statement : for_.body()->statements()) {
+        auto copy = Cloner().clone(statement);
+        substitute(copy, induction.slot, induction.init + trip * induction.step);
+        copies.push_back(std::move(copy));
+      }
+    }
+    if (!induction.in_place) {
+      statements.insert(statements.end(), copies.begin(), copies.end());
+      return;
+    }
+    /// Init literal is less than bound only before the first run of loop.
+    auto counter = Cloner().clone(static_cast<const ast::Binary&>(*for_.loop_init()).lhs());
+    static_cast<ast::Symbol&>(*counter).set_inferred_type(ast::inferred_t::INTEGER);
+    copies.push_back(boost::make_local_shared<ast::Binary>(token_t::PLUS_ASSIGN, std::move(counter), boost::make_local_shared<ast::Integer>(trips * induction.step)));
+    statements.push_back(for_.loop_init());
+    statements.push_back(boost::make_local_shared<ast::If>(for_.exit_condition(), boost::make_local_shared<ast::Block>(std::move(copies))));
+  }
+
+  void unroll_partially(const boost::local_shared_ptr<ast::For>& for_, const Induction& induction, size_t trips, size_t factor, std::vector<object_t>& statements) noexcept(false) {
+    const auto& body = for_->body()->statements();
+    std::vector<object_t> copies(body);
+    for (size_t copy = 1; copy < factor; ++copy) {
+      copies.push_back(Cloner().clone(for_->increment()));
+      for (const auto& statement : body) {
+        copies.push_back(Cloner().clone(statement));
+      }
+    }
+    object_t remainder;
+    if (trips % factor != 0) {
+      std::vector<object_t> iteration;
+      for (const auto& statement : body) {
+        iteration.push_back(Cloner().clone(statement));
+      }
+      iteration.push_back(Cloner().clone(for_->increment()));
+      auto loop = boost::make_local_shared<ast::While>(Cloner().clone(for_->exit_condition()), boost::make_local_shared<ast::Block>(std::move(iteration)));
+      loop->set_inferred_type(for_->inferred_type());
+      remainder = std::move(loop);
+    }
+    /// All copies run while counter, increased by all steps but the last, is in bound.
+    static_cast<ast::Binary&>(*for_->exit_condition()).rhs() = boost::make_local_shared<ast::Integer>(*induction.bound - (factor - 1) * induction.step);
+    for_->set_body(boost::make_local_shared<ast::Block>(std::move(copies)));
+    statements.push_back(for_);
+    if (remainder) {
+      statements.push_back(std::move(remainder));
+    }
+  }
+
+  ast::Lambda& lambda_;
+  size_t factor_;
+  size_t full_limit_;
+  size_t size_limit_;
+  AliasAnalysis aliases_;
+  size_t unrolled_ = 0;
+};
+
+}// namespace
+
+LoopUnroller::LoopUnroller(ast::Lambda& lambda, size_t factor, size_t full_limit, size_t size_limit) noexcept(true)
+  : lambda_(lambda)
+  , factor_(factor)
+  , full_limit_(full_limit)
+  , size_limit_(size_limit) {}
+
+size_t LoopUnroller::run() noexcept(false) {
+  return UnrollingPass(lambda_, factor_, full_limit_, size_limit_).run();
+}
@@ -1,112 +1,93 @@
 #include "../../include/optimizer/optimizer.hpp"
 
 #include "../../include/ast/ast.hpp"
-#include "../../include/eval/implementation/unary.hpp"
+#include "../../include/optimizer/common_subexpression_eliminator.hpp"
+#include "../../include/optimizer/constant_folder.hpp"
+#include "../../include/optimizer/dead_code_eliminator.hpp"
+#include "../../include/optimizer/inliner.hpp"
+#include "../../include/optimizer/loop_invariant_hoister.hpp"
+#include "../../include/optimizer/loop_unroller.hpp"
+#include "../../include/optimizer/strength_reducer.hpp"
 
-static void optimize(
-    std::vector<boost::local_shared_ptr<ast::Object>>& outside_block,
-    boost::local_shared_ptr<ast::Object>& expression,
-    ssize_t to_erase) noexcept(false);
+#include <algorithm>
 
-static void optimize_while(
-    std::vector<boost::local_shared_ptr<ast::Object>>& outside_block,
-    boost::local_shared_ptr<ast::Object>& expression,
-    ssize_t to_erase) noexcept(false);
-
-static void optimize_for(
-    std::vector<boost::local_shared_ptr<ast::Object>>& outside_block,
-    boost::local_shared_ptr<ast::Object>& expression,
-    ssize_t to_erase) noexcept(false);
+const std::vector<Optimizer::Pass>& Optimizer::passes() noexcept(true) {
+  static const std::vector<Pass> all = {
+    {"inline", [](ast::Lambda& lambda) { return Inliner(lambda).run(); }},
+    {"fold", [](ast::Lambda& lambda) { return ConstantFolder(lambda).run(); }},
+    {"strength-reduce", [](ast::Lambda& lambda) { return StrengthReducer(lambda).run(); }},
+    {"hoist", [](ast::Lambda& lambda) { return LoopInvariantHoister(lambda).run(); }},
+    {"unroll", [](ast::Lambda& lambda) { return LoopUnroller(lambda).run(); }},
+    {"cse", [](ast::Lambda& lambda) { return CommonSubexpressionEliminator(lambda).run(); }},
+    {"dce", [](ast::Lambda& lambda) { return DeadCodeEliminator(lambda).run(); }}};
+  return all;
+}
 
-static void optimize_unary(
-    std::vector<boost::local_shared_ptr<ast::Object>>& outside_block,
-    boost::local_shared_ptr<ast::Object>& expression,
-    ssize_t to_erase) noexcept(false);
+const Optimizer::Pass* Optimizer::find_pass(std::string_view name) noexcept(true) {
+  const auto& all = passes();
+  const auto it = std::find_if(all.begin(), all.end(), [name](const Pass& pass) { return pass.name == name; });
+  return it != all.end() ? &*it : nullptr;
+}
 
-static void optimize_binary(
-    std::vector<boost::local_shared_ptr<ast::Object>>& outside_block,
-    boost::local_shared_ptr<ast::Object>& expression,
-    ssize_t to_erase) noexcept(false);
+Optimizer::Optimizer(boost::local_shared_ptr<ast::RootObject>& root, unsigned level)
+  : Optimizer(root, level > 0 ? passes() : std::vector<Pass>{}, level > 1) {}
 
-Optimizer::Optimizer(boost::local_shared_ptr<ast::RootObject>& root)
-  : input_(root->get()) {}
+Optimizer::Optimizer(boost::local_shared_ptr<ast::RootObject>& root, std::vector<Pass> pipeline, bool to_fixed_point)
+  : input_(root->get())
+  , pipeline_(std::move(pipeline))
+  , to_fixed_point_(to_fixed_point) {
+  for (const auto& pass : pipeline_) {
+    stats_.push_back({pass.name});
+  }
+}
 
 void Optimizer::optimize() {
+  if (pipeline_.empty()) {
+    return;
+  }
   for (auto& expr : input_) {
     if (expr->ast_type() != ast::type_t::LAMBDA) {
       continue;
     }
-    ssize_t to_erase = 0;
-    auto function = boost::static_pointer_cast<ast::Lambda>(expr);
-    auto& function_stmts = function->body()->statements();
-    for (auto& function_expr : function_stmts) {
-      ::optimize(function_stmts, function_expr, to_erase);
-      ++to_erase;
+    auto& function = static_cast<ast::Lambda&>(*expr);
+    if (function.is_lazy()) {
+      continue;
     }
+    iterations_ = std::max(iterations_, run(function, pipeline_, to_fixed_point_, stats_).first);
   }
 }
 
-void optimize(std::vector<boost::local_shared_ptr<ast::Object>>& outside_block, boost::local_shared_ptr<ast::Object>& expression, ssize_t to_erase) noexcept(false) {
-  if (!expression) {
-    return;
-  }
-  // clang-format off
-  switch (expression->ast_type()) {
-    case ast::type_t::WHILE: { optimize_while(outside_block, expression, to_erase); return; }
-    case ast::type_t::FOR: { optimize_for(outside_block, expression, to_erase); return; }
-    case ast::type_t::UNARY: { optimize_unary(outside_block, expression, to_erase); return; }
-    case ast::type_t::BINARY: { optimize_binary(outside_block, expression, to_erase); return; }
-    default:
-      return;
-  }
-  // clang-format on
-}
-
-static void optimize_while(std::vector<boost::local_shared_ptr<ast::Object>>& outside_block, boost::local_shared_ptr<ast::Object>& expression, ssize_t to_erase) noexcept(false) {
-  auto expr = boost::static_pointer_cast<ast::While>(expression);
-  auto& statements = expr->body()->statements();
-  auto exit_condition_type = expr->exit_condition()->ast_type();
-  if (exit_condition_type == ast::type_t::INTEGER || exit_condition_type == ast::type_t::FLOAT || exit_condition_type == ast::type_t::SYMBOL) {
-    if (statements.empty()) {
-      outside_block.erase(outside_block.begin() + to_erase);
-      return;
-    }
-  }
-  for (auto& while_statement : statements) {
-    optimize(outside_block, while_statement, to_erase);
+size_t Optimizer::optimize(ast::Lambda& lambda, unsigned level) {
+  if (level == 0) {
+    return 0;
   }
+  std::vector<PassStats> stats(passes().size());
+  return run(lambda, passes(), level > 1, stats).second;
 }
 
-static void optimize_for(std::vector<boost::local_shared_ptr<ast::Object>>& outside_block, boost::local_shared_ptr<ast::Object>& expression, ssize_t to_erase) noexcept(false) {
-  auto expr = boost::static_pointer_cast<ast::For>(expression);
-  auto& statements = expr->body()->statements();
-  if (!expr->exit_condition()) {
-    if (statements.empty()) {
-      outside_block.erase(outside_block.begin() + to_erase);
-      return;
+std::pair<size_t, size_t> Optimizer::run(ast::Lambda& lambda, const std::vector<Pass>& pipeline, bool to_fixed_point, std::vector<PassStats>& stats) {
+  size_t iteration = 0;
+  size_t total = 0;
+  for (bool changed = true; changed && iteration < (to_fixed_point ? max_iterations : 1); ++iteration) {
+    changed = false;
+    for (size_t i = 0; i < pipeline.size(); ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      const size_t changes = pipeline[i].run(lambda);
+      auto& pass_stats = stats[i];
+      pass_stats.time += std::chrono::steady_clock::now() - start;
+      pass_stats.changes += changes;
+      ++pass_stats.runs;
+      total += changes;
+      changed |= changes > 0;
     }
   }
-  for (auto& for_statement : statements) {
-    optimize(outside_block, for_statement, to_erase);
-  }
+  return {iteration, total};
 }
 
-static void optimize_unary(std::vector<boost::local_shared_ptr<ast::Object>>& outside_block, boost::local_shared_ptr<ast::Object>& expression, ssize_t to_erase) noexcept(false) {
-  const auto unary = boost::static_pointer_cast<ast::Unary>(expression);
-  if (unary->operand()->ast_type() == ast::type_t::INTEGER || unary->operand()->ast_type() == ast::type_t::FLOAT) {
-    bool failed = false;
-    eval_context::unary_implementation(
-        unary->type(),
-        unary->operand(),
-        failed);
-    if (!failed) {
-      outside_block[to_erase] = unary->operand();
-    }
-  }
+const std::vector<Optimizer::PassStats>& Optimizer::stats() const noexcept(true) {
+  return stats_;
 }
 
-static void optimize_binary(std::vector<boost::local_shared_ptr<ast::Object>>& outside_block, boost::local_shared_ptr<ast::Object>& expression, ssize_t to_erase) noexcept(false) {
-  UNUSED(outside_block);
-  UNUSED(expression);
-  UNUSED(to_erase);
+size_t Optimizer::iterations() const noexcept(true) {
+  return iterations_;
 }
@@ -0,0 +1,297 @@
+#include "../../include/optimizer/strength_reducer.hpp"
+
+#include "../../include/optimizer/tree_utility.hpp"
+#include "../../include/std/builtins.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace {
+
+using namespace optimization;
+
+bool is_power_of_two(const object_t& node) noexcept(true) {
+  const auto value = literal_value(node);
+  return value && *value > 1 && std::has_single_bit(*value);
+}
+
+/// Reads of counter in loop.
+struct Reads {
+  /// `i * M`, which values are consumed, with M.
+  std::vector<std::pair<object_t*, size_t>> products;
+  /// `i / 2^k` and `i % 2^k`.
+  std::vector<object_t*> divisions;
+  /// All occurrences of counter.
+  size_t count = 0;
+  /// Counter is changed, given away or kept.
+  bool escaped = false;
+};
+
+class ReductionPass {
+public:
+  explicit ReductionPass(ast::Lambda& lambda) noexcept(true)
+    : lambda_(lambda) {}
+
+  size_t run() noexcept(false) {
+    if (lambda_.is_lazy() || !lambda_.is_bound()) {
+      return 0;
+    }
+    occurrences_.assign(lambda_.frame_size(), 0);
+    count_occurrences(lambda_.body());
+    reduce_block(*lambda_.body());
+    return reduced_;
+  }
+
+private:
+  void count_occurrences(const object_t& node) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::LAMBDA: {
+        /// Nested lambda has own frame.
+        return;
+      }
+      case ast::type_t::SYMBOL: {
+        count(static_cast<const ast::Symbol&>(*node));
+        return;
+      }
+      case ast::type_t::TYPE_FIELD: {
+        count(static_cast<const ast::TypeFieldOperator&>(*node));
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        count(static_cast<const ast::LambdaCall&>(*node));
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+    for_each_child(node, [this](const object_t& child) { count_occurrences(child); });
+  }
+
+  void count(const ast::Resolvable& variable) noexcept(true) {
+    if (variable.in_frame()) {
+      ++occurrences_[variable.slot()];
+    }
+  }
+
+  void reduce_block(ast::Block& block) noexcept(false) {
+    for (const auto& statement : block.statements()) {
+      if (statement->ast_type() == ast::type_t::LAMBDA) {
+        reduced_ += ReductionPass(static_cast<ast::Lambda&>(*statement)).run();
+        continue;
+      }
+      for_each_block(statement, [this](ast::Block& nested) { reduce_block(nested); });
+      if (statement->ast_type() == ast::type_t::FOR) {
+        reduce_loop(static_cast<ast::For&>(*statement));
+      }
+    }
+  }
+
+  /// @param consumed - value of node is only read, not kept by variable or array
+  void scan(object_t& node, bool consumed, uint32_t slot, Reads& reads) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::SYMBOL: {
+        if (is_variable(node, slot)) {
+          ++reads.count;
+          reads.escaped |= !consumed;
+        }
+        return;
+      }
+      case ast::type_t::TYPE_FIELD: {
+        if (const auto& field = static_cast<const ast::TypeFieldOperator&>(*node); field.in_frame() && field.slot() == slot) {
+          ++reads.count;
+          reads.escaped = true;
+        }
+        return;
+      }
+      case ast::type_t::BINARY: {
+        auto& binary = static_cast<ast::Binary&>(*node);
+        const token_t type = binary.type();
+        if (is_assignment(type)) {
+          scan(binary.lhs(), /*consumed=*/false, slot, reads);
+          scan(binary.rhs(), /*consumed=*/type != token_t::ASSIGN, slot, reads);
+          return;
+        }
+        if (consumed && type == token_t::STAR) {
+          const bool lhs_counter = is_variable(binary.lhs(), slot);
+          const auto factor = literal_value(lhs_counter ? binary.rhs() : binary.lhs());
+          if (factor && (lhs_counter || is_variable(binary.rhs(), slot))) {
+            reads.products.emplace_back(&node, *factor);
+            ++reads.count;
+            return;
+          }
+        }
+        if ((type == token_t::SLASH || type == token_t::MOD) && is_variable(binary.lhs(), slot) && is_power_of_two(binary.rhs())) {
+          reads.divisions.push_back(&node);
+        }
+        scan(binary.lhs(), /*consumed=*/true, slot, reads);
+        scan(binary.rhs(), /*consumed=*/true, slot, reads);
+        return;
+      }
+      case ast::type_t::UNARY: {
+        scan(static_cast<ast::Unary&>(*node).operand(), /*consumed=*/false, slot, reads);
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        auto& call = static_cast<ast::LambdaCall&>(*node);
+        if (call.target() == ast::LambdaCall::target_t::VARIABLE && call.in_frame() && call.slot() == slot) {
+          ++reads.count;
+          reads.escaped = true;
+        }
+        const bool reader = is_output(call) || (call.target() == ast::LambdaCall::target_t::BUILTIN && is_pure_builtin(call.name()));
+        for (auto& argument : call.arguments()) {
+          scan(argument, reader, slot, reads);
+        }
+        return;
+      }
+      case ast::type_t::ARRAY: {
+        for (auto& element : static_cast<ast::Array&>(*node).elements()) {
+          scan(element, /*consumed=*/false, slot, reads);
+        }
+        return;
+      }
+      case ast::type_t::TYPE_CREATOR: {
+        for (auto& argument : static_cast<ast::TypeCreator&>(*node).arguments()) {
+          scan(argument, /*consumed=*/false, slot, reads);
+        }
+        return;
+      }
+      case ast::type_t::BLOCK: {
+        scan_statements(static_cast<ast::Block&>(*node), slot, reads);
+        return;
+      }
+      case ast::type_t::IF: {
+        auto& if_ = static_cast<ast::If&>(*node);
+        scan(if_.condition(), /*consumed=*/true, slot, reads);
+        scan_statements(*if_.body(), slot, reads);
+        if (if_.else_body()) {
+          scan_statements(*if_.else_body(), slot, reads);
+        }
+        return;
+      }
+      case ast::type_t::WHILE: {
+        auto& while_ = static_cast<ast::While&>(*node);
+        scan(while_.exit_condition(), /*consumed=*/true, slot, reads);
+        scan_statements(*while_.body(), slot, reads);
+        return;
+      }
+      case ast::type_t::FOR: {
+        const auto& for_ = static_cast<const ast::For&>(*node);
+        scan_header(for_.loop_init(), /*consumed=*/false, slot, reads);
+        scan_header(for_.exit_condition(), /*consumed=*/true, slot, reads);
+        scan_header(for_.increment(), /*consumed=*/false, slot, reads);
+        scan_statements(*for_.body(), slot, reads);
+        return;
+      }
+      default: {
+        return;
+      }
+    }
+  }
+
+  /// @brief  scan expression of for loop, which can't be replaced in place
+  void scan_header(const object_t& node, bool consumed, uint32_t slot, Reads& reads) noexcept(false) {
+    object_t copy = node;
+    const size_t products = reads.products.size();
+    const size_t divisions = reads.divisions.size();
+    scan(copy, consumed, slot, reads);
+    if (!reads.products.empty() && reads.products.back().first == &copy) {
+      reads.products.resize(products);
+      reads.escaped = true;
+    }
+    if (!reads.divisions.empty() && reads.divisions.back() == &copy) {
+      reads.divisions.resize(divisions);
+      reads.escaped = true;
+    }
+  }
+
+  void scan_statements(ast::Block& block, uint32_t slot, Reads& reads) noexcept(false) {
+    for (auto& statement : block.statements()) {
+      scan(statement, /*consumed=*/false, slot, reads);
+    }
+  }
+
+  void reduce_loop(ast::For& for_) noexcept(false) {
+    const auto induction = find_induction(for_);
+    if (!induction) {
+      return;
+    }
+    Reads reads;
+    scan(static_cast<ast::Binary&>(*for_.exit_condition()).rhs(), /*consumed=*/true, induction->slot, reads);
+    scan_statements(*for_.body(), induction->slot, reads);
+    if (reads.escaped || occurrences_[induction->slot] != induction->occurrences + reads.count) {
+      return;
+    }
+    if (scale(for_, *induction, reads)) {
+      return;
+    }
+    for (object_t* division : reads.divisions) {
+      const auto& binary = static_cast<const ast::Binary&>(**division);
+      const size_t divisor = static_cast<const ast::Integer&>(*binary.rhs()).value();
+      const bool is_mod = binary.type() == token_t::MOD;
+      auto reduced = boost::make_local_shared<ast::Binary>(is_mod ? token_t::BIT_AND : token_t::SRLI, binary.lhs(), boost::make_local_shared<ast::Integer>(is_mod ? divisor - 1 : std::countr_zero(divisor)));
+      reduced->set_inferred_type(binary.inferred_type());
+      *division = std::move(reduced);
+      ++reduced_;
+    }
+  }
+
+  /// @brief  multiply counter by factor of its products, so products become reads
+  /// @return false if loop doesn't fit
+  bool scale(ast::For& for_, const Induction& induction, const Reads& reads) noexcept(false) {
+    if (!induction.bound || reads.products.empty() || reads.products.size() != reads.count) {
+      return false;
+    }
+    const size_t factor = reads.products.front().second;
+    const bool same_factor = std::all_of(reads.products.begin(), reads.products.end(), [factor](const auto& product) { return product.second == factor; });
+    if (!same_factor || factor < 2 || std::max(induction.init, *induction.bound + induction.step) > max_integer / factor) {
+      return false;
+    }
+    for (const auto& [product, _] : reads.products) {
+      const auto& binary = static_cast<const ast::Binary&>(**product);
+      auto counter = is_variable(binary.lhs(), induction.slot) ? binary.lhs() : binary.rhs();
+      static_cast<ast::Symbol&>(*counter).set_inferred_type(ast::inferred_t::INTEGER);
+      *product = std::move(counter);
+      ++reduced_;
+    }
+    static_cast<ast::Binary&>(*for_.loop_init()).rhs() = boost::make_local_shared<ast::Integer>(induction.init * factor);
+    static_cast<ast::Binary&>(*for_.exit_condition()).rhs() = boost::make_local_shared<ast::Integer>(*induction.bound * factor);
+    auto step = boost::make_local_shared<ast::Integer>(induction.step * factor);
+    const auto& increment = for_.increment();
+    if (increment->ast_type() == ast::type_t::UNARY) {
+      object_t counter = static_cast<const ast::Unary&>(*increment).operand();
+      static_cast<ast::Symbol&>(*counter).set_inferred_type(ast::inferred_t::INTEGER);
+      /// `+=` changes the same object in place, as `++` does.
+      for_.set_increment(boost::make_local_shared<ast::Binary>(token_t::PLUS_ASSIGN, std::move(counter), std::move(step)));
+    } else if (auto& binary = static_cast<ast::Binary&>(*increment); binary.type() == token_t::PLUS_ASSIGN) {
+      static_cast<ast::Symbol&>(*binary.lhs()).set_inferred_type(ast::inferred_t::INTEGER);
+      binary.rhs() = std::move(step);
+    } else {
+      static_cast<ast::Binary&>(*binary.rhs()).rhs() = std::move(step);
+    }
+    return true;
+  }
+
+  ast::Lambda& lambda_;
+  size_t reduced_ = 0;
+  /// Slot -> count of nodes, that refer to it.
+  std::vector<size_t> occurrences_;
+};
+
+}// namespace
+
+StrengthReducer::StrengthReducer(ast::Lambda& lambda) noexcept(true)
+  : lambda_(lambda) {}
+
+size_t StrengthReducer::run() noexcept(false) {
+  return ReductionPass(lambda_).run();
+}
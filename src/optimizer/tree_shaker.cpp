@@ -0,0 +1,137 @@
+#include "../../include/optimizer/tree_shaker.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+
+namespace {
+
+std::string lowercase(std::string_view name) noexcept(false) {
+  std::string result(name);
+  std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+  return result;
+}
+
+struct Declaration {
+  size_t tree;
+  size_t statement;
+  /// Names of lambdas and types this declaration may refer to.
+  std::vector<std::string> references;
+  size_t nodes = 0;
+  bool lazy = false;
+  bool reachable = false;
+};
+
+/// @brief collect references of top-level statement by linear scan of its subtree
+Declaration describe(const ast::FlatTree& tree, ast::FlatTree::index_t root) noexcept(false) {
+  Declaration declaration{};
+  if (tree.kind(root) == ast::type_t::LAMBDA) {
+    /// Body of lazy lambda is absent.
+    const ast::FlatTree::index_t body = tree.child(root, tree.children_count(root) - 1);
+    declaration.lazy = tree.is_null(body);
+  }
+  for (ast::FlatTree::index_t node = root; node < tree.end(root); ++node) {
+    if (tree.is_null(node)) {
+      continue;
+    }
+    ++declaration.nodes;
+    switch (tree.kind(node)) {
+      case ast::type_t::SYMBOL:
+      case ast::type_t::LAMBDA_CALL:
+      case ast::type_t::TYPE_CREATOR: {
+        declaration.references.push_back(lowercase(tree.string(node)));
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+  return declaration;
+}
+
+}// namespace
+
+TreeShaker::TreeShaker(std::vector<boost::local_shared_ptr<ast::RootObject>>& trees, std::string entry) noexcept(true)
+  : trees_(trees)
+  , entry_(std::move(entry)) {}
+
+TreeShaker::TreeShaker(std::vector<boost::local_shared_ptr<ast::RootObject>>& trees, const std::vector<ast::FlatTree>& flat_trees, std::string entry) noexcept(true)
+  : trees_(trees)
+  , flat_trees_(&flat_trees)
+  , entry_(std::move(entry)) {}
+
+TreeShaker::Stats TreeShaker::shake() noexcept(false) {
+  std::vector<Declaration> declarations;
+  std::unordered_map<std::string, std::vector<size_t>> by_name;
+  std::vector<size_t> worklist;
+
+  for (size_t tree_index = 0; tree_index < trees_.size(); ++tree_index) {
+    ast::FlatTree flattened;
+    if (!flat_trees_) {
+      flattened = ast::FlatTree::flatten(*trees_[tree_index]);
+    }
+    const ast::FlatTree& tree = flat_trees_ ? (*flat_trees_)[tree_index] : flattened;
+    size_t statement = 0;
+    for (ast::FlatTree::index_t root : tree.roots()) {
+      Declaration declaration = describe(tree, root);
+      declaration.tree = tree_index;
+      declaration.statement = statement++;
+      const ast::type_t kind = tree.kind(root);
+      if (kind == ast::type_t::LAMBDA || kind == ast::type_t::TYPE_DEFINITION) {
+        by_name[lowercase(tree.string(root))].push_back(declarations.size());
+      } else {
+        /// Statements other than declarations are executed, so they are roots too.
+        worklist.push_back(declarations.size());
+      }
+      declarations.push_back(std::move(declaration));
+    }
+  }
+
+  auto entry = by_name.find(lowercase(entry_));
+  if (entry == by_name.end()) {
+    return {};
+  }
+  worklist.insert(worklist.end(), entry->second.begin(), entry->second.end());
+
+  while (!worklist.empty()) {
+    Declaration& declaration = declarations[worklist.back()];
+    worklist.pop_back();
+    if (declaration.reachable) {
+      continue;
+    }
+    declaration.reachable = true;
+    if (declaration.lazy) {
+      return {};
+    }
+    for (const std::string& reference : declaration.references) {
+      if (auto referenced = by_name.find(reference); referenced != by_name.end()) {
+        worklist.insert(worklist.end(), referenced->second.begin(), referenced->second.end());
+      }
+    }
+  }
+
+  Stats stats;
+  std::vector<std::vector<bool>> removed(trees_.size());
+  for (size_t i = 0; i < trees_.size(); ++i) {
+    removed[i].resize(trees_[i]->get().size());
+  }
+  for (const Declaration& declaration : declarations) {
+    if (!declaration.reachable) {
+      removed[declaration.tree][declaration.statement] = true;
+      ++stats.declarations;
+      stats.nodes += declaration.nodes;
+    }
+  }
+  for (size_t i = 0; i < trees_.size(); ++i) {
+    auto& statements = trees_[i]->get();
+    size_t kept = 0;
+    for (size_t statement = 0; statement < statements.size(); ++statement) {
+      if (!removed[i][statement]) {
+        statements[kept++] = std::move(statements[statement]);
+      }
+    }
+    statements.resize(kept);
+  }
+  return stats;
+}
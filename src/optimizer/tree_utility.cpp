@@ -0,0 +1,478 @@
+#include "../../include/optimizer/tree_utility.hpp"
+
+#include "../../include/std/builtins.hpp"
+
+#include <algorithm>
+
+namespace optimization {
+
+bool is_number(const object_t& node) noexcept(true) {
+  return node && (node->ast_type() == ast::type_t::INTEGER || node->ast_type() == ast::type_t::FLOAT);
+}
+
+object_t copy_number(const object_t& number) noexcept(false) {
+  if (number->ast_type() == ast::type_t::INTEGER) {
+    return boost::make_local_shared<ast::Integer>(static_cast<const ast::Integer&>(*number));
+  }
+  return boost::make_local_shared<ast::Float>(static_cast<const ast::Float&>(*number).value());
+}
+
+bool is_zero(const ast::Integer& integer) noexcept(true) {
+  return !integer.is_big() && integer.value() == 0;
+}
+
+bool is_literal(const object_t& node) noexcept(true) {
+  const auto type = node->ast_type();
+  return type == ast::type_t::INTEGER || type == ast::type_t::FLOAT || type == ast::type_t::STRING;
+}
+
+bool is_assignment(token_t type) noexcept(true) {
+  return type == token_t::ASSIGN || token_traits::is_assign_operator(type);
+}
+
+const ast::Symbol* assigned_symbol(const object_t& node) noexcept(true) {
+  if (node->ast_type() != ast::type_t::BINARY) {
+    return nullptr;
+  }
+  const auto& binary = static_cast<const ast::Binary&>(*node);
+  if (binary.type() != token_t::ASSIGN || binary.lhs()->ast_type() != ast::type_t::SYMBOL) {
+    return nullptr;
+  }
+  const auto& symbol = static_cast<const ast::Symbol&>(*binary.lhs());
+  return symbol.in_frame() ? &symbol : nullptr;
+}
+
+bool is_fresh(const object_t& node) noexcept(true) {
+  return node->ast_type() == ast::type_t::BINARY && !is_assignment(static_cast<const ast::Binary&>(*node).type());
+}
+
+bool is_output(const ast::LambdaCall& call) noexcept(true) {
+  return call.target() == ast::LambdaCall::target_t::BUILTIN && (call.name() == "print" || call.name() == "println");
+}
+
+bool reads_arguments(const ast::LambdaCall& call) noexcept(true) {
+  return is_output(call) || (call.target() == ast::LambdaCall::target_t::BUILTIN && is_pure_builtin(call.name())) || (call.target() == ast::LambdaCall::target_t::LAMBDA && call.lambda().is_pure());
+}
+
+const ast::Symbol* changed_symbol(const object_t& node) noexcept(true) {
+  if (node->ast_type() == ast::type_t::UNARY) {
+    const auto& operand = static_cast<const ast::Unary&>(*node).operand();
+    return operand->ast_type() == ast::type_t::SYMBOL ? &static_cast<const ast::Symbol&>(*operand) : nullptr;
+  }
+  if (node->ast_type() == ast::type_t::BINARY) {
+    const auto& binary = static_cast<const ast::Binary&>(*node);
+    return token_traits::is_assign_operator(binary.type()) ? &static_cast<const ast::Symbol&>(*binary.lhs()) : nullptr;
+  }
+  return nullptr;
+}
+
+bool has_effects(const object_t& node) noexcept(true) {
+  switch (node->ast_type()) {
+    case ast::type_t::INTEGER:
+    case ast::type_t::FLOAT:
+    case ast::type_t::STRING:
+    case ast::type_t::SYMBOL:
+    case ast::type_t::TYPE_FIELD: {
+      return false;
+    }
+    case ast::type_t::BINARY: {
+      const auto& binary = static_cast<const ast::Binary&>(*node);
+      if (is_assignment(binary.type())) {
+        return true;
+      }
+      if (binary.type() == token_t::SLASH || binary.type() == token_t::MOD) {
+        const auto& rhs = binary.rhs();
+        /// Integral division by zero throws, floating point modulo fails.
+        const bool safe = (rhs->ast_type() == ast::type_t::INTEGER && !is_zero(static_cast<const ast::Integer&>(*rhs))) || (rhs->ast_type() == ast::type_t::FLOAT && binary.type() == token_t::SLASH);
+        if (!safe) {
+          return true;
+        }
+      }
+      return has_effects(binary.lhs()) || has_effects(binary.rhs());
+    }
+    case ast::type_t::ARRAY: {
+      const auto& elements = static_cast<const ast::Array&>(*node).elements();
+      return std::any_of(elements.begin(), elements.end(), has_effects);
+    }
+    case ast::type_t::LAMBDA_CALL: {
+      const auto& call = static_cast<const ast::LambdaCall&>(*node);
+      const bool pure_target = (call.target() == ast::LambdaCall::target_t::BUILTIN && is_pure_builtin(call.name())) || (call.target() == ast::LambdaCall::target_t::LAMBDA && call.lambda().is_pure());
+      const auto& arguments = call.arguments();
+      return !pure_target || std::any_of(arguments.begin(), arguments.end(), has_effects);
+    }
+    default: {
+      return true;
+    }
+  }
+}
+
+size_t count_nodes(const object_t& node) noexcept(false) {
+  if (!node) {
+    return 0;
+  }
+  size_t count = 1;
+  for_each_child(node, [&count](const object_t& child) { count += count_nodes(child); });
+  return count;
+}
+
+std::optional<size_t> literal_value(const object_t& node) noexcept(true) {
+  if (!node || node->ast_type() != ast::type_t::INTEGER) {
+    return std::nullopt;
+  }
+  const auto& integer = static_cast<const ast::Integer&>(*node);
+  if (integer.is_big() || integer.value() < 0 || static_cast<size_t>(integer.value()) > max_integer) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(integer.value());
+}
+
+bool is_variable(const object_t& node, uint32_t slot) noexcept(true) {
+  if (!node || node->ast_type() != ast::type_t::SYMBOL) {
+    return false;
+  }
+  const auto& symbol = static_cast<const ast::Symbol&>(*node);
+  return symbol.in_frame() && symbol.slot() == slot;
+}
+
+std::optional<Induction> find_induction(const ast::For& for_) noexcept(true) {
+  Induction induction;
+  const ast::Symbol* counter = for_.loop_init() ? assigned_symbol(for_.loop_init()) : nullptr;
+  if (!counter) {
+    return std::nullopt;
+  }
+  induction.slot = counter->slot();
+  const auto init = literal_value(static_cast<const ast::Binary&>(*for_.loop_init()).rhs());
+  if (!init) {
+    return std::nullopt;
+  }
+  induction.init = *init;
+
+  const auto& condition = for_.exit_condition();
+  if (!condition || condition->ast_type() != ast::type_t::BINARY) {
+    return std::nullopt;
+  }
+  const auto& comparison = static_cast<const ast::Binary&>(*condition);
+  if ((comparison.type() != token_t::LT && comparison.type() != token_t::LE) || !is_variable(comparison.lhs(), induction.slot)) {
+    return std::nullopt;
+  }
+  induction.bound = literal_value(comparison.rhs());
+  induction.inclusive = comparison.type() == token_t::LE;
+
+  const auto& increment = for_.increment();
+  if (!increment) {
+    return std::nullopt;
+  }
+  if (increment->ast_type() == ast::type_t::UNARY) {
+    const auto& unary = static_cast<const ast::Unary&>(*increment);
+    if (unary.type() != token_t::INC || !is_variable(unary.operand(), induction.slot)) {
+      return std::nullopt;
+    }
+    induction.step = 1;
+    induction.in_place = true;
+    induction.occurrences = 3;
+  } else if (increment->ast_type() == ast::type_t::BINARY) {
+    const auto& binary = static_cast<const ast::Binary&>(*increment);
+    if (!is_variable(binary.lhs(), induction.slot)) {
+      return std::nullopt;
+    }
+    std::optional<size_t> step;
+    if (binary.type() == token_t::PLUS_ASSIGN) {
+      step = literal_value(binary.rhs());
+      induction.in_place = true;
+      induction.occurrences = 3;
+    } else if (binary.type() == token_t::ASSIGN && binary.rhs()->ast_type() == ast::type_t::BINARY) {
+      const auto& sum = static_cast<const ast::Binary&>(*binary.rhs());
+      if (sum.type() == token_t::PLUS && is_variable(sum.lhs(), induction.slot)) {
+        step = literal_value(sum.rhs());
+        induction.occurrences = 4;
+      }
+    }
+    if (!step || *step == 0) {
+      return std::nullopt;
+    }
+    induction.step = *step;
+  } else {
+    return std::nullopt;
+  }
+
+  /// Counter never wraps to negative value, if last value fits into 32 bits.
+  if (induction.bound ? *induction.bound + induction.step > max_integer : induction.inclusive || induction.step != 1) {
+    return std::nullopt;
+  }
+  return induction;
+}
+
+std::optional<size_t> trip_count(const Induction& induction) noexcept(true) {
+  if (!induction.bound) {
+    return std::nullopt;
+  }
+  const size_t end = *induction.bound + (induction.inclusive ? 1 : 0);
+  return induction.init < end ? (end - induction.init + induction.step - 1) / induction.step : 0;
+}
+
+Cloner::Cloner(std::vector<uint32_t> slots) noexcept(true)
+  : slots_(std::move(slots)) {}
+
+Cloner::Cloner(const std::vector<object_t>& arguments) noexcept(true)
+  : arguments_(&arguments) {}
+
+Cloner Cloner::sharing_literals() noexcept(true) {
+  Cloner cloner;
+  cloner.share_literals_ = true;
+  return cloner;
+}
+
+object_t Cloner::clone(const object_t& node) const noexcept(false) {
+  if (!node) {
+    return nullptr;
+  }
+  switch (node->ast_type()) {
+    case ast::type_t::INTEGER:
+    case ast::type_t::FLOAT: {
+      return share_literals_ ? node : copy_number(node);
+    }
+    case ast::type_t::STRING: {
+      if (share_literals_) {
+        return node;
+      }
+      return boost::make_local_shared<ast::String>(static_cast<const ast::String&>(*node).value());
+    }
+    case ast::type_t::SYMBOL: {
+      const auto& symbol = static_cast<const ast::Symbol&>(*node);
+      if (arguments_ && symbol.scope() == ast::scope_t::PARAMETER) {
+        return Cloner().clone((*arguments_)[symbol.slot()]);
+      }
+      auto copy = boost::make_local_shared<ast::Symbol>(symbol.name());
+      copy->set_inferred_type(symbol.inferred_type());
+      resolve(symbol, *copy);
+      return copy;
+    }
+    case ast::type_t::TYPE_FIELD: {
+      const auto& field = static_cast<const ast::TypeFieldOperator&>(*node);
+      auto copy = boost::make_local_shared<ast::TypeFieldOperator>(field.name(), field.field());
+      resolve(field, *copy);
+      return copy;
+    }
+    case ast::type_t::ARRAY: {
+      if (share_literals_) {
+        return node;
+      }
+      return boost::make_local_shared<ast::Array>(clone_all(static_cast<const ast::Array&>(*node).elements()));
+    }
+    case ast::type_t::UNARY: {
+      const auto& unary = static_cast<const ast::Unary&>(*node);
+      auto copy = boost::make_local_shared<ast::Unary>(unary.type(), clone(unary.operand()));
+      copy->set_inferred_type(unary.inferred_type());
+      return copy;
+    }
+    case ast::type_t::BINARY: {
+      const auto& binary = static_cast<const ast::Binary&>(*node);
+      auto copy = boost::make_local_shared<ast::Binary>(binary.type(), clone(binary.lhs()), clone(binary.rhs()));
+      copy->set_inferred_type(binary.inferred_type());
+      return copy;
+    }
+    case ast::type_t::BLOCK: {
+      return clone_block(boost::static_pointer_cast<ast::Block>(node));
+    }
+    case ast::type_t::WHILE: {
+      const auto& while_ = static_cast<const ast::While&>(*node);
+      auto copy = boost::make_local_shared<ast::While>(clone(while_.exit_condition()), clone_block(while_.body()));
+      copy->set_inferred_type(while_.inferred_type());
+      return copy;
+    }
+    case ast::type_t::FOR: {
+      const auto& for_ = static_cast<const ast::For&>(*node);
+      auto copy = boost::make_local_shared<ast::For>();
+      copy->set_init(clone(for_.loop_init()));
+      copy->set_exit_condition(clone(for_.exit_condition()));
+      copy->set_increment(clone(for_.increment()));
+      copy->set_body(clone_block(for_.body()));
+      copy->set_inferred_type(for_.inferred_type());
+      return copy;
+    }
+    case ast::type_t::IF: {
+      const auto& if_ = static_cast<const ast::If&>(*node);
+      if (if_.else_body()) {
+        return boost::make_local_shared<ast::If>(clone(if_.condition()), clone_block(if_.body()), clone_block(if_.else_body()));
+      }
+      return boost::make_local_shared<ast::If>(clone(if_.condition()), clone_block(if_.body()));
+    }
+    case ast::type_t::LAMBDA_CALL: {
+      const auto& call = static_cast<const ast::LambdaCall&>(*node);
+      auto copy = boost::make_local_shared<ast::LambdaCall>(call.name(), clone_all(call.arguments()));
+      switch (call.target()) {
+        // clang-format off
+        case ast::LambdaCall::target_t::BUILTIN: { copy->bind(call.builtin()); break; }
+        case ast::LambdaCall::target_t::LAMBDA: { copy->bind(call.lambda()); break; }
+        case ast::LambdaCall::target_t::VARIABLE: { resolve(call, *copy); copy->bind_variable(); break; }
+        case ast::LambdaCall::target_t::UNRESOLVED: { break; }
+        // clang-format on
+      }
+      return copy;
+    }
+    case ast::type_t::TYPE_CREATOR: {
+      const auto& creator = static_cast<const ast::TypeCreator&>(*node);
+      return boost::make_local_shared<ast::TypeCreator>(creator.name(), clone_all(creator.arguments()));
+    }
+    default: {
+      return node;
+    }
+  }
+}
+
+std::vector<object_t> Cloner::clone_all(const std::vector<object_t>& nodes) const noexcept(false) {
+  std::vector<object_t> copies;
+  copies.reserve(nodes.size());
+  for (const auto& node : nodes) {
+    copies.push_back(clone(node));
+  }
+  return copies;
+}
+
+boost::local_shared_ptr<ast::Block> Cloner::clone_block(const boost::local_shared_ptr<ast::Block>& block) const noexcept(false) {
+  return boost::make_local_shared<ast::Block>(clone_all(block->statements()));
+}
+
+void Cloner::resolve(const ast::Resolvable& from, ast::Resolvable& to) const noexcept(true) {
+  if (!from.in_frame()) {
+    to.resolve(from.scope());
+  } else if (slots_.empty()) {
+    to.resolve(from.scope(), from.slot());
+  } else {
+    to.resolve(ast::scope_t::LOCAL, slots_[from.slot()]);
+  }
+}
+
+AliasAnalysis::AliasAnalysis(const ast::Lambda& lambda) noexcept(false)
+  : shared_(lambda.frame_size(), false)
+  , kept_(lambda.frame_size(), false) {
+  std::fill_n(shared_.begin(), lambda.arguments().size(), true);
+  const auto& statements = lambda.body()->statements();
+  for (const auto& statement : statements) {
+    collect(statement);
+  }
+  /// Last statement is the value of lambda.
+  if (!statements.empty() && statements.back()->ast_type() == ast::type_t::SYMBOL) {
+    keep(statements.back());
+  }
+}
+
+void AliasAnalysis::add_slot() noexcept(false) {
+  shared_.push_back(false);
+  kept_.push_back(false);
+}
+
+void AliasAnalysis::share(const object_t& node) noexcept(true) {
+  if (node->ast_type() == ast::type_t::SYMBOL && static_cast<const ast::Symbol&>(*node).in_frame()) {
+    shared_[static_cast<const ast::Symbol&>(*node).slot()] = true;
+  }
+}
+
+void AliasAnalysis::keep(const object_t& node) noexcept(true) {
+  if (node->ast_type() == ast::type_t::SYMBOL && static_cast<const ast::Symbol&>(*node).in_frame()) {
+    kept_[static_cast<const ast::Symbol&>(*node).slot()] = true;
+  }
+}
+
+void AliasAnalysis::collect(const object_t& node) noexcept(false) {
+  if (!node) {
+    return;
+  }
+  if (const auto* symbol = changed_symbol(node); symbol && symbol->in_frame()) {
+    kept_[symbol->slot()] = true;
+  }
+  switch (node->ast_type()) {
+    case ast::type_t::BINARY: {
+      const auto& binary = static_cast<const ast::Binary&>(*node);
+      if (const auto* symbol = assigned_symbol(node)) {
+        const auto& rhs = binary.rhs();
+        const bool fresh = is_literal(rhs) || rhs->ast_type() == ast::type_t::ARRAY || (rhs->ast_type() == ast::type_t::BINARY && !is_assignment(static_cast<const ast::Binary&>(*rhs).type()));
+        if (!fresh) {
+          shared_[symbol->slot()] = true;
+        }
+        share(rhs);
+        keep(rhs);
+      }
+      break;
+    }
+    case ast::type_t::ARRAY: {
+      for (const auto& element : static_cast<const ast::Array&>(*node).elements()) {
+        share(element);
+        keep(element);
+      }
+      break;
+    }
+    case ast::type_t::TYPE_CREATOR: {
+      for (const auto& argument : static_cast<const ast::TypeCreator&>(*node).arguments()) {
+        share(argument);
+        keep(argument);
+      }
+      break;
+    }
+    case ast::type_t::LAMBDA_CALL: {
+      const auto& call = static_cast<const ast::LambdaCall&>(*node);
+      if (call.target() == ast::LambdaCall::target_t::VARIABLE && call.in_frame()) {
+        kept_[call.slot()] = true;
+      }
+      const bool builtin_reader = is_output(call) || (call.target() == ast::LambdaCall::target_t::BUILTIN && is_pure_builtin(call.name()));
+      for (const auto& argument : call.arguments()) {
+        /// Lambda may give its argument back.
+        if (!builtin_reader) {
+          share(argument);
+          keep(argument);
+        }
+      }
+      break;
+    }
+    case ast::type_t::TYPE_FIELD: {
+      const auto& field = static_cast<const ast::TypeFieldOperator&>(*node);
+      if (field.in_frame()) {
+        kept_[field.slot()] = true;
+      }
+      break;
+    }
+    default: {
+      break;
+    }
+  }
+  for_each_child(node, [this](const object_t& child) { collect(child); });
+}
+
+Assignments::Assignments(const ast::Lambda& lambda) noexcept(false)
+  : shared_(lambda.frame_size(), false)
+  , assigned_(lambda.frame_size(), false) {
+  collect(lambda.body());
+}
+
+bool Assignments::is_value(const object_t& statement) const noexcept(true) {
+  if (is_fresh(statement)) {
+    return true;
+  }
+  if (statement->ast_type() != ast::type_t::SYMBOL) {
+    return false;
+  }
+  const auto& symbol = static_cast<const ast::Symbol&>(*statement);
+  return symbol.scope() == ast::scope_t::LOCAL && assigned_[symbol.slot()] && !shared_[symbol.slot()];
+}
+
+void Assignments::collect(const object_t& node) noexcept(false) {
+  if (!node) {
+    return;
+  }
+  if (const auto* symbol = assigned_symbol(node)) {
+    assigned_[symbol->slot()] = true;
+    if (!is_fresh(static_cast<const ast::Binary&>(*node).rhs())) {
+      shared_[symbol->slot()] = true;
+    }
+  }
+  for_each_child(node, [this](const object_t& child) { collect(child); });
+}
+
+bool returns_new_value(const ast::Lambda& lambda) noexcept(false) {
+  if (!lambda.is_bound() || lambda.is_lazy() || lambda.body()->statements().empty()) {
+    return false;
+  }
+  return Assignments(lambda).is_value(lambda.body()->statements().back());
+}
+
+}// namespace optimization
@@ -0,0 +1,100 @@
+#include "../../include/parser/module_parser.hpp"
+
+#include "../../include/parser/parser.hpp"
+#include "../../include/semantic/semantic_analyzer.hpp"
+
+#include <future>
+#include <utility>
+
+namespace {
+
+/// @param inner_pool - if set, declarations are parsed on its workers, must be null on pool workers
+boost::local_shared_ptr<ast::RootObject> parse_module(std::vector<Token> tokens, ThreadPool* inner_pool, bool lazy_bodies) noexcept(false) {
+  tokens.push_back(Token{"", token_t::END_OF_DATA});
+  Parser parser(std::move(tokens), lazy_bodies);
+  return inner_pool ? parser.parse_parallel(*inner_pool) : parser.parse();
+}
+
+/// @brief  call function(i, inner_pool) for every module, concurrently if pool is set
+/// @throws exception of the first failed module
+/// @return results in order of modules
+template <typename Result, typename Function>
+std::vector<Result> for_each_module(ThreadPool* pool, size_t modules_count, Function function) noexcept(false) {
+  std::vector<Result> results;
+  results.reserve(modules_count);
+  if (!pool || pool->size() < 2 || modules_count < 2) {
+    for (size_t i = 0; i < modules_count; ++i) {
+      results.push_back(function(i, pool));
+    }
+    return results;
+  }
+  std::vector<std::future<Result>> futures;
+  futures.reserve(modules_count);
+  for (size_t i = 0; i < modules_count; ++i) {
+    futures.push_back(pool->submit([&function, i] {
+      return function(i, /*inner_pool=*/nullptr);
+    }));
+  }
+  /// Wait for all modules, so failed module doesn't leave trees owned by running workers.
+  for (auto& future : futures) {
+    future.wait();
+  }
+  for (auto& future : futures) {
+    results.push_back(future.get());
+  }
+  return results;
+}
+
+}// namespace
+
+boost::local_shared_ptr<ast::RootObject> parse_modules(std::vector<ModuleLoader::Module> modules, ThreadPool* pool, ModuleParserOptions options, TreeShaker::Stats* shaking_stats) noexcept(false) {
+  using parsed_t = std::pair<boost::local_shared_ptr<ast::RootObject>, ast::FlatTree>;
+  /// Module is flattened once, flat tree serves both tree shaking and semantic analysis.
+  std::vector<parsed_t> parsed = for_each_module<parsed_t>(pool, modules.size(), [&modules, &options](size_t i, ThreadPool* inner_pool) {
+    auto tree = parse_module(std::move(modules[i].tokens), inner_pool, options.lazy_bodies);
+    auto flat = ast::FlatTree::flatten(*tree);
+    return parsed_t{std::move(tree), std::move(flat)};
+  });
+  std::vector<boost::local_shared_ptr<ast::RootObject>> trees;
+  std::vector<ast::FlatTree> flat_trees;
+  trees.reserve(parsed.size());
+  flat_trees.reserve(parsed.size());
+  for (auto& [tree, flat] : parsed) {
+    trees.push_back(std::move(tree));
+    flat_trees.push_back(std::move(flat));
+  }
+  for (const auto& tree : trees) {
+    for (const auto& declaration : tree->get()) {
+      const ast::type_t type = declaration->ast_type();
+      if (type != ast::type_t::LAMBDA && type != ast::type_t::TYPE_DEFINITION) {
+        throw SemanticError("Only lambdas and type definitions are allowed at top level");
+      }
+    }
+  }
+
+  if (options.tree_shaking) {
+    TreeShaker shaker(trees, flat_trees);
+    const TreeShaker::Stats stats = shaker.shake();
+    if (shaking_stats) {
+      *shaking_stats = stats;
+    }
+  }
+
+  /// Flat trees aren't shaken, so removed declarations are checked too, but types are
+  /// inferred only for kept ones.
+  for_each_module<bool>(pool, trees.size(), [&trees, &flat_trees](size_t i, ThreadPool*) {
+    SemanticAnalyzer semantic_analyzer(trees[i], std::move(flat_trees[i]));
+    semantic_analyzer.analyze();
+    return true;
+  });
+
+  auto root = boost::make_local_shared<ast::RootObject>();
+  for (const auto& tree : trees) {
+    for (auto& declaration : tree->get()) {
+      root->add(std::move(declaration));
+    }
+  }
+  /// Names are bound across modules, so it's done after merge.
+  SemanticAnalyzer::bind(*root);
+  return root;
+}
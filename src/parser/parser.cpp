@@ -1,5 +1,10 @@
 #include "../../include/parser/parser.hpp"
 
+#include <algorithm>
+#include <future>
+
+/// Nodes are allocated with global allocator, so parsers can run on different
+/// threads, while each of them owns its own tree.
 template <typename T, typename... Args>
 static auto make_ast_ptr(Args&&... args) noexcept(false) {
   return boost::make_local_shared<T>(std::forward<Args>(args)...);
@@ -23,13 +28,28 @@ static bool is_block(const Parser::ast_ptr<ast::Object>& statement) noexcept(tru
   return statement->ast_type() == ast::type_t::BLOCK;
 }
 
-Parser::Parser(std::vector<Token> tokens) noexcept(true)
-  : input_(std::move(tokens))
-  , current_index_(0) {}
+Parser::Parser(std::vector<Token> tokens, bool lazy_bodies) noexcept(false)
+  : tokens_(std::make_shared<const std::vector<Token>>(std::move(tokens)))
+  , input_(*tokens_)
+  , current_index_(0)
+  , end_index_(tokens_->size())
+  , lazy_bodies_(lazy_bodies) {}
+
+Parser::Parser(std::shared_ptr<const std::vector<Token>> tokens, size_t begin, size_t end, bool lazy_bodies) noexcept(true)
+  : tokens_(std::move(tokens))
+  , input_(*tokens_)
+  , current_index_(begin)
+  , end_index_(end)
+  , lazy_bodies_(lazy_bodies) {}
 
 Parser::ast_ptr<ast::RootObject> Parser::parse() noexcept(false) {
   ast_ptr<ast::RootObject> root = make_ast_ptr<ast::RootObject>();
   while (has_next()) {
+    if (lazy_bodies_ && current().type == token_t::LAMBDA) {
+      peek();
+      root->add(lazy_lambda_declare_statement());
+      continue;
+    }
     auto expression = additive();
     if (!is_block_statement(expression)) {
       require({token_t::SEMICOLON});
@@ -39,6 +59,85 @@ Parser::ast_ptr<ast::RootObject> Parser::parse() noexcept(false) {
   return root;
 }
 
+Parser::ast_ptr<ast::RootObject> Parser::parse_parallel(ThreadPool& pool, size_t min_chunk_tokens) noexcept(false) {
+  const std::vector<size_t> boundaries = top_level_boundaries();
+  if (boundaries.empty() || pool.size() < 2 || boundaries.back() - current_index_ < 2 * min_chunk_tokens) {
+    return parse();
+  }
+
+  /// Few chunks per worker to balance declarations of different size.
+  const size_t chunk_tokens = std::max(min_chunk_tokens, (boundaries.back() - current_index_) / (pool.size() * 4));
+  std::vector<std::future<ast_ptr<ast::RootObject>>> chunks;
+  for (size_t first = 0; first + 1 < boundaries.size();) {
+    size_t last = first + 1;
+    while (last + 1 < boundaries.size() && boundaries[last] - boundaries[first] < chunk_tokens) {
+      ++last;
+    }
+    chunks.push_back(pool.submit([this, begin = boundaries[first], end = boundaries[last]] {
+      Parser parser(tokens_, begin, end, lazy_bodies_);
+      return parser.parse();
+    }));
+    first = last;
+  }
+  /// Wait for all chunks, so failed chunk doesn't leave trees owned by running workers.
+  for (auto& chunk : chunks) {
+    chunk.wait();
+  }
+
+  ast_ptr<ast::RootObject> root = make_ast_ptr<ast::RootObject>();
+  try {
+    for (auto& chunk : chunks) {
+      const ast_ptr<ast::RootObject> tree = chunk.get();
+      for (auto& declaration : tree->get()) {
+        root->add(std::move(declaration));
+      }
+    }
+  } catch (...) {
+    return parse();
+  }
+  current_index_ = boundaries.back();
+  return root;
+}
+
+std::vector<size_t> Parser::top_level_boundaries() const noexcept(true) {
+  std::vector<size_t> boundaries;
+  size_t index = current_index_;
+  auto skip_to = [this, &index](token_t type) {
+    while (index < end_index_ && input_[index].type != type && input_[index].type != token_t::END_OF_DATA) {
+      ++index;
+    }
+    return index < end_index_ && input_[index].type == type;
+  };
+
+  while (index < end_index_ && input_[index].type != token_t::END_OF_DATA) {
+    boundaries.push_back(index);
+    if (input_[index].type == token_t::DEFINE_TYPE) {
+      if (!skip_to(token_t::SEMICOLON)) {
+        return {};
+      }
+      ++index;
+      continue;
+    }
+    if (input_[index].type != token_t::LAMBDA || !skip_to(token_t::LEFT_BRACE)) {
+      return {};
+    }
+    size_t depth = 0;
+    for (; index < end_index_ && input_[index].type != token_t::END_OF_DATA; ++index) {
+      if (input_[index].type == token_t::LEFT_BRACE) {
+        ++depth;
+      } else if (input_[index].type == token_t::RIGHT_BRACE && --depth == 0) {
+        break;
+      }
+    }
+    if (depth != 0) {
+      return {};
+    }
+    ++index;
+  }
+  boundaries.push_back(index);
+  return boundaries;
+}
+
 Parser::ast_ptr<ast::Object> Parser::primary() noexcept(false) {
   peek();
   switch (previous().type) {
@@ -95,15 +194,24 @@ Parser::ast_ptr<ast::Object> Parser::primary() noexcept(false) {
 }
 
 const Token& Parser::current() const noexcept(false) {
-  return input_.at(current_index_);
+  if (current_index_ >= input_.size()) {
+    throw std::out_of_range("Parser::current()");
+  }
+  return input_[current_index_];
 }
 
 const Token& Parser::previous() const noexcept(false) {
-  return input_.at(current_index_ - 1);
+  if (current_index_ - 1 >= input_.size()) {
+    throw std::out_of_range("Parser::previous()");
+  }
+  return input_[current_index_ - 1];
 }
 
 const Token& Parser::peek() noexcept(false) {
-  return input_.at(current_index_++);
+  if (current_index_ >= input_.size()) {
+    throw std::out_of_range("Parser::peek()");
+  }
+  return input_[current_index_++];
 }
 
 bool Parser::end_of_expression() const noexcept(true) {
@@ -121,26 +229,21 @@ bool Parser::end_of_expression() const noexcept(true) {
 }
 
 bool Parser::has_next() const noexcept(false) {
-  return current_index_ < input_.size() && current().type != token_t::END_OF_DATA;
+  return current_index_ < end_index_ && current().type != token_t::END_OF_DATA;
 }
 
-std::optional<Token> Parser::match(const std::vector<token_t>& expected_types) noexcept(false) {
-  if (has_next()) {
-    const Token token = current();
-    if (std::find(expected_types.begin(), expected_types.end(), token.type) != expected_types.end()) {
-      peek();
-      return token;
-    }
+const Token* Parser::match(TokenSet expected_types) noexcept(false) {
+  if (has_next() && expected_types.contains(current().type)) {
+    return &peek();
   }
-  return std::nullopt;
+  return nullptr;
 }
 
-Token Parser::require(const std::vector<token_t>& expected_types) noexcept(false) {
-  if (const std::optional<Token> token = match(expected_types)) {
-    return token.value();
-  } else {
-    throw ParseError("{} expected, got {}", dispatch_token(expected_types[0]), dispatch_token(current().type));
+const Token& Parser::require(TokenSet expected_types) noexcept(false) {
+  if (const Token* token = match(expected_types)) {
+    return *token;
   }
+  throw ParseError("{} expected, got {}", expected_types.to_string(), dispatch_token(current().type));
 }
 
 Parser::ast_ptr<ast::Object> Parser::additive() noexcept(false) {
@@ -217,7 +320,7 @@ Parser::ast_ptr<ast::Object> Parser::array() noexcept(false) {
   }
   while (true) {
     objects.emplace_back(primary());
-    const auto term = require({token_t::RIGHT_BOX_BRACE, token_t::COMMA});
+    const Token& term = require({token_t::RIGHT_BOX_BRACE, token_t::COMMA});
     if (term.type == token_t::RIGHT_BOX_BRACE) {
       break;
     }
@@ -279,8 +382,45 @@ Parser::ast_ptr<ast::Object> Parser::for_statement() noexcept(false) {
 };
 
 Parser::ast_ptr<ast::Object> Parser::lambda_declare_statement() noexcept(false) {
-  const Token symbol = require({token_t::SYMBOL});
+  const Token& symbol = require({token_t::SYMBOL});
   const std::string lambda_name = symbol.data;
+  auto arguments = lambda_parameters();
+  auto lambda_body = block();
+  return make_ast_ptr<ast::Lambda>(lambda_name, std::move(arguments), std::move(lambda_body));
+}
+
+Parser::ast_ptr<ast::Object> Parser::lazy_lambda_declare_statement() noexcept(false) {
+  std::string lambda_name = require({token_t::SYMBOL}).data;
+  auto arguments = lambda_parameters();
+  const size_t body_begin = current_index_;
+  require({token_t::LEFT_BRACE});
+  for (size_t depth = 1; depth > 0; peek()) {
+    switch (current().type) {
+      case token_t::LEFT_BRACE: {
+        ++depth;
+        break;
+      }
+      case token_t::RIGHT_BRACE: {
+        --depth;
+        break;
+      }
+      case token_t::END_OF_DATA: {
+        /// Let block() report the error.
+        current_index_ = body_begin;
+        return make_ast_ptr<ast::Lambda>(std::move(lambda_name), std::move(arguments), block());
+      }
+      default: {
+        break;
+      }
+    }
+  }
+  return make_ast_ptr<ast::Lambda>(std::move(lambda_name), std::move(arguments), [tokens = tokens_, body_begin] {
+    Parser parser(tokens, body_begin, tokens->size(), /*lazy_bodies=*/false);
+    return parser.block();
+  });
+}
+
+std::vector<Parser::ast_ptr<ast::Object>> Parser::lambda_parameters() noexcept(false) {
   require({token_t::LEFT_PAREN});
   std::vector<ast_ptr<ast::Object>> arguments;
   if (!match({token_t::RIGHT_PAREN})) {
@@ -291,7 +431,7 @@ Parser::ast_ptr<ast::Object> Parser::lambda_declare_statement() noexcept(false)
         arguments.emplace_back(make_ast_ptr<ast::Symbol>(current().data));
       }
       peek();
-      const auto term = require({token_t::RIGHT_PAREN, token_t::COMMA});
+      const Token& term = require({token_t::RIGHT_PAREN, token_t::COMMA});
       if (term.type == token_t::COMMA) {
         continue;
       } else if (term.type == token_t::RIGHT_PAREN) {
@@ -299,8 +439,7 @@ Parser::ast_ptr<ast::Object> Parser::lambda_declare_statement() noexcept(false)
       }
     }
   }
-  auto lambda_body = block();
-  return make_ast_ptr<ast::Lambda>(lambda_name, std::move(arguments), std::move(lambda_body));
+  return arguments;
 }
 
 Parser::ast_ptr<ast::Object> Parser::define_type_statement() noexcept(false) {
@@ -314,7 +453,7 @@ Parser::ast_ptr<ast::Object> Parser::define_type_statement() noexcept(false) {
       fields.push_back(current().data);
     }
     peek();
-    const auto term = require({token_t::RIGHT_PAREN, token_t::COMMA});
+    const Token& term = require({token_t::RIGHT_PAREN, token_t::COMMA});
     if (term.type == token_t::COMMA) {
       continue;
     } else if (term.type == token_t::RIGHT_PAREN) {
@@ -332,7 +471,7 @@ std::vector<Parser::ast_ptr<ast::Object>> Parser::resolve_lambda_arguments() noe
   std::vector<ast_ptr<ast::Object>> arguments;
   while (true) {
     arguments.push_back(primary());
-    const auto term = require({token_t::RIGHT_PAREN, token_t::COMMA});
+    const Token& term = require({token_t::RIGHT_PAREN, token_t::COMMA});
     if (term.type != token_t::COMMA) {
       break;
     }
@@ -0,0 +1,475 @@
+#include "../../include/semantic/semantic_analyzer.hpp"
+
+#include "../../include/std/builtins.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+using lambda_table_t = SemanticAnalyzer::lambda_table_t;
+
+std::string ascii_to_lower(std::string_view str) noexcept(false) {
+  std::string result(str);
+  std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+  return result;
+}
+
+template <typename Function>
+void for_each_child(const boost::local_shared_ptr<ast::Object>& node, Function function) noexcept(false) {
+  // clang-format off
+  switch (node->ast_type()) {
+    case ast::type_t::ARRAY: { for (const auto& element : static_cast<const ast::Array&>(*node).elements()) { function(element); } return; }
+    case ast::type_t::BLOCK: { for (const auto& statement : static_cast<const ast::Block&>(*node).statements()) { function(statement); } return; }
+    case ast::type_t::UNARY: { function(static_cast<const ast::Unary&>(*node).operand()); return; }
+    case ast::type_t::BINARY: { function(static_cast<const ast::Binary&>(*node).lhs()); function(static_cast<const ast::Binary&>(*node).rhs()); return; }
+    case ast::type_t::LAMBDA_CALL: { for (const auto& argument : static_cast<const ast::LambdaCall&>(*node).arguments()) { function(argument); } return; }
+    case ast::type_t::TYPE_CREATOR: { for (const auto& argument : static_cast<const ast::TypeCreator&>(*node).arguments()) { function(argument); } return; }
+    // clang-format on
+    case ast::type_t::WHILE: {
+      const auto& while_ = static_cast<const ast::While&>(*node);
+      function(while_.exit_condition());
+      function(while_.body());
+      return;
+    }
+    case ast::type_t::FOR: {
+      const auto& for_ = static_cast<const ast::For&>(*node);
+      function(for_.loop_init());
+      function(for_.exit_condition());
+      function(for_.increment());
+      function(for_.body());
+      return;
+    }
+    case ast::type_t::IF: {
+      const auto& if_ = static_cast<const ast::If&>(*node);
+      function(if_.condition());
+      function(if_.body());
+      function(if_.else_body());
+      return;
+    }
+    default: {
+      return;
+    }
+  }
+}
+
+/// Resolves names of one lambda body, or of statements outside lambdas.
+class FrameBinder {
+public:
+  /// @param globals - top-level declarations
+  /// @param nested  - lambdas, declared in enclosing lambdas
+  FrameBinder(const lambda_table_t& globals, lambda_table_t nested, bool free_names_are_globals) noexcept(true)
+    : globals_(globals)
+    , nested_(std::move(nested))
+    , free_names_are_globals_(free_names_are_globals) {}
+
+  /// @pre    lambda body is parsed
+  void bind_lambda(ast::Lambda& lambda) noexcept(false) {
+    in_lambda_ = true;
+    /// Parameters take slots by position, so repeated name refers to the last one, as in storage.
+    const auto& parameters = lambda.arguments();
+    for (uint32_t i = 0; i < parameters.size(); ++i) {
+      slots_[ascii_to_lower(static_cast<const ast::Symbol&>(*parameters[i]).name())] = i;
+    }
+    parameters_count_ = static_cast<uint32_t>(parameters.size());
+    frame_size_ = parameters_count_;
+    collect(lambda.body());
+    resolve(lambda.body());
+    lambda.bind(frame_size_);
+  }
+
+  void bind_statement(const boost::local_shared_ptr<ast::Object>& statement) noexcept(false) {
+    collect(statement);
+    resolve(statement);
+  }
+
+private:
+  /// @brief  allocate slots for assigned variables, remember nested lambdas
+  void collect(const boost::local_shared_ptr<ast::Object>& node) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::BINARY: {
+        const auto& binary = static_cast<const ast::Binary&>(*node);
+        const token_t type = binary.type();
+        if (in_lambda_ && (type == token_t::ASSIGN || token_traits::is_assign_operator(type)) && binary.lhs()->ast_type() == ast::type_t::SYMBOL) {
+          std::string name = ascii_to_lower(static_cast<const ast::Symbol&>(*binary.lhs()).name());
+          if (std::find(loop_names_.begin(), loop_names_.end(), name) == loop_names_.end() && slots_.try_emplace(std::move(name), frame_size_).second) {
+            ++frame_size_;
+          }
+        }
+        collect(binary.lhs());
+        collect(binary.rhs());
+        return;
+      }
+      case ast::type_t::FOR: {
+        /// Variable of for init is visible only inside loop.
+        const auto name = loop_variable(static_cast<const ast::For&>(*node));
+        if (name) {
+          loop_names_.push_back(*name);
+        }
+        for_each_child(node, [this](const boost::local_shared_ptr<ast::Object>& child) { collect(child); });
+        if (name) {
+          loop_names_.pop_back();
+        }
+        return;
+      }
+      case ast::type_t::LAMBDA: {
+        auto& lambda = static_cast<ast::Lambda&>(*node);
+        nested_[ascii_to_lower(lambda.name())] = &lambda;
+        return;
+      }
+      default: {
+        for_each_child(node, [this](const boost::local_shared_ptr<ast::Object>& child) { collect(child); });
+        return;
+      }
+    }
+  }
+
+  void resolve(const boost::local_shared_ptr<ast::Object>& node) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::SYMBOL: {
+        auto& symbol = static_cast<ast::Symbol&>(*node);
+        resolve_variable(symbol, symbol.name());
+        return;
+      }
+      case ast::type_t::TYPE_FIELD: {
+        auto& field = static_cast<ast::TypeFieldOperator&>(*node);
+        resolve_variable(field, field.name());
+        return;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        auto& call = static_cast<ast::LambdaCall&>(*node);
+        for (const auto& argument : call.arguments()) {
+          resolve(argument);
+        }
+        resolve_call(call);
+        return;
+      }
+      case ast::type_t::FOR: {
+        const auto name = loop_variable(static_cast<const ast::For&>(*node));
+        /// Loop variable takes new slot, unless it's also assigned outside of loop.
+        const bool scoped = name && in_lambda_ && !slots_.contains(*name);
+        if (scoped) {
+          loop_slots_.emplace_back(*name, frame_size_++);
+        }
+        for_each_child(node, [this](const boost::local_shared_ptr<ast::Object>& child) { resolve(child); });
+        if (scoped) {
+          loop_slots_.pop_back();
+        }
+        return;
+      }
+      case ast::type_t::LAMBDA: {
+        auto& lambda = static_cast<ast::Lambda&>(*node);
+        if (!lambda.is_lazy()) {
+          FrameBinder(globals_, nested_, free_names_are_globals_).bind_lambda(lambda);
+        }
+        return;
+      }
+      default: {
+        for_each_child(node, [this](const boost::local_shared_ptr<ast::Object>& child) { resolve(child); });
+        return;
+      }
+    }
+  }
+
+  /// @return lowercased name of variable, assigned in for init
+  static std::optional<std::string> loop_variable(const ast::For& for_) noexcept(false) {
+    const auto& init = for_.loop_init();
+    if (!init || init->ast_type() != ast::type_t::BINARY) {
+      return std::nullopt;
+    }
+    const auto& assignment = static_cast<const ast::Binary&>(*init);
+    if (assignment.type() != token_t::ASSIGN || assignment.lhs()->ast_type() != ast::type_t::SYMBOL) {
+      return std::nullopt;
+    }
+    return ascii_to_lower(static_cast<const ast::Symbol&>(*assignment.lhs()).name());
+  }
+
+  /// @return nested lambda, that is registered at runtime later than top-level one
+  ast::Lambda* find_lambda(const std::string& lower_name) const noexcept(true) {
+    if (const auto nested = nested_.find(lower_name); nested != nested_.end()) {
+      return nested->second;
+    }
+    if (const auto global = globals_.find(lower_name); global != globals_.end()) {
+      return global->second;
+    }
+    return nullptr;
+  }
+
+  /// @return slot of parameter, local or loop variable
+  std::optional<uint32_t> find_slot(const std::string& lower_name) const noexcept(true) {
+    for (auto it = loop_slots_.rbegin(); it != loop_slots_.rend(); ++it) {
+      if (it->first == lower_name) {
+        return it->second;
+      }
+    }
+    if (const auto slot = slots_.find(lower_name); slot != slots_.end()) {
+      return slot->second;
+    }
+    return std::nullopt;
+  }
+
+  void resolve_variable(ast::Resolvable& variable, const std::string& name) noexcept(false) {
+    const std::string lower_name = ascii_to_lower(name);
+    if (const auto slot = find_slot(lower_name)) {
+      variable.resolve(*slot < parameters_count_ ? ast::scope_t::PARAMETER : ast::scope_t::LOCAL, *slot);
+    } else if (find_lambda(lower_name)) {
+      variable.resolve(ast::scope_t::GLOBAL);
+    } else if (!free_names_are_globals_ && in_lambda_) {
+      throw SemanticError("Variable not found: {}", lower_name);
+    }
+  }
+
+  void resolve_call(ast::LambdaCall& call) noexcept(false) {
+    /// Builtins are found by exact name, before any lambda, as in evaluator.
+    if (const auto builtin = builtins.find(call.name()); builtin != builtins.end()) {
+      call.bind(builtin->second);
+      return;
+    }
+    const std::string lower_name = ascii_to_lower(call.name());
+    if (const auto slot = find_slot(lower_name)) {
+      call.resolve(*slot < parameters_count_ ? ast::scope_t::PARAMETER : ast::scope_t::LOCAL, *slot);
+      call.bind_variable();
+      return;
+    }
+    if (ast::Lambda* lambda = find_lambda(lower_name)) {
+      const size_t expected = lambda->arguments().size();
+      if (call.arguments().size() != expected) {
+        throw SemanticError("{}: wrong arguments size, expected {}, got {}", lower_name, expected, call.arguments().size());
+      }
+      call.bind(*lambda);
+      return;
+    }
+    if (!free_names_are_globals_) {
+      throw SemanticError("Lambda not found: {}", lower_name);
+    }
+  }
+
+  const lambda_table_t& globals_;
+  lambda_table_t nested_;
+  bool free_names_are_globals_;
+  bool in_lambda_ = false;
+  std::unordered_map<std::string, uint32_t> slots_;
+  /// Names of loops, enclosing collected node.
+  std::vector<std::string> loop_names_;
+  /// Slots of loops, enclosing resolved node, innermost last.
+  std::vector<std::pair<std::string, uint32_t>> loop_slots_;
+  uint32_t parameters_count_ = 0;
+  uint32_t frame_size_ = 0;
+};
+
+
+/// Finds pure lambdas over call graph. Lambda is pure, if it and all lambdas it calls
+/// don't print, don't mutate arrays and don't write anything except own frame.
+/// @note Literals and arguments are shared with program tree and caller, and ++, -- and
+///       compound assignments change their operand in place, so such writes are allowed
+///       only to locals, which always hold value computed by binary operator.
+/// @note Purity says nothing about returned object, that caller may change in place,
+///       MemoCache checks it separately.
+class EffectAnalyzer {
+public:
+  /// @brief  collect local effects and calls of lambda and its nested lambdas
+  void add(ast::Lambda& lambda) noexcept(false) {
+    auto& summary = summaries_[&lambda];
+    summary.pure = !lambda.is_lazy() && lambda.is_bound();
+    if (!summary.pure) {
+      return;
+    }
+    fresh_slots_.clear();
+    collect_fresh_slots(lambda.body());
+    current_ = &summary;
+    walk(lambda.body());
+    current_ = nullptr;
+    /// Nested lambdas are added after walk, since they reuse fresh slots.
+    auto nested = std::move(nested_);
+    for (ast::Lambda* nested_lambda : nested) {
+      add(*nested_lambda);
+    }
+  }
+
+  /// @brief  propagate impurity from callees to callers, mark lambdas
+  void mark() noexcept(true) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (auto& [lambda, summary] : summaries_) {
+        if (summary.pure && std::any_of(summary.callees.begin(), summary.callees.end(), [this](ast::Lambda* callee) { return !is_pure(callee); })) {
+          summary.pure = false;
+          changed = true;
+        }
+      }
+    }
+    for (auto& [lambda, summary] : summaries_) {
+      lambda->set_pure(summary.pure);
+    }
+  }
+
+private:
+  struct Summary {
+    bool pure = false;
+    std::vector<ast::Lambda*> callees;
+  };
+
+  bool is_pure(ast::Lambda* lambda) const noexcept(true) {
+    const auto summary = summaries_.find(lambda);
+    return summary != summaries_.end() && summary->second.pure;
+  }
+
+  static bool is_literal(const boost::local_shared_ptr<ast::Object>& node) noexcept(true) {
+    const auto type = node->ast_type();
+    return type == ast::type_t::INTEGER || type == ast::type_t::FLOAT || type == ast::type_t::STRING;
+  }
+
+  /// @brief  find locals, every assignment of which creates new value
+  void collect_fresh_slots(const boost::local_shared_ptr<ast::Object>& node) noexcept(false) {
+    if (!node || node->ast_type() == ast::type_t::LAMBDA) {
+      return;
+    }
+    if (node->ast_type() == ast::type_t::BINARY) {
+      const auto& binary = static_cast<const ast::Binary&>(*node);
+      if (binary.type() == token_t::ASSIGN && binary.lhs()->ast_type() == ast::type_t::SYMBOL) {
+        const auto& symbol = static_cast<const ast::Symbol&>(*binary.lhs());
+        if (symbol.scope() == ast::scope_t::LOCAL) {
+          const auto& rhs = binary.rhs();
+          const bool fresh = rhs->ast_type() == ast::type_t::BINARY && !is_assignment(static_cast<const ast::Binary&>(*rhs).type());
+          fresh_slots_.try_emplace(symbol.slot(), true).first->second &= fresh;
+        }
+      }
+    }
+    for_each_child(node, [this](const boost::local_shared_ptr<ast::Object>& child) { collect_fresh_slots(child); });
+  }
+
+  static bool is_assignment(token_t type) noexcept(true) {
+    return type == token_t::ASSIGN || token_traits::is_assign_operator(type);
+  }
+
+  /// @return true if in-place change of variable is visible only in current frame
+  bool is_fresh(const boost::local_shared_ptr<ast::Object>& node) const noexcept(true) {
+    if (node->ast_type() != ast::type_t::SYMBOL) {
+      return false;
+    }
+    const auto& symbol = static_cast<const ast::Symbol&>(*node);
+    const auto slot = fresh_slots_.find(symbol.slot());
+    return symbol.scope() == ast::scope_t::LOCAL && slot != fresh_slots_.end() && slot->second;
+  }
+
+  void walk(const boost::local_shared_ptr<ast::Object>& node) noexcept(false) {
+    if (!node) {
+      return;
+    }
+    switch (node->ast_type()) {
+      case ast::type_t::SYMBOL: {
+        /// Unresolved names are read from storage, that may change between calls.
+        current_->pure &= static_cast<const ast::Symbol&>(*node).scope() != ast::scope_t::UNRESOLVED;
+        return;
+      }
+      case ast::type_t::TYPE_FIELD: {
+        current_->pure &= static_cast<const ast::TypeFieldOperator&>(*node).scope() != ast::scope_t::UNRESOLVED;
+        return;
+      }
+      case ast::type_t::BINARY: {
+        const auto& binary = static_cast<const ast::Binary&>(*node);
+        if (binary.type() == token_t::ASSIGN) {
+          current_->pure &= binary.lhs()->ast_type() == ast::type_t::SYMBOL && static_cast<const ast::Symbol&>(*binary.lhs()).in_frame();
+        } else if (token_traits::is_assign_operator(binary.type())) {
+          current_->pure &= is_fresh(binary.lhs());
+        }
+        break;
+      }
+      case ast::type_t::UNARY: {
+        current_->pure &= is_fresh(static_cast<const ast::Unary&>(*node).operand());
+        break;
+      }
+      case ast::type_t::ARRAY: {
+        /// Evaluated elements replace expressions in array node.
+        const auto& elements = static_cast<const ast::Array&>(*node).elements();
+        current_->pure &= std::all_of(elements.begin(), elements.end(), is_literal);
+        break;
+      }
+      case ast::type_t::LAMBDA_CALL: {
+        walk_call(static_cast<const ast::LambdaCall&>(*node));
+        break;
+      }
+      case ast::type_t::LAMBDA: {
+        /// Declaration is stored in storage on every call.
+        current_->pure = false;
+        nested_.push_back(&static_cast<ast::Lambda&>(*node));
+        return;
+      }
+      case ast::type_t::TYPE_DEFINITION: {
+        current_->pure = false;
+        return;
+      }
+      default: {
+        break;
+      }
+    }
+    for_each_child(node, [this](const boost::local_shared_ptr<ast::Object>& child) { walk(child); });
+  }
+
+  void walk_call(const ast::LambdaCall& call) noexcept(false) {
+    switch (call.target()) {
+      case ast::LambdaCall::target_t::BUILTIN: {
+        current_->pure &= is_pure_builtin(call.name());
+        return;
+      }
+      case ast::LambdaCall::target_t::LAMBDA: {
+        current_->callees.push_back(&call.lambda());
+        return;
+      }
+      default: {
+        /// Callee is known only at runtime.
+        current_->pure = false;
+        return;
+      }
+    }
+  }
+
+  std::unordered_map<ast::Lambda*, Summary> summaries_;
+  Summary* current_ = nullptr;
+  /// Local slot -> true if all its assignments create new value.
+  std::unordered_map<uint32_t, bool> fresh_slots_;
+  std::vector<ast::Lambda*> nested_;
+};
+
+}// namespace
+
+void SemanticAnalyzer::bind(ast::RootObject& program, bool free_names_are_globals) noexcept(false) {
+  const lambda_table_t globals = lambdas(program.get());
+  for (const auto& declaration : program.get()) {
+    FrameBinder binder(globals, {}, free_names_are_globals);
+    if (declaration->ast_type() != ast::type_t::LAMBDA) {
+      binder.bind_statement(declaration);
+    } else if (auto& lambda = static_cast<ast::Lambda&>(*declaration); !lambda.is_lazy()) {
+      binder.bind_lambda(lambda);
+    }
+  }
+  EffectAnalyzer effects;
+  for (const auto& declaration : program.get()) {
+    if (declaration->ast_type() == ast::type_t::LAMBDA) {
+      effects.add(static_cast<ast::Lambda&>(*declaration));
+    }
+  }
+  effects.mark();
+}
+
+void SemanticAnalyzer::bind(ast::Lambda& lambda, const lambda_table_t& globals) noexcept(false) {
+  FrameBinder(globals, {}, /*free_names_are_globals=*/false).bind_lambda(lambda);
+}
+
+SemanticAnalyzer::lambda_table_t SemanticAnalyzer::lambdas(const std::vector<boost::local_shared_ptr<ast::Object>>& program) noexcept(false) {
+  /// Later declaration replaces previous one, as in evaluator storage.
+  lambda_table_t table;
+  for (const auto& declaration : program) {
+    if (declaration->ast_type() == ast::type_t::LAMBDA) {
+      auto& lambda = static_cast<ast::Lambda&>(*declaration);
+      table[ascii_to_lower(lambda.name())] = &lambda;
+    }
+  }
+  return table;
+}
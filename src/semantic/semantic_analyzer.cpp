@@ -1,20 +1,51 @@
 #include "../../include/semantic/semantic_analyzer.hpp"
 
-SemanticAnalyzer::SemanticAnalyzer(boost::local_shared_ptr<ast::RootObject> input) noexcept(false) {
-  for (const auto& expr : input->get()) {
-    input_.push_back(expr);
+#include <algorithm>
+#include <cctype>
+
+static std::string ascii_to_lower(std::string_view str) noexcept(false) {
+  std::string result(str);
+  std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return std::tolower(c); });
+  return result;
+}
+
+/// @return types, that are the same on both paths
+static std::unordered_map<std::string, ast::inferred_t> join(const std::unordered_map<std::string, ast::inferred_t>& lhs, const std::unordered_map<std::string, ast::inferred_t>& rhs) noexcept(false) {
+  std::unordered_map<std::string, ast::inferred_t> result;
+  for (const auto& [name, type] : lhs) {
+    if (auto found = rhs.find(name); found != rhs.end() && found->second == type) {
+      result.emplace(name, type);
+    }
   }
+  return result;
+}
+
+static bool is_number(ast::inferred_t type) noexcept(true) {
+  return type == ast::inferred_t::INTEGER || type == ast::inferred_t::FLOAT;
 }
 
+SemanticAnalyzer::SemanticAnalyzer(boost::local_shared_ptr<ast::RootObject> input) noexcept(false)
+  : SemanticAnalyzer(input, ast::FlatTree::flatten(*input)) {}
+
+SemanticAnalyzer::SemanticAnalyzer(boost::local_shared_ptr<ast::RootObject> input, ast::FlatTree flat) noexcept(true)
+  : program_(std::move(input))
+  , input_(std::move(flat)) {}
+
+SemanticAnalyzer::SemanticAnalyzer(ast::FlatTree input) noexcept(true)
+  : input_(std::move(input)) {}
+
 void SemanticAnalyzer::analyze() noexcept(false) {
-  for (const auto& expression : input_) {
+  for (index_t expression : input_.roots()) {
     analyze_statement(expression);
   }
+  if (program_) {
+    infer_types();
+  }
 }
 
-void SemanticAnalyzer::analyze_statement(const boost::local_shared_ptr<ast::Object>& statement) noexcept(false) {
+void SemanticAnalyzer::analyze_statement(index_t statement) noexcept(false) {
   // clang-format off
-  switch (statement->ast_type()) {
+  switch (input_.kind(statement)) {
     case ast::type_t::STRING:
     case ast::type_t::INTEGER:
     case ast::type_t::FLOAT:
@@ -24,48 +55,47 @@ void SemanticAnalyzer::analyze_statement(const boost::local_shared_ptr<ast::Obje
       return;
     }
     case ast::type_t::BINARY: {
-      const auto binary = boost::static_pointer_cast<ast::Binary>(statement);
-      const token_t binary_type = binary->type();
+      const token_t binary_type = input_.op(statement);
       if (binary_type == token_t::ASSIGN || token_traits::is_assign_operator(binary_type)) {
-        analyze_assign_statement(binary);
+        analyze_assign_statement(statement);
       } else {
-        analyze_binary_statement(binary);
+        analyze_binary_statement(statement);
       }
       return;
     }
     case ast::type_t::UNARY: {
-      const auto unary = boost::static_pointer_cast<ast::Unary>(statement);
-      if (unary->operand()->ast_type() != ast::type_t::INTEGER && unary->operand()->ast_type() != ast::type_t::FLOAT && unary->operand()->ast_type() != ast::type_t::SYMBOL) {
+      const ast::type_t operand_type = input_.kind(input_.child(statement, 0));
+      if (operand_type != ast::type_t::INTEGER && operand_type != ast::type_t::FLOAT && operand_type != ast::type_t::SYMBOL) {
         throw SemanticError("Invalid unary operands");
       }
       return;
     }
     case ast::type_t::BLOCK: {
-      analyze_block_statement(boost::static_pointer_cast<ast::Block>(statement));
+      analyze_block_statement(statement);
       return;
     }
     case ast::type_t::ARRAY: {
-      analyze_array_statement(boost::static_pointer_cast<ast::Array>(statement));
+      analyze_array_statement(statement);
       return;
     }
     case ast::type_t::LAMBDA: {
-      analyze_lambda_statement(boost::static_pointer_cast<ast::Lambda>(statement));
+      analyze_lambda_statement(statement);
       return;
     }
     case ast::type_t::LAMBDA_CALL: {
-      analyze_lambda_call_statement(boost::static_pointer_cast<ast::LambdaCall>(statement));
+      analyze_lambda_call_statement(statement);
       return;
     }
     case ast::type_t::IF: {
-      analyze_if_statement(boost::static_pointer_cast<ast::If>(statement));
+      analyze_if_statement(statement);
       return;
     }
     case ast::type_t::WHILE: {
-      analyze_while_statement(boost::static_pointer_cast<ast::While>(statement));
+      analyze_while_statement(statement);
       return;
     }
     case ast::type_t::FOR: {
-      analyze_for_statement(boost::static_pointer_cast<ast::For>(statement));
+      analyze_for_statement(statement);
       return;
     }
     default: { throw SemanticError("Unexpected statement"); }
@@ -73,45 +103,43 @@ void SemanticAnalyzer::analyze_statement(const boost::local_shared_ptr<ast::Obje
   // clang-format on
 }
 
-void SemanticAnalyzer::analyze_array_statement(const boost::local_shared_ptr<ast::Array>& statement) noexcept(false) {
-  for (const auto& element : statement->elements()) {
-    ast::type_t element_type = element->ast_type();
+void SemanticAnalyzer::analyze_array_statement(index_t statement) noexcept(false) {
+  for (index_t element : input_.children(statement)) {
+    ast::type_t element_type = input_.kind(element);
     if (element_type != ast::type_t::SYMBOL && element_type != ast::type_t::INTEGER && element_type != ast::type_t::FLOAT && element_type != ast::type_t::STRING && element_type != ast::type_t::BINARY && element_type != ast::type_t::LAMBDA_CALL && element_type != ast::type_t::ARRAY) {
       throw SemanticError("Array expects object don't statement");
     }
   }
 }
 
-void SemanticAnalyzer::analyze_assign_statement(const boost::local_shared_ptr<ast::Binary>& statement) noexcept(false) {
-  if (statement->lhs()->ast_type() != ast::type_t::SYMBOL) {
+void SemanticAnalyzer::analyze_assign_statement(index_t statement) noexcept(false) {
+  if (input_.kind(input_.child(statement, 0)) != ast::type_t::SYMBOL) {
     throw SemanticError("Expression is not assignable");
   }
 
-  const ast::type_t statement_type = statement->ast_type();
-  if (statement_type != ast::type_t::SYMBOL && statement_type != ast::type_t::INTEGER && statement_type != ast::type_t::FLOAT && statement_type != ast::type_t::STRING && statement_type != ast::type_t::BINARY && statement_type != ast::type_t::UNARY && statement_type != ast::type_t::LAMBDA_CALL && statement_type != ast::type_t::ARRAY) {
-    throw SemanticError("Expression is not assignable");
-  }
-
-  if (statement->rhs()->ast_type() == ast::type_t::BINARY) {
-    analyze_statement(boost::static_pointer_cast<ast::Binary>(statement->rhs()));
+  const index_t rhs = input_.child(statement, 1);
+  if (input_.kind(rhs) == ast::type_t::BINARY) {
+    analyze_statement(rhs);
   }
 }
 
-void SemanticAnalyzer::analyze_binary_statement(const boost::local_shared_ptr<ast::Binary>& statement) noexcept(false) {
-  if (!token_traits::is_binary(statement->type())) {
-    throw SemanticError("Incorrect binary expression operator: {}", dispatch_token(statement->type()));
+void SemanticAnalyzer::analyze_binary_statement(index_t statement) noexcept(false) {
+  if (!token_traits::is_binary(input_.op(statement))) {
+    throw SemanticError("Incorrect binary expression operator: {}", dispatch_token(input_.op(statement)));
   }
 
-  if (auto lhs = boost::dynamic_pointer_cast<ast::Binary>(statement->lhs())) {
+  const index_t lhs = input_.child(statement, 0);
+  const index_t rhs = input_.child(statement, 1);
+  if (input_.kind(lhs) == ast::type_t::BINARY) {
     analyze_binary_statement(lhs);
-  } else if (auto rhs = boost::dynamic_pointer_cast<ast::Binary>(statement->rhs())) {
+  } else if (input_.kind(rhs) == ast::type_t::BINARY) {
     analyze_binary_statement(rhs);
   }
 }
 
-void SemanticAnalyzer::analyze_lambda_call_statement(const boost::local_shared_ptr<ast::LambdaCall>& lambda) noexcept(false) {
-  for (const auto& argument : lambda->arguments()) {
-    switch (argument->ast_type()) {
+void SemanticAnalyzer::analyze_lambda_call_statement(index_t lambda) noexcept(false) {
+  for (index_t argument : input_.children(lambda)) {
+    switch (input_.kind(argument)) {
       case ast::type_t::INTEGER:
       case ast::type_t::FLOAT:
       case ast::type_t::STRING:
@@ -130,75 +158,75 @@ void SemanticAnalyzer::analyze_lambda_call_statement(const boost::local_shared_p
   }
 }
 
-void SemanticAnalyzer::analyze_lambda_statement(const boost::local_shared_ptr<ast::Lambda>& lambda) noexcept(false) {
-  /// Lambda arguments are easily checked in parser.
-  analyze_block_statement(lambda->body());
+void SemanticAnalyzer::analyze_lambda_statement(index_t lambda) noexcept(false) {
+  /// Lambda arguments are easily checked in parser, body is the last child.
+  index_t body = lambda + 1;
+  while (input_.end(body) != input_.end(lambda)) {
+    body = input_.end(body);
+  }
+  /// Lazy body is analyzed on first call.
+  if (input_.is_null(body)) {
+    return;
+  }
+  analyze_block_statement(body);
 }
 
-void SemanticAnalyzer::analyze_if_statement(const boost::local_shared_ptr<ast::If>& if_statement) noexcept(false) {
-  if (!to_integral_convertible(if_statement->condition())) {
+void SemanticAnalyzer::analyze_if_statement(index_t if_statement) noexcept(false) {
+  if (!to_integral_convertible(input_.child(if_statement, 0))) {
     throw SemanticError("If condition requires convertible to bool expression");
   }
 
-  auto if_body = boost::dynamic_pointer_cast<ast::Block>(if_statement->body());
-  auto else_body = boost::dynamic_pointer_cast<ast::Block>(if_statement->else_body());
+  analyze_block_statement(input_.child(if_statement, 1));
 
-  for (const auto& if_instruction : if_body->statements()) {
-    analyze_statement(if_instruction);
-  }
-
-  if (else_body) {
-    for (const auto& if_instruction : else_body->statements()) {
-      analyze_statement(if_instruction);
-    }
+  const index_t else_body = input_.child(if_statement, 2);
+  if (!input_.is_null(else_body)) {
+    analyze_block_statement(else_body);
   }
 }
 
-void SemanticAnalyzer::analyze_while_statement(const boost::local_shared_ptr<ast::While>& while_statement) noexcept(false) {
-  if (!to_number_convertible(while_statement->exit_condition())) {
+void SemanticAnalyzer::analyze_while_statement(index_t while_statement) noexcept(false) {
+  if (!to_number_convertible(input_.child(while_statement, 0))) {
     throw SemanticError("While condition requires convertible to bool expression");
   }
-  auto body = boost::dynamic_pointer_cast<ast::Block>(while_statement->body());
-  for (const auto& while_instruction : body->statements()) {
-    analyze_statement(while_instruction);
-  }
+  analyze_block_statement(input_.child(while_statement, 1));
 }
 
-void SemanticAnalyzer::analyze_for_statement(const boost::local_shared_ptr<ast::For>& statement) noexcept(false) {
-  if (statement->loop_init()) {
-    if (statement->loop_init()->ast_type() != ast::type_t::BINARY) {
+void SemanticAnalyzer::analyze_for_statement(index_t statement) noexcept(false) {
+  const index_t init = input_.child(statement, 0);
+  const index_t exit_condition = input_.end(init);
+  const index_t increment = input_.end(exit_condition);
+  const index_t body = input_.end(increment);
+
+  if (!input_.is_null(init)) {
+    if (input_.kind(init) != ast::type_t::BINARY) {
       throw SemanticError("Bad for init");
     }
-
-    auto init = boost::static_pointer_cast<ast::Binary>(statement->loop_init());
-    if (init->type() != token_t::ASSIGN) {
+    if (input_.op(init) != token_t::ASSIGN) {
       throw SemanticError("For init part requires assignment operation");
     }
   }
-  if (statement->exit_condition()) {
-    if (!to_integral_convertible(statement->exit_condition())) {
+  if (!input_.is_null(exit_condition)) {
+    if (!to_integral_convertible(exit_condition)) {
       throw SemanticError("For condition requires convertible to bool expression");
     }
   }
-  if (statement->increment()) {
-    if (statement->increment()->ast_type() != ast::type_t::UNARY && statement->increment()->ast_type() != ast::type_t::BINARY) {
+  if (!input_.is_null(increment)) {
+    if (input_.kind(increment) != ast::type_t::UNARY && input_.kind(increment) != ast::type_t::BINARY) {
       throw SemanticError("Bad for increment part");
     }
   }
-  for (const auto& instruction : statement->body()->statements()) {
-    analyze_statement(instruction);
-  }
+  analyze_block_statement(body);
 }
 
-void SemanticAnalyzer::analyze_block_statement(const boost::local_shared_ptr<ast::Block>& statement) noexcept(false) {
-  for (const auto& instruction : statement->statements()) {
+void SemanticAnalyzer::analyze_block_statement(index_t statement) noexcept(false) {
+  for (index_t instruction : input_.children(statement)) {
     analyze_statement(instruction);
   }
 }
 
-bool SemanticAnalyzer::to_integral_convertible(const boost::local_shared_ptr<ast::Object>& statement) noexcept(false) {
+bool SemanticAnalyzer::to_integral_convertible(index_t statement) noexcept(false) {
   // clang-format off
-  switch (statement->ast_type()) {
+  switch (input_.kind(statement)) {
     case ast::type_t::SYMBOL:
     case ast::type_t::INTEGER:
     case ast::type_t::LAMBDA_CALL:
@@ -206,9 +234,8 @@ bool SemanticAnalyzer::to_integral_convertible(const boost::local_shared_ptr<ast
       return true;
     }
     case ast::type_t::BINARY: {
-      auto binary = boost::static_pointer_cast<ast::Binary>(statement);
       try {
-        analyze_binary_statement(binary);
+        analyze_binary_statement(statement);
       } catch (SemanticError& err) {
         return false;
       }
@@ -219,6 +246,167 @@ bool SemanticAnalyzer::to_integral_convertible(const boost::local_shared_ptr<ast
   // clang-format on
 }
 
-bool SemanticAnalyzer::to_number_convertible(const boost::local_shared_ptr<ast::Object>& statement) noexcept(false) {
-  return to_integral_convertible(statement) || statement->ast_type() == ast::type_t::FLOAT;
+bool SemanticAnalyzer::to_number_convertible(index_t statement) noexcept(false) {
+  return to_integral_convertible(statement) || input_.kind(statement) == ast::type_t::FLOAT;
+}
+
+void SemanticAnalyzer::infer_types() noexcept(false) {
+  for (const auto& expression : program_->get()) {
+    type_environment_t environment;
+    infer_expression(expression, environment);
+  }
+}
+
+void SemanticAnalyzer::specialize(ast::Lambda& lambda, const std::vector<ast::inferred_t>& parameters) noexcept(false) {
+  type_environment_t environment;
+  const auto& arguments = lambda.arguments();
+  for (size_t i = 0; i < arguments.size() && i < parameters.size(); ++i) {
+    if (parameters[i] != ast::inferred_t::UNKNOWN) {
+      environment.emplace(ascii_to_lower(static_cast<const ast::Symbol&>(*arguments[i]).name()), parameters[i]);
+    }
+  }
+  SemanticAnalyzer analyzer{ast::FlatTree{}};
+  analyzer.infer_expression(lambda.body(), environment);
+}
+
+ast::inferred_t SemanticAnalyzer::infer_expression(const boost::local_shared_ptr<ast::Object>& expression, type_environment_t& environment) noexcept(false) {
+  if (!expression) {
+    return ast::inferred_t::UNKNOWN;
+  }
+  // clang-format off
+  switch (expression->ast_type()) {
+    case ast::type_t::INTEGER: { return ast::inferred_t::INTEGER; }
+    case ast::type_t::FLOAT: { return ast::inferred_t::FLOAT; }
+    case ast::type_t::STRING: { return ast::inferred_t::STRING; }
+    // clang-format on
+    case ast::type_t::SYMBOL: {
+      auto& symbol = static_cast<ast::Symbol&>(*expression);
+      const auto found = environment.find(ascii_to_lower(symbol.name()));
+      symbol.set_inferred_type(found != environment.end() ? found->second : ast::inferred_t::UNKNOWN);
+      return symbol.inferred_type();
+    }
+    case ast::type_t::ARRAY: {
+      for (const auto& element : static_cast<ast::Array&>(*expression).elements()) {
+        infer_expression(element, environment);
+      }
+      return ast::inferred_t::ARRAY;
+    }
+    case ast::type_t::BINARY: {
+      return infer_binary(static_cast<ast::Binary&>(*expression), environment);
+    }
+    case ast::type_t::UNARY: {
+      return infer_unary(static_cast<ast::Unary&>(*expression), environment);
+    }
+    case ast::type_t::BLOCK: {
+      for (const auto& statement : static_cast<ast::Block&>(*expression).statements()) {
+        infer_expression(statement, environment);
+      }
+      return ast::inferred_t::UNKNOWN;
+    }
+    case ast::type_t::IF: {
+      infer_if(static_cast<ast::If&>(*expression), environment);
+      return ast::inferred_t::UNKNOWN;
+    }
+    case ast::type_t::WHILE: {
+      auto& while_ = static_cast<ast::While&>(*expression);
+      while_.set_inferred_type(infer_loop(while_.exit_condition(), {while_.body()}, environment));
+      return ast::inferred_t::UNKNOWN;
+    }
+    case ast::type_t::FOR: {
+      auto& for_ = static_cast<ast::For&>(*expression);
+      infer_expression(for_.loop_init(), environment);
+      for_.set_inferred_type(infer_loop(for_.exit_condition(), {for_.body(), for_.increment()}, environment));
+      return ast::inferred_t::UNKNOWN;
+    }
+    case ast::type_t::LAMBDA: {
+      /// Nested lambda doesn't see types of enclosing one, since it may be called from anywhere.
+      type_environment_t lambda_environment;
+      infer_expression(static_cast<ast::Lambda&>(*expression).body(), lambda_environment);
+      return ast::inferred_t::UNKNOWN;
+    }
+    case ast::type_t::LAMBDA_CALL: {
+      const auto& call = static_cast<ast::LambdaCall&>(*expression);
+      for (const auto& argument : call.arguments()) {
+        infer_expression(argument, environment);
+      }
+      return ast::inferred_t::UNKNOWN;
+    }
+    case ast::type_t::TYPE_CREATOR: {
+      for (const auto& argument : static_cast<ast::TypeCreator&>(*expression).arguments()) {
+        infer_expression(argument, environment);
+      }
+      return ast::inferred_t::OBJECT;
+    }
+    default: {
+      return ast::inferred_t::UNKNOWN;
+    }
+  }
+}
+
+ast::inferred_t SemanticAnalyzer::infer_binary(ast::Binary& binary, type_environment_t& environment) noexcept(false) {
+  const token_t type = binary.type();
+  if (type == token_t::ASSIGN || token_traits::is_assign_operator(type)) {
+    const ast::inferred_t rhs = infer_expression(binary.rhs(), environment);
+    if (binary.lhs()->ast_type() != ast::type_t::SYMBOL) {
+      return ast::inferred_t::UNKNOWN;
+    }
+    auto& variable = static_cast<ast::Symbol&>(*binary.lhs());
+    ast::inferred_t& variable_type = environment[ascii_to_lower(variable.name())];
+    if (type == token_t::ASSIGN || is_number(rhs)) {
+      /// Compound assignment succeeds only for operands of the same numeric type.
+      variable_type = rhs;
+    } else if (!is_number(variable_type)) {
+      variable_type = ast::inferred_t::UNKNOWN;
+    }
+    variable.set_inferred_type(variable_type);
+    /// Value of assignment is the assignment node (or the variable symbol), not a number.
+    binary.set_inferred_type(ast::inferred_t::UNKNOWN);
+    return ast::inferred_t::UNKNOWN;
+  }
+  const ast::inferred_t lhs = infer_expression(binary.lhs(), environment);
+  const ast::inferred_t rhs = infer_expression(binary.rhs(), environment);
+  ast::inferred_t result = ast::inferred_t::UNKNOWN;
+  if (lhs == ast::inferred_t::INTEGER && rhs == ast::inferred_t::INTEGER) {
+    result = ast::inferred_t::INTEGER;
+  } else if (is_number(lhs) && is_number(rhs)) {
+    result = ast::inferred_t::FLOAT;
+  }
+  binary.set_inferred_type(result);
+  return result;
+}
+
+ast::inferred_t SemanticAnalyzer::infer_unary(ast::Unary& unary, type_environment_t& environment) noexcept(false) {
+  const ast::inferred_t operand = infer_expression(unary.operand(), environment);
+  const bool is_increment = unary.type() == token_t::INC || unary.type() == token_t::DEC;
+  unary.set_inferred_type(is_increment && is_number(operand) ? operand : ast::inferred_t::UNKNOWN);
+  return unary.inferred_type();
+}
+
+void SemanticAnalyzer::infer_if(const ast::If& if_statement, type_environment_t& environment) noexcept(false) {
+  infer_expression(if_statement.condition(), environment);
+  type_environment_t else_environment = environment;
+  infer_expression(if_statement.body(), environment);
+  infer_expression(if_statement.else_body(), else_environment);
+  environment = join(environment, else_environment);
+}
+
+ast::inferred_t SemanticAnalyzer::infer_loop(const boost::local_shared_ptr<ast::Object>& condition, std::initializer_list<boost::local_shared_ptr<ast::Object>> iteration, type_environment_t& environment) noexcept(false) {
+  /// Types at loop head are joined with types after iteration until they stop changing.
+  /// Variable can only lose its type while joining, so it takes few passes. Every pass
+  /// rewrites annotations, so the last one leaves annotations valid for stable head.
+  type_environment_t head = environment;
+  while (true) {
+    type_environment_t state = head;
+    infer_expression(condition, state);
+    for (const auto& part : iteration) {
+      infer_expression(part, state);
+    }
+    type_environment_t joined = join(head, state);
+    if (joined == head) {
+      break;
+    }
+    head = std::move(joined);
+  }
+  environment = std::move(head);
+  return infer_expression(condition, environment);
 }
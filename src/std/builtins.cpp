@@ -22,3 +22,7 @@ const std::unordered_map<std::string, builtin_function_t> builtins{
     /// io
     {"print", print},
     {"println", println}};
+
+bool is_pure_builtin(std::string_view name) noexcept(true) {
+  return name != "print" && name != "println" && name != "array-replace" && name != "array-insert";
+}
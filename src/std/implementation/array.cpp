@@ -1,12 +1,18 @@
 #include "../../../include/ast/ast.hpp"
 #include "../../../include/error/eval_error.hpp"
 
+#include <limits>
 #include <optional>
 
+/// @return index, max of size_t if it's negative or big, so it's out of range of any array
+ALWAYS_INLINE static size_t to_index(const ast::Integer* index) noexcept(true) {
+  return index->is_big() || index->value() < 0 ? std::numeric_limits<size_t>::max() : static_cast<size_t>(index->value());
+}
+
 template <typename AST>
 ALWAYS_INLINE static void perform_assign(ast::Array* array, ast::Integer* index, ast::Object* object) noexcept(false) {
-  static_cast<AST*>(array->elements().at(index->value()).get())->value() =
-      static_cast<AST*>(object)->value();
+  *static_cast<AST*>(array->elements().at(to_index(index)).get()) =
+      *static_cast<AST*>(object);
 }
 
 ALWAYS_INLINE static void perform_insertion(ast::Array* array, ast::Integer* index, boost::local_shared_ptr<ast::Object> object) noexcept(false) {
@@ -22,10 +28,10 @@ inline std::optional<boost::local_shared_ptr<ast::Object>> array_get(const std::
   if (!array || !index) {
     throw EvalError("array-get: wrong types");
   }
-  if (array->elements().size() <= index->value()) {
-    throw EvalError("array-get: overflow (index is {}, size is {})", index->value(), array->elements().size());
+  if (array->elements().size() <= to_index(index)) {
+    throw EvalError("array-get: overflow (index is {}, size is {})", index->to_string(), array->elements().size());
   }
-  return array->elements().at(index->value());
+  return array->elements().at(to_index(index));
 }
 
 inline std::optional<boost::local_shared_ptr<ast::Object>> array_replace(const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) noexcept(false) {
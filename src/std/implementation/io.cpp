@@ -7,7 +7,11 @@ extern std::ostream& default_stdout;
 
 inline std::optional<boost::local_shared_ptr<ast::Object>> print(const std::vector<boost::local_shared_ptr<ast::Object>>& arguments) {
   auto print_impl = [&arguments](size_t idx, auto* object) {
-    default_stdout << object->value();
+    if constexpr (std::is_same_v<std::remove_pointer_t<decltype(object)>, ast::Integer>) {
+      default_stdout << object->to_string();
+    } else {
+      default_stdout << object->value();
+    }
     if (idx < arguments.size() - 1) {
       default_stdout << ' ';
     }